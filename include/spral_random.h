@@ -18,6 +18,22 @@ int spral_random_integer(int *state, int n);
 int64_t spral_random_long(int *state, int64_t n);
 /* Generate a sample with equal probability of true or false */
 bool spral_random_logical(int *state);
+/* Fill x[0:len-1] with samples from Unif(-1,1) or Unif(0,1) */
+void spral_random_real_array(int *state, bool positive, int64_t len,
+      double *x);
+/* Fill x[0:len-1] with samples from Unif(minv,maxv) */
+void spral_random_real_array_in_range(int *state, double minv, double maxv,
+      int64_t len, double *x);
+/* Fill x[0:len-1] with samples from discrete Unif(1,...,n) */
+void spral_random_integer_array(int *state, int n, int64_t len, int *x);
+/* Fill x[0:len-1] with samples from discrete Unif(1,...,n) */
+void spral_random_long_array(int *state, int64_t n, int64_t len, int64_t *x);
+/* Fill x[0:len-1] with samples from discrete Unif(minv,...,maxv) */
+void spral_random_integer_array_in_range(int *state, int minv, int maxv,
+      int64_t len, int *x);
+/* Fill x[0:len-1] with samples from discrete Unif(minv,...,maxv) */
+void spral_random_long_array_in_range(int *state, int64_t minv, int64_t maxv,
+      int64_t len, int64_t *x);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -11,6 +11,8 @@ extern "C" {
 #define SPRAL_RANDOM_MATRIX_FINDEX        1
 #define SPRAL_RANDOM_MATRIX_NONSINGULAR   2
 #define SPRAL_RANDOM_MATRIX_SORT          4
+#define SPRAL_RANDOM_MATRIX_DIRECT        8
+#define SPRAL_RANDOM_MATRIX_COMPLEMENT   16
 
 /* Generate an m x n random matrix with nnz non-zero entries */
 int spral_random_matrix_generate(int *state, enum spral_matrix_type matrix_type,
@@ -28,6 +30,52 @@ int spral_random_matrix_generate_band(int *state, enum spral_matrix_type matrix_
 int spral_random_matrix_generate_band_long(int *state,
       enum spral_matrix_type matrix_type, int m, int n, int64_t nnz, int bandwidth,
       int64_t *ptr, int *row, double *val, int flags);
+/* Generate an m x n random band matrix with nnz non-zero entries, lower
+ * bandwidth kl and upper bandwidth ku, diagonally dominant if dominance>0 */
+int spral_random_matrix_generate_band_kl_ku(int *state,
+      enum spral_matrix_type matrix_type, int m, int n, int nnz, int kl, int ku,
+      int *ptr, int *row, double *val, double dominance, int flags);
+/* Generate an m x n random band matrix with nnz non-zero entries, lower
+ * bandwidth kl and upper bandwidth ku (nnz,ptr int64_t) */
+int spral_random_matrix_generate_band_kl_ku_long(int *state,
+      enum spral_matrix_type matrix_type, int m, int n, int64_t nnz, int kl,
+      int ku, int64_t *ptr, int *row, double *val, double dominance, int flags);
+/* Generate an m x n random band matrix with nnz non-zero entries, lower
+ * bandwidth kl and upper bandwidth ku, in coordinate format: entry k is in
+ * row row[k] and column col[k] */
+int spral_random_matrix_generate_band_coord(int *state,
+      enum spral_matrix_type matrix_type, int m, int n, int nnz, int kl, int ku,
+      int *row, int *col, double *val, double dominance, int flags);
+/* Generate an m x n random band matrix with nnz non-zero entries in
+ * coordinate format (nnz int64_t) */
+int spral_random_matrix_generate_band_coord_long(int *state,
+      enum spral_matrix_type matrix_type, int m, int n, int64_t nnz, int kl,
+      int ku, int *row, int *col, double *val, double dominance, int flags);
+
+/* Generate an m x n random band matrix with nnz non-zero entries directly in
+ * LAPACK band storage ab[n][ldab] (GB layout, or SB lower layout if
+ * symmetric) */
+int spral_random_matrix_generate_lapack_band(int *state,
+      enum spral_matrix_type matrix_type, int m, int n, int nnz, int kl, int ku,
+      double *ab, int ldab, double dominance, int flags);
+/* Generate an m x n random band matrix with nnz non-zero entries directly in
+ * LAPACK band storage ab[n][ldab] (nnz int64_t) */
+int spral_random_matrix_generate_lapack_band_long(int *state,
+      enum spral_matrix_type matrix_type, int m, int n, int64_t nnz, int kl,
+      int ku, double *ab, int ldab, double dominance, int flags);
+
+/* Generate an m x n random block band matrix with nblk dense b x b blocks,
+ * lower and upper bandwidths kl and ku in blocks. row and val must have space
+ * for nblk*b*b entries, of which ptr[n] are used (ptr[n]-1 if FINDEX) */
+int spral_random_matrix_generate_block_band(int *state,
+      enum spral_matrix_type matrix_type, int m, int n, int b, int nblk, int kl,
+      int ku, int *ptr, int *row, double *val, double dominance, int flags);
+/* Generate an m x n random block band matrix with nblk dense b x b blocks
+ * (nblk,ptr int64_t) */
+int spral_random_matrix_generate_block_band_long(int *state,
+      enum spral_matrix_type matrix_type, int m, int n, int b, int64_t nblk,
+      int kl, int ku, int64_t *ptr, int *row, double *val, double dominance,
+      int flags);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -32,7 +32,12 @@ struct spral_ssids_options {
    int pivot_method;
    double small;
    double u;
-   char unused[80]; // Allow for future expansion
+   int band_mode;
+   int band_max_width;
+   bool single_precision;
+   int max_refine;
+   double refine_tol;
+   char unused[56]; // Allow for future expansion
 };
 
 struct spral_ssids_inform {
@@ -53,7 +58,9 @@ struct spral_ssids_inform {
    int cuda_error;
    int cublas_error;
    int maxsupernode;
-   char unused[76]; // Allow for future expansion
+   int num_refine;
+   int num_relaxed;
+   char unused[68]; // Allow for future expansion
 };
 
 /************************************
@@ -93,6 +100,20 @@ void spral_ssids_solve1(int job, double *x1, void *akeep, void *fkeep,
 void spral_ssids_solve(int job, int nrhs, double *x, int ldx, void *akeep,
       void *fkeep, const struct spral_ssids_options *options,
       struct spral_ssids_inform *inform);
+/* Perform full solve(s) for sparse rhs, computing selected components of x */
+void spral_ssids_solve_sparse(int nrhs, const int *rhs_ptr, const int *rhs_row,
+      const double *rhs_val, double *x, int ldx, int nwant, const int *want,
+      void *akeep, void *fkeep, const struct spral_ssids_options *options,
+      struct spral_ssids_inform *inform);
+/* Perform full solve(s) with iterative refinement */
+void spral_ssids_solve_refine(int nrhs, double *x, int ldx,
+      const int64_t *ptr, const int *row, const double *val, void *akeep,
+      void *fkeep, const struct spral_ssids_options *options,
+      struct spral_ssids_inform *inform);
+void spral_ssids_solve_refine_ptr32(int nrhs, double *x, int ldx,
+      const int *ptr, const int *row, const double *val, void *akeep,
+      void *fkeep, const struct spral_ssids_options *options,
+      struct spral_ssids_inform *inform);
 /* Free memory */
 int spral_ssids_free_akeep(void **akeep);
 int spral_ssids_free_fkeep(void **fkeep);
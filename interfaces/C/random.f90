@@ -78,3 +78,143 @@ logical(C_BOOL) function spral_random_logical(cstate) bind(C)
    ! Recover state
    cstate = random_get_seed(fstate)
 end function spral_random_logical
+
+subroutine spral_random_real_array(cstate, cpositive, len, cx) bind(C)
+   use iso_c_binding
+   use spral_random
+   implicit none
+
+   integer(C_INT), intent(inout) :: cstate
+   logical(C_BOOL), value :: cpositive
+   integer(C_INT64_T), value :: len
+   real(C_DOUBLE), dimension(len), intent(out) :: cx
+
+   type(random_state) :: fstate
+   logical :: fpositive
+
+   ! Initialize state
+   call random_set_seed(fstate, cstate)
+
+   ! Call Fortran routine
+   fpositive = cpositive
+   call random_real_array(fstate, cx, positive=fpositive)
+
+   ! Recover state
+   cstate = random_get_seed(fstate)
+end subroutine spral_random_real_array
+
+subroutine spral_random_real_array_in_range(cstate, minv, maxv, len, cx) &
+      bind(C)
+   use iso_c_binding
+   use spral_random
+   implicit none
+
+   integer(C_INT), intent(inout) :: cstate
+   real(C_DOUBLE), value :: minv
+   real(C_DOUBLE), value :: maxv
+   integer(C_INT64_T), value :: len
+   real(C_DOUBLE), dimension(len), intent(out) :: cx
+
+   type(random_state) :: fstate
+
+   ! Initialize state
+   call random_set_seed(fstate, cstate)
+
+   ! Call Fortran routine
+   call random_real_array_in_range(fstate, minv, maxv, cx)
+
+   ! Recover state
+   cstate = random_get_seed(fstate)
+end subroutine spral_random_real_array_in_range
+
+subroutine spral_random_integer_array(cstate, n, len, cx) bind(C)
+   use iso_c_binding
+   use spral_random
+   implicit none
+
+   integer(C_INT), intent(inout) :: cstate
+   integer(C_INT), value :: n
+   integer(C_INT64_T), value :: len
+   integer(C_INT), dimension(len), intent(out) :: cx
+
+   type(random_state) :: fstate
+
+   ! Initialize state
+   call random_set_seed(fstate, cstate)
+
+   ! Call Fortran routine
+   call random_integer_array(fstate, n, cx)
+
+   ! Recover state
+   cstate = random_get_seed(fstate)
+end subroutine spral_random_integer_array
+
+subroutine spral_random_long_array(cstate, n, len, cx) bind(C)
+   use iso_c_binding
+   use spral_random
+   implicit none
+
+   integer(C_INT), intent(inout) :: cstate
+   integer(C_INT64_T), value :: n
+   integer(C_INT64_T), value :: len
+   integer(C_INT64_T), dimension(len), intent(out) :: cx
+
+   type(random_state) :: fstate
+
+   ! Initialize state
+   call random_set_seed(fstate, cstate)
+
+   ! Call Fortran routine
+   call random_integer_array(fstate, n, cx)
+
+   ! Recover state
+   cstate = random_get_seed(fstate)
+end subroutine spral_random_long_array
+
+subroutine spral_random_integer_array_in_range(cstate, minv, maxv, len, cx) &
+      bind(C)
+   use iso_c_binding
+   use spral_random
+   implicit none
+
+   integer(C_INT), intent(inout) :: cstate
+   integer(C_INT), value :: minv
+   integer(C_INT), value :: maxv
+   integer(C_INT64_T), value :: len
+   integer(C_INT), dimension(len), intent(out) :: cx
+
+   type(random_state) :: fstate
+
+   ! Initialize state
+   call random_set_seed(fstate, cstate)
+
+   ! Call Fortran routine
+   call random_integer_array_in_range(fstate, minv, maxv, cx)
+
+   ! Recover state
+   cstate = random_get_seed(fstate)
+end subroutine spral_random_integer_array_in_range
+
+subroutine spral_random_long_array_in_range(cstate, minv, maxv, len, cx) &
+      bind(C)
+   use iso_c_binding
+   use spral_random
+   implicit none
+
+   integer(C_INT), intent(inout) :: cstate
+   integer(C_INT64_T), value :: minv
+   integer(C_INT64_T), value :: maxv
+   integer(C_INT64_T), value :: len
+   integer(C_INT64_T), dimension(len), intent(out) :: cx
+
+   type(random_state) :: fstate
+
+   ! Initialize state
+   call random_set_seed(fstate, cstate)
+
+   ! Call Fortran routine
+   call random_integer_array_in_range(fstate, minv, maxv, cx)
+
+   ! Recover state
+   cstate = random_get_seed(fstate)
+end subroutine spral_random_long_array_in_range
@@ -19,10 +19,11 @@ integer(C_INT) function spral_random_matrix_generate(cstate, matrix_type, m, &
   integer, parameter :: SPRAL_RANDOM_MATRIX_FINDEX       = 1
   integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
   integer, parameter :: SPRAL_RANDOM_MATRIX_SORT         = 4
+  integer, parameter :: SPRAL_RANDOM_MATRIX_COMPLEMENT   = 16
 
   type(random_state) :: fstate
   real(wp), dimension(:), pointer, contiguous :: fval
-  logical :: findex, nonsingular, sort
+  logical :: findex, nonsingular, sort, complement
 
   ! Set random generator state
   call random_set_seed(fstate, cstate)
@@ -31,6 +32,7 @@ integer(C_INT) function spral_random_matrix_generate(cstate, matrix_type, m, &
   findex      = (iand(flags, SPRAL_RANDOM_MATRIX_FINDEX)      .ne. 0)
   nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
   sort        = (iand(flags, SPRAL_RANDOM_MATRIX_SORT)        .ne. 0)
+  complement  = (iand(flags, SPRAL_RANDOM_MATRIX_COMPLEMENT)  .ne. 0)
 
   ! Check if we have a val vector
   if (C_ASSOCIATED(cval)) then
@@ -42,10 +44,11 @@ integer(C_INT) function spral_random_matrix_generate(cstate, matrix_type, m, &
   if (ASSOCIATED(fval)) then
      call random_matrix_generate(fstate, matrix_type, m, n, nnz, ptr, row, &
           spral_random_matrix_generate, nonsingular=nonsingular, sort=sort, &
-          val=fval)
+          val=fval, complement=complement)
   else
      call random_matrix_generate(fstate, matrix_type, m, n, nnz, ptr, row, &
-          spral_random_matrix_generate, nonsingular=nonsingular, sort=sort)
+          spral_random_matrix_generate, nonsingular=nonsingular, sort=sort, &
+          complement=complement)
   end if
 
   ! Convert to C indexing if required
@@ -79,10 +82,11 @@ integer(C_INT) function spral_random_matrix_generate_long(cstate, matrix_type, &
   integer, parameter :: SPRAL_RANDOM_MATRIX_FINDEX       = 1
   integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
   integer, parameter :: SPRAL_RANDOM_MATRIX_SORT         = 4
+  integer, parameter :: SPRAL_RANDOM_MATRIX_COMPLEMENT   = 16
 
   type(random_state) :: fstate
   real(wp), dimension(:), pointer, contiguous :: fval
-  logical :: findex, nonsingular, sort
+  logical :: findex, nonsingular, sort, complement
 
   ! Set random generator state
   call random_set_seed(fstate, cstate)
@@ -91,6 +95,7 @@ integer(C_INT) function spral_random_matrix_generate_long(cstate, matrix_type, &
   findex      = (iand(flags, SPRAL_RANDOM_MATRIX_FINDEX)      .ne. 0)
   nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
   sort        = (iand(flags, SPRAL_RANDOM_MATRIX_SORT)        .ne. 0)
+  complement  = (iand(flags, SPRAL_RANDOM_MATRIX_COMPLEMENT)  .ne. 0)
 
   ! Check if we have a val vector
   if (C_ASSOCIATED(cval)) then
@@ -102,10 +107,11 @@ integer(C_INT) function spral_random_matrix_generate_long(cstate, matrix_type, &
   if (ASSOCIATED(fval)) then
      call random_matrix_generate(fstate, matrix_type, m, n, nnz, ptr, row, &
           spral_random_matrix_generate_long, nonsingular=nonsingular, sort=sort,&
-          val=fval)
+          val=fval, complement=complement)
   else
      call random_matrix_generate(fstate, matrix_type, m, n, nnz, ptr, row, &
-          spral_random_matrix_generate_long, nonsingular=nonsingular, sort=sort)
+          spral_random_matrix_generate_long, nonsingular=nonsingular, sort=sort,&
+          complement=complement)
   end if
 
   ! Convert to C indexing if required
@@ -140,10 +146,11 @@ integer(C_INT) function spral_random_matrix_generate_band(cstate, matrix_type, m
   integer, parameter :: SPRAL_RANDOM_MATRIX_FINDEX       = 1
   integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
   integer, parameter :: SPRAL_RANDOM_MATRIX_SORT         = 4
+  integer, parameter :: SPRAL_RANDOM_MATRIX_DIRECT       = 8
 
   type(random_state) :: fstate
   real(wp), dimension(:), pointer, contiguous :: fval
-  logical :: findex, nonsingular, sort
+  logical :: findex, nonsingular, sort, direct
 
   ! Set random generator state
   call random_set_seed(fstate, cstate)
@@ -152,6 +159,7 @@ integer(C_INT) function spral_random_matrix_generate_band(cstate, matrix_type, m
   findex      = (iand(flags, SPRAL_RANDOM_MATRIX_FINDEX)      .ne. 0)
   nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
   sort        = (iand(flags, SPRAL_RANDOM_MATRIX_SORT)        .ne. 0)
+  direct      = (iand(flags, SPRAL_RANDOM_MATRIX_DIRECT)      .ne. 0)
 
   ! Check if we have a val vector
   if (C_ASSOCIATED(cval)) then
@@ -163,11 +171,11 @@ integer(C_INT) function spral_random_matrix_generate_band(cstate, matrix_type, m
   if (ASSOCIATED(fval)) then
      call random_matrix_generate(fstate, matrix_type, m, n, nnz, bandwidth, &
           ptr, row, spral_random_matrix_generate_band,                      &
-          nonsingular=nonsingular, sort=sort, val=fval)
+          nonsingular=nonsingular, sort=sort, direct=direct, val=fval)
   else
      call random_matrix_generate(fstate, matrix_type, m, n, nnz, bandwidth, &
           ptr, row, spral_random_matrix_generate_band,                      &
-          nonsingular=nonsingular, sort=sort)
+          nonsingular=nonsingular, sort=sort, direct=direct)
   end if
 
   ! Convert to C indexing if required
@@ -202,10 +210,11 @@ integer(C_INT) function spral_random_matrix_generate_band_long(cstate, matrix_ty
   integer, parameter :: SPRAL_RANDOM_MATRIX_FINDEX       = 1
   integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
   integer, parameter :: SPRAL_RANDOM_MATRIX_SORT         = 4
+  integer, parameter :: SPRAL_RANDOM_MATRIX_DIRECT       = 8
 
   type(random_state) :: fstate
   real(wp), dimension(:), pointer, contiguous :: fval
-  logical :: findex, nonsingular, sort
+  logical :: findex, nonsingular, sort, direct
 
   ! Set random generator state
   call random_set_seed(fstate, cstate)
@@ -214,6 +223,7 @@ integer(C_INT) function spral_random_matrix_generate_band_long(cstate, matrix_ty
   findex      = (iand(flags, SPRAL_RANDOM_MATRIX_FINDEX)      .ne. 0)
   nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
   sort        = (iand(flags, SPRAL_RANDOM_MATRIX_SORT)        .ne. 0)
+  direct      = (iand(flags, SPRAL_RANDOM_MATRIX_DIRECT)      .ne. 0)
 
   ! Check if we have a val vector
   if (C_ASSOCIATED(cval)) then
@@ -225,11 +235,11 @@ integer(C_INT) function spral_random_matrix_generate_band_long(cstate, matrix_ty
   if (ASSOCIATED(fval)) then
      call random_matrix_generate(fstate, matrix_type, m, n, nnz, bandwidth, &
           ptr, row, spral_random_matrix_generate_band_long,                 &
-          nonsingular=nonsingular, sort=sort, val=fval)
+          nonsingular=nonsingular, sort=sort, direct=direct, val=fval)
   else
      call random_matrix_generate(fstate, matrix_type, m, n, nnz, bandwidth, &
           ptr, row, spral_random_matrix_generate_band_long,                 &
-          nonsingular=nonsingular, sort=sort)
+          nonsingular=nonsingular, sort=sort, direct=direct)
   end if
 
   ! Convert to C indexing if required
@@ -241,3 +251,538 @@ integer(C_INT) function spral_random_matrix_generate_band_long(cstate, matrix_ty
   ! Recover new random genenerator state
   cstate = random_get_seed(fstate)
 end function spral_random_matrix_generate_band_long
+
+integer(C_INT) function spral_random_matrix_generate_band_kl_ku(cstate, &
+     matrix_type, m, n, nnz, kl, ku, ptr, row, cval, dominance, flags) bind(C)
+  use iso_c_binding
+  use spral_random, only: random_state, random_get_seed, random_set_seed
+  use spral_random_matrix, only: random_matrix_generate
+  implicit none
+
+  integer(C_INT), intent(inout) :: cstate
+  integer(C_INT), value :: matrix_type
+  integer(C_INT), value :: m
+  integer(C_INT), value :: n
+  integer(C_INT), value :: nnz
+  integer(C_INT), value :: kl
+  integer(C_INT), value :: ku
+  integer(C_INT), dimension(n+1), intent(out) :: ptr
+  integer(C_INT), dimension(nnz), intent(out) :: row
+  type(C_PTR), value :: cval
+  real(C_DOUBLE), value :: dominance
+  integer(C_INT), value :: flags
+
+  integer, parameter :: wp = C_DOUBLE
+  integer, parameter :: SPRAL_RANDOM_MATRIX_FINDEX       = 1
+  integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
+  integer, parameter :: SPRAL_RANDOM_MATRIX_SORT         = 4
+  integer, parameter :: SPRAL_RANDOM_MATRIX_DIRECT       = 8
+
+  type(random_state) :: fstate
+  real(wp), dimension(:), pointer, contiguous :: fval
+  real(wp), allocatable :: ldominance
+  logical :: findex, nonsingular, sort, direct
+
+  ! Set random generator state
+  call random_set_seed(fstate, cstate)
+
+  ! Decipher flags
+  findex      = (iand(flags, SPRAL_RANDOM_MATRIX_FINDEX)      .ne. 0)
+  nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
+  sort        = (iand(flags, SPRAL_RANDOM_MATRIX_SORT)        .ne. 0)
+  direct      = (iand(flags, SPRAL_RANDOM_MATRIX_DIRECT)      .ne. 0)
+
+  ! A non-positive dominance factor means none was given (ldominance is then
+  ! unallocated, and so treated as not present)
+  if (dominance .gt. 0) ldominance = dominance
+
+  ! Check if we have a val vector
+  if (C_ASSOCIATED(cval)) then
+     call C_F_POINTER(cval, fval, shape = (/ nnz /))
+  else
+     nullify(fval)
+  end if
+
+  if (ASSOCIATED(fval)) then
+     call random_matrix_generate(fstate, matrix_type, m, n, nnz, kl, ku,  &
+          ptr, row, spral_random_matrix_generate_band_kl_ku,               &
+          nonsingular=nonsingular, sort=sort, direct=direct, val=fval,    &
+          dominance=ldominance)
+  else
+     call random_matrix_generate(fstate, matrix_type, m, n, nnz, kl, ku,  &
+          ptr, row, spral_random_matrix_generate_band_kl_ku,               &
+          nonsingular=nonsingular, sort=sort, direct=direct,              &
+          dominance=ldominance)
+  end if
+
+  ! Convert to C indexing if required
+  if (.not. findex) then
+     ptr(:) = ptr(:) - 1
+     row(:) = row(:) - 1
+  end if
+
+  ! Recover new random genenerator state
+  cstate = random_get_seed(fstate)
+end function spral_random_matrix_generate_band_kl_ku
+
+integer(C_INT) function spral_random_matrix_generate_band_kl_ku_long(cstate, &
+     matrix_type, m, n, nnz, kl, ku, ptr, row, cval, dominance, flags) bind(C)
+  use iso_c_binding
+  use spral_random, only: random_state, random_get_seed, random_set_seed
+  use spral_random_matrix, only: random_matrix_generate
+  implicit none
+
+  integer(C_INT), intent(inout) :: cstate
+  integer(C_INT), value :: matrix_type
+  integer(C_INT), value :: m
+  integer(C_INT), value :: n
+  integer(C_INT64_T), value :: nnz
+  integer(C_INT), value :: kl
+  integer(C_INT), value :: ku
+  integer(C_INT64_T), dimension(n+1), intent(out) :: ptr
+  integer(C_INT), dimension(nnz), intent(out) :: row
+  type(C_PTR), value :: cval
+  real(C_DOUBLE), value :: dominance
+  integer(C_INT), value :: flags
+
+  integer, parameter :: wp = C_DOUBLE
+  integer, parameter :: SPRAL_RANDOM_MATRIX_FINDEX       = 1
+  integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
+  integer, parameter :: SPRAL_RANDOM_MATRIX_SORT         = 4
+  integer, parameter :: SPRAL_RANDOM_MATRIX_DIRECT       = 8
+
+  type(random_state) :: fstate
+  real(wp), dimension(:), pointer, contiguous :: fval
+  real(wp), allocatable :: ldominance
+  logical :: findex, nonsingular, sort, direct
+
+  ! Set random generator state
+  call random_set_seed(fstate, cstate)
+
+  ! Decipher flags
+  findex      = (iand(flags, SPRAL_RANDOM_MATRIX_FINDEX)      .ne. 0)
+  nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
+  sort        = (iand(flags, SPRAL_RANDOM_MATRIX_SORT)        .ne. 0)
+  direct      = (iand(flags, SPRAL_RANDOM_MATRIX_DIRECT)      .ne. 0)
+
+  ! A non-positive dominance factor means none was given (ldominance is then
+  ! unallocated, and so treated as not present)
+  if (dominance .gt. 0) ldominance = dominance
+
+  ! Check if we have a val vector
+  if (C_ASSOCIATED(cval)) then
+     call C_F_POINTER(cval, fval, shape = (/ nnz /))
+  else
+     nullify(fval)
+  end if
+
+  if (ASSOCIATED(fval)) then
+     call random_matrix_generate(fstate, matrix_type, m, n, nnz, kl, ku,  &
+          ptr, row, spral_random_matrix_generate_band_kl_ku_long,          &
+          nonsingular=nonsingular, sort=sort, direct=direct, val=fval,    &
+          dominance=ldominance)
+  else
+     call random_matrix_generate(fstate, matrix_type, m, n, nnz, kl, ku,  &
+          ptr, row, spral_random_matrix_generate_band_kl_ku_long,          &
+          nonsingular=nonsingular, sort=sort, direct=direct,              &
+          dominance=ldominance)
+  end if
+
+  ! Convert to C indexing if required
+  if (.not. findex) then
+     ptr(:) = ptr(:) - 1
+     row(:) = row(:) - 1
+  end if
+
+  ! Recover new random genenerator state
+  cstate = random_get_seed(fstate)
+end function spral_random_matrix_generate_band_kl_ku_long
+
+integer(C_INT) function spral_random_matrix_generate_band_coord(cstate, &
+     matrix_type, m, n, nnz, kl, ku, row, col, cval, dominance, flags) bind(C)
+  use iso_c_binding
+  use spral_random, only: random_state, random_get_seed, random_set_seed
+  use spral_random_matrix, only: random_matrix_generate_band_coord
+  implicit none
+
+  integer(C_INT), intent(inout) :: cstate
+  integer(C_INT), value :: matrix_type
+  integer(C_INT), value :: m
+  integer(C_INT), value :: n
+  integer(C_INT), value :: nnz
+  integer(C_INT), value :: kl
+  integer(C_INT), value :: ku
+  integer(C_INT), dimension(nnz), intent(out) :: row
+  integer(C_INT), dimension(nnz), intent(out) :: col
+  type(C_PTR), value :: cval
+  real(C_DOUBLE), value :: dominance
+  integer(C_INT), value :: flags
+
+  integer, parameter :: wp = C_DOUBLE
+  integer, parameter :: SPRAL_RANDOM_MATRIX_FINDEX       = 1
+  integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
+  integer, parameter :: SPRAL_RANDOM_MATRIX_SORT         = 4
+  integer, parameter :: SPRAL_RANDOM_MATRIX_DIRECT       = 8
+
+  type(random_state) :: fstate
+  real(wp), dimension(:), pointer, contiguous :: fval
+  real(wp), allocatable :: ldominance
+  logical :: findex, nonsingular, sort, direct
+
+  ! Set random generator state
+  call random_set_seed(fstate, cstate)
+
+  ! Decipher flags
+  findex      = (iand(flags, SPRAL_RANDOM_MATRIX_FINDEX)      .ne. 0)
+  nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
+  sort        = (iand(flags, SPRAL_RANDOM_MATRIX_SORT)        .ne. 0)
+  direct      = (iand(flags, SPRAL_RANDOM_MATRIX_DIRECT)      .ne. 0)
+
+  ! A non-positive dominance factor means none was given (ldominance is then
+  ! unallocated, and so treated as not present)
+  if (dominance .gt. 0) ldominance = dominance
+
+  ! Check if we have a val vector
+  if (C_ASSOCIATED(cval)) then
+     call C_F_POINTER(cval, fval, shape = (/ nnz /))
+  else
+     nullify(fval)
+  end if
+
+  if (ASSOCIATED(fval)) then
+     call random_matrix_generate_band_coord(fstate, matrix_type, m, n, &
+          int(nnz,C_INT64_T), kl, ku, row, col,                          &
+          spral_random_matrix_generate_band_coord, nonsingular=nonsingular, &
+          sort=sort, direct=direct, val=fval, dominance=ldominance)
+  else
+     call random_matrix_generate_band_coord(fstate, matrix_type, m, n, &
+          int(nnz,C_INT64_T), kl, ku, row, col,                          &
+          spral_random_matrix_generate_band_coord, nonsingular=nonsingular, &
+          sort=sort, direct=direct, dominance=ldominance)
+  end if
+
+  ! Convert to C indexing if required
+  if (.not. findex) then
+     row(:) = row(:) - 1
+     col(:) = col(:) - 1
+  end if
+
+  ! Recover new random genenerator state
+  cstate = random_get_seed(fstate)
+end function spral_random_matrix_generate_band_coord
+
+integer(C_INT) function spral_random_matrix_generate_band_coord_long(cstate, &
+     matrix_type, m, n, nnz, kl, ku, row, col, cval, dominance, flags) bind(C)
+  use iso_c_binding
+  use spral_random, only: random_state, random_get_seed, random_set_seed
+  use spral_random_matrix, only: random_matrix_generate_band_coord
+  implicit none
+
+  integer(C_INT), intent(inout) :: cstate
+  integer(C_INT), value :: matrix_type
+  integer(C_INT), value :: m
+  integer(C_INT), value :: n
+  integer(C_INT64_T), value :: nnz
+  integer(C_INT), value :: kl
+  integer(C_INT), value :: ku
+  integer(C_INT), dimension(nnz), intent(out) :: row
+  integer(C_INT), dimension(nnz), intent(out) :: col
+  type(C_PTR), value :: cval
+  real(C_DOUBLE), value :: dominance
+  integer(C_INT), value :: flags
+
+  integer, parameter :: wp = C_DOUBLE
+  integer, parameter :: SPRAL_RANDOM_MATRIX_FINDEX       = 1
+  integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
+  integer, parameter :: SPRAL_RANDOM_MATRIX_SORT         = 4
+  integer, parameter :: SPRAL_RANDOM_MATRIX_DIRECT       = 8
+
+  type(random_state) :: fstate
+  real(wp), dimension(:), pointer, contiguous :: fval
+  real(wp), allocatable :: ldominance
+  logical :: findex, nonsingular, sort, direct
+
+  ! Set random generator state
+  call random_set_seed(fstate, cstate)
+
+  ! Decipher flags
+  findex      = (iand(flags, SPRAL_RANDOM_MATRIX_FINDEX)      .ne. 0)
+  nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
+  sort        = (iand(flags, SPRAL_RANDOM_MATRIX_SORT)        .ne. 0)
+  direct      = (iand(flags, SPRAL_RANDOM_MATRIX_DIRECT)      .ne. 0)
+
+  ! A non-positive dominance factor means none was given (ldominance is then
+  ! unallocated, and so treated as not present)
+  if (dominance .gt. 0) ldominance = dominance
+
+  ! Check if we have a val vector
+  if (C_ASSOCIATED(cval)) then
+     call C_F_POINTER(cval, fval, shape = (/ nnz /))
+  else
+     nullify(fval)
+  end if
+
+  if (ASSOCIATED(fval)) then
+     call random_matrix_generate_band_coord(fstate, matrix_type, m, n, nnz, &
+          kl, ku, row, col, spral_random_matrix_generate_band_coord_long,  &
+          nonsingular=nonsingular, sort=sort, direct=direct, val=fval,    &
+          dominance=ldominance)
+  else
+     call random_matrix_generate_band_coord(fstate, matrix_type, m, n, nnz, &
+          kl, ku, row, col, spral_random_matrix_generate_band_coord_long,  &
+          nonsingular=nonsingular, sort=sort, direct=direct,              &
+          dominance=ldominance)
+  end if
+
+  ! Convert to C indexing if required
+  if (.not. findex) then
+     row(:) = row(:) - 1
+     col(:) = col(:) - 1
+  end if
+
+  ! Recover new random genenerator state
+  cstate = random_get_seed(fstate)
+end function spral_random_matrix_generate_band_coord_long
+
+integer(C_INT) function spral_random_matrix_generate_lapack_band(cstate, &
+     matrix_type, m, n, nnz, kl, ku, ab, ldab, dominance, flags) bind(C)
+  use iso_c_binding
+  use spral_random, only: random_state, random_get_seed, random_set_seed
+  use spral_random_matrix, only: random_matrix_generate_lapack_band
+  implicit none
+
+  integer(C_INT), intent(inout) :: cstate
+  integer(C_INT), value :: matrix_type
+  integer(C_INT), value :: m
+  integer(C_INT), value :: n
+  integer(C_INT), value :: nnz
+  integer(C_INT), value :: kl
+  integer(C_INT), value :: ku
+  integer(C_INT), value :: ldab
+  real(C_DOUBLE), dimension(ldab, n), intent(out) :: ab
+  real(C_DOUBLE), value :: dominance
+  integer(C_INT), value :: flags
+
+  integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
+
+  type(random_state) :: fstate
+  real(C_DOUBLE), allocatable :: ldominance
+  logical :: nonsingular
+
+  ! Set random generator state
+  call random_set_seed(fstate, cstate)
+
+  ! Decipher flags
+  nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
+
+  ! A non-positive dominance factor means none was given (ldominance is then
+  ! unallocated, and so treated as not present)
+  if (dominance .gt. 0) ldominance = dominance
+
+  call random_matrix_generate_lapack_band(fstate, matrix_type, m, n, &
+       int(nnz,C_INT64_T), kl, ku, ab, ldab,                          &
+       spral_random_matrix_generate_lapack_band, nonsingular=nonsingular, &
+       dominance=ldominance)
+
+  ! Recover new random genenerator state
+  cstate = random_get_seed(fstate)
+end function spral_random_matrix_generate_lapack_band
+
+integer(C_INT) function spral_random_matrix_generate_lapack_band_long(cstate, &
+     matrix_type, m, n, nnz, kl, ku, ab, ldab, dominance, flags) bind(C)
+  use iso_c_binding
+  use spral_random, only: random_state, random_get_seed, random_set_seed
+  use spral_random_matrix, only: random_matrix_generate_lapack_band
+  implicit none
+
+  integer(C_INT), intent(inout) :: cstate
+  integer(C_INT), value :: matrix_type
+  integer(C_INT), value :: m
+  integer(C_INT), value :: n
+  integer(C_INT64_T), value :: nnz
+  integer(C_INT), value :: kl
+  integer(C_INT), value :: ku
+  integer(C_INT), value :: ldab
+  real(C_DOUBLE), dimension(ldab, n), intent(out) :: ab
+  real(C_DOUBLE), value :: dominance
+  integer(C_INT), value :: flags
+
+  integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
+
+  type(random_state) :: fstate
+  real(C_DOUBLE), allocatable :: ldominance
+  logical :: nonsingular
+
+  ! Set random generator state
+  call random_set_seed(fstate, cstate)
+
+  ! Decipher flags
+  nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
+
+  ! A non-positive dominance factor means none was given (ldominance is then
+  ! unallocated, and so treated as not present)
+  if (dominance .gt. 0) ldominance = dominance
+
+  call random_matrix_generate_lapack_band(fstate, matrix_type, m, n, nnz, &
+       kl, ku, ab, ldab, spral_random_matrix_generate_lapack_band_long,   &
+       nonsingular=nonsingular, dominance=ldominance)
+
+  ! Recover new random genenerator state
+  cstate = random_get_seed(fstate)
+end function spral_random_matrix_generate_lapack_band_long
+
+integer(C_INT) function spral_random_matrix_generate_block_band(cstate, &
+     matrix_type, m, n, b, nblk, kl, ku, ptr, row, cval, dominance, flags) &
+     bind(C)
+  use iso_c_binding
+  use spral_random, only: random_state, random_get_seed, random_set_seed
+  use spral_random_matrix, only: random_matrix_generate_block_band
+  implicit none
+
+  integer(C_INT), intent(inout) :: cstate
+  integer(C_INT), value :: matrix_type
+  integer(C_INT), value :: m
+  integer(C_INT), value :: n
+  integer(C_INT), value :: b
+  integer(C_INT), value :: nblk
+  integer(C_INT), value :: kl
+  integer(C_INT), value :: ku
+  integer(C_INT), dimension(n+1), intent(out) :: ptr
+  integer(C_INT), dimension(int(nblk,C_INT64_T)*b*b), intent(out) :: row
+  type(C_PTR), value :: cval
+  real(C_DOUBLE), value :: dominance
+  integer(C_INT), value :: flags
+
+  integer, parameter :: wp = C_DOUBLE
+  integer, parameter :: SPRAL_RANDOM_MATRIX_FINDEX       = 1
+  integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
+
+  integer, parameter :: ERROR_ALLOCATION = -1
+
+  type(random_state) :: fstate
+  integer(C_INT64_T), dimension(:), allocatable :: ptr64
+  real(wp), dimension(:), pointer, contiguous :: fval
+  real(wp), allocatable :: ldominance
+  logical :: findex, nonsingular
+  integer :: st
+
+  ! Set random generator state
+  call random_set_seed(fstate, cstate)
+
+  ! Decipher flags
+  findex      = (iand(flags, SPRAL_RANDOM_MATRIX_FINDEX)      .ne. 0)
+  nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
+
+  ! A non-positive dominance factor means none was given (ldominance is then
+  ! unallocated, and so treated as not present)
+  if (dominance .gt. 0) ldominance = dominance
+
+  ! Check if we have a val vector
+  if (C_ASSOCIATED(cval)) then
+     call C_F_POINTER(cval, fval, shape = (/ int(nblk,C_INT64_T)*b*b /))
+  else
+     nullify(fval)
+  end if
+
+  ! Blocks are written by the generator with 64-bit column pointers, which
+  ! are then copied to ptr
+  allocate(ptr64(n+1), stat=st)
+  if (st .ne. 0) then
+     spral_random_matrix_generate_block_band = ERROR_ALLOCATION
+     return
+  end if
+  if (ASSOCIATED(fval)) then
+     call random_matrix_generate_block_band(fstate, matrix_type, m, n, b, &
+          int(nblk,C_INT64_T), kl, ku, ptr64, row,                      &
+          spral_random_matrix_generate_block_band,                      &
+          nonsingular=nonsingular, val=fval, dominance=ldominance)
+  else
+     call random_matrix_generate_block_band(fstate, matrix_type, m, n, b, &
+          int(nblk,C_INT64_T), kl, ku, ptr64, row,                      &
+          spral_random_matrix_generate_block_band,                      &
+          nonsingular=nonsingular, dominance=ldominance)
+  end if
+  if (spral_random_matrix_generate_block_band .eq. 0) ptr(:) = int(ptr64(:))
+
+  ! Convert to C indexing if required (only ptr(n+1)-1 entries are used)
+  if ((.not. findex) .and. (spral_random_matrix_generate_block_band .eq. 0)) &
+       then
+     row(1:ptr(n+1)-1) = row(1:ptr(n+1)-1) - 1
+     ptr(:) = ptr(:) - 1
+  end if
+
+  ! Recover new random genenerator state
+  cstate = random_get_seed(fstate)
+end function spral_random_matrix_generate_block_band
+
+integer(C_INT) function spral_random_matrix_generate_block_band_long(cstate, &
+     matrix_type, m, n, b, nblk, kl, ku, ptr, row, cval, dominance, flags) &
+     bind(C)
+  use iso_c_binding
+  use spral_random, only: random_state, random_get_seed, random_set_seed
+  use spral_random_matrix, only: random_matrix_generate_block_band
+  implicit none
+
+  integer(C_INT), intent(inout) :: cstate
+  integer(C_INT), value :: matrix_type
+  integer(C_INT), value :: m
+  integer(C_INT), value :: n
+  integer(C_INT), value :: b
+  integer(C_INT64_T), value :: nblk
+  integer(C_INT), value :: kl
+  integer(C_INT), value :: ku
+  integer(C_INT64_T), dimension(n+1), intent(out) :: ptr
+  integer(C_INT), dimension(nblk*b*b), intent(out) :: row
+  type(C_PTR), value :: cval
+  real(C_DOUBLE), value :: dominance
+  integer(C_INT), value :: flags
+
+  integer, parameter :: wp = C_DOUBLE
+  integer, parameter :: SPRAL_RANDOM_MATRIX_FINDEX       = 1
+  integer, parameter :: SPRAL_RANDOM_MATRIX_NONSINGULAR  = 2
+
+  type(random_state) :: fstate
+  real(wp), dimension(:), pointer, contiguous :: fval
+  real(wp), allocatable :: ldominance
+  logical :: findex, nonsingular
+
+  ! Set random generator state
+  call random_set_seed(fstate, cstate)
+
+  ! Decipher flags
+  findex      = (iand(flags, SPRAL_RANDOM_MATRIX_FINDEX)      .ne. 0)
+  nonsingular = (iand(flags, SPRAL_RANDOM_MATRIX_NONSINGULAR) .ne. 0)
+
+  ! A non-positive dominance factor means none was given (ldominance is then
+  ! unallocated, and so treated as not present)
+  if (dominance .gt. 0) ldominance = dominance
+
+  ! Check if we have a val vector
+  if (C_ASSOCIATED(cval)) then
+     call C_F_POINTER(cval, fval, shape = (/ nblk*b*b /))
+  else
+     nullify(fval)
+  end if
+
+  if (ASSOCIATED(fval)) then
+     call random_matrix_generate_block_band(fstate, matrix_type, m, n, b, &
+          nblk, kl, ku, ptr, row,                                         &
+          spral_random_matrix_generate_block_band_long,                   &
+          nonsingular=nonsingular, val=fval, dominance=ldominance)
+  else
+     call random_matrix_generate_block_band(fstate, matrix_type, m, n, b, &
+          nblk, kl, ku, ptr, row,                                         &
+          spral_random_matrix_generate_block_band_long,                   &
+          nonsingular=nonsingular, dominance=ldominance)
+  end if
+
+  ! Convert to C indexing if required (only ptr(n+1)-1 entries are used)
+  if ((.not. findex) .and. &
+       (spral_random_matrix_generate_block_band_long .eq. 0)) then
+     row(1:ptr(n+1)-1) = row(1:ptr(n+1)-1) - 1
+     ptr(:) = ptr(:) - 1
+  end if
+
+  ! Recover new random genenerator state
+  cstate = random_get_seed(fstate)
+end function spral_random_matrix_generate_block_band_long
@@ -23,7 +23,12 @@ module spral_ssids_ciface
      integer(C_INT) :: pivot_method
      real(C_DOUBLE) :: small
      real(C_DOUBLE) :: u
-     character(C_CHAR) :: unused(80)
+     integer(C_INT) :: band_mode
+     integer(C_INT) :: band_max_width
+     logical(C_BOOL) :: single_precision
+     integer(C_INT) :: max_refine
+     real(C_DOUBLE) :: refine_tol
+     character(C_CHAR) :: unused(56)
   end type spral_ssids_options
 
   type, bind(C) :: spral_ssids_inform
@@ -44,7 +49,9 @@ module spral_ssids_ciface
      integer(C_INT) :: cuda_error
      integer(C_INT) :: cublas_error
      integer(C_INT) :: maxsupernode
-     character(C_CHAR) :: unused(76)
+     integer(C_INT) :: num_refine
+     integer(C_INT) :: num_relaxed
+     character(C_CHAR) :: unused(68)
   end type spral_ssids_inform
 
 contains
@@ -73,6 +80,11 @@ contains
     foptions%pivot_method      = coptions%pivot_method
     foptions%small             = coptions%small
     foptions%u                 = coptions%u
+    foptions%band_mode         = coptions%band_mode
+    foptions%band_max_width    = coptions%band_max_width
+    foptions%single_precision  = coptions%single_precision
+    foptions%max_refine        = coptions%max_refine
+    foptions%refine_tol        = coptions%refine_tol
   end subroutine copy_options_in
 
   subroutine copy_inform_out(finform, cinform)
@@ -94,6 +106,8 @@ contains
     cinform%num_neg               = finform%num_neg
     cinform%num_sup               = finform%num_sup
     cinform%num_two               = finform%num_two
+    cinform%num_refine            = finform%num_refine
+    cinform%num_relaxed           = finform%num_relaxed
     cinform%stat                  = finform%stat
     cinform%cuda_error            = finform%cuda_error
     cinform%cublas_error          = finform%cublas_error
@@ -127,6 +141,11 @@ subroutine spral_ssids_default_options(coptions) bind(C)
   coptions%pivot_method      = default_options%pivot_method
   coptions%small             = default_options%small
   coptions%u                 = default_options%u
+  coptions%band_mode         = default_options%band_mode
+  coptions%band_max_width    = default_options%band_max_width
+  coptions%single_precision  = default_options%single_precision
+  coptions%max_refine        = default_options%max_refine
+  coptions%refine_tol        = default_options%refine_tol
 end subroutine spral_ssids_default_options
 
 subroutine spral_ssids_analyse(ccheck, n, corder, cptr, crow, cval, cakeep, &
@@ -684,6 +703,224 @@ subroutine spral_ssids_solve(job, nrhs, x, ldx, cakeep, cfkeep, coptions, &
   call copy_inform_out(finform, cinform)
 end subroutine spral_ssids_solve
 
+subroutine spral_ssids_solve_sparse(nrhs, crhs_ptr, crhs_row, rhs_val, x, ldx, &
+     nwant, cwant, cakeep, cfkeep, coptions, cinform) bind(C)
+  use spral_ssids_ciface
+  implicit none
+
+  integer(C_INT), value :: nrhs
+  integer(C_INT), target, dimension(nrhs+1) :: crhs_ptr
+  type(spral_ssids_options), intent(in) :: coptions
+  integer(C_INT), target, &
+       dimension(crhs_ptr(nrhs+1)-coptions%array_base) :: crhs_row
+  real(C_DOUBLE), dimension(*) :: rhs_val
+  integer(C_INT), value :: ldx
+  real(C_DOUBLE), dimension(ldx,nrhs) :: x
+  integer(C_INT), value :: nwant
+  type(C_PTR), value :: cwant
+  type(C_PTR), value :: cakeep
+  type(C_PTR), value :: cfkeep
+  type(spral_ssids_inform), intent(out) :: cinform
+
+  integer(C_INT), dimension(:), pointer :: frhs_ptr
+  integer(C_INT), dimension(:), allocatable, target :: frhs_ptr_alloc
+  integer(C_INT), dimension(:), pointer :: frhs_row
+  integer(C_INT), dimension(:), allocatable, target :: frhs_row_alloc
+  integer(C_INT), dimension(:), pointer :: fwant
+  integer(C_INT), dimension(:), allocatable, target :: fwant_alloc
+  type(ssids_akeep), pointer :: fakeep
+  type(ssids_fkeep), pointer :: ffkeep
+  type(ssids_options) :: foptions
+  type(ssids_inform) :: finform
+
+  logical :: cindexed
+
+  ! Copy options in first to find out whether we use Fortran or C indexing
+  call copy_options_in(coptions, foptions, cindexed)
+
+  ! Translate arguments
+  if (C_ASSOCIATED(cakeep)) then
+     call C_F_POINTER(cakeep, fakeep)
+  else
+     nullify(fakeep)
+  end if
+  if (C_ASSOCIATED(cfkeep)) then
+     call C_F_POINTER(cfkeep, ffkeep)
+  else
+     nullify(ffkeep)
+  end if
+  frhs_ptr => crhs_ptr
+  if (cindexed) then
+     allocate(frhs_ptr_alloc(nrhs+1))
+     frhs_ptr_alloc(:) = frhs_ptr(:) + 1
+     frhs_ptr => frhs_ptr_alloc
+  end if
+  frhs_row => crhs_row
+  if (cindexed) then
+     allocate(frhs_row_alloc(frhs_ptr(nrhs+1)-1))
+     frhs_row_alloc(:) = frhs_row(:) + 1
+     frhs_row => frhs_row_alloc
+  end if
+  if (C_ASSOCIATED(cwant) .and. nwant .ge. 0) then
+     call C_F_POINTER(cwant, fwant, shape=(/ nwant /))
+     if (cindexed) then
+        allocate(fwant_alloc(nwant))
+        fwant_alloc(:) = fwant(:) + 1
+        fwant => fwant_alloc
+     end if
+  else
+     nullify(fwant)
+  end if
+
+  ! Call Fortran routine
+  if (associated(fwant)) then
+     call ssids_solve_sparse(nrhs, frhs_ptr, frhs_row, rhs_val, x, ldx, &
+          fakeep, ffkeep, foptions, finform, want=fwant)
+  else
+     call ssids_solve_sparse(nrhs, frhs_ptr, frhs_row, rhs_val, x, ldx, &
+          fakeep, ffkeep, foptions, finform)
+  end if
+
+  ! Copy arguments out
+  call copy_inform_out(finform, cinform)
+end subroutine spral_ssids_solve_sparse
+
+subroutine spral_ssids_solve_refine(nrhs, x, ldx, cptr, crow, val, cakeep, &
+     cfkeep, coptions, cinform) bind(C)
+  use spral_ssids_ciface
+  implicit none
+
+  integer(C_INT), value :: nrhs
+  real(C_DOUBLE), dimension(ldx,nrhs) :: x
+  integer(C_INT), value :: ldx
+  type(C_PTR), value :: cptr
+  type(C_PTR), value :: crow
+  real(C_DOUBLE), dimension(*), intent(in) :: val
+  type(C_PTR), value :: cakeep
+  type(C_PTR), value :: cfkeep
+  type(spral_ssids_options), intent(in) :: coptions
+  type(spral_ssids_inform), intent(out) :: cinform
+
+  integer(C_INT64_T), dimension(:), pointer :: fptr
+  integer(C_INT64_T), dimension(:), allocatable, target :: fptr_alloc
+  integer(C_INT), dimension(:), pointer :: frow
+  integer(C_INT), dimension(:), allocatable, target :: frow_alloc
+  type(ssids_akeep), pointer :: fakeep
+  type(ssids_fkeep), pointer :: ffkeep
+  type(ssids_options) :: foptions
+  type(ssids_inform) :: finform
+
+  logical :: cindexed
+
+  ! Copy options in first to find out whether we use Fortran or C indexing
+  call copy_options_in(coptions, foptions, cindexed)
+
+  ! Translate arguments
+  call C_F_POINTER(cakeep, fakeep)
+  if (C_ASSOCIATED(cfkeep)) then
+     call C_F_POINTER(cfkeep, ffkeep)
+  else
+     nullify(ffkeep)
+  end if
+  if (C_ASSOCIATED(cptr) .and. C_ASSOCIATED(crow)) then
+     call C_F_POINTER(cptr, fptr, shape=(/ fakeep%n+1 /))
+     if (cindexed) then
+        allocate(fptr_alloc(fakeep%n+1))
+        fptr_alloc(:) = fptr(:) + 1
+        fptr => fptr_alloc
+     end if
+     call C_F_POINTER(crow, frow, shape=(/ fptr(fakeep%n+1)-1 /))
+     if (cindexed) then
+        allocate(frow_alloc(fptr(fakeep%n+1)-1))
+        frow_alloc(:) = frow(:) + 1
+        frow => frow_alloc
+     end if
+  else
+     nullify(fptr)
+     nullify(frow)
+  end if
+
+  ! Call Fortran routine
+  if (ASSOCIATED(fptr) .and. ASSOCIATED(frow)) then
+     call ssids_solve_refine(nrhs, x, ldx, val, fakeep, ffkeep, foptions, &
+          finform, ptr=fptr, row=frow)
+  else
+     call ssids_solve_refine(nrhs, x, ldx, val, fakeep, ffkeep, foptions, &
+          finform)
+  end if
+
+  ! Copy arguments out
+  call copy_inform_out(finform, cinform)
+end subroutine spral_ssids_solve_refine
+
+subroutine spral_ssids_solve_refine_ptr32(nrhs, x, ldx, cptr, crow, val, cakeep, &
+     cfkeep, coptions, cinform) bind(C)
+  use spral_ssids_ciface
+  implicit none
+
+  integer(C_INT), value :: nrhs
+  real(C_DOUBLE), dimension(ldx,nrhs) :: x
+  integer(C_INT), value :: ldx
+  type(C_PTR), value :: cptr
+  type(C_PTR), value :: crow
+  real(C_DOUBLE), dimension(*), intent(in) :: val
+  type(C_PTR), value :: cakeep
+  type(C_PTR), value :: cfkeep
+  type(spral_ssids_options), intent(in) :: coptions
+  type(spral_ssids_inform), intent(out) :: cinform
+
+  integer(C_INT), dimension(:), pointer :: fptr
+  integer(C_INT), dimension(:), allocatable, target :: fptr_alloc
+  integer(C_INT), dimension(:), pointer :: frow
+  integer(C_INT), dimension(:), allocatable, target :: frow_alloc
+  type(ssids_akeep), pointer :: fakeep
+  type(ssids_fkeep), pointer :: ffkeep
+  type(ssids_options) :: foptions
+  type(ssids_inform) :: finform
+
+  logical :: cindexed
+
+  ! Copy options in first to find out whether we use Fortran or C indexing
+  call copy_options_in(coptions, foptions, cindexed)
+
+  ! Translate arguments
+  call C_F_POINTER(cakeep, fakeep)
+  if (C_ASSOCIATED(cfkeep)) then
+     call C_F_POINTER(cfkeep, ffkeep)
+  else
+     nullify(ffkeep)
+  end if
+  if (C_ASSOCIATED(cptr) .and. C_ASSOCIATED(crow)) then
+     call C_F_POINTER(cptr, fptr, shape=(/ fakeep%n+1 /))
+     if (cindexed) then
+        allocate(fptr_alloc(fakeep%n+1))
+        fptr_alloc(:) = fptr(:) + 1
+        fptr => fptr_alloc
+     end if
+     call C_F_POINTER(crow, frow, shape=(/ fptr(fakeep%n+1)-1 /))
+     if (cindexed) then
+        allocate(frow_alloc(fptr(fakeep%n+1)-1))
+        frow_alloc(:) = frow(:) + 1
+        frow => frow_alloc
+     end if
+  else
+     nullify(fptr)
+     nullify(frow)
+  end if
+
+  ! Call Fortran routine
+  if (ASSOCIATED(fptr) .and. ASSOCIATED(frow)) then
+     call ssids_solve_refine(nrhs, x, ldx, val, fakeep, ffkeep, foptions, &
+          finform, ptr=fptr, row=frow)
+  else
+     call ssids_solve_refine(nrhs, x, ldx, val, fakeep, ffkeep, foptions, &
+          finform)
+  end if
+
+  ! Copy arguments out
+  call copy_inform_out(finform, cinform)
+end subroutine spral_ssids_solve_refine_ptr32
+
 integer(C_INT) function spral_ssids_free_akeep(cakeep) bind(C)
   use spral_ssids_ciface
   implicit none
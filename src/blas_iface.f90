@@ -6,7 +6,9 @@ module spral_blas_iface
   public :: daxpy, dcopy, ddot, dnrm2, dscal
   public :: zaxpy, zcopy, zdotc, dznrm2, zscal
   public :: dgemv, dtrsv
+  public :: sgemv, strsv
   public :: dgemm, dsyrk, dtrsm
+  public :: sgemm, ssyrk, strsm
   public :: zgemm, ztrsm
 
   ! Level 1 BLAS
@@ -97,6 +99,22 @@ module spral_blas_iface
       double precision, intent(in   ), dimension(lda, n) :: a
       double precision, intent(inout), dimension(*) :: x
     end subroutine dtrsv
+    subroutine sgemv( trans, m, n, alpha, a, lda, x, incx, beta, y, incy )
+      implicit none
+      character, intent(in) :: trans
+      integer, intent(in) :: m, n, lda, incx, incy
+      real, intent(in) :: alpha, beta
+      real, intent(in   ), dimension(lda, n) :: a
+      real, intent(in   ), dimension(*) :: x
+      real, intent(inout), dimension(*) :: y
+    end subroutine sgemv
+    subroutine strsv( uplo, trans, diag, n, a, lda, x, incx )
+      implicit none
+      character, intent(in) :: uplo, trans, diag
+      integer, intent(in) :: n, lda, incx
+      real, intent(in   ), dimension(lda, n) :: a
+      real, intent(inout), dimension(*) :: x
+    end subroutine strsv
   end interface
 
   ! Level 3 BLAS
@@ -127,6 +145,32 @@ module spral_blas_iface
       double precision, intent(in   ) :: a(lda, *)
       double precision, intent(inout) :: b(ldb, n)
     end subroutine dtrsm
+    subroutine sgemm( ta, tb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc )
+      implicit none
+      character, intent(in) :: ta, tb
+      integer, intent(in) :: m, n, k
+      integer, intent(in) :: lda, ldb, ldc
+      real, intent(in) :: alpha, beta
+      real, intent(in   ), dimension(lda, *) :: a
+      real, intent(in   ), dimension(ldb, *) :: b
+      real, intent(inout), dimension(ldc, *) :: c
+    end subroutine sgemm
+    subroutine ssyrk( uplo, trans, n, k, alpha, a, lda, beta, c, ldc)
+      implicit none
+      character, intent(in) :: uplo, trans
+      integer, intent(in) :: n, k, lda, ldc
+      real, intent(in) :: alpha, beta
+      real, intent(in   ), dimension(lda, *) :: a
+      real, intent(inout), dimension(ldc, n) :: c
+    end subroutine ssyrk
+    subroutine strsm( side, uplo, trans, diag, m, n, alpha, a, lda, b, ldb )
+      implicit none
+      character, intent(in) :: side, uplo, trans, diag
+      integer, intent(in) :: m, n, lda, ldb
+      real, intent(in   ) :: alpha
+      real, intent(in   ) :: a(lda, *)
+      real, intent(inout) :: b(ldb, n)
+    end subroutine strsm
     subroutine zgemm( ta, tb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc )
       implicit none
       integer, parameter :: PRECISION = kind(1.0D0)
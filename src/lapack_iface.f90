@@ -4,6 +4,7 @@ module spral_lapack_iface
 
   private
   public :: dpotrf, dlacpy, dsytrf
+  public :: spotrf, ssytrf
   public :: zpotrf, zlacpy
 
   interface
@@ -30,6 +31,22 @@ module spral_lapack_iface
       double precision, intent(inout), dimension(lda, *) :: a
       double precision, intent(out  ), dimension(*) :: work
     end subroutine dsytrf
+    subroutine spotrf( uplo, n, a, lda, info )
+      implicit none
+      character, intent(in) :: uplo
+      integer, intent(in) :: n, lda
+      real, intent(inout) :: a(lda, n)
+      integer, intent(out) :: info
+    end subroutine spotrf
+    subroutine ssytrf( uplo, n, a, lda, ipiv, work, lwork, info )
+      implicit none
+      character, intent(in) :: uplo
+      integer, intent(in) :: n, lda, lwork
+      integer, intent(out), dimension(n) :: ipiv
+      integer, intent(out) :: info
+      real, intent(inout), dimension(lda, *) :: a
+      real, intent(out  ), dimension(*) :: work
+    end subroutine ssytrf
   end interface
 
   interface
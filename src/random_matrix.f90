@@ -5,19 +5,77 @@
 !
 ! FIXME: I don't think the positive definite case is implemented as per doc yet!
 module spral_random_matrix
-  use spral_random, only : random_state, random_integer, random_real
+  use spral_random, only : random_state, random_integer, random_real, &
+       random_real_array, random_skip_ahead, random_split
   use spral_matrix_util, only : SPRAL_MATRIX_UNSPECIFIED,          &
        SPRAL_MATRIX_REAL_RECT, SPRAL_MATRIX_REAL_UNSYM,            &
        SPRAL_MATRIX_REAL_SYM_PSDEF, SPRAL_MATRIX_REAL_SYM_INDEF,   &
-       SPRAL_MATRIX_REAL_SKEW
+       SPRAL_MATRIX_REAL_SKEW, SPRAL_MATRIX_CPLX_RECT,             &
+       SPRAL_MATRIX_CPLX_UNSYM, SPRAL_MATRIX_CPLX_HERM_PSDEF,      &
+       SPRAL_MATRIX_CPLX_HERM_INDEF, SPRAL_MATRIX_CPLX_SYM,        &
+       SPRAL_MATRIX_CPLX_SKEW
   implicit none
 
   private
-  public :: random_matrix_generate
+  public :: random_matrix_generate, random_matrix_generate_lapack_band, &
+       random_matrix_band_stream_init, random_matrix_band_stream_next,  &
+       random_matrix_band_stream_free, random_matrix_generate_profile,  &
+       random_matrix_envelope, random_matrix_generate_block_band,       &
+       random_matrix_generate_stencil, random_matrix_stencil_size,      &
+       random_matrix_generate_band_batch, random_matrix_workspace_free, &
+       random_matrix_generate_band_coord
+  public :: random_matrix_band_stream ! Streaming band generator type
+  public :: random_matrix_workspace ! Reusable generator workspace
+  public :: RANDOM_MATRIX_ENVELOPE_LINEAR, RANDOM_MATRIX_ENVELOPE_BLOCK, &
+       RANDOM_MATRIX_ENVELOPE_ARROW
+  public :: RANDOM_MATRIX_STENCIL_STAR, RANDOM_MATRIX_STENCIL_BOX, &
+       RANDOM_MATRIX_NUMBER_LEXICOGRAPHIC, RANDOM_MATRIX_NUMBER_BLOCKED
 
   integer, parameter :: wp = kind(0d0)
+  integer, parameter :: sp = kind(0e0)
   integer, parameter :: long = selected_int_kind(18)
 
+  ! Number of columns per independently generated block in the direct band
+  ! generator. Changing this value changes the matrices generated.
+  integer, parameter :: BLOCK_COLS = 256
+
+  ! Number of entries per independently generated chunk of values in the
+  ! single precision and complex band generators. Changing this value changes
+  ! the matrices generated.
+  integer, parameter :: VALUE_CHUNK = 4096
+
+  ! A column is generated by sampling its holes rather than its entries only if
+  ! more than half of its free positions are required and it has at least this
+  ! many free positions. Below this, rejection sampling costs little and
+  ! sampling holes would change the matrices of common narrow bands.
+  integer, parameter :: HOLE_MIN_FREE = 64
+
+  ! Dominance factor used for positive-definite band matrices if the user does
+  ! not specify one.
+  real(wp), parameter :: DEFAULT_DOMINANCE = 1.1_wp
+
+  ! Envelope shapes for random_matrix_envelope()
+  integer, parameter :: RANDOM_MATRIX_ENVELOPE_LINEAR = 1, & ! bandwidth grows
+                          ! linearly from 0 to width
+                        RANDOM_MATRIX_ENVELOPE_BLOCK  = 2, & ! block
+                          ! tridiagonal with blocks of size width
+                        RANDOM_MATRIX_ENVELOPE_ARROW  = 3    ! bandwidth width
+                          ! plus width dense leading columns
+
+  ! Stencils and grid numberings for random_matrix_generate_stencil()
+  integer, parameter :: RANDOM_MATRIX_STENCIL_STAR = 1, & ! neighbours along
+                          ! each axis (3, 5 and 7-point in 1, 2 and 3d)
+                        RANDOM_MATRIX_STENCIL_BOX  = 2    ! all neighbours
+                          ! (3, 9 and 27-point in 1, 2 and 3d)
+  integer, parameter :: RANDOM_MATRIX_NUMBER_LEXICOGRAPHIC = 1, & ! first
+                          ! coordinate varies fastest
+                        RANDOM_MATRIX_NUMBER_BLOCKED       = 2    ! tile by
+                          ! tile, lexicographically within tiles
+
+  ! Tile size used for blocked stencil numbering if the user does not specify
+  ! one.
+  integer, parameter :: DEFAULT_STENCIL_TILE = 8
+
   integer, parameter :: ERROR_ALLOCATION = -1, & ! Allocation failed
                         ERROR_MATRIX_TYPE= -2, & ! Bad matrix type
                         ERROR_ARG        = -3, & ! m, n or nnz < 1
@@ -25,9 +83,61 @@ module spral_random_matrix
                         ERROR_SINGULAR   = -5    ! request non-singular
                                                  ! but nnz<min(m,n)
 
+  ! State of a streaming band matrix generator. Columns are generated with
+  ! the direct band sampler one at a time, so only the stream of the current
+  ! block of columns and the position within it need be kept.
+  type :: random_matrix_band_stream
+     private
+     type(random_state) :: base ! state all block and node streams split from
+     type(random_state) :: bstate ! stream of current block
+     logical :: lsymmetric = .false. ! generate lower triangle only
+     logical :: lnonsingular = .false. ! force diagonal to be present
+     logical :: lsort = .false. ! sort entries within columns
+     logical :: ldominant = .false. ! set diagonally dominant diagonal
+     real(wp) :: dominance = 0.0 ! dominance factor
+     integer :: m = 0 ! number of rows
+     integer :: n = 0 ! number of columns
+     integer :: kl = 0 ! lower bandwidth
+     integer :: ku = 0 ! upper bandwidth
+     integer :: nblk = 0 ! number of blocks
+     integer(long) :: nfree = 0 ! entries in free positions of whole matrix
+     integer :: next = 1 ! next column to generate
+     integer(long) :: cells_left = 0 ! free positions left in current block
+     integer(long) :: ent_left = 0 ! entries left in current block
+     integer :: pending = -1 ! if >= 0, entries already drawn for free
+       ! positions of column next
+     logical, dimension(:), allocatable :: mark ! workspace
+     real(wp), dimension(:), allocatable :: rsum ! absolute row sums of rows
+       ! next:next+kl of the lower triangle so far, held cyclically
+  end type random_matrix_band_stream
+
+  ! Workspace of the generators, which a caller may keep from one call to the
+  ! next to avoid repeated allocation. It is also reused from one matrix to
+  ! the next by random_matrix_generate_band_batch(). Arrays are grown as
+  ! required and never shrunk. On entry to and exit from any generator
+  ! rused(:) and mark(:) are all .false.
+  type :: random_matrix_workspace
+     private
+     integer, dimension(:), allocatable :: cnt ! entries in each column
+     integer, dimension(:), allocatable :: rperm ! row permutation
+     integer, dimension(:), allocatable :: cperm ! column permutation
+     integer(long), dimension(:), allocatable :: ptr64 ! 64-bit column
+       ! pointers for the 32-bit generators
+     integer, dimension(:), allocatable :: ccap ! capacity of each column
+     integer, dimension(:), allocatable :: cols ! columns with capacity
+     logical, dimension(:), allocatable :: rused ! rows present in column
+     logical, dimension(:), allocatable :: mark ! rows chosen by Floyd's
+       ! algorithm, indexed from 0
+     integer(long), dimension(:), allocatable :: blkcap ! cumulative free
+       ! positions of blocks, indexed from 0
+     integer(long), dimension(:), allocatable :: blkcnt ! entries of blocks
+  end type random_matrix_workspace
+
   interface random_matrix_generate
      module procedure random_matrix_generate32, random_matrix_generate64,    &
-         random_matrix_generate32_band, random_matrix_generate64_band
+         random_matrix_generate32_band, random_matrix_generate64_band,       &
+         random_matrix_generate32_band_kl_ku,                                &
+         random_matrix_generate64_band_kl_ku
   end interface random_matrix_generate
 contains
 
@@ -37,7 +147,7 @@ contains
 ! non-singularity, and the sorting of entries within columns.
 !
   subroutine random_matrix_generate32(state, matrix_type, m, n, nnz, ptr, row, &
-       flag, stat, val, nonsingular, sort)
+       flag, stat, val, nonsingular, sort, work, complement)
     implicit none
     type(random_state), intent(inout) :: state ! random generator to use
     integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
@@ -54,12 +164,18 @@ contains
       ! non-singular. If not present, treated as .false.
     logical, optional, intent(in) :: sort ! sort entries in columns by row index.
       ! If not present, treated as .false.
+    type(random_matrix_workspace), optional, intent(inout) :: work ! if
+      ! present, workspace kept by the caller between calls
+    logical, optional, intent(in) :: complement ! beyond half fill, sample
+      ! holes instead of entries. If not present, treated as .false.
 
     integer(long), dimension(:), allocatable :: ptr64
     integer :: st
 
-   ! Create temporary 64-bit version of ptr
-    allocate(ptr64(n+1), stat=st)
+    ! Create temporary 64-bit version of ptr, held in the workspace if there
+    ! is one so that it is only allocated on the first call
+    if (present(work)) call move_alloc(work%ptr64, ptr64)
+    call grow_long(ptr64, n+1, st)
     if (st .ne. 0) then
        flag = ERROR_ALLOCATION
        if (present(stat)) stat = st
@@ -68,10 +184,12 @@ contains
 
     ! Call 64-bit version
     call random_matrix_generate64(state, matrix_type, m, n, int(nnz,long), &
-      ptr64, row, flag, stat=stat, val=val, nonsingular=nonsingular, sort=sort)
+      ptr64, row, flag, stat=stat, val=val, nonsingular=nonsingular, sort=sort, &
+      work=work, complement=complement)
 
     ! ... and copy back to 32-bit ptr
-    ptr(:) = int(ptr64(:))
+    ptr(:) = int(ptr64(1:n+1))
+    if (present(work)) call move_alloc(ptr64, work%ptr64)
   end subroutine random_matrix_generate32
 
 !
@@ -79,11 +197,13 @@ contains
 ! User can additionally specify a symmetric matrix (requires m==n), forced
 ! non-singularity, and the sorting of entries within columns.
 !
-! FIXME: This routine will be slow if we're asked for a (near) dense matrix
-! In this case, we might be better served by finding holes or using the first
-! part of random permutations
+! If complement is .true., beyond half fill holes are drawn instead of
+! entries, both in assigning them to columns and in choosing rows within a
+! column, so that at most min(nnz, capacity-nnz) positions are drawn, each
+! with fewer than one redraw expected. This changes the matrix generated, so
+! it is not done by default.
   subroutine random_matrix_generate64(state, matrix_type, m, n, nnz, ptr, row, &
-       flag, stat, val, nonsingular, sort)
+       flag, stat, val, nonsingular, sort, work, complement)
     implicit none
     type(random_state), intent(inout) :: state ! random generator to use
     integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
@@ -100,12 +220,16 @@ contains
       ! non-singular. If not present, treated as .false.
     logical, optional, intent(in) :: sort ! sort entries in columns by row index.
       ! If not present, treated as .false.
+    type(random_matrix_workspace), optional, intent(inout) :: work ! if
+      ! present, workspace kept by the caller between calls
+    logical, optional, intent(in) :: complement ! beyond half fill, sample
+      ! holes instead of entries. If not present, treated as .false.
 
-    integer :: i, j, k, minidx
-    integer(long) :: ii, jj
+    integer :: i, j, k, minidx, nfree, nhole
+    integer(long) :: ii, jj, ncells
     integer, dimension(:), allocatable :: cnt, rperm, cperm
     logical, dimension(:), allocatable :: rused
-    logical :: lsymmetric, lnonsingular, lsort
+    logical :: lsymmetric, lnonsingular, lsort, lcomplement
     integer :: st
 
     ! Initialize return codes
@@ -117,6 +241,8 @@ contains
     if (present(nonsingular)) lnonsingular = nonsingular
     lsort = .false.
     if (present(sort)) lsort = sort
+    lcomplement = .false.
+    if (present(complement)) lcomplement = complement
 
     ! Handle matrix type
     select case (matrix_type)
@@ -161,15 +287,26 @@ contains
        return
     end if
 
+    ! Take arrays from the caller's workspace, if any. They are returned
+    ! before exit.
+    if (present(work)) then
+       call move_alloc(work%cnt, cnt)
+       call move_alloc(work%rperm, rperm)
+       call move_alloc(work%cperm, cperm)
+       call move_alloc(work%rused, rused)
+    end if
+
     ! Allocate non-zeroes to columns
-    allocate(cnt(n), stat=st)
+    call grow_int(cnt, n, st)
     if (st .ne. 0) goto 100
-    cnt(:) = 0
+    cnt(1:n) = 0
     if (lsymmetric) then
        ! In symmetric case, structural non-singularity is guarunteed by adding
        ! the diagonal
        if (lnonsingular) then
-          allocate(rperm(m), cperm(n), stat=st)
+          call grow_int(rperm, m, st)
+          if (st .ne. 0) goto 100
+          call grow_int(cperm, n, st)
           if (st .ne. 0) goto 100
           ! To be consistent with unsymmetric case, we satisfy the following
           ! through identity permutations:
@@ -179,22 +316,39 @@ contains
              rperm(i) = i
              cperm(i) = i
           end do
-          cnt(cperm(:)) = cnt(cperm(:)) + 1
+          cnt(cperm(1:n)) = cnt(cperm(1:n)) + 1
        end if
-       ! Generate column assignments of remaining entries
+       ! Generate column assignments of remaining entries or, beyond half
+       ! fill if lcomplement, of the holes, starting from full columns
        ii = nnz; if(lnonsingular) ii = nnz - min(m,n) ! Allow for forced non-sing
-       do ii = 1, ii
-          j = random_sym_wt_integer(state, n)
-          do while (cnt(j) .ge. (m-j+1))
+       ncells = n*(n+1_long)/2; if(lnonsingular) ncells = ncells - min(m,n)
+       if ((.not. lcomplement) .or. (2*ii .le. ncells)) then
+          do ii = 1, ii
              j = random_sym_wt_integer(state, n)
+             do while (cnt(j) .ge. (m-j+1))
+                j = random_sym_wt_integer(state, n)
+             end do
+             cnt(j) = cnt(j) + 1
           end do
-          cnt(j) = cnt(j) + 1
-       end do
+       else
+          do j = 1, n
+             cnt(j) = m-j+1
+          end do
+          do ii = 1, ncells-ii
+             j = random_sym_wt_integer(state, n)
+             do while (cnt(j) .le. forced(j))
+                j = random_sym_wt_integer(state, n)
+             end do
+             cnt(j) = cnt(j) - 1
+          end do
+       end if
     else
        ! If we force (structural) non-singularity, generate locations and
        ! add to column counts
        if (lnonsingular) then
-          allocate(rperm(m), cperm(n), stat=st)
+          call grow_int(rperm, m, st)
+          if (st .ne. 0) goto 100
+          call grow_int(cperm, n, st)
           if (st .ne. 0) goto 100
           ! We generate random permutations of rows and columns
           ! We use the first min(m,n) of each permutation
@@ -203,29 +357,74 @@ contains
           ! [i.e. rperm gives actual rows, cperm doesn't - its an inverse]
           call random_perm(state, m, rperm)
           call random_perm(state, n, cperm)
-          where (cperm(:) .le. min(m,n)) cnt(:) = 1
+          where (cperm(1:n) .le. min(m,n)) cnt(1:n) = 1
        end if
-       ! Generate column assignments of remaining entries
+       ! Generate column assignments of remaining entries or, beyond half
+       ! fill if lcomplement, of the holes, starting from full columns
        ii = nnz; if(lnonsingular) ii = nnz - min(m,n) ! Allow for forced non-sing
-       do ii = 1, ii
-          j = random_integer(state, n)
-          do while (cnt(j) .ge. m)
+       ncells = m*(n+0_long); if(lnonsingular) ncells = ncells - min(m,n)
+       if ((.not. lcomplement) .or. (2*ii .le. ncells)) then
+          do ii = 1, ii
              j = random_integer(state, n)
+             do while (cnt(j) .ge. m)
+                j = random_integer(state, n)
+             end do
+             cnt(j) = cnt(j) + 1
           end do
-          cnt(j) = cnt(j) + 1
-       end do
-       if (sum(cnt) .ne. nnz) stop
+       else
+          cnt(1:n) = m
+          do ii = 1, ncells-ii
+             j = random_integer(state, n)
+             do while (cnt(j) .le. forced(j))
+                j = random_integer(state, n)
+             end do
+             cnt(j) = cnt(j) - 1
+          end do
+       end if
+       if (sum(cnt(1:n)) .ne. nnz) stop
     end if
 
     ! Determine row values
-    allocate(rused(m), stat=st)
-    if (st .ne. 0) goto 100
-    rused(:) = .false.
+    if (allocated(rused)) then
+       if (size(rused) .lt. m) deallocate(rused)
+    end if
+    if (.not. allocated(rused)) then
+       allocate(rused(m), stat=st)
+       if (st .ne. 0) goto 100
+    end if
+    rused(1:m) = .false.
     ptr(1) = 1
     do i = 1, n
        ! Determine end of col
        ptr(i+1) = ptr(i) + cnt(i)
        jj = ptr(i)
+       minidx = 1
+       if (lsymmetric) minidx = i
+       ! Dense column (see HOLE_MIN_FREE), if lcomplement: mark the holes
+       ! among the free positions, then scan the column for the entries
+       nfree = m - minidx + 1 - forced(i)
+       nhole = nfree - (cnt(i) - forced(i))
+       if (lcomplement .and. (2*nhole .lt. nfree) .and. &
+            (nfree .ge. HOLE_MIN_FREE)) then
+          if (forced(i) .gt. 0) rused(rperm(cperm(i))) = .true.
+          do j = 1, nhole
+             k = random_integer_in_range(state, minidx, m)
+             do while (rused(k))
+                k = random_integer_in_range(state, minidx, m)
+             end do
+             rused(k) = .true.
+          end do
+          if (forced(i) .gt. 0) rused(rperm(cperm(i))) = .false.
+          do k = minidx, m
+             if (rused(k)) then
+                rused(k) = .false.
+             else
+                row(jj) = k
+                jj = jj + 1
+             end if
+          end do
+          cycle
+       end if
        ! Add non-singular entry if required
        if (lnonsingular) then
           if (cperm(i) .le. min(m,n)) then
@@ -236,8 +435,6 @@ contains
           end if
        end if
        ! Add normal entries
-       minidx = 1
-       if (lsymmetric) minidx = i
        do jj = jj, ptr(i+1)-1
           k = random_integer_in_range(state, minidx, m)
           do while (rused(k))
@@ -259,19 +456,36 @@ contains
     end if
 
     ! Determine values
-    if (present(val)) then
-       do jj = 1, ptr(n+1)-1
-          val(jj) = random_real(state)
-       end do
-    end if
+    if (present(val)) call random_real_array(state, val(1:ptr(n+1)-1))
 
+    call return_work()
     return ! Normal return
 
 100 continue
     ! Memory allocation failure
     flag = ERROR_ALLOCATION
     if (present(stat)) stat = st
+    call return_work()
     return
+
+  contains
+    ! Return arrays to the caller's workspace
+    subroutine return_work()
+      if (.not. present(work)) return
+      call move_alloc(cnt, work%cnt)
+      call move_alloc(rperm, work%rperm)
+      call move_alloc(cperm, work%cperm)
+      call move_alloc(rused, work%rused)
+    end subroutine return_work
+
+    ! Number of entries forced into column j for non-singularity
+    integer function forced(j)
+      integer, intent(in) :: j
+
+      forced = 0
+      if (.not. lnonsingular) return
+      if (cperm(j) .le. min(m,n)) forced = 1
+    end function forced
   end subroutine random_matrix_generate64
 
 !
@@ -283,7 +497,8 @@ contains
 ! not band variant.
 !
   subroutine random_matrix_generate32_band(state, matrix_type, m, n, nnz, bw, ptr, row, &
-       flag, stat, val, nonsingular, sort)
+       flag, stat, val, nonsingular, sort, direct, dominance, &
+       cond, cond_est, x, rhs, work)
     implicit none
     type(random_state), intent(inout) :: state ! random generator to use
     integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
@@ -301,12 +516,147 @@ contains
       ! non-singular. If not present, treated as .false.
     logical, optional, intent(in) :: sort ! sort entries in columns by row index.
       ! If not present, treated as .false.
+    logical, optional, intent(in) :: direct ! use rejection-free sampling.
+      ! If not present, treated as .false.
+    real(wp), optional, intent(in) :: dominance ! if present, make the matrix
+      ! strictly diagonally dominant with this factor (must be > 1)
+    real(wp), dimension(2), optional, intent(in) :: cond ! if present, make
+      ! the 2-norm condition number lie in the range cond(1:2). Requires val
+    real(wp), dimension(2), optional, intent(out) :: cond_est ! if cond is
+      ! present, lower and upper bounds on the condition number achieved
+    real(wp), dimension(n), optional, intent(out) :: x ! random solution
+      ! vector x_true
+    real(wp), dimension(m), optional, intent(out) :: rhs ! right-hand side
+      ! A*x_true (the full matrix in the symmetric case). Requires x and val
+    type(random_matrix_workspace), optional, intent(inout) :: work ! if
+      ! present, workspace kept by the caller between calls
+
+    integer :: lbw
+
+    ! A bandwidth <= 0 means the band covers the whole matrix
+    lbw = bw
+    if (bw .le. 0) lbw = m
+
+    call random_matrix_generate32_band_kl_ku(state, matrix_type, m, n, nnz, &
+         lbw, lbw, ptr, row, flag, stat=stat, val=val,                     &
+         nonsingular=nonsingular, sort=sort, direct=direct,             &
+      dominance=dominance, cond=cond, cond_est=cond_est, x=x, rhs=rhs, &
+      work=work)
+  end subroutine random_matrix_generate32_band
+
+! Generate a random m x n band matrix with nnz non-zeroes.
+! User can additionally specify a symmetric matrix (requires m==n), forced
+! non-singularity, and the sorting of entries within columns.
+! User can specify a upper band width (lower is the same) to generate
+! a band matrix. A bandwidth <= 0 should have the same behaviour as the
+! not band variant.
+!
+! If direct is present with value .true., the matrix is sampled without
+! rejection in O(nnz+n) time, in parallel (see band_generate_direct()).
+! Otherwise the original rejection sampler is used.
+!
+  subroutine random_matrix_generate64_band(state, matrix_type, m, n, nnz, bw, ptr, row, &
+       flag, stat, val, nonsingular, sort, direct, dominance, &
+       cond, cond_est, x, rhs, work)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
+      ! (in future will be used for complex sym vs hermitian at least)
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: bw ! upper/lower bw
+    integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    integer, intent(out) :: flag ! return code
+    integer, optional, intent(out) :: stat ! allocate error code
+    real(wp), dimension(nnz), optional, intent(out) :: val ! numerical values
+    logical, optional, intent(in) :: nonsingular ! force matrix to be explicitly
+      ! non-singular. If not present, treated as .false.
+    logical, optional, intent(in) :: sort ! sort entries in columns by row index.
+      ! If not present, treated as .false.
+    logical, optional, intent(in) :: direct ! use rejection-free sampling.
+      ! If not present, treated as .false.
+    real(wp), optional, intent(in) :: dominance ! if present, make the matrix
+      ! strictly diagonally dominant with this factor (must be > 1)
+    real(wp), dimension(2), optional, intent(in) :: cond ! if present, make
+      ! the 2-norm condition number lie in the range cond(1:2). Requires val
+    real(wp), dimension(2), optional, intent(out) :: cond_est ! if cond is
+      ! present, lower and upper bounds on the condition number achieved
+    real(wp), dimension(n), optional, intent(out) :: x ! random solution
+      ! vector x_true
+    real(wp), dimension(m), optional, intent(out) :: rhs ! right-hand side
+      ! A*x_true (the full matrix in the symmetric case). Requires x and val
+    type(random_matrix_workspace), optional, intent(inout) :: work ! if
+      ! present, workspace kept by the caller between calls
+
+    integer :: lbw
+
+    ! A bandwidth <= 0 means the band covers the whole matrix
+    lbw = bw
+    if (bw .le. 0) lbw = m
+
+    call random_matrix_generate64_band_kl_ku(state, matrix_type, m, n, nnz, &
+         lbw, lbw, ptr, row, flag, stat=stat, val=val,                     &
+         nonsingular=nonsingular, sort=sort, direct=direct,             &
+      dominance=dominance, cond=cond, cond_est=cond_est, x=x, rhs=rhs, &
+      work=work)
+  end subroutine random_matrix_generate64_band
+
+!
+! Generate a random m x n band matrix with nnz non-zeroes, lower bandwidth kl
+! and upper bandwidth ku. 32-bit version of
+! random_matrix_generate64_band_kl_ku().
+!
+  subroutine random_matrix_generate32_band_kl_ku(state, matrix_type, m, n, &
+       nnz, kl, ku, ptr, row, flag, stat, val, nonsingular, sort, direct, &
+       dominance, cond, cond_est, x, rhs, work, sval, cval, zval)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
+      ! (in future will be used for complex sym vs hermitian at least)
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer, intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer, dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    integer, intent(out) :: flag ! return code
+    integer, optional, intent(out) :: stat ! allocate error code
+    real(wp), dimension(nnz), optional, intent(out) :: val ! numerical values
+    logical, optional, intent(in) :: nonsingular ! force matrix to be explicitly
+      ! non-singular. If not present, treated as .false.
+    logical, optional, intent(in) :: sort ! sort entries in columns by row index.
+      ! If not present, treated as .false.
+    logical, optional, intent(in) :: direct ! use rejection-free sampling.
+      ! If not present, treated as .false.
+    real(wp), optional, intent(in) :: dominance ! if present, make the matrix
+      ! strictly diagonally dominant with this factor (must be > 1)
+    real(wp), dimension(2), optional, intent(in) :: cond ! if present, make
+      ! the 2-norm condition number lie in the range cond(1:2). Requires val
+    real(wp), dimension(2), optional, intent(out) :: cond_est ! if cond is
+      ! present, lower and upper bounds on the condition number achieved
+    real(wp), dimension(n), optional, intent(out) :: x ! random solution
+      ! vector x_true
+    real(wp), dimension(m), optional, intent(out) :: rhs ! right-hand side
+      ! A*x_true (the full matrix in the symmetric case). Requires x and val
+    type(random_matrix_workspace), optional, intent(inout) :: work ! if
+      ! present, workspace kept by the caller between calls
+    real(sp), dimension(nnz), optional, intent(out) :: sval ! single
+      ! precision values, in place of val
+    complex(sp), dimension(nnz), optional, intent(out) :: cval ! single
+      ! precision complex values, in place of val
+    complex(wp), dimension(nnz), optional, intent(out) :: zval ! double
+      ! precision complex values, in place of val
 
     integer(long), dimension(:), allocatable :: ptr64
     integer :: st
 
-   ! Create temporary 64-bit version of ptr
-    allocate(ptr64(n+1), stat=st)
+    ! Create temporary 64-bit version of ptr, held in the workspace if there
+    ! is one so that it is only allocated on the first call
+    if (present(work)) call move_alloc(work%ptr64, ptr64)
+    call grow_long(ptr64, n+1, st)
     if (st .ne. 0) then
        flag = ERROR_ALLOCATION
        if (present(stat)) stat = st
@@ -314,27 +664,59 @@ contains
     end if
 
     ! Call 64-bit version
-    call random_matrix_generate64_band(state, matrix_type, m, n, int(nnz,long), &
-      bw, ptr64, row, flag, stat=stat, val=val,                     &
-      nonsingular=nonsingular, sort=sort)
+    call random_matrix_generate64_band_kl_ku(state, matrix_type, m, n, &
+      int(nnz,long), kl, ku, ptr64, row, flag, stat=stat, val=val,   &
+      nonsingular=nonsingular, sort=sort, direct=direct,             &
+      dominance=dominance, cond=cond, cond_est=cond_est, x=x, rhs=rhs, &
+      work=work, sval=sval, cval=cval, zval=zval)
 
     ! ... and copy back to 32-bit ptr
-    ptr(:) = int(ptr64(:))
-  end subroutine random_matrix_generate32_band
+    ptr(:) = int(ptr64(1:n+1))
+    if (present(work)) call move_alloc(ptr64, work%ptr64)
+  end subroutine random_matrix_generate32_band_kl_ku
 
+!
 ! Generate a random m x n band matrix with nnz non-zeroes.
 ! User can additionally specify a symmetric matrix (requires m==n), forced
 ! non-singularity, and the sorting of entries within columns.
-! User can specify a upper band width (lower is the same) to generate
-! a band matrix. A bandwidth <= 0 should have the same behaviour as the
-! not band variant.
+! Entries are restricted to the band j-ku <= i <= j+kl. A symmetric matrix
+! requires kl == ku. Bandwidths may be 0 (e.g. kl=0 gives an upper triangular
+! band), and those of at least m or n give the not band variant.
 !
-! FIXME: This routine will be slow if we're asked for a (near) dense matrix
-! In this case, we might be better served by finding holes or using the first
-! part of random permutations
-! The band constrains worsen this issue as the allowed positions are fewer.
-  subroutine random_matrix_generate64_band(state, matrix_type, m, n, nnz, bw, ptr, row, &
-       flag, stat, val, nonsingular, sort)
+! If direct is present with value .true., the matrix is sampled without
+! rejection in O(nnz+n) time, in parallel (see band_generate_direct()).
+! Otherwise the original rejection sampler is used.
+!
+! If dominance is present, the (square) matrix is made strictly diagonally
+! dominant by rows and columns: the diagonal is forced to be present and each
+! diagonal entry is set to dominance times the larger of the absolute sums of
+! the off-diagonal entries in its row and column (in the symmetric case, of
+! the whole symmetric matrix). Positive-definite matrices are always made
+! diagonally dominant in this way, with a factor of DEFAULT_DOMINANCE if
+! dominance is not present, so that they may be factorized without pivoting.
+!
+! If cond is present, the matrix is made diagonally dominant with a 2-norm
+! condition number between cond(1) and cond(2) (see band_set_conditioned()),
+! with diagonal entries of random sign for symmetric indefinite matrices.
+! Cheap lower and upper bounds on the condition number achieved are returned
+! in cond_est.
+!
+! If x is present, it is set to a random vector x_true with entries in (-1,1),
+! drawn from a stream split from state so that the matrix is unchanged. If rhs
+! is also present, it is set to A*x_true, accumulated in the same sweep that
+! sets the final values (with the symmetric expansion of the lower triangle),
+! so that no separate matrix-vector product is needed.
+!
+! If sval, cval or zval is present in place of val, single precision real,
+! single precision complex or double precision complex values are generated
+! instead by band_generate_values(), and matrix_type must be a complex type
+! for cval and zval. cond, x and rhs are not available with them.
+!
+! Without direct, holes are drawn instead of entries beyond half fill of the
+! band or of a column (see band_pattern_rejection()).
+  subroutine random_matrix_generate64_band_kl_ku(state, matrix_type, m, n, nnz, &
+       kl, ku, ptr, row, flag, stat, val, nonsingular, sort, direct, &
+       dominance, cond, cond_est, x, rhs, work, sval, cval, zval)
     implicit none
     type(random_state), intent(inout) :: state ! random generator to use
     integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
@@ -342,7 +724,8 @@ contains
     integer, intent(in) :: m ! number of rows
     integer, intent(in) :: n ! number of columns
     integer(long), intent(in) :: nnz ! number of entries
-    integer, intent(in) :: bw ! upper/lower bw
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
     integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
     integer, dimension(nnz), intent(out) :: row ! row indices
     integer, intent(out) :: flag ! return code
@@ -352,212 +735,3342 @@ contains
       ! non-singular. If not present, treated as .false.
     logical, optional, intent(in) :: sort ! sort entries in columns by row index.
       ! If not present, treated as .false.
+    logical, optional, intent(in) :: direct ! use rejection-free sampling.
+      ! If not present, treated as .false.
+    real(wp), optional, intent(in) :: dominance ! if present, make the matrix
+      ! strictly diagonally dominant with this factor (must be > 1)
+    real(wp), dimension(2), optional, intent(in) :: cond ! if present, make
+      ! the 2-norm condition number lie in the range cond(1:2). Requires val
+    real(wp), dimension(2), optional, intent(out) :: cond_est ! if cond is
+      ! present, lower and upper bounds on the condition number achieved
+    real(wp), dimension(n), optional, intent(out) :: x ! random solution
+      ! vector x_true
+    real(wp), dimension(m), optional, intent(out) :: rhs ! right-hand side
+      ! A*x_true (the full matrix in the symmetric case). Requires x and val
+    type(random_matrix_workspace), optional, intent(inout) :: work ! if
+      ! present, workspace kept by the caller between calls
+    real(sp), dimension(nnz), optional, intent(out) :: sval ! single
+      ! precision values, in place of val
+    complex(sp), dimension(nnz), optional, intent(out) :: cval ! single
+      ! precision complex values, in place of val
+    complex(wp), dimension(nnz), optional, intent(out) :: zval ! double
+      ! precision complex values, in place of val
 
-    integer :: i, j, k, minidx, maxidx
-    integer(long) :: ii, jj
-    integer, dimension(:), allocatable :: cnt, rperm, cperm
-    logical, dimension(:), allocatable :: rused
-    logical :: lsymmetric, lnonsingular, lsort
+    integer :: lkl, lku, j
+    type(random_matrix_workspace) :: lwork
+    logical :: lsymmetric, lnonsingular, lsort, ldirect, ldominant, lskew
+    logical :: lfused
+    type(random_state) :: xstate
+    real(wp) :: ldom
+    real(wp), dimension(2) :: lcond_est
     integer :: st
 
     ! Initialize return codes
     flag = 0
     if (present(stat)) stat = 0
 
+    ! Values of other precisions are drawn for the pattern alone (see
+    ! band_generate_values()), so they take the place of val, x and rhs
+    if (present(sval) .or. present(cval) .or. present(zval)) then
+       if ((count((/ present(val), present(sval), present(cval),          &
+            present(zval) /)) .gt. 1) .or. present(cond) .or. present(x) .or. &
+            present(rhs)) then
+          flag = ERROR_ARG
+          return
+       end if
+       if (present(work)) call workspace_move(work, lwork)
+       call band_generate_values(state, matrix_type, m, n, nnz, kl, ku, ptr, &
+            row, lwork, flag, st, sval=sval, cval=cval, zval=zval,             &
+            nonsingular=nonsingular, sort=sort, direct=direct,               &
+            dominance=dominance)
+       if ((flag .eq. ERROR_ALLOCATION) .and. present(stat)) stat = st
+       if (present(work)) call workspace_move(lwork, work)
+       return
+    end if
+
     ! Generate local logical flags
     lnonsingular = .false.
     if (present(nonsingular)) lnonsingular = nonsingular
     lsort = .false.
     if (present(sort)) lsort = sort
+    ldirect = .false.
+    if (present(direct)) ldirect = direct
 
-    ! Handle matrix type
-    select case (matrix_type)
-    case(SPRAL_MATRIX_UNSPECIFIED, SPRAL_MATRIX_REAL_RECT)
-       lsymmetric = .false.
-    case(SPRAL_MATRIX_REAL_UNSYM)
-       lsymmetric = .false.
-       if (m .ne. n) then
-          ! Matrix is not square - did user mean SPRAL_MATRIX_REAL_RECT?
-          flag = ERROR_NONSQUARE
-          return
-       end if
-    case(SPRAL_MATRIX_REAL_SYM_PSDEF, SPRAL_MATRIX_REAL_SYM_INDEF, &
-         SPRAL_MATRIX_REAL_SKEW)
-       lsymmetric = .true.
-       if (m .ne. n) then
-          ! Matrix is not square - did user mean SPRAL_MATRIX_REAL_RECT?
-          flag = ERROR_NONSQUARE
-          return
-       end if
-    case default
-       ! COMPLEX or unknown matrix type
-       flag = ERROR_MATRIX_TYPE
-       return
-    end select
-
-    ! Check args
-    if ((m .lt. 1) .or. (n .lt. 1) .or. (nnz .lt. 1)) then
-       ! Args out of range
+    ! Check arguments
+    call band_dominance_args(matrix_type, m, n, lnonsingular, ldominant, &
+         ldom, flag, dominance=dominance, cond=cond)
+    if (flag .ne. 0) return
+    if (present(cond) .and. (.not. present(val))) then
+       ! Condition number depends on values
        flag = ERROR_ARG
        return
     end if
-    if ((lsymmetric .and. (n*(n+1_long)/2 .lt. nnz)) .or. &
-         ((.not. lsymmetric) .and. (m*(n+0_long) .lt. nnz))) then
-       ! Too many non-zeroes for matrix
+    if (present(rhs) .and. .not. (present(x) .and. present(val))) then
+       ! Right-hand side depends on x_true and values
        flag = ERROR_ARG
        return
     end if
-    if (lnonsingular .and. (nnz .lt. min(m,n))) then
-       ! Requested a non-singular matrix, but not enough non-zeroes
-       flag = ERROR_SINGULAR
-       return
+    call band_check_args(matrix_type, m, n, nnz, kl, ku, lnonsingular, &
+         lsymmetric, flag)
+    if (flag .ne. 0) return
+    ! Bandwidths beyond the matrix cover it entirely
+    lkl = min(kl, m)
+    lku = min(ku, n)
+
+    ! Draw x_true from its own stream, so that the matrix is unchanged. The
+    ! right-hand side is accumulated in whichever sweep sets the final values:
+    ! the generation itself, or the conditioning or dominance pass.
+    if (present(x)) then
+       call random_split(state, 0_long, xstate)
+       call random_real_array(xstate, x)
     end if
+    if (present(rhs)) rhs(:) = 0.0
+    lskew = (matrix_type .eq. SPRAL_MATRIX_REAL_SKEW)
+    lfused = present(rhs) .and. .not. (present(cond) .or. ldominant)
 
-    ! Allocate non-zeroes to columns
-    allocate(cnt(n), stat=st)
-    if (st .ne. 0) goto 100
-    cnt(:) = 0
-    if (lsymmetric) then
-       ! In symmetric case, structural non-singularity is guarunteed by adding
-       ! the diagonal
-       if (lnonsingular) then
-          allocate(rperm(m), cperm(n), stat=st)
-          if (st .ne. 0) goto 100
-          ! To be consistent with unsymmetric case, we satisfy the following
-          ! through identity permutations:
-          ! If cperm(i)<=min(m,n) then that column has a structural non-zero
-          ! in position rperm(cperm(i))
-          do i = 1, n
-             rperm(i) = i
-             cperm(i) = i
-          end do
-          cnt(cperm(:)) = cnt(cperm(:)) + 1
+    if (present(work)) call workspace_move(work, lwork)
+    if (ldirect) then
+       ! Generate pattern, sorted if required, and values together
+       call grow_int(lwork%cnt, n, st)
+       if (st .ne. 0) goto 100
+       if (lfused) then
+          call band_generate_direct(state, lsymmetric, lnonsingular, lsort, &
+               m, n, nnz, lkl, lku, lwork%cnt, ptr, row, st, val=val, x=x, &
+               rhs=rhs, skew=lskew)
+       else
+          call band_generate_direct(state, lsymmetric, lnonsingular, lsort, &
+               m, n, nnz, lkl, lku, lwork%cnt, ptr, row, st, val=val)
        end if
-       ! Generate column assignments of remaining entries
-       ii = nnz; if(lnonsingular) ii = nnz - min(m,n) ! Allow for forced non-sing
-       do ii = 1, ii
-          j = random_integer(state, n)
-          do while (((bw .gt. 0) .and. (cnt(j) .ge. bw+1)) .or. (cnt(j) .ge. (m-j+1)))
-             j = random_integer(state, n)
-          end do
-          cnt(j) = cnt(j) + 1
-       end do
+       if (st .ne. 0) goto 100
     else
-       ! If we force (structural) non-singularity, generate locations and
-       ! add to column counts
-       if (lnonsingular) then
-          allocate(rperm(m), cperm(n), stat=st)
-          if (st .ne. 0) goto 100
-          ! We generate random permutations of rows and columns
-          ! We use the first min(m,n) of each permutation
-          ! If cperm(i)<=min(m,n) then that column has a structural non-zero
-          ! in position rperm(cperm(i))
-          ! [i.e. rperm gives actual rows, cperm doesn't - its an inverse]
-          ! call random_perm(state, m, rperm)
-          ! call random_perm(state, n, cperm)
-          ! where (cperm(:) .le. min(m,n)) cnt(:) = 1
-          do i = 1, n
-             rperm(i) = i
-             cperm(i) = i
+       ! Generate pattern, sorted if required
+       call band_pattern_rejection(state, lsymmetric, lnonsingular, lsort, &
+            m, n, nnz, lkl, lku, ptr, row, lwork, st)
+       if (st .ne. 0) goto 100
+
+       ! Determine values
+       if (present(val)) call random_real_array(state, val(1:ptr(n+1)-1))
+       if (lfused) then
+          do j = 1, n
+             call csc_col_matvec(lsymmetric, lskew, j,                    &
+                  int(ptr(j+1)-ptr(j)), row(ptr(j):ptr(j+1)-1),             &
+                  val(ptr(j):ptr(j+1)-1), x, rhs)
           end do
-          cnt(cperm(:)) = cnt(cperm(:)) + 1
        end if
-       ! Generate column assignments of remaining entries
-       ii = nnz; if(lnonsingular) ii = nnz - min(m,n) ! Allow for forced non-sing
-       do ii = 1, ii
-          j = random_integer(state, n)
-          do while (((bw .gt. 0) .and. &
-              ((cnt(j) .ge. (2*bw)+1) .or. (cnt(j) .ge. (m-j+1+bw)) .or.&
-              (cnt(j) .ge. (j+bw)))) &
-              .or. (cnt(j) .ge. m))
-             j = random_integer(state, n)
-          end do
-          cnt(j) = cnt(j) + 1
-       end do
-       if (sum(cnt) .ne. nnz) stop
     end if
 
-    ! Determine row values
-    allocate(rused(m), stat=st)
-    if (st .ne. 0) goto 100
-    rused(:) = .false.
-    ptr(1) = 1
-    do i = 1, n
-       ! Determine the bound of the band
-       minidx = i - bw
-       if ((bw .le. 0) .or. (minidx .le. 0)) then
-           minidx = 1
-       endif
-       maxidx = i + bw
-       if ((bw .le. 0) .or. (maxidx .gt. m)) then
-           maxidx = m
-       endif
-       if (lsymmetric) minidx = i
-
-       ! Determine end of col
-       ptr(i+1) = ptr(i) + cnt(i)
-       jj = ptr(i)
-       ! Add non-singular entry if required
-       if (lnonsingular) then
-          if (cperm(i) .le. min(m,n)) then
-             k = rperm(cperm(i))
-             if ((k .lt. minidx) .or. (k .gt. maxidx)) then
-                 k = random_integer_in_range(state, minidx, maxidx)
-             endif
-             row(jj) = k
-             rused(k) = .true.
-             jj = jj + 1
-          end if
-       end if
-
-       ! Add normal entries
-       do jj = jj, ptr(i+1)-1
-          k = random_integer_in_range(state, minidx, maxidx)
-          do while (rused(k))
-             k = random_integer_in_range(state, minidx, maxidx)
-          end do
-          row(jj) = k
-          rused(k) = .true.
-       end do
-       ! Reset rused(:)
-       do jj = ptr(i), ptr(i+1)-1
-          rused(row(jj)) = .false.
-       end do
-    end do
-
-    ! Optionally, sort
-    if (lsort) then
-       call dbl_tr_sort(m, n, ptr, row, st)
+    ! Conditioned, diagonally dominant and positive definite cases
+    if (present(cond)) then
+       call band_set_conditioned(state, lsymmetric,                    &
+            (matrix_type .eq. SPRAL_MATRIX_REAL_SYM_INDEF), n, ptr, row, &
+            val, cond, lcond_est, st, x=x, rhs=rhs)
+       if (st .ne. 0) goto 100
+       if (present(cond_est)) cond_est(:) = lcond_est(:)
+    else if (ldominant .and. present(val)) then
+       call band_set_dominant(lsymmetric, n, ptr, row, val, ldom, st, x=x, &
+            rhs=rhs)
        if (st .ne. 0) goto 100
     end if
 
-    ! Determine values
-    if (present(val)) then
-       do jj = 1, ptr(n+1)-1
-          val(jj) = random_real(state)
-       end do
-    end if
-
-    ! Positive Definite Case
-    if (matrix_type .eq. SPRAL_MATRIX_REAL_SYM_PSDEF) then
-        do j = 1, n
-            do jj = ptr(j), ptr(j+1)
-                if (row(jj) .eq. j) then
-                    val(jj) = cnt(j) + 0.1
-                    exit
-                end if
-            end do
-        end do
-    end if
-
+    if (present(work)) call workspace_move(lwork, work)
     return ! Normal return
 
 100 continue
     ! Memory allocation failure
     flag = ERROR_ALLOCATION
     if (present(stat)) stat = st
+    if (present(work)) call workspace_move(lwork, work)
     return
-  end subroutine random_matrix_generate64_band
+  end subroutine random_matrix_generate64_band_kl_ku
+
+!
+! Generate a random m x n band matrix with nnz non-zeroes in coordinate
+! format: entry k lies in row row(k) and column col(k). The entries, their
+! order and the random stream used are exactly those of
+! random_matrix_generate64_band_kl_ku() with the same arguments, so entries
+! are ordered by column (and by row within columns if sort is .true.).
+!
+! If direct is present with value .true., the column indices are written by
+! each block of the direct sampler as it is generated, into the range of
+! positions determined for the block before generation begins. The blocks are
+! generated in parallel, and the result does not depend on the number of
+! threads. Otherwise the column indices are expanded from the column pointers
+! of the rejection sampler in a separate (parallel) pass.
+!
+  subroutine random_matrix_generate_band_coord(state, matrix_type, m, n, &
+       nnz, kl, ku, row, col, flag, stat, val, nonsingular, sort, direct, &
+       dominance, work)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    integer, dimension(nnz), intent(out) :: col ! column indices
+    integer, intent(out) :: flag ! return code
+    integer, optional, intent(out) :: stat ! allocate error code
+    real(wp), dimension(nnz), optional, intent(out) :: val ! numerical values
+    logical, optional, intent(in) :: nonsingular ! force matrix to be explicitly
+      ! non-singular. If not present, treated as .false.
+    logical, optional, intent(in) :: sort ! sort entries in columns by row index.
+      ! If not present, treated as .false.
+    logical, optional, intent(in) :: direct ! use rejection-free sampling.
+      ! If not present, treated as .false.
+    real(wp), optional, intent(in) :: dominance ! if present, make the matrix
+      ! strictly diagonally dominant with this factor (must be > 1)
+    type(random_matrix_workspace), optional, intent(inout) :: work ! if
+      ! present, workspace kept by the caller between calls
+
+    integer :: lkl, lku, j
+    type(random_matrix_workspace) :: lwork
+    integer(long), dimension(:), allocatable :: ptr
+    logical :: lsymmetric, lnonsingular, lsort, ldirect, ldominant
+    real(wp) :: ldom
+    integer :: st
+
+    ! Initialize return codes
+    flag = 0
+    if (present(stat)) stat = 0
+
+    ! Generate local logical flags
+    lnonsingular = .false.
+    if (present(nonsingular)) lnonsingular = nonsingular
+    lsort = .false.
+    if (present(sort)) lsort = sort
+    ldirect = .false.
+    if (present(direct)) ldirect = direct
+
+    ! Check arguments
+    call band_dominance_args(matrix_type, m, n, lnonsingular, ldominant, &
+         ldom, flag, dominance=dominance)
+    if (flag .ne. 0) return
+    call band_check_args(matrix_type, m, n, nnz, kl, ku, lnonsingular, &
+         lsymmetric, flag)
+    if (flag .ne. 0) return
+    ! Bandwidths beyond the matrix cover it entirely
+    lkl = min(kl, m)
+    lku = min(ku, n)
+
+    ! Column pointers are still needed internally, and are held in the
+    ! workspace if there is one
+    if (present(work)) call workspace_move(work, lwork)
+    call move_alloc(lwork%ptr64, ptr)
+    call grow_long(ptr, n+1, st)
+    if (st .ne. 0) goto 100
+
+    if (ldirect) then
+       ! Generate pattern, sorted if required, values and column indices
+       ! together
+       call grow_int(lwork%cnt, n, st)
+       if (st .ne. 0) goto 100
+       call band_generate_direct(state, lsymmetric, lnonsingular, lsort, &
+            m, n, nnz, lkl, lku, lwork%cnt, ptr, row, st, val=val, col=col)
+       if (st .ne. 0) goto 100
+    else
+       ! Generate pattern, sorted if required
+       call band_pattern_rejection(state, lsymmetric, lnonsingular, lsort, &
+            m, n, nnz, lkl, lku, ptr, row, lwork, st)
+       if (st .ne. 0) goto 100
+
+       ! Determine values
+       if (present(val)) call random_real_array(state, val(1:ptr(n+1)-1))
+
+       ! Expand column pointers
+       !$omp parallel do default(shared) private(j) schedule(static)
+       do j = 1, n
+          col(ptr(j):ptr(j+1)-1) = j
+       end do
+       !$omp end parallel do
+    end if
+
+    ! Diagonally dominant and positive definite cases
+    if (ldominant .and. present(val)) then
+       call band_set_dominant(lsymmetric, n, ptr, row, val, ldom, st)
+       if (st .ne. 0) goto 100
+    end if
+
+    call move_alloc(ptr, lwork%ptr64)
+    if (present(work)) call workspace_move(lwork, work)
+    return ! Normal return
+
+100 continue
+    ! Memory allocation failure
+    flag = ERROR_ALLOCATION
+    if (present(stat)) stat = st
+    if (allocated(ptr)) call move_alloc(ptr, lwork%ptr64)
+    if (present(work)) call workspace_move(lwork, work)
+    return
+  end subroutine random_matrix_generate_band_coord
+
+!
+! Generate nmat random band matrices in one call, packed one after another.
+! The column pointers of matrix i are ptr(mptr(i):mptr(i+1)-1), relative to
+! its own first entry, and its row indices and values are in
+! row(eptr(i):eptr(i+1)-1) and val(eptr(i):eptr(i+1)-1). Other arguments
+! are as for random_matrix_generate64_band_kl_ku(), with one entry of m, n,
+! nnz, kl and ku for each matrix.
+!
+! Matrix i is the same as that generated by
+! random_matrix_generate64_band_kl_ku() from the stream split from state by
+! index i, so the matrices are generated in parallel and do not depend on
+! the number of threads. Each thread reuses its workspace from one matrix to
+! the next. All arguments are checked before any matrix is generated.
+!
+  subroutine random_matrix_generate_band_batch(state, matrix_type, nmat, m, &
+       n, nnz, kl, ku, mptr, eptr, ptr, row, flag, stat, val, nonsingular, &
+       sort, direct, dominance)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
+    integer, intent(in) :: nmat ! number of matrices
+    integer, dimension(nmat), intent(in) :: m ! number of rows of each matrix
+    integer, dimension(nmat), intent(in) :: n ! number of columns of each
+      ! matrix
+    integer, dimension(nmat), intent(in) :: nnz ! number of entries of each
+      ! matrix
+    integer, dimension(nmat), intent(in) :: kl ! lower bandwidth of each
+      ! matrix
+    integer, dimension(nmat), intent(in) :: ku ! upper bandwidth of each
+      ! matrix
+    integer(long), dimension(nmat+1), intent(out) :: mptr ! start of each
+      ! matrix in ptr(:)
+    integer(long), dimension(nmat+1), intent(out) :: eptr ! start of each
+      ! matrix in row(:) and val(:)
+    integer, dimension(sum(int(n,long))+nmat), intent(out) :: ptr ! column
+      ! pointers of each matrix
+    integer, dimension(sum(int(nnz,long))), intent(out) :: row ! row indices
+    integer, intent(out) :: flag ! return code
+    integer, optional, intent(out) :: stat ! allocate error code
+    real(wp), dimension(sum(int(nnz,long))), optional, intent(out) :: val
+      ! numerical values
+    logical, optional, intent(in) :: nonsingular ! force matrices to be
+      ! explicitly non-singular. If not present, treated as .false.
+    logical, optional, intent(in) :: sort ! sort entries in columns by row index.
+      ! If not present, treated as .false.
+    logical, optional, intent(in) :: direct ! use rejection-free sampling.
+      ! If not present, treated as .false.
+    real(wp), optional, intent(in) :: dominance ! if present, make the
+      ! matrices strictly diagonally dominant with this factor (must be > 1)
+
+    integer :: i, thread_st
+    logical :: lsymmetric, lnonsingular, lsort, ldirect, ldominant
+    real(wp) :: ldom
+    type(random_state) :: base, mstate
+    type(random_matrix_workspace) :: work
+    integer :: st
+
+    ! Initialize return codes
+    flag = 0
+    st = 0
+    if (present(stat)) stat = 0
+
+    ! Generate local logical flags
+    lsort = .false.
+    if (present(sort)) lsort = sort
+    ldirect = .false.
+    if (present(direct)) ldirect = direct
+
+    ! Check arguments of every matrix, and determine where each is stored
+    if (nmat .lt. 0) then
+       flag = ERROR_ARG
+       return
+    end if
+    mptr(1) = 1
+    eptr(1) = 1
+    do i = 1, nmat
+       lnonsingular = .false.
+       if (present(nonsingular)) lnonsingular = nonsingular
+       call band_dominance_args(matrix_type, m(i), n(i), lnonsingular, &
+            ldominant, ldom, flag, dominance=dominance)
+       if (flag .ne. 0) return
+       call band_check_args(matrix_type, m(i), n(i), int(nnz(i),long), &
+            kl(i), ku(i), lnonsingular, lsymmetric, flag)
+       if (flag .ne. 0) return
+       mptr(i+1) = mptr(i) + n(i) + 1
+       eptr(i+1) = eptr(i) + nnz(i)
+    end do
+
+    ! Generate matrices, each from its own stream
+    base = state
+    call random_skip_ahead(state, 1_long)
+    !$omp parallel default(shared) private(i, mstate, work, thread_st)
+    thread_st = 0
+    !$omp do schedule(dynamic)
+    do i = 1, nmat
+       if (thread_st .ne. 0) cycle
+       call random_split(base, int(i,long), mstate)
+       if (present(val)) then
+          call band_batch_matrix(mstate, lsymmetric, lnonsingular, lsort, &
+               ldirect, ldominant, ldom, m(i), n(i), int(nnz(i),long),   &
+               kl(i), ku(i), ptr(mptr(i):mptr(i+1)-1),                   &
+               row(eptr(i):eptr(i+1)-1), work, thread_st,                 &
+               val=val(eptr(i):eptr(i+1)-1))
+       else
+          call band_batch_matrix(mstate, lsymmetric, lnonsingular, lsort, &
+               ldirect, ldominant, ldom, m(i), n(i), int(nnz(i),long),   &
+               kl(i), ku(i), ptr(mptr(i):mptr(i+1)-1),                   &
+               row(eptr(i):eptr(i+1)-1), work, thread_st)
+       end if
+       if (thread_st .ne. 0) then
+          !$omp critical (random_matrix_st)
+          st = thread_st
+          !$omp end critical (random_matrix_st)
+       end if
+    end do
+    !$omp end do
+    !$omp end parallel
+    if (st .ne. 0) goto 100
+
+    return ! Normal return
+
+100 continue
+    ! Memory allocation failure
+    flag = ERROR_ALLOCATION
+    if (present(stat)) stat = st
+    return
+  end subroutine random_matrix_generate_band_batch
+
+!
+! Generate a random m x n band matrix with nnz non-zeroes, lower bandwidth kl
+! and upper bandwidth ku, written directly to LAPACK band storage with no
+! intermediate CSC matrix. For unsymmetric and rectangular matrices the
+! general band layout used by dgbtrf() is produced: A(i,j) is stored in
+! ab(kl+ku+1+i-j,j), which requires ldab >= 2*kl+ku+1; the first kl rows are
+! left for fill-in. For symmetric and skew symmetric matrices the lower
+! triangle is produced in the symmetric band layout used by dpbtrf() with
+! uplo='L': A(i,j) is stored in ab(1+i-j,j), which requires kl == ku and
+! ldab >= kl+1. All other entries of ab(:,1:n) are set to zero.
+!
+! The pattern and values are sampled as by random_matrix_generate64_band_kl_ku()
+! with direct=.true. and sort=.false., so the two give the same matrix from
+! the same state. The diagonal of a diagonally dominant matrix (see dominance)
+! is the same up to the rounding of the absolute sums.
+!
+  subroutine random_matrix_generate_lapack_band(state, matrix_type, m, n, &
+       nnz, kl, ku, ab, ldab, flag, stat, nonsingular, dominance)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
+      ! and positive-definite
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer, intent(in) :: ldab ! leading dimension of ab
+    real(wp), dimension(ldab, n), intent(out) :: ab ! matrix in band storage
+    integer, intent(out) :: flag ! return code
+    integer, optional, intent(out) :: stat ! allocate error code
+    logical, optional, intent(in) :: nonsingular ! force matrix to be explicitly
+      ! non-singular. If not present, treated as .false.
+    real(wp), optional, intent(in) :: dominance ! if present, make the matrix
+      ! strictly diagonally dominant with this factor (must be > 1)
+
+    integer :: off, st
+    logical :: lsymmetric, lnonsingular, ldominant
+    real(wp) :: ldom
+
+    ! Initialize return codes
+    flag = 0
+    if (present(stat)) stat = 0
+
+    ! Generate local logical flags
+    lnonsingular = .false.
+    if (present(nonsingular)) lnonsingular = nonsingular
+
+    ! Check arguments
+    call band_dominance_args(matrix_type, m, n, lnonsingular, ldominant, &
+         ldom, flag, dominance=dominance)
+    if (flag .ne. 0) return
+    call band_check_args(matrix_type, m, n, nnz, kl, ku, lnonsingular, &
+         lsymmetric, flag)
+    if (flag .ne. 0) return
+    ! Determine row of ab holding the diagonal
+    if (lsymmetric) then
+       off = 1
+       if (ldab .lt. kl+1_long) flag = ERROR_ARG
+    else
+       off = kl + ku + 1
+       if (ldab .lt. 2_long*kl+ku+1) flag = ERROR_ARG
+    end if
+    if (flag .ne. 0) return
+
+    call band_generate_direct_lapack(state, lsymmetric, lnonsingular, m, n, &
+         nnz, min(kl,m), min(ku,n), ab, ldab, off, st)
+    if (st .ne. 0) then
+       ! Memory allocation failure
+       flag = ERROR_ALLOCATION
+       if (present(stat)) stat = st
+       return
+    end if
+
+    ! Diagonally dominant and positive definite cases
+    if (ldominant) call band_set_dominant_lapack(lsymmetric, n, min(kl,m), &
+         min(ku,n), ab, ldab, off, ldom, lnonsingular)
+  end subroutine random_matrix_generate_lapack_band
+
+!
+! Generate a random m x n matrix with nnz non-zeroes and a variable profile
+! (skyline): the entries of column j lie in rows first(j):last(j), and a
+! column with last(j) < first(j) is empty. In the symmetric case only the
+! lower triangle is generated, so first(j) >= j is required. If the diagonal
+! is forced (nonsingular, dominance or a positive-definite matrix) it must
+! lie in the window of each column j <= min(m,n).
+!
+! The pattern is sampled without rejection in O(nnz+n) time, in parallel, by
+! band_generate_direct() with the band replaced by the profile. Other
+! arguments are as for random_matrix_generate64_band_kl_ku(). Profiles of
+! common shapes are produced by random_matrix_envelope().
+!
+  subroutine random_matrix_generate_profile(state, matrix_type, m, n, nnz, &
+       first, last, ptr, row, flag, stat, val, nonsingular, sort, dominance)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
+      ! and positive-definite
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, dimension(n), intent(in) :: first ! first row of each column
+    integer, dimension(n), intent(in) :: last ! last row of each column
+    integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    integer, intent(out) :: flag ! return code
+    integer, optional, intent(out) :: stat ! allocate error code
+    real(wp), dimension(nnz), optional, intent(out) :: val ! numerical values
+    logical, optional, intent(in) :: nonsingular ! force matrix to be explicitly
+      ! non-singular. If not present, treated as .false.
+    logical, optional, intent(in) :: sort ! sort entries in columns by row index.
+      ! If not present, treated as .false.
+    real(wp), optional, intent(in) :: dominance ! if present, make the matrix
+      ! strictly diagonally dominant with this factor (must be > 1)
+
+    integer :: j
+    integer(long) :: cap
+    integer, dimension(:), allocatable :: cnt
+    logical :: lsymmetric, lnonsingular, lsort, ldominant
+    real(wp) :: ldom
+    integer :: st
+
+    ! Initialize return codes
+    flag = 0
+    if (present(stat)) stat = 0
+
+    ! Generate local logical flags
+    lnonsingular = .false.
+    if (present(nonsingular)) lnonsingular = nonsingular
+    lsort = .false.
+    if (present(sort)) lsort = sort
+
+    ! Check arguments, treating the profile as a full band at first
+    call band_dominance_args(matrix_type, m, n, lnonsingular, ldominant, &
+         ldom, flag, dominance=dominance)
+    if (flag .ne. 0) return
+    call band_check_args(matrix_type, m, n, nnz, m, n, lnonsingular, &
+         lsymmetric, flag)
+    if (flag .ne. 0) return
+
+    ! Check profile
+    cap = 0
+    do j = 1, n
+       if (lnonsingular .and. (j .le. min(m,n))) then
+          if ((first(j) .gt. j) .or. (last(j) .lt. j)) flag = ERROR_ARG
+       end if
+       if (last(j) .lt. first(j)) cycle ! Empty column
+       if ((first(j) .lt. 1) .or. (last(j) .gt. m)) flag = ERROR_ARG
+       if (lsymmetric .and. (first(j) .lt. j)) flag = ERROR_ARG
+       cap = cap + (last(j)-first(j)+1)
+    end do
+    if (cap .lt. nnz) flag = ERROR_ARG ! Too many non-zeroes for profile
+    if (flag .ne. 0) return
+
+    allocate(cnt(n), stat=st)
+    if (st .ne. 0) goto 100
+    ! Generate pattern, sorted if required, and values together
+    call band_generate_direct(state, lsymmetric, lnonsingular, lsort, m, n, &
+         nnz, 0, 0, cnt, ptr, row, st, val=val, first=first, last=last)
+    if (st .ne. 0) goto 100
+
+    ! Diagonally dominant and positive definite cases
+    if (ldominant .and. present(val)) then
+       call band_set_dominant(lsymmetric, n, ptr, row, val, ldom, st)
+       if (st .ne. 0) goto 100
+    end if
+
+    return ! Normal return
+
+100 continue
+    ! Memory allocation failure
+    flag = ERROR_ALLOCATION
+    if (present(stat)) stat = st
+    return
+  end subroutine random_matrix_generate_profile
+
+!
+! Set first(:) and last(:) to the envelope of given shape for use with
+! random_matrix_generate_profile(), clipped to the m x n matrix (and to the
+! lower triangle for symmetric matrix types). The shapes are:
+!  RANDOM_MATRIX_ENVELOPE_LINEAR: column j has bandwidth
+!     width*(j-1)/(n-1), growing linearly from 0 to width.
+!  RANDOM_MATRIX_ENVELOPE_BLOCK: block tridiagonal with width x width blocks;
+!     column j covers the rows of its own block and of the blocks either side.
+!  RANDOM_MATRIX_ENVELOPE_ARROW: bandwidth width, plus the first width
+!     columns are full (an arrowhead in the symmetric case).
+! flag is set to ERROR_ARG if shape is unknown or width is negative (or zero
+! for RANDOM_MATRIX_ENVELOPE_BLOCK).
+!
+  subroutine random_matrix_envelope(shape, matrix_type, m, n, width, first, &
+       last, flag)
+    implicit none
+    integer, intent(in) :: shape ! envelope shape
+    integer, intent(in) :: matrix_type ! used to determine symmetry
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer, intent(in) :: width ! bandwidth or block size
+    integer, dimension(n), intent(out) :: first ! first row of each column
+    integer, dimension(n), intent(out) :: last ! last row of each column
+    integer, intent(out) :: flag ! return code
+
+    integer :: j, blk
+    integer(long) :: b, lo, hi
+    logical :: lsymmetric
+
+    flag = 0
+    if ((width .lt. 0) .or. ((shape .eq. RANDOM_MATRIX_ENVELOPE_BLOCK) .and. &
+         (width .lt. 1))) then
+       flag = ERROR_ARG
+       return
+    end if
+    lsymmetric = (matrix_type .eq. SPRAL_MATRIX_REAL_SYM_PSDEF) .or. &
+         (matrix_type .eq. SPRAL_MATRIX_REAL_SYM_INDEF) .or.        &
+         (matrix_type .eq. SPRAL_MATRIX_REAL_SKEW)
+
+    do j = 1, n
+       select case(shape)
+       case(RANDOM_MATRIX_ENVELOPE_LINEAR)
+          b = (int(width,long)*(j-1)) / max(1, n-1)
+          lo = j - b
+          hi = j + b
+       case(RANDOM_MATRIX_ENVELOPE_BLOCK)
+          blk = (j-1) / width
+          lo = (blk-1)*int(width,long) + 1
+          hi = (blk+2)*int(width,long)
+       case(RANDOM_MATRIX_ENVELOPE_ARROW)
+          if (j .le. width) then
+             lo = 1
+             hi = m
+          else
+             lo = j - int(width,long)
+             hi = j + int(width,long)
+          end if
+       case default
+          flag = ERROR_ARG
+          return
+       end select
+       if (lsymmetric) lo = j
+       first(j) = int(max(1_long, lo))
+       last(j) = int(min(int(m,long), hi))
+    end do
+  end subroutine random_matrix_envelope
+
+!
+! Generate a random m x n block band matrix with nblk dense b x b blocks, at
+! most kl blocks below and ku blocks above the diagonal block in each block
+! column. Blocks in the last block row and column are truncated to the matrix.
+! In the symmetric case only the lower triangle is generated, so the diagonal
+! blocks hold their lower triangles only. If nonsingular is requested, all
+! diagonal blocks are present.
+!
+! The block pattern is generated by band_generate_direct() as a sorted band
+! matrix of size ceiling(m/b) x ceiling(n/b), and each selected block is then
+! written as a contiguous run of rows in each of its columns, so that entries
+! are sorted within columns. As blocks may be truncated, the number of entries
+! is not known in advance: row(:) and val(:) have space for nblk*b*b entries,
+! of which the first ptr(n+1)-1 are used.
+!
+  subroutine random_matrix_generate_block_band(state, matrix_type, m, n, b, &
+       nblk, kl, ku, ptr, row, flag, stat, val, nonsingular, dominance)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
+      ! and positive-definite
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer, intent(in) :: b ! block size
+    integer(long), intent(in) :: nblk ! number of non-zero blocks
+    integer, intent(in) :: kl ! lower bandwidth in blocks
+    integer, intent(in) :: ku ! upper bandwidth in blocks
+    integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nblk*b*b), intent(out) :: row ! row indices
+    integer, intent(out) :: flag ! return code
+    integer, optional, intent(out) :: stat ! allocate error code
+    real(wp), dimension(nblk*b*b), optional, intent(out) :: val ! numerical
+      ! values
+    logical, optional, intent(in) :: nonsingular ! force diagonal blocks to be
+      ! present. If not present, treated as .false.
+    real(wp), optional, intent(in) :: dominance ! if present, make the matrix
+      ! strictly diagonally dominant with this factor (must be > 1)
+
+    integer :: mb, nb, bj, i, j, lo, hi
+    integer(long) :: jj, kk
+    integer, dimension(:), allocatable :: bcnt, brow
+    integer(long), dimension(:), allocatable :: bptr
+    logical :: lsymmetric, lnonsingular, ldominant
+    real(wp) :: ldom
+    type(random_state) :: base, bstate
+    integer :: st
+
+    ! Initialize return codes
+    flag = 0
+    if (present(stat)) stat = 0
+
+    ! Generate local logical flags
+    lnonsingular = .false.
+    if (present(nonsingular)) lnonsingular = nonsingular
+
+    ! Check arguments. The block pattern is itself a band matrix.
+    if (b .lt. 1) then
+       flag = ERROR_ARG
+       return
+    end if
+    call band_dominance_args(matrix_type, m, n, lnonsingular, ldominant, &
+         ldom, flag, dominance=dominance)
+    if (flag .ne. 0) return
+    if ((m .ne. n) .and. (matrix_type .ne. SPRAL_MATRIX_UNSPECIFIED) .and. &
+         (matrix_type .ne. SPRAL_MATRIX_REAL_RECT)) then
+       ! Matrix is not square - did user mean SPRAL_MATRIX_REAL_RECT?
+       flag = ERROR_NONSQUARE
+       return
+    end if
+    mb = (m-1) / b + 1
+    nb = (n-1) / b + 1
+    call band_check_args(matrix_type, mb, nb, nblk, kl, ku, lnonsingular, &
+         lsymmetric, flag)
+    if (flag .ne. 0) return
+
+    ! Generate sorted block pattern
+    allocate(bcnt(nb), bptr(nb+1), brow(nblk), stat=st)
+    if (st .ne. 0) goto 100
+    call band_generate_direct(state, lsymmetric, lnonsingular, .true., mb, &
+         nb, nblk, min(kl,mb), min(ku,nb), bcnt, bptr, brow, st)
+    if (st .ne. 0) goto 100
+
+    ! Count entries in each column, then convert to column pointers
+    !$omp parallel do default(shared) private(bj, j, kk, lo) schedule(static)
+    do bj = 1, nb
+       do j = (bj-1)*b + 1, min(n, bj*b)
+          ptr(j+1) = 0
+          do kk = bptr(bj), bptr(bj+1)-1
+             lo = (brow(kk)-1)*b + 1
+             if (lsymmetric .and. (brow(kk) .eq. bj)) lo = j
+             ptr(j+1) = ptr(j+1) + (min(m, brow(kk)*b) - lo + 1)
+          end do
+       end do
+    end do
+    !$omp end parallel do
+    ptr(1) = 1
+    do j = 1, n
+       ptr(j+1) = ptr(j+1) + ptr(j)
+    end do
+
+    ! Write each block as a run of rows in each of its columns. Values of each
+    ! block column come from their own stream split from state, so the matrix
+    ! does not depend on the number of threads.
+    base = state
+    call random_skip_ahead(state, 1_long)
+    !$omp parallel do default(shared) &
+    !$omp    private(bj, bstate, j, jj, kk, i, lo, hi) schedule(dynamic)
+    do bj = 1, nb
+       do j = (bj-1)*b + 1, min(n, bj*b)
+          jj = ptr(j)
+          do kk = bptr(bj), bptr(bj+1)-1
+             lo = (brow(kk)-1)*b + 1
+             if (lsymmetric .and. (brow(kk) .eq. bj)) lo = j
+             hi = min(m, brow(kk)*b)
+             do i = lo, hi
+                row(jj) = i
+                jj = jj + 1
+             end do
+          end do
+       end do
+       if (present(val)) then
+          call random_split(base, int(bj,long), bstate)
+          j = (bj-1)*b + 1
+          call random_real_array(bstate, val(ptr(j):ptr(min(n,bj*b)+1)-1))
+       end if
+    end do
+    !$omp end parallel do
+
+    ! Diagonally dominant and positive definite cases
+    if (ldominant .and. present(val)) then
+       call band_set_dominant(lsymmetric, n, ptr, row, val, ldom, st)
+       if (st .ne. 0) goto 100
+    end if
+
+    return ! Normal return
+
+100 continue
+    ! Memory allocation failure
+    flag = ERROR_ALLOCATION
+    if (present(stat)) stat = st
+    return
+  end subroutine random_matrix_generate_block_band
+
+!
+! Return the order n and number of entries nnz of the matrix generated by
+! random_matrix_generate_stencil() for the given grid and stencil. flag is
+! set to ERROR_ARG if the arguments are bad or n is too large for an integer.
+!
+  subroutine random_matrix_stencil_size(matrix_type, d, dims, stencil, n, &
+       nnz, flag)
+    implicit none
+    integer, intent(in) :: matrix_type ! used to determine symmetry
+    integer, intent(in) :: d ! number of grid dimensions
+    integer, dimension(d), intent(in) :: dims ! number of grid points in each
+      ! dimension
+    integer, intent(in) :: stencil ! RANDOM_MATRIX_STENCIL_STAR or
+      ! RANDOM_MATRIX_STENCIL_BOX
+    integer, intent(out) :: n ! order of matrix
+    integer(long), intent(out) :: nnz ! number of entries
+    integer, intent(out) :: flag ! return code
+
+    integer :: k
+    integer(long) :: ln, npair
+    logical :: lsymmetric
+
+    flag = 0
+    n = 0
+    nnz = 0
+
+    select case (matrix_type)
+    case(SPRAL_MATRIX_UNSPECIFIED, SPRAL_MATRIX_REAL_RECT, &
+         SPRAL_MATRIX_REAL_UNSYM)
+       lsymmetric = .false.
+    case(SPRAL_MATRIX_REAL_SYM_PSDEF, SPRAL_MATRIX_REAL_SYM_INDEF, &
+         SPRAL_MATRIX_REAL_SKEW)
+       lsymmetric = .true.
+    case default
+       ! COMPLEX or unknown matrix type
+       flag = ERROR_MATRIX_TYPE
+       return
+    end select
+    if (d .lt. 1) then
+       flag = ERROR_ARG
+       return
+    end if
+    if (any(dims(:) .lt. 1)) then
+       flag = ERROR_ARG
+       return
+    end if
+
+    ! Order of matrix, which must fit in an integer
+    ln = 1
+    do k = 1, d
+       ln = ln * dims(k)
+       if (ln .gt. huge(n)) then
+          flag = ERROR_ARG
+          return
+       end if
+    end do
+    n = int(ln)
+
+    ! Count ordered pairs (i,j) of grid points related by the stencil,
+    ! including i = j
+    select case (stencil)
+    case(RANDOM_MATRIX_STENCIL_STAR)
+       ! One pair in each direction per grid edge
+       npair = ln
+       do k = 1, d
+          npair = npair + 2 * (ln / dims(k)) * (dims(k)-1)
+       end do
+    case(RANDOM_MATRIX_STENCIL_BOX)
+       ! Offsets are independent in each dimension, each being one of -1, 0
+       ! and 1, for which there are 3*dims(k)-2 pairs
+       npair = 1
+       do k = 1, d
+          npair = npair * (3_long*dims(k) - 2)
+       end do
+    case default
+       flag = ERROR_ARG
+       return
+    end select
+    if (lsymmetric) then
+       nnz = (npair + ln) / 2
+    else
+       nnz = npair
+    end if
+  end subroutine random_matrix_stencil_size
+
+!
+! Generate the n x n matrix of a stencil on a d-dimensional grid of
+! dims(1) x ... x dims(d) points. Entry (i,j) is present if grid points i and
+! j are related by the stencil:
+!  RANDOM_MATRIX_STENCIL_STAR: points differing by one in a single coordinate
+!     (the 3, 5 and 7-point stencils in 1, 2 and 3 dimensions).
+!  RANDOM_MATRIX_STENCIL_BOX: points differing by at most one in every
+!     coordinate (the 3, 9 and 27-point stencils).
+! n and nnz must be as returned by random_matrix_stencil_size(). In the
+! symmetric case only the lower triangle is generated. Entries are sorted
+! within columns.
+!
+! Grid points are numbered lexicographically, the first coordinate varying
+! fastest, or, with RANDOM_MATRIX_NUMBER_BLOCKED, tile by tile in
+! lexicographic order of tiles of tile points in each dimension, and
+! lexicographically within each tile.
+!
+! By default the values are those of the discrete Laplacian: -1 off the
+! diagonal and the number of neighbours of an interior point on it, giving a
+! positive-definite matrix. With random_values=.true. they are drawn from
+! (-1,1) instead, and for a positive-definite matrix the diagonal is then made
+! dominant.
+!
+! Columns are generated directly in O(nnz) time, in parallel in chunks of
+! BLOCK_COLS consecutive points of a tile. The values of each chunk are drawn
+! from their own stream split from state, so the matrix does not depend on
+! the number of threads.
+!
+  subroutine random_matrix_generate_stencil(state, matrix_type, d, dims, &
+       stencil, n, nnz, ptr, row, flag, stat, val, random_values, numbering, &
+       tile)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
+      ! and positive-definite
+    integer, intent(in) :: d ! number of grid dimensions
+    integer, dimension(d), intent(in) :: dims ! number of grid points in each
+      ! dimension
+    integer, intent(in) :: stencil ! RANDOM_MATRIX_STENCIL_STAR or
+      ! RANDOM_MATRIX_STENCIL_BOX
+    integer, intent(in) :: n ! order of matrix
+    integer(long), intent(in) :: nnz ! number of entries
+    integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    integer, intent(out) :: flag ! return code
+    integer, optional, intent(out) :: stat ! allocate error code
+    real(wp), dimension(nnz), optional, intent(out) :: val ! numerical values
+    logical, optional, intent(in) :: random_values ! use random coefficients.
+      ! If not present, treated as .false.
+    integer, optional, intent(in) :: numbering ! numbering of grid points.
+      ! If not present, treated as RANDOM_MATRIX_NUMBER_LEXICOGRAPHIC
+    integer, optional, intent(in) :: tile ! tile size for blocked numbering.
+      ! If not present, treated as DEFAULT_STENCIL_TILE
+
+    integer :: lnumbering, ltile, lsize, noff, thread_st
+    integer :: u, ntile, nchunk, j, j0, q, cnt
+    integer(long) :: lnnz, jj
+    integer, dimension(:), allocatable :: tsize, ntiles, tc, ext, inner, c, nbr
+    integer, dimension(:,:), allocatable :: off
+    logical :: lsymmetric, lrandom
+    type(random_state) :: base, tstate
+    integer :: st
+
+    ! Initialize return codes
+    flag = 0
+    if (present(stat)) stat = 0
+
+    ! Generate local flags
+    lrandom = .false.
+    if (present(random_values)) lrandom = random_values
+    lnumbering = RANDOM_MATRIX_NUMBER_LEXICOGRAPHIC
+    if (present(numbering)) lnumbering = numbering
+    ltile = DEFAULT_STENCIL_TILE
+    if (present(tile)) ltile = tile
+
+    ! Check arguments
+    call random_matrix_stencil_size(matrix_type, d, dims, stencil, lsize, &
+         lnnz, flag)
+    if (flag .ne. 0) return
+    if ((lsize .ne. n) .or. (lnnz .ne. nnz) .or. (ltile .lt. 1)) then
+       flag = ERROR_ARG
+       return
+    end if
+    lsymmetric = (matrix_type .eq. SPRAL_MATRIX_REAL_SYM_PSDEF) .or. &
+         (matrix_type .eq. SPRAL_MATRIX_REAL_SYM_INDEF) .or.        &
+         (matrix_type .eq. SPRAL_MATRIX_REAL_SKEW)
+
+    ! Points are numbered tile by tile. Lexicographic numbering is the special
+    ! case of a single tile.
+    allocate(tsize(d), ntiles(d), stat=st)
+    if (st .ne. 0) goto 100
+    select case (lnumbering)
+    case(RANDOM_MATRIX_NUMBER_LEXICOGRAPHIC)
+       tsize(:) = dims(:)
+    case(RANDOM_MATRIX_NUMBER_BLOCKED)
+       tsize(:) = min(ltile, dims(:))
+    case default
+       flag = ERROR_ARG
+       return
+    end select
+    ntiles(:) = (dims(:)-1) / tsize(:) + 1
+    ntile = product(ntiles(:))
+
+    ! Each tile is divided into chunks of BLOCK_COLS consecutive points, which
+    ! are generated independently
+    nchunk = int((product(int(tsize(:),long)) - 1) / BLOCK_COLS) + 1
+
+    ! Stencil offsets
+    call stencil_offsets(d, stencil, noff, off, st)
+    if (st .ne. 0) goto 100
+
+    ! First pass counts the entries of each column, the second fills them
+    ptr(1) = 1
+    base = state
+    call random_skip_ahead(state, 1_long)
+    !$omp parallel default(shared) &
+    !$omp    private(u, tc, ext, inner, c, nbr, j, j0, q, jj, cnt, tstate, &
+    !$omp    thread_st)
+    allocate(tc(d), ext(d), inner(d), c(d), nbr(noff), stat=thread_st)
+    if (thread_st .ne. 0) then
+       !$omp critical (random_matrix_st)
+       st = thread_st
+       !$omp end critical (random_matrix_st)
+    end if
+    !$omp barrier
+    if (st .eq. 0) then
+       !$omp do schedule(dynamic)
+       do u = 1, ntile*nchunk
+          if (.not. chunk_first(u, tc, ext, inner, c, j0, q)) cycle
+          do j = j0, j0+q-1
+             call stencil_col(d, dims, tsize, tc, ext, inner, noff, off, &
+                  lsymmetric, c, j, cnt, nbr)
+             ptr(j+1) = cnt
+             call next_point(tc, ext, c)
+          end do
+       end do
+       !$omp end do
+
+       !$omp single
+       do j = 1, n
+          ptr(j+1) = ptr(j+1) + ptr(j)
+       end do
+       !$omp end single
+
+       !$omp do schedule(dynamic)
+       do u = 1, ntile*nchunk
+          if (.not. chunk_first(u, tc, ext, inner, c, j0, q)) cycle
+          do j = j0, j0+q-1
+             call stencil_col(d, dims, tsize, tc, ext, inner, noff, off, &
+                  lsymmetric, c, j, cnt, nbr)
+             row(ptr(j):ptr(j+1)-1) = nbr(1:cnt)
+             if (present(val) .and. .not. lrandom) then
+                do jj = ptr(j), ptr(j+1)-1
+                   if (row(jj) .eq. j) then
+                      val(jj) = noff - 1
+                   else
+                      val(jj) = -1.0
+                   end if
+                end do
+             end if
+             call next_point(tc, ext, c)
+          end do
+          if (present(val) .and. lrandom) then
+             call random_split(base, int(u,long), tstate)
+             call random_real_array(tstate, val(ptr(j0):ptr(j0+q)-1))
+          end if
+       end do
+       !$omp end do
+    end if
+    !$omp end parallel
+    if (st .ne. 0) goto 100
+
+    ! Random positive-definite case
+    if (lrandom .and. present(val) .and. &
+         (matrix_type .eq. SPRAL_MATRIX_REAL_SYM_PSDEF)) then
+       call band_set_dominant(lsymmetric, n, ptr, row, val, &
+            DEFAULT_DOMINANCE, st)
+       if (st .ne. 0) goto 100
+    end if
+
+    return ! Normal return
+
+100 continue
+    ! Memory allocation failure
+    flag = ERROR_ALLOCATION
+    if (present(stat)) stat = st
+    return
+
+  contains
+    ! Set up chunk u: the (0-based) coordinates tc(:) and extent ext(:) of its
+    ! tile, the strides inner(:) of coordinates within the tile, and the
+    ! coordinates c(:) and index j0 of its first point. Returns .false. if the
+    ! chunk is empty, and otherwise sets q to the number of points in it.
+    logical function chunk_first(u, tc, ext, inner, c, j0, q)
+      integer, intent(in) :: u
+      integer, dimension(d), intent(out) :: tc
+      integer, dimension(d), intent(out) :: ext
+      integer, dimension(d), intent(out) :: inner
+      integer, dimension(d), intent(out) :: c
+      integer, intent(out) :: j0
+      integer, intent(out) :: q
+
+      integer :: k, r, q0
+
+      r = (u-1) / nchunk
+      do k = 1, d
+         tc(k) = mod(r, ntiles(k))
+         r = r / ntiles(k)
+         ext(k) = min(tsize(k), dims(k) - tc(k)*tsize(k))
+      end do
+      inner(1) = 1
+      do k = 2, d
+         inner(k) = inner(k-1) * ext(k-1)
+      end do
+      q0 = mod(u-1, nchunk) * BLOCK_COLS
+      q = min(BLOCK_COLS, inner(d)*ext(d) - q0)
+      chunk_first = (q .gt. 0)
+      if (.not. chunk_first) return
+      r = q0
+      do k = 1, d
+         c(k) = tc(k)*tsize(k) + mod(r, ext(k))
+         r = r / ext(k)
+      end do
+      j0 = stencil_index(d, dims, tsize, c)
+    end function chunk_first
+
+    ! Advance c(:) to the next point of tile tc(:) in lexicographic order
+    subroutine next_point(tc, ext, c)
+      integer, dimension(d), intent(in) :: tc
+      integer, dimension(d), intent(in) :: ext
+      integer, dimension(d), intent(inout) :: c
+
+      integer :: k
+
+      do k = 1, d
+         c(k) = c(k) + 1
+         if (c(k) .lt. tc(k)*tsize(k) + ext(k)) return
+         c(k) = tc(k) * tsize(k)
+      end do
+    end subroutine next_point
+  end subroutine random_matrix_generate_stencil
+
+!
+! Initialize a streaming generator for the same random m x n band matrix as
+! random_matrix_generate64_band_kl_ku() with direct=.true. (the bw version
+! corresponds to kl = ku = bw, or kl = ku = m if bw <= 0). The columns are then
+! obtained in order, a chunk at a time, by calls to
+! random_matrix_band_stream_next(). The stream holds O(kl+ku) memory only.
+!
+! state is advanced on return exactly as by the one-shot routine, and may be
+! used for other purposes while the stream is in use.
+!
+! Diagonal dominance (see random_matrix_generate64_band_kl_ku()) is supported
+! for symmetric matrices only, as the diagonal entry of an unsymmetric matrix
+! depends on columns not yet generated. The absolute row sums of the lower
+! triangle are accumulated as columns are returned, so the values of every
+! column must be requested for the diagonal to be correct.
+!
+  subroutine random_matrix_band_stream_init(stream, state, matrix_type, m, n, &
+       nnz, kl, ku, flag, stat, nonsingular, sort, dominance)
+    implicit none
+    type(random_matrix_band_stream), intent(inout) :: stream ! stream to set up
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! ignored except for symmetric/unsymmetric
+      ! and positive-definite
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer, intent(out) :: flag ! return code
+    integer, optional, intent(out) :: stat ! allocate error code
+    logical, optional, intent(in) :: nonsingular ! force matrix to be explicitly
+      ! non-singular. If not present, treated as .false.
+    logical, optional, intent(in) :: sort ! sort entries in columns by row index.
+      ! If not present, treated as .false.
+    real(wp), optional, intent(in) :: dominance ! if present, make the matrix
+      ! strictly diagonally dominant with this factor (must be > 1)
+
+    integer :: maxw, st
+
+    ! Initialize return codes
+    flag = 0
+    if (present(stat)) stat = 0
+
+    call random_matrix_band_stream_free(stream)
+
+    ! Generate local logical flags
+    stream%lnonsingular = .false.
+    if (present(nonsingular)) stream%lnonsingular = nonsingular
+    stream%lsort = .false.
+    if (present(sort)) stream%lsort = sort
+
+    ! Check arguments
+    call band_dominance_args(matrix_type, m, n, stream%lnonsingular, &
+         stream%ldominant, stream%dominance, flag, dominance=dominance)
+    if (flag .ne. 0) return
+    call band_check_args(matrix_type, m, n, nnz, kl, ku, stream%lnonsingular, &
+         stream%lsymmetric, flag)
+    if (flag .ne. 0) return
+    if (stream%ldominant .and. (.not. stream%lsymmetric)) then
+       ! Unsymmetric diagonal dominance is not supported
+       flag = ERROR_ARG
+       return
+    end if
+
+    stream%m = m
+    stream%n = n
+    stream%kl = min(kl, m)
+    stream%ku = min(ku, n)
+    stream%nblk = (n-1) / BLOCK_COLS + 1
+    stream%nfree = nnz
+    if (stream%lnonsingular) stream%nfree = nnz - min(m,n)
+    stream%next = 1
+    stream%pending = -1
+
+    maxw = min(m, stream%kl+stream%ku+1)
+    if (stream%lsymmetric) maxw = min(m, stream%kl+1)
+    allocate(stream%mark(0:maxw-1), stat=st)
+    if ((st .eq. 0) .and. stream%ldominant) &
+         allocate(stream%rsum(0:stream%kl), stat=st)
+    if (st .ne. 0) then
+       flag = ERROR_ALLOCATION
+       if (present(stat)) stat = st
+       return
+    end if
+    stream%mark(:) = .false.
+    if (stream%ldominant) stream%rsum(:) = 0.0
+
+    ! All streams are split from the current state, which is then advanced
+    stream%base = state
+    call random_skip_ahead(state, 1_long)
+  end subroutine random_matrix_band_stream_init
+
+!
+! Generate the next chunk of columns of the matrix set up by
+! random_matrix_band_stream_init(). As many whole columns as fit in ptr(:)
+! and row(:) are returned: columns jfirst:jfirst+ncol-1 with local column
+! pointers ptr(1:ncol+1) into row(:) and val(:). ncol = 0 is returned once all
+! columns have been generated. If row(:) is too small for even the next
+! column, flag is set to ERROR_ARG; min(m,kl+ku+1) entries always suffice.
+!
+  subroutine random_matrix_band_stream_next(stream, maxcol, maxent, jfirst, &
+       ncol, ptr, row, flag, val)
+    implicit none
+    type(random_matrix_band_stream), intent(inout) :: stream ! stream to use
+    integer, intent(in) :: maxcol ! maximum number of columns to return
+    integer(long), intent(in) :: maxent ! size of row(:) and val(:)
+    integer, intent(out) :: jfirst ! first column returned
+    integer, intent(out) :: ncol ! number of columns returned
+    integer(long), dimension(maxcol+1), intent(out) :: ptr ! column pointers
+    integer, dimension(maxent), intent(out) :: row ! row indices
+    integer, intent(out) :: flag ! return code
+    real(wp), dimension(maxent), optional, intent(out) :: val ! numerical values
+
+    integer :: i, c, ntot, lo, hi
+    integer(long) :: jj
+    logical :: ldiag
+
+    flag = 0
+    jfirst = stream%next
+    ncol = 0
+    if ((maxcol .lt. 1) .or. (.not. allocated(stream%mark))) then
+       flag = ERROR_ARG
+       return
+    end if
+
+    ptr(1) = 1
+    jj = 1
+    do while ((stream%next .le. stream%n) .and. (ncol .lt. maxcol))
+       i = stream%next
+       if (stream%pending .lt. 0) then
+          ! Start a new block if required
+          if (mod(i-1, BLOCK_COLS) .eq. 0) call stream_start_block(stream, &
+               (i-1)/BLOCK_COLS + 1)
+          stream%pending = band_direct_count(stream%bstate,              &
+               col_free(stream%lsymmetric, stream%lnonsingular, stream%m, &
+               stream%n, i, stream%kl, stream%ku), stream%cells_left,     &
+               stream%ent_left)
+       end if
+       ! Check the column fits
+       ldiag = stream%lnonsingular .and. (i .le. min(stream%m,stream%n))
+       ntot = stream%pending
+       if (ldiag) ntot = ntot + 1
+       if (jj+ntot-1 .gt. maxent) exit
+       ! Generate it
+       c = 0
+       if (ntot .gt. 0) then
+          call band_window(stream%lsymmetric, stream%m, i, stream%kl, &
+               stream%ku, lo, hi)
+          if (present(val)) then
+             call band_direct_col(stream%bstate, ldiag, stream%lsort, i, lo, &
+                  hi, stream%pending, stream%mark, c, row(jj), val=val(jj))
+             ! Diagonally dominant and positive definite cases
+             if (stream%ldominant) call stream_set_dominant(stream, i, c, &
+                  row(jj:jj+c-1), val(jj:jj+c-1))
+          else
+             call band_direct_col(stream%bstate, ldiag, stream%lsort, i, lo, &
+                  hi, stream%pending, stream%mark, c, row(jj))
+          end if
+       end if
+       stream%pending = -1
+       stream%next = i + 1
+       jj = jj + c
+       ncol = ncol + 1
+       ptr(ncol+1) = jj
+    end do
+
+    ! Buffer too small for next column
+    if ((ncol .eq. 0) .and. (stream%next .le. stream%n)) flag = ERROR_ARG
+  end subroutine random_matrix_band_stream_next
+
+!
+! Free memory held by a streaming band generator
+!
+  subroutine random_matrix_band_stream_free(stream)
+    implicit none
+    type(random_matrix_band_stream), intent(inout) :: stream ! stream to free
+
+    integer :: st
+
+    deallocate(stream%mark, stat=st)
+    deallocate(stream%rsum, stat=st)
+  end subroutine random_matrix_band_stream_free
+
+!
+! Free memory held by a generator workspace
+!
+  subroutine random_matrix_workspace_free(work)
+    implicit none
+    type(random_matrix_workspace), intent(inout) :: work ! workspace to free
+
+    integer :: st
+
+    deallocate(work%cnt, stat=st)
+    deallocate(work%rperm, stat=st)
+    deallocate(work%cperm, stat=st)
+    deallocate(work%ptr64, stat=st)
+    deallocate(work%ccap, stat=st)
+    deallocate(work%cols, stat=st)
+    deallocate(work%rused, stat=st)
+    deallocate(work%mark, stat=st)
+    deallocate(work%blkcap, stat=st)
+    deallocate(work%blkcnt, stat=st)
+  end subroutine random_matrix_workspace_free
+
+!
+! Set the diagonal entry of column i of a symmetric stream as done by
+! band_set_dominant(), then add the column's off-diagonal entries to the
+! absolute row sums of the later rows.
+!
+  subroutine stream_set_dominant(stream, i, cnt, row, val)
+    implicit none
+    type(random_matrix_band_stream), intent(inout) :: stream ! stream to use
+    integer, intent(in) :: i ! column
+    integer, intent(in) :: cnt ! number of entries in column
+    integer, dimension(cnt), intent(in) :: row ! row indices
+    real(wp), dimension(cnt), intent(inout) :: val ! numerical values
+
+    integer :: k, kdiag, nring
+    real(wp) :: csum
+
+    nring = stream%kl + 1
+    kdiag = 0
+    csum = 0.0
+    do k = 1, cnt
+       if (row(k) .eq. i) then
+          kdiag = k
+       else
+          csum = csum + abs(val(k))
+       end if
+    end do
+    if (kdiag .gt. 0) val(kdiag) = &
+         dominant_diag(stream%dominance, csum + stream%rsum(mod(i,nring)))
+    ! Slot of row i is reused for row i+kl+1
+    stream%rsum(mod(i,nring)) = 0.0
+    do k = 1, cnt
+       if (k .eq. kdiag) cycle
+       stream%rsum(mod(row(k),nring)) = stream%rsum(mod(row(k),nring)) + &
+            abs(val(k))
+    end do
+  end subroutine stream_set_dominant
+
+!
+! Set up the stream for block blk, determining its number of entries by
+! descending the bisection tree of band_split_direct() from the root. Only
+! the nodes on the path to blk are evaluated.
+!
+  subroutine stream_start_block(stream, blk)
+    implicit none
+    type(random_matrix_band_stream), intent(inout) :: stream
+    integer, intent(in) :: blk ! block to start
+
+    integer :: b1, b2, bmid
+    integer(long) :: node, nent, nleft
+    type(random_state) :: nstate
+
+    b1 = 1
+    b2 = stream%nblk
+    node = 1
+    nent = stream%nfree
+    do while (b1 .lt. b2)
+       bmid = (b1+b2) / 2
+       call random_split(stream%base, -node, nstate)
+       nleft = random_hypergeometric(nstate, block_free(b1, b2), &
+            block_free(b1, bmid), nent)
+       if (blk .le. bmid) then
+          b2 = bmid
+          node = 2*node
+          nent = nleft
+       else
+          b1 = bmid + 1
+          node = 2*node + 1
+          nent = nent - nleft
+       end if
+    end do
+
+    call random_split(stream%base, int(blk,long), stream%bstate)
+    stream%cells_left = block_free(blk, blk)
+    stream%ent_left = nent
+
+  contains
+    ! Free positions in blocks b1:b2
+    integer(long) function block_free(b1, b2)
+      integer, intent(in) :: b1, b2
+      block_free = band_range_free(stream%lsymmetric, stream%lnonsingular, &
+           stream%m, stream%n, stream%kl, stream%ku, (b1-1)*BLOCK_COLS+1, &
+           min(stream%n, b2*BLOCK_COLS))
+    end function block_free
+  end subroutine stream_start_block
+
+!
+! Generate the pattern of a random m x n band matrix of real type matrix_type
+! with nnz non-zeroes, lower bandwidth kl and upper bandwidth ku, as
+! random_matrix_generate64_band_kl_ku() does when called without val. Also
+! returns the symmetry and dominance settings for the values. flag is set to
+! a non-zero error code if any arguments are bad, and st is set on
+! allocation failure.
+!
+  subroutine band_generate_pattern(state, matrix_type, m, n, nnz, kl, ku, &
+       ptr, row, work, flag, st, lsymmetric, ldominant, ldom, nonsingular, &
+       sort, direct, dominance)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! real matrix type
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    type(random_matrix_workspace), intent(inout) :: work ! workspace
+    integer, intent(out) :: flag ! return code
+    integer, intent(out) :: st ! allocate error code
+    logical, intent(out) :: lsymmetric ! .true. if only lower triangle is used
+    logical, intent(out) :: ldominant ! .true. if diagonal is to be dominant
+    real(wp), intent(out) :: ldom ! dominance factor
+    logical, optional, intent(in) :: nonsingular ! force diagonal to be present
+    logical, optional, intent(in) :: sort ! sort entries in columns
+    logical, optional, intent(in) :: direct ! use rejection-free sampling
+    real(wp), optional, intent(in) :: dominance ! user-supplied factor
+
+    logical :: lnonsingular, lsort, ldirect
+
+    st = 0
+
+    ! Generate local logical flags
+    lnonsingular = .false.
+    if (present(nonsingular)) lnonsingular = nonsingular
+    lsort = .false.
+    if (present(sort)) lsort = sort
+    ldirect = .false.
+    if (present(direct)) ldirect = direct
+
+    ! Check arguments
+    call band_dominance_args(matrix_type, m, n, lnonsingular, ldominant, &
+         ldom, flag, dominance=dominance)
+    if (flag .ne. 0) return
+    call band_check_args(matrix_type, m, n, nnz, kl, ku, lnonsingular, &
+         lsymmetric, flag)
+    if (flag .ne. 0) return
+
+    ! Generate pattern, sorted if required
+    if (ldirect) then
+       call grow_int(work%cnt, n, st)
+       if (st .ne. 0) goto 100
+       call band_generate_direct(state, lsymmetric, lnonsingular, lsort, m, &
+            n, nnz, min(kl,m), min(ku,n), work%cnt, ptr, row, st)
+    else
+       call band_pattern_rejection(state, lsymmetric, lnonsingular, lsort, &
+            m, n, nnz, min(kl,m), min(ku,n), ptr, row, work, st)
+    end if
+    if (st .ne. 0) goto 100
+    return
+
+100 continue
+    ! Memory allocation failure
+    flag = ERROR_ALLOCATION
+  end subroutine band_generate_pattern
+
+!
+! Map a complex matrix type to the real type with the same structure, setting
+! lhermitian if the diagonal must be real. flag is set to ERROR_MATRIX_TYPE
+! if matrix_type is not a complex type.
+!
+  subroutine complex_band_type(matrix_type, rtype, lhermitian, flag)
+    implicit none
+    integer, intent(in) :: matrix_type ! complex matrix type
+    integer, intent(out) :: rtype ! real matrix type
+    logical, intent(out) :: lhermitian ! .true. if matrix is Hermitian
+    integer, intent(out) :: flag ! return code
+
+    flag = 0
+    lhermitian = .false.
+    select case (matrix_type)
+    case(SPRAL_MATRIX_UNSPECIFIED)
+       rtype = SPRAL_MATRIX_UNSPECIFIED
+    case(SPRAL_MATRIX_CPLX_RECT)
+       rtype = SPRAL_MATRIX_REAL_RECT
+    case(SPRAL_MATRIX_CPLX_UNSYM)
+       rtype = SPRAL_MATRIX_REAL_UNSYM
+    case(SPRAL_MATRIX_CPLX_HERM_PSDEF)
+       rtype = SPRAL_MATRIX_REAL_SYM_PSDEF
+       lhermitian = .true.
+    case(SPRAL_MATRIX_CPLX_HERM_INDEF)
+       rtype = SPRAL_MATRIX_REAL_SYM_INDEF
+       lhermitian = .true.
+    case(SPRAL_MATRIX_CPLX_SYM)
+       rtype = SPRAL_MATRIX_REAL_SYM_INDEF
+    case(SPRAL_MATRIX_CPLX_SKEW)
+       rtype = SPRAL_MATRIX_REAL_SKEW
+    case default
+       ! REAL or unknown matrix type
+       rtype = matrix_type
+       flag = ERROR_MATRIX_TYPE
+    end select
+  end subroutine complex_band_type
+
+!
+! Generate a random m x n band matrix of complex type matrix_type, returning
+! the real and imaginary parts of its values in re and im. The pattern is
+! generated by band_generate_pattern() for the real matrix type of the same
+! structure, and the real and imaginary parts of each entry are drawn in turn
+! in chunks of VALUE_CHUNK entries. The diagonal of a Hermitian matrix is
+! real, and a dominant diagonal is set by modulus. Other arguments are as for
+! band_generate_pattern().
+!
+  subroutine band_generate_complex(state, matrix_type, m, n, nnz, kl, ku, &
+       ptr, row, work, flag, st, re, im, nonsingular, sort, direct, dominance)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! complex matrix type
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    type(random_matrix_workspace), intent(inout) :: work ! workspace
+    integer, intent(out) :: flag ! return code
+    integer, intent(out) :: st ! allocate error code
+    real(wp), dimension(nnz), intent(out) :: re ! real parts of values
+    real(wp), dimension(nnz), intent(out) :: im ! imaginary parts of values
+    logical, optional, intent(in) :: nonsingular ! force diagonal to be present
+    logical, optional, intent(in) :: sort ! sort entries in columns
+    logical, optional, intent(in) :: direct ! use rejection-free sampling
+    real(wp), optional, intent(in) :: dominance ! user-supplied factor
+
+    integer :: j, k, cnt, rtype
+    integer(long) :: jj, nent, c, first
+    logical :: lsymmetric, ldominant, lhermitian
+    real(wp) :: ldom
+    real(wp), dimension(:), allocatable :: aval
+    real(wp), dimension(2*VALUE_CHUNK) :: buf
+    type(random_state) :: base, cstate
+
+    st = 0
+
+    ! Determine the real matrix type with the same structure
+    call complex_band_type(matrix_type, rtype, lhermitian, flag)
+    if (flag .ne. 0) return
+
+    ! Generate pattern
+    call band_generate_pattern(state, rtype, m, n, nnz, kl, ku, ptr, row, &
+         work, flag, st, lsymmetric, ldominant, ldom,                      &
+         nonsingular=nonsingular, sort=sort, direct=direct,                &
+         dominance=dominance)
+    if (flag .ne. 0) return
+    nent = ptr(n+1) - 1
+
+    ! Determine values in chunks of VALUE_CHUNK entries, each from its own
+    ! stream split from state, with the real and imaginary parts of each entry
+    ! drawn in turn
+    base = state
+    call random_skip_ahead(state, 1_long)
+    !$omp parallel do default(shared) private(c, cstate, first, cnt, k, buf) &
+    !$omp    schedule(static)
+    do c = 1, (nent-1)/VALUE_CHUNK + 1
+       call random_split(base, c, cstate)
+       first = (c-1)*VALUE_CHUNK + 1
+       cnt = int(min(int(VALUE_CHUNK,long), nent-first+1))
+       call random_real_array(cstate, buf(1:2*cnt))
+       do k = 1, cnt
+          re(first+k-1) = buf(2*k-1)
+          im(first+k-1) = buf(2*k)
+       end do
+    end do
+    !$omp end parallel do
+    if (lhermitian) then
+       do j = 1, n
+          do jj = ptr(j), ptr(j+1)-1
+             if (row(jj) .eq. j) im(jj) = 0.0
+          end do
+       end do
+    end if
+
+    ! Diagonally dominant and positive definite cases, by modulus
+    if (ldominant) then
+       allocate(aval(nent), stat=st)
+       if (st .ne. 0) goto 100
+       aval(:) = abs(cmplx(re(1:nent), im(1:nent), kind=wp))
+       call band_set_dominant(lsymmetric, n, ptr, row, aval, ldom, st)
+       if (st .ne. 0) goto 100
+       do j = 1, n
+          do jj = ptr(j), ptr(j+1)-1
+             if (row(jj) .eq. j) then
+                re(jj) = aval(jj)
+                im(jj) = 0.0
+             end if
+          end do
+       end do
+    end if
+    return
+
+100 continue
+    ! Memory allocation failure
+    flag = ERROR_ALLOCATION
+  end subroutine band_generate_complex
+
+!
+! Generate a random m x n band matrix with nnz non-zeroes, lower bandwidth kl
+! and upper bandwidth ku, with values in whichever of sval (single precision
+! real), cval (single precision complex) and zval (double precision complex)
+! is present. For sval the pattern is that of band_generate_pattern() and the
+! values are drawn in bulk, in chunks of VALUE_CHUNK entries, before any
+! dominant diagonal is set in working precision. For cval and zval the matrix
+! is generated by band_generate_complex() and its values converted. Other
+! arguments are as for band_generate_pattern().
+!
+  subroutine band_generate_values(state, matrix_type, m, n, nnz, kl, ku, ptr, &
+       row, work, flag, st, sval, cval, zval, nonsingular, sort, direct, &
+       dominance)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    integer, intent(in) :: matrix_type ! real type for sval, else complex type
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    type(random_matrix_workspace), intent(inout) :: work ! workspace
+    integer, intent(out) :: flag ! return code
+    integer, intent(out) :: st ! allocate error code
+    real(sp), dimension(nnz), optional, intent(out) :: sval ! single
+      ! precision values
+    complex(sp), dimension(nnz), optional, intent(out) :: cval ! single
+      ! precision complex values
+    complex(wp), dimension(nnz), optional, intent(out) :: zval ! double
+      ! precision complex values
+    logical, optional, intent(in) :: nonsingular ! force diagonal to be present
+    logical, optional, intent(in) :: sort ! sort entries in columns
+    logical, optional, intent(in) :: direct ! use rejection-free sampling
+    real(wp), optional, intent(in) :: dominance ! user-supplied factor
+
+    integer :: j, cnt
+    integer(long) :: jj, nent, c, first
+    logical :: lsymmetric, ldominant
+    real(wp) :: ldom
+    real(wp), dimension(:), allocatable :: aval, re, im
+    real(wp), dimension(VALUE_CHUNK) :: buf
+    type(random_state) :: base, cstate
+
+    st = 0
+
+    if (.not. present(sval)) then
+       ! Complex values, generated in working precision and then converted
+       allocate(re(nnz), im(nnz), stat=st)
+       if (st .ne. 0) goto 100
+       call band_generate_complex(state, matrix_type, m, n, nnz, kl, ku, ptr, &
+            row, work, flag, st, re, im, nonsingular=nonsingular, sort=sort, &
+            direct=direct, dominance=dominance)
+       if (flag .ne. 0) return
+       nent = ptr(n+1) - 1
+       if (present(cval)) &
+            cval(1:nent) = cmplx(re(1:nent), im(1:nent), kind=sp)
+       if (present(zval)) &
+            zval(1:nent) = cmplx(re(1:nent), im(1:nent), kind=wp)
+       return
+    end if
+
+    ! Generate pattern
+    call band_generate_pattern(state, matrix_type, m, n, nnz, kl, ku, ptr, &
+         row, work, flag, st, lsymmetric, ldominant, ldom,                  &
+         nonsingular=nonsingular, sort=sort, direct=direct,                 &
+         dominance=dominance)
+    if (flag .ne. 0) return
+    nent = ptr(n+1) - 1
+
+    ! Determine values in chunks of VALUE_CHUNK entries, each from its own
+    ! stream split from state, so they do not depend on the number of threads
+    base = state
+    call random_skip_ahead(state, 1_long)
+    !$omp parallel do default(shared) private(c, cstate, first, cnt, buf) &
+    !$omp    schedule(static)
+    do c = 1, (nent-1)/VALUE_CHUNK + 1
+       call random_split(base, c, cstate)
+       first = (c-1)*VALUE_CHUNK + 1
+       cnt = int(min(int(VALUE_CHUNK,long), nent-first+1))
+       call random_real_array(cstate, buf(1:cnt))
+       sval(first:first+cnt-1) = real(buf(1:cnt), sp)
+    end do
+    !$omp end parallel do
+
+    ! Diagonally dominant and positive definite cases
+    if (ldominant) then
+       allocate(aval(nent), stat=st)
+       if (st .ne. 0) goto 100
+       aval(:) = real(sval(1:nent), wp)
+       call band_set_dominant(lsymmetric, n, ptr, row, aval, ldom, st)
+       if (st .ne. 0) goto 100
+       do j = 1, n
+          do jj = ptr(j), ptr(j+1)-1
+             if (row(jj) .eq. j) sval(jj) = real(aval(jj), sp)
+          end do
+       end do
+    end if
+    return
+
+100 continue
+    ! Memory allocation failure
+    flag = ERROR_ALLOCATION
+  end subroutine band_generate_values
+
+!
+! Check the arguments common to all band generators, setting flag to a
+! non-zero error code if any are bad, and lsymmetric according to matrix_type.
+!
+  subroutine band_check_args(matrix_type, m, n, nnz, kl, ku, lnonsingular, &
+       lsymmetric, flag)
+    implicit none
+    integer, intent(in) :: matrix_type ! matrix type
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    logical, intent(in) :: lnonsingular ! force diagonal to be present
+    logical, intent(out) :: lsymmetric ! .true. if only lower triangle is used
+    integer, intent(out) :: flag ! return code
+
+    flag = 0
+    lsymmetric = .false.
+
+    ! Handle matrix type
+    select case (matrix_type)
+    case(SPRAL_MATRIX_UNSPECIFIED, SPRAL_MATRIX_REAL_RECT)
+       lsymmetric = .false.
+    case(SPRAL_MATRIX_REAL_UNSYM)
+       lsymmetric = .false.
+       if (m .ne. n) then
+          ! Matrix is not square - did user mean SPRAL_MATRIX_REAL_RECT?
+          flag = ERROR_NONSQUARE
+          return
+       end if
+    case(SPRAL_MATRIX_REAL_SYM_PSDEF, SPRAL_MATRIX_REAL_SYM_INDEF, &
+         SPRAL_MATRIX_REAL_SKEW)
+       lsymmetric = .true.
+       if (m .ne. n) then
+          ! Matrix is not square - did user mean SPRAL_MATRIX_REAL_RECT?
+          flag = ERROR_NONSQUARE
+          return
+       end if
+    case default
+       ! COMPLEX or unknown matrix type
+       flag = ERROR_MATRIX_TYPE
+       return
+    end select
+
+    ! Check args
+    if ((m .lt. 1) .or. (n .lt. 1) .or. (nnz .lt. 1)) then
+       ! Args out of range
+       flag = ERROR_ARG
+       return
+    end if
+    if ((lsymmetric .and. (n*(n+1_long)/2 .lt. nnz)) .or. &
+         ((.not. lsymmetric) .and. (m*(n+0_long) .lt. nnz))) then
+       ! Too many non-zeroes for matrix
+       flag = ERROR_ARG
+       return
+    end if
+    if (lnonsingular .and. (nnz .lt. min(m,n))) then
+       ! Requested a non-singular matrix, but not enough non-zeroes
+       flag = ERROR_SINGULAR
+       return
+    end if
+
+    if ((kl .lt. 0) .or. (ku .lt. 0) .or. (lsymmetric .and. (kl .ne. ku))) then
+       ! Bad bandwidths
+       flag = ERROR_ARG
+       return
+    end if
+    ! Bandwidths beyond the matrix cover it entirely
+    if (band_capacity(lsymmetric, m, n, min(kl,m), min(ku,n)) .lt. nnz) then
+       ! Too many non-zeroes for band
+       flag = ERROR_ARG
+       return
+    end if
+  end subroutine band_check_args
+
+!
+! Handle the dominance and cond arguments common to the band generators.
+! ldominant is set if the diagonal is to be made dominant, which is always the
+! case for positive-definite matrices and conditioned matrices, and ldom to
+! the factor to use. The diagonal is then forced to be present if dominance or
+! cond is given. A positive-definite matrix without them only has its diagonal
+! forced if lnonsingular is already set, so it is not guaranteed to be
+! definite (or non-singular) otherwise. flag is set to
+! ERROR_ARG if the factor is not greater than one, the condition number range
+! is bad, both are given, or the matrix cannot be diagonally dominant.
+!
+  subroutine band_dominance_args(matrix_type, m, n, lnonsingular, ldominant, &
+       ldom, flag, dominance, cond)
+    implicit none
+    integer, intent(in) :: matrix_type ! matrix type
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    logical, intent(inout) :: lnonsingular ! force diagonal to be present
+    logical, intent(out) :: ldominant ! .true. if diagonal is to be dominant
+    real(wp), intent(out) :: ldom ! dominance factor
+    integer, intent(out) :: flag ! return code
+    real(wp), optional, intent(in) :: dominance ! user-supplied factor
+    real(wp), dimension(2), optional, intent(in) :: cond ! user-supplied
+      ! condition number range
+
+    flag = 0
+    ldominant = present(dominance) .or. present(cond) .or. &
+         (matrix_type .eq. SPRAL_MATRIX_REAL_SYM_PSDEF)
+    ldom = DEFAULT_DOMINANCE
+    if (present(dominance)) ldom = dominance
+    if (.not. ldominant) return
+
+    if ((ldom .le. 1.0) .or. (m .ne. n) .or. &
+         (matrix_type .eq. SPRAL_MATRIX_REAL_SKEW)) then
+       ! Factor too small, or matrix without a (non-zero) diagonal
+       flag = ERROR_ARG
+       return
+    end if
+    if (present(cond)) then
+       if (present(dominance) .or. (cond(1) .lt. 1.0) .or. &
+            (cond(2) .lt. cond(1)) .or.                     &
+            ((n .eq. 1) .and. (cond(1) .gt. 1.0))) then
+          ! Conflicting arguments or unattainable range
+          flag = ERROR_ARG
+          return
+       end if
+    end if
+    ! A positive-definite matrix only has its diagonal forced if dominance or
+    ! cond is given (or by nonsingular), so that calls with nnz < n still
+    ! succeed. Otherwise only the diagonal entries present are made dominant.
+    if (present(dominance) .or. present(cond)) lnonsingular = .true.
+  end subroutine band_dominance_args
+
+!
+! Returns the diagonal entry giving dominance factor dom over off-diagonal
+! absolute sum offsum. A row and column with no off-diagonal entries get dom.
+!
+  real(wp) function dominant_diag(dom, offsum)
+    implicit none
+    real(wp), intent(in) :: dom ! dominance factor
+    real(wp), intent(in) :: offsum ! absolute sum of off-diagonal entries
+
+    dominant_diag = dom * offsum
+    if (offsum .le. 0.0) dominant_diag = dom
+  end function dominant_diag
+
+!
+! Set the diagonal of an n x n matrix in CSC format to be strictly dominant
+! by rows and columns with factor dom. The absolute row and column sums are
+! found in a single pass over the entries. In the symmetric case (lower
+! triangle only) these are the sums of the whole symmetric matrix, and all of
+! row j is known on reaching column j, so the diagonal is set in the same
+! pass. Columns without a diagonal entry are left unchanged. If rhs is
+! present, A*x is added to it during the same pass.
+!
+  subroutine band_set_dominant(lsymmetric, n, ptr, row, val, dom, st, x, rhs)
+    implicit none
+    logical, intent(in) :: lsymmetric ! .true. if only lower triangle is used
+    integer, intent(in) :: n ! number of rows and columns
+    integer(long), dimension(n+1), intent(in) :: ptr ! column pointers
+    integer, dimension(ptr(n+1)-1), intent(in) :: row ! row indices
+    real(wp), dimension(ptr(n+1)-1), intent(inout) :: val ! numerical values
+    real(wp), intent(in) :: dom ! dominance factor
+    integer, intent(out) :: st ! allocate error code
+    real(wp), dimension(n), optional, intent(in) :: x ! if present, add A*x
+    real(wp), dimension(n), optional, intent(inout) :: rhs ! to rhs
+
+    integer :: i, j
+    integer(long) :: jj
+    integer(long), dimension(:), allocatable :: dpos
+    real(wp), dimension(:), allocatable :: rsum, csum
+
+    allocate(dpos(n), rsum(n), csum(n), stat=st)
+    if (st .ne. 0) return
+
+    rsum(:) = 0.0
+    do j = 1, n
+       dpos(j) = 0
+       csum(j) = 0.0
+       do jj = ptr(j), ptr(j+1)-1
+          i = row(jj)
+          if (i .eq. j) then
+             dpos(j) = jj
+             cycle
+          end if
+          csum(j) = csum(j) + abs(val(jj))
+          rsum(i) = rsum(i) + abs(val(jj))
+          if (present(rhs)) then
+             rhs(i) = rhs(i) + val(jj)*x(j)
+             if (lsymmetric) rhs(j) = rhs(j) + val(jj)*x(i)
+          end if
+       end do
+       if (lsymmetric .and. (dpos(j) .gt. 0)) then
+          val(dpos(j)) = dominant_diag(dom, csum(j) + rsum(j))
+          if (present(rhs)) rhs(j) = rhs(j) + val(dpos(j))*x(j)
+       end if
+    end do
+    if (lsymmetric) return
+
+    ! Unsymmetric case: row sums are only complete at the end
+    do j = 1, n
+       if (dpos(j) .gt. 0) then
+          val(dpos(j)) = dominant_diag(dom, max(rsum(j), csum(j)))
+          if (present(rhs)) rhs(j) = rhs(j) + val(dpos(j))*x(j)
+       end if
+    end do
+  end subroutine band_set_dominant
+
+!
+! Add the contribution of column j of a sparse matrix to rhs = A*x. In the
+! symmetric case the column holds entries of the lower triangle only, and the
+! transposed entries (negated if skew) are also added.
+!
+  subroutine csc_col_matvec(lsymmetric, lskew, j, cnt, row, val, x, rhs)
+    implicit none
+    logical, intent(in) :: lsymmetric ! .true. if only lower triangle is used
+    logical, intent(in) :: lskew ! .true. if matrix is skew symmetric
+    integer, intent(in) :: j ! column
+    integer, intent(in) :: cnt ! number of entries in column
+    integer, dimension(cnt), intent(in) :: row ! row indices of column
+    real(wp), dimension(cnt), intent(in) :: val ! values of column
+    real(wp), dimension(*), intent(in) :: x ! vector to multiply
+    real(wp), dimension(*), intent(inout) :: rhs ! result to update
+
+    integer :: k, i
+    real(wp) :: xj, t
+
+    xj = x(j)
+    t = 0.0
+    do k = 1, cnt
+       i = row(k)
+       rhs(i) = rhs(i) + val(k)*xj
+       if (lsymmetric .and. (i .ne. j)) t = t + val(k)*x(i)
+    end do
+    if (lskew) then
+       rhs(j) = rhs(j) - t
+    else
+       rhs(j) = rhs(j) + t
+    end if
+  end subroutine csc_col_matvec
+
+!
+! Set the values of an n x n matrix in CSC format, which must have all its
+! diagonal entries, so that its 2-norm condition number lies in
+! [cond(1),cond(2)]. The off-diagonal entries are scaled so that no absolute
+! row or column sum exceeds eps, and the diagonal entries are given
+! magnitudes log-uniformly distributed in [1,k], with both extremes attained,
+! where k = cond(1)*(1+eps). As sigma_max >= k and sigma_min <= 1+eps, and
+! by the bounds below,
+!    cond(1) <= k/(1+eps) <= cond <= (k+eps)/(1-eps) <= cond(2)
+! for eps = min(1/2, (cond(2)-cond(1))/(cond(2)+cond(1)+1)). If lindef is
+! .true., the diagonal entries are given random signs.
+!
+! On return cond_est holds cheap lower and upper bounds on the condition
+! number achieved: the ratio of the largest to the smallest column 2-norm,
+! and sqrt(||A||_1*||A||_inf) / min_i(|a_ii|-(r_i+c_i)/2), where r_i and c_i
+! are the absolute off-diagonal sums of row and column i (Johnson's bound on
+! the smallest singular value).
+!
+! If rhs is present, A*x is added to it as the final values are set.
+!
+  subroutine band_set_conditioned(state, lsymmetric, lindef, n, ptr, row, &
+       val, cond, cond_est, st, x, rhs)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    logical, intent(in) :: lsymmetric ! .true. if only lower triangle is used
+    logical, intent(in) :: lindef ! give diagonal entries random signs
+    integer, intent(in) :: n ! number of rows and columns
+    integer(long), dimension(n+1), intent(in) :: ptr ! column pointers
+    integer, dimension(ptr(n+1)-1), intent(in) :: row ! row indices
+    real(wp), dimension(ptr(n+1)-1), intent(inout) :: val ! numerical values
+    real(wp), dimension(2), intent(in) :: cond ! target condition number range
+    real(wp), dimension(2), intent(out) :: cond_est ! bounds on condition number
+    integer, intent(out) :: st ! allocate error code
+    real(wp), dimension(n), optional, intent(in) :: x ! if present, add A*x
+    real(wp), dimension(n), optional, intent(inout) :: rhs ! to rhs
+
+    integer :: i, j
+    integer(long) :: jj
+    real(wp) :: eps, tau, k, g, umin, umax
+    real(wp), dimension(:), allocatable :: rsum, csum, diag
+
+    allocate(rsum(n), csum(n), diag(n), stat=st)
+    if (st .ne. 0) return
+
+    ! Find absolute off-diagonal row and column sums
+    rsum(:) = 0.0
+    csum(:) = 0.0
+    do j = 1, n
+       do jj = ptr(j), ptr(j+1)-1
+          i = row(jj)
+          if (i .eq. j) cycle
+          csum(j) = csum(j) + abs(val(jj))
+          rsum(i) = rsum(i) + abs(val(jj))
+       end do
+    end do
+    if (lsymmetric) then
+       csum(:) = csum(:) + rsum(:)
+       rsum(:) = csum(:)
+    end if
+
+    ! Scale factor for off-diagonal entries
+    eps = min(0.5_wp, (cond(2)-cond(1)) / (cond(2)+cond(1)+1))
+    tau = max(maxval(rsum), maxval(csum))
+    if (tau .gt. 0.0) tau = eps / tau
+    rsum(:) = tau * rsum(:)
+    csum(:) = tau * csum(:)
+
+    ! Log-uniform diagonal magnitudes in [1,k], signs from the same draws
+    k = cond(1) * (1+eps)
+    call random_real_array(state, diag)
+    umin = minval(abs(diag))
+    umax = maxval(abs(diag))
+    do j = 1, n
+       g = 1.0
+       if (umax .gt. umin) g = k ** ((abs(diag(j))-umin) / (umax-umin))
+       if (lindef) then
+          diag(j) = sign(g, diag(j))
+       else
+          diag(j) = g
+       end if
+    end do
+
+    ! Set values
+    do j = 1, n
+       do jj = ptr(j), ptr(j+1)-1
+          if (row(jj) .eq. j) then
+             val(jj) = diag(j)
+          else
+             val(jj) = tau * val(jj)
+          end if
+       end do
+       if (present(rhs)) &
+            call csc_col_matvec(lsymmetric, .false., j, int(ptr(j+1)-ptr(j)), &
+            row(ptr(j):ptr(j+1)-1), val(ptr(j):ptr(j+1)-1), x, rhs)
+    end do
+
+    ! Upper bound on condition number
+    cond_est(2) = sqrt(maxval(abs(diag)+csum) * maxval(abs(diag)+rsum)) / &
+         minval(abs(diag) - 0.5*(rsum+csum))
+
+    ! Lower bound from squared column 2-norms
+    csum(:) = 0.0
+    do j = 1, n
+       do jj = ptr(j), ptr(j+1)-1
+          i = row(jj)
+          csum(j) = csum(j) + val(jj)**2
+          if (lsymmetric .and. (i .ne. j)) csum(i) = csum(i) + val(jj)**2
+       end do
+    end do
+    cond_est(1) = sqrt(maxval(csum) / minval(csum))
+  end subroutine band_set_conditioned
+
+!
+! As band_set_dominant(), but for an n x n matrix in LAPACK band storage with
+! the diagonal in row off of ab (see band_generate_direct_lapack()). Row sums
+! are read directly from the band, so no workspace is needed and the columns
+! are independent.
+!
+  subroutine band_set_dominant_lapack(lsymmetric, n, kl, ku, ab, ldab, off, &
+       dom, lnonsingular)
+    implicit none
+    logical, intent(in) :: lsymmetric ! .true. if only lower triangle is used
+    integer, intent(in) :: n ! number of rows and columns
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth (ignored if symmetric)
+    integer, intent(in) :: ldab ! leading dimension of ab
+    real(wp), dimension(ldab, n), intent(inout) :: ab ! band storage
+    integer, intent(in) :: off ! row of ab holding the diagonal
+    real(wp), intent(in) :: dom ! dominance factor
+    logical, intent(in) :: lnonsingular ! if .false., only diagonal entries
+      ! present (non-zero) are set
+
+    integer :: i, j
+    real(wp) :: csum, rsum
+
+    !$omp parallel do default(shared) private(i, j, csum, rsum) &
+    !$omp    schedule(static)
+    do j = 1, n
+       if ((.not. lnonsingular) .and. (ab(off, j) .eq. 0.0)) cycle
+       csum = 0.0
+       rsum = 0.0
+       if (lsymmetric) then
+          do i = j+1, min(n, j+kl)
+             csum = csum + abs(ab(1+i-j, j))
+          end do
+          do i = max(1, j-kl), j-1
+             rsum = rsum + abs(ab(1+j-i, i))
+          end do
+          ab(1, j) = dominant_diag(dom, csum + rsum)
+       else
+          do i = max(1, j-ku), min(n, j+kl)
+             if (i .ne. j) csum = csum + abs(ab(off+i-j, j))
+          end do
+          do i = max(1, j-kl), min(n, j+ku)
+             if (i .ne. j) rsum = rsum + abs(ab(off+j-i, i))
+          end do
+          ab(off, j) = dominant_diag(dom, max(rsum, csum))
+       end if
+    end do
+    !$omp end parallel do
+  end subroutine band_set_dominant_lapack
+!
+! Returns the rows [lo,hi] in the band of column j. If hi < lo the column is
+! empty. In the symmetric case only the lower triangle is considered.
+!
+  subroutine band_window(lsymmetric, m, j, kl, ku, lo, hi)
+    implicit none
+    logical, intent(in) :: lsymmetric ! .true. if only lower triangle is used
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: j ! column
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth (ignored if symmetric)
+    integer, intent(out) :: lo ! first row in band
+    integer, intent(out) :: hi ! last row in band
+
+    if (lsymmetric) then
+       lo = j
+    else
+       lo = int(max(1_long, j-int(ku,long)))
+    end if
+    hi = int(min(int(m,long), j+int(kl,long)))
+  end subroutine band_window
+
+!
+! Returns the number of positions in the band of an m x n matrix
+!
+  integer(long) function band_capacity(lsymmetric, m, n, kl, ku)
+    implicit none
+    logical, intent(in) :: lsymmetric ! .true. if only lower triangle is used
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth (ignored if symmetric)
+
+    band_capacity = band_range_capacity(lsymmetric, m, kl, ku, 1, n)
+  end function band_capacity
+
+!
+! Returns the number of positions in the band in columns j1:j2, in O(1) time.
+! The capacity of a column is piecewise linear in the column index, changing
+! slope only where the band meets the first or last row, so the sum is
+! evaluated as a handful of arithmetic series.
+!
+  integer(long) function band_range_capacity(lsymmetric, m, kl, ku, j1, j2)
+    implicit none
+    logical, intent(in) :: lsymmetric ! .true. if only lower triangle is used
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth (ignored if symmetric)
+    integer, intent(in) :: j1 ! first column
+    integer, intent(in) :: j2 ! last column
+
+    integer :: k, lku
+    integer(long) :: x, y, c, f0, slope
+    integer(long), dimension(3) :: brk
+
+    band_range_capacity = 0
+    if (j2 .lt. j1) return
+
+    ! Columns at which a new linear piece starts. The symmetric case is the
+    ! unsymmetric case with ku = 0.
+    lku = ku
+    if (lsymmetric) lku = 0
+    brk(1) = m - int(kl,long) + 1 ! last row reached
+    brk(2) = lku + 2_long ! first row left
+    brk(3) = m + int(lku,long) + 1 ! band empty
+
+    x = j1
+    do while (x .le. j2)
+       ! Find end of the linear piece containing x
+       y = j2
+       do k = 1, 3
+          if (brk(k) .gt. x) y = min(y, brk(k)-1)
+       end do
+       c = y - x + 1
+       f0 = band_col_capacity(lsymmetric, m, int(x), kl, ku)
+       slope = 0
+       if (c .gt. 1) slope = band_col_capacity(lsymmetric, m, int(x)+1, kl, &
+            ku) - f0
+       band_range_capacity = band_range_capacity + c*f0 + slope*(c*(c-1)/2)
+       x = y + 1
+    end do
+  end function band_range_capacity
+
+!
+! Returns the number of free positions (i.e. excluding any forced diagonal) in
+! the band in columns j1:j2
+!
+  integer(long) function band_range_free(lsymmetric, lnonsingular, m, n, kl, &
+       ku, j1, j2)
+    implicit none
+    logical, intent(in) :: lsymmetric ! .true. if only lower triangle is used
+    logical, intent(in) :: lnonsingular ! .true. if diagonal is forced
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth (ignored if symmetric)
+    integer, intent(in) :: j1 ! first column
+    integer, intent(in) :: j2 ! last column
+
+    band_range_free = band_range_capacity(lsymmetric, m, kl, ku, j1, j2)
+    if (lnonsingular) band_range_free = band_range_free - &
+         max(0, min(j2, m, n) - j1 + 1)
+  end function band_range_free
+
+!
+! Generate the pattern of a band matrix by rejection sampling.
+! Entries are first assigned to columns uniformly at random, redrawing if the
+! chosen column is already full. Rows are then drawn uniformly from the band,
+! redrawing any that are already present in the column. If required, each
+! column is then sorted in place, by a scan of its window of the band if it is
+! at least a quarter full, and by heapsort otherwise.
+!
+! Beyond half fill, the redraws would dominate. If more than half of the free
+! positions of the band are to be filled, the holes are instead assigned to
+! columns in the same way, each column starting full. Likewise, if more than
+! half of the free positions of a column are to be filled, its holes are drawn
+! instead, and its entries are then found in order by a scan of its window.
+! At most min(nnz, capacity-nnz) positions are drawn in each case, and the
+! expected number of redraws per draw is below one.
+!
+! Any forced diagonal is the maximum transversal given by identity row and
+! column permutations, consistent with random_matrix_generate64().
+!
+  subroutine band_pattern_rejection(state, lsymmetric, lnonsingular, lsort, &
+       m, n, nnz, kl, ku, ptr, row, work, st)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    logical, intent(in) :: lsymmetric ! generate lower triangle only
+    logical, intent(in) :: lnonsingular ! force diagonal to be present
+    logical, intent(in) :: lsort ! sort entries within columns
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    type(random_matrix_workspace), intent(inout) :: work ! workspace
+    integer, intent(out) :: st ! allocate error code
+
+    integer :: i, j, k, minidx, maxidx, ncol, nforced, nfree, nhole
+    integer(long) :: ii, jj, nent, ncells
+
+    call workspace_reserve(work, m, n, 0, st)
+    if (st .ne. 0) return
+
+    ! In both the symmetric and unsymmetric case, structural non-singularity
+    ! is guaranteed by adding the diagonal. Find the free positions of each
+    ! column, excluding any forced diagonal. Columns lying wholly outside the
+    ! band are never drawn.
+    nforced = 0
+    if (lnonsingular) nforced = min(m,n)
+    ncol = 0
+    ncells = 0
+    do j = 1, n
+       work%ccap(j) = band_col_capacity(lsymmetric, m, j, kl, ku)
+       if (work%ccap(j) .gt. 0) then
+          ncol = ncol + 1
+          work%cols(ncol) = j
+       end if
+       if (j .le. nforced) work%ccap(j) = work%ccap(j) - 1
+       ncells = ncells + work%ccap(j)
+    end do
+
+    ! Allocate non-zeroes (or holes) to columns, redrawing if the column is
+    ! already full (or empty). work%cnt(:) counts entries in free positions.
+    nent = nnz - nforced
+    if (2*nent .le. ncells) then
+       work%cnt(1:n) = 0
+       do ii = 1, nent
+          j = work%cols(random_integer(state, ncol))
+          do while (work%cnt(j) .ge. work%ccap(j))
+             j = work%cols(random_integer(state, ncol))
+          end do
+          work%cnt(j) = work%cnt(j) + 1
+       end do
+    else
+       work%cnt(1:n) = work%ccap(1:n)
+       do ii = 1, ncells - nent
+          j = work%cols(random_integer(state, ncol))
+          do while (work%cnt(j) .le. 0)
+             j = work%cols(random_integer(state, ncol))
+          end do
+          work%cnt(j) = work%cnt(j) - 1
+       end do
+    end if
+    if (nforced .gt. 0) work%cnt(1:nforced) = work%cnt(1:nforced) + 1
+
+    ! Determine row values
+    ptr(1) = 1
+    do i = 1, n
+       ! Determine the bound of the band
+       call band_window(lsymmetric, m, i, kl, ku, minidx, maxidx)
+
+       ! Determine end of col
+       ptr(i+1) = ptr(i) + work%cnt(i)
+       jj = ptr(i)
+
+       ! Dense column (see HOLE_MIN_FREE): mark the holes among the free
+       ! positions, then scan the band for the entries, which are thus sorted
+       nfree = maxidx - minidx + 1
+       if (i .le. nforced) nfree = nfree - 1
+       nhole = nfree - int(ptr(i+1)-jj)
+       if (i .le. nforced) nhole = nhole + 1
+       if ((2*nhole .lt. nfree) .and. (nfree .ge. HOLE_MIN_FREE)) then
+          if (i .le. nforced) work%rused(i) = .true.
+          do j = 1, nhole
+             k = random_integer_in_range(state, minidx, maxidx)
+             do while (work%rused(k))
+                k = random_integer_in_range(state, minidx, maxidx)
+             end do
+             work%rused(k) = .true.
+          end do
+          if (i .le. nforced) work%rused(i) = .false.
+          do k = minidx, maxidx
+             if (work%rused(k)) then
+                work%rused(k) = .false.
+             else
+                row(jj) = k
+                jj = jj + 1
+             end if
+          end do
+          cycle
+       end if
+
+       ! Add non-singular entry if required
+       if (i .le. nforced) then
+          row(jj) = i
+          work%rused(i) = .true.
+          jj = jj + 1
+       end if
+
+       ! Add normal entries
+       do jj = jj, ptr(i+1)-1
+          k = random_integer_in_range(state, minidx, maxidx)
+          do while (work%rused(k))
+             k = random_integer_in_range(state, minidx, maxidx)
+          end do
+          row(jj) = k
+          work%rused(k) = .true.
+       end do
+       ! Sort (if required) and reset rused(:)
+       if (lsort .and. (maxidx-minidx+1 .le. 4*work%cnt(i))) then
+          ! Dense column: scan the band
+          jj = ptr(i)
+          do k = minidx, maxidx
+             if (.not. work%rused(k)) cycle
+             row(jj) = k
+             work%rused(k) = .false.
+             jj = jj + 1
+          end do
+       else
+          if (lsort .and. (work%cnt(i) .gt. 1)) &
+               call sort_int(work%cnt(i), row(ptr(i)))
+          do jj = ptr(i), ptr(i+1)-1
+             work%rused(row(jj)) = .false.
+          end do
+       end if
+    end do
+  end subroutine band_pattern_rejection
+
+!
+! Generate a band matrix without any rejection, in O(nnz+n) time.
+!
+! Sampling is equivalent to choosing nnz positions from the band uniformly at
+! random. The columns are split into blocks of BLOCK_COLS columns, and the
+! entries are first divided between blocks by recursive bisection: at each
+! node of the bisection tree, the number of entries falling in the left half
+! is drawn from the hypergeometric distribution given the band capacity of
+! each half. Within a block, the number of entries in each column is drawn in
+! turn in the same way, and the rows within each column are then chosen by
+! Floyd's algorithm for sampling without replacement. Values, if required, are
+! generated immediately after the rows of each column.
+!
+! Every tree node and every block draws from its own stream, split from state
+! by the node or block index. Blocks can thus be generated in parallel, and the
+! result does not depend on the number of threads used.
+!
+! If first and last are present, the band is replaced by the profile in which
+! column j has window first(j):last(j), and kl and ku are ignored.
+!
+! If rhs is present, A*x is added to it as each column is generated.
+!
+! If col is present, the column index of each entry is written alongside its
+! row index, giving the matrix in coordinate format as well.
+!
+  subroutine band_generate_direct(state, lsymmetric, lnonsingular, lsort, m, &
+       n, nnz, kl, ku, cnt, ptr, row, st, val, first, last, x, rhs, skew, col)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    logical, intent(in) :: lsymmetric ! generate lower triangle only
+    logical, intent(in) :: lnonsingular ! force diagonal to be present
+    logical, intent(in) :: lsort ! sort entries within columns
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer, dimension(n), intent(out) :: cnt ! entries in each column
+    integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    integer, intent(out) :: st ! allocate error code
+    real(wp), dimension(nnz), optional, intent(out) :: val ! numerical values
+    integer, dimension(n), optional, intent(in) :: first ! first row of each
+      ! column's window
+    integer, dimension(n), optional, intent(in) :: last ! last row of each
+      ! column's window
+    real(wp), dimension(n), optional, intent(in) :: x ! if present, add A*x
+    real(wp), dimension(m), optional, intent(inout) :: rhs ! to rhs (requires
+      ! val and the band, not a profile)
+    logical, optional, intent(in) :: skew ! if present and .true., the
+      ! symmetric matrix is skew symmetric in computing rhs
+    integer, dimension(nnz), optional, intent(out) :: col ! if present,
+      ! column indices of entries
+
+    integer :: nblk, blk, jfirst, jlast, maxw, thread_st, ncolor, color
+    integer(long), dimension(:), allocatable :: blkcap, blkcnt, blkstart
+    logical, dimension(:), allocatable :: mark
+    type(random_state) :: base, bstate
+
+    ! Divide entries between blocks
+    call band_split_direct(state, lsymmetric, lnonsingular, m, n, nnz, kl, &
+         ku, base, nblk, blkcap, blkcnt, st, first=first, last=last)
+    if (st .ne. 0) return
+
+    ! Determine start of each block in row(:), allowing for forced diagonal
+    ! entries. The number of entries in each column is not known until the
+    ! block is generated.
+    allocate(blkstart(nblk+1), stat=st)
+    if (st .ne. 0) return
+    blkstart(1) = 1
+    do blk = 1, nblk
+       blkstart(blk+1) = blkstart(blk) + blkcnt(blk)
+       if (lnonsingular) blkstart(blk+1) = blkstart(blk+1) + &
+            max(0, min(m, n, blk*BLOCK_COLS) - (blk-1)*BLOCK_COLS)
+    end do
+    ptr(n+1) = blkstart(nblk+1)
+
+    ! Generate blocks
+    maxw = min(m, kl+ku+1)
+    if (lsymmetric) maxw = min(m, kl+1)
+    if (present(first)) maxw = max(1, maxval(last(:)-first(:)+1))
+
+    ! If rhs is accumulated, each block adds to rows jfirst-ku:jlast+kl only.
+    ! Blocks ncolor apart then touch disjoint rows, so the blocks of each
+    ! colour can run in parallel, and the sums do not depend on the number of
+    ! threads.
+    ncolor = 1
+    if (present(rhs)) then
+       if (lsymmetric) then
+          ncolor = (kl + BLOCK_COLS-1) / BLOCK_COLS + 1
+       else
+          ncolor = (kl + ku + BLOCK_COLS-1) / BLOCK_COLS + 1
+       end if
+    end if
+
+    !$omp parallel default(shared) &
+    !$omp    private(blk, color, bstate, mark, jfirst, jlast, thread_st)
+    allocate(mark(0:maxw-1), stat=thread_st)
+    if (thread_st .ne. 0) then
+       !$omp critical (random_matrix_st)
+       st = thread_st
+       !$omp end critical (random_matrix_st)
+    end if
+    !$omp barrier
+    if (st .eq. 0) then
+       mark(:) = .false.
+       do color = 1, ncolor
+          !$omp do schedule(dynamic)
+          do blk = color, nblk, ncolor
+             jfirst = (blk-1)*BLOCK_COLS + 1
+             jlast = min(n, blk*BLOCK_COLS)
+             call random_split(base, int(blk,long), bstate)
+             call band_direct_block(bstate, lsymmetric, lnonsingular, lsort, &
+                  m, n, jfirst, jlast, kl, ku, blkcap(blk)-blkcap(blk-1), &
+                  blkcnt(blk), blkstart(blk), mark, cnt(jfirst:jlast), &
+                  ptr(jfirst:jlast), row, val=val, first=first, last=last, &
+                  x=x, rhs=rhs, skew=skew, col=col)
+          end do
+          !$omp end do
+       end do
+    end if
+    !$omp end parallel
+  end subroutine band_generate_direct
+
+!
+! As band_generate_direct(), but the matrix is written to LAPACK band storage:
+! entry (i,j) is stored in ab(off+i-j,j), and all other entries of ab(:,1:n)
+! are set to zero. Each block is generated into thread-private CSC workspace
+! and scattered while it is still in cache. Entries within columns are not
+! sorted, so the matrix is the same as that from band_generate_direct() with
+! lsort=.false.
+!
+  subroutine band_generate_direct_lapack(state, lsymmetric, lnonsingular, m, &
+       n, nnz, kl, ku, ab, ldab, off, st)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    logical, intent(in) :: lsymmetric ! generate lower triangle only
+    logical, intent(in) :: lnonsingular ! force diagonal to be present
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer, intent(in) :: ldab ! leading dimension of ab
+    real(wp), dimension(ldab, n), intent(out) :: ab ! band storage
+    integer, intent(in) :: off ! row of ab holding the diagonal
+    integer, intent(out) :: st ! allocate error code
+
+    integer :: nblk, blk, i, jfirst, jlast, maxw, thread_st
+    integer(long) :: jj, maxent
+    integer(long), dimension(:), allocatable :: blkcap, blkcnt
+    integer, dimension(:), allocatable :: lcnt, lrow
+    integer(long), dimension(:), allocatable :: lptr
+    real(wp), dimension(:), allocatable :: lval
+    logical, dimension(:), allocatable :: mark
+    type(random_state) :: base, bstate
+
+    ! Divide entries between blocks
+    call band_split_direct(state, lsymmetric, lnonsingular, m, n, nnz, kl, &
+         ku, base, nblk, blkcap, blkcnt, st)
+    if (st .ne. 0) return
+
+    ! Size workspace for the largest block
+    maxent = 0
+    do blk = 1, nblk
+       jj = blkcnt(blk)
+       if (lnonsingular) jj = jj + &
+            max(0, min(m, n, blk*BLOCK_COLS) - (blk-1)*BLOCK_COLS)
+       maxent = max(maxent, jj)
+    end do
+
+    ! Generate blocks
+    maxw = min(m, kl+ku+1)
+    if (lsymmetric) maxw = min(m, kl+1)
+    !$omp parallel default(shared) &
+    !$omp    private(blk, bstate, i, jj, jfirst, jlast, mark, lcnt, lptr, &
+    !$omp       lrow, lval, thread_st)
+    allocate(mark(0:maxw-1), lcnt(BLOCK_COLS), lptr(BLOCK_COLS), &
+         lrow(maxent), lval(maxent), stat=thread_st)
+    if (thread_st .ne. 0) then
+       !$omp critical (random_matrix_st)
+       st = thread_st
+       !$omp end critical (random_matrix_st)
+    end if
+    !$omp barrier
+    if (st .eq. 0) then
+       mark(:) = .false.
+       !$omp do schedule(dynamic)
+       do blk = 1, nblk
+          jfirst = (blk-1)*BLOCK_COLS + 1
+          jlast = min(n, blk*BLOCK_COLS)
+          call random_split(base, int(blk,long), bstate)
+          call band_direct_block(bstate, lsymmetric, lnonsingular, .false., &
+               m, n, jfirst, jlast, kl, ku, blkcap(blk)-blkcap(blk-1), &
+               blkcnt(blk), 1_long, mark, lcnt, lptr, lrow, val=lval)
+          ! Scatter into ab
+          do i = jfirst, jlast
+             ab(:, i) = 0.0
+             do jj = lptr(i-jfirst+1), lptr(i-jfirst+1)+lcnt(i-jfirst+1)-1
+                ab(off+lrow(jj)-i, i) = lval(jj)
+             end do
+          end do
+       end do
+       !$omp end do
+    end if
+    !$omp end parallel
+  end subroutine band_generate_direct_lapack
+
+!
+! Generate one matrix of a batch for random_matrix_generate_band_batch(), as
+! random_matrix_generate64_band_kl_ku() would from the same state, using
+! workspace work, which also holds the 64-bit column pointers. The arguments
+! must already have been checked.
+!
+  subroutine band_batch_matrix(state, lsymmetric, lnonsingular, lsort, &
+       ldirect, ldominant, ldom, m, n, nnz, kl, ku, ptr, row, work, st, val)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    logical, intent(in) :: lsymmetric ! generate lower triangle only
+    logical, intent(in) :: lnonsingular ! force diagonal to be present
+    logical, intent(in) :: lsort ! sort entries within columns
+    logical, intent(in) :: ldirect ! use rejection-free sampling
+    logical, intent(in) :: ldominant ! make diagonal dominant
+    real(wp), intent(in) :: ldom ! dominance factor
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer, dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    type(random_matrix_workspace), intent(inout) :: work ! workspace
+    integer, intent(out) :: st ! allocate error code
+    real(wp), dimension(nnz), optional, intent(out) :: val ! numerical values
+
+    integer(long), dimension(:), allocatable :: ptr64
+
+    call move_alloc(work%ptr64, ptr64)
+    call grow_long(ptr64, n+1, st)
+    if (st .ne. 0) goto 100
+    if (ldirect) then
+       call band_direct_serial(state, lsymmetric, lnonsingular, lsort, m, n, &
+            nnz, min(kl,m), min(ku,n), ptr64, row, work, st, val=val)
+       if (st .ne. 0) goto 100
+    else
+       call band_pattern_rejection(state, lsymmetric, lnonsingular, lsort, &
+            m, n, nnz, min(kl,m), min(ku,n), ptr64, row, work, st)
+       if (st .ne. 0) goto 100
+       if (present(val)) call random_real_array(state, val)
+    end if
+    if (ldominant .and. present(val)) then
+       call band_set_dominant(lsymmetric, n, ptr64, row, val, ldom, st)
+       if (st .ne. 0) goto 100
+    end if
+    ptr(:) = int(ptr64(1:n+1))
+
+100 continue
+    call move_alloc(ptr64, work%ptr64)
+  end subroutine band_batch_matrix
+
+!
+! As band_generate_direct(), but the blocks are generated in turn by the
+! calling thread, using workspace from work. Used to generate each matrix of
+! a batch, for which the matrix is the same as from band_generate_direct().
+!
+  subroutine band_direct_serial(state, lsymmetric, lnonsingular, lsort, m, n, &
+       nnz, kl, ku, ptr, row, work, st, val)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    logical, intent(in) :: lsymmetric ! generate lower triangle only
+    logical, intent(in) :: lnonsingular ! force diagonal to be present
+    logical, intent(in) :: lsort ! sort entries within columns
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer(long), dimension(n+1), intent(out) :: ptr ! column pointers
+    integer, dimension(nnz), intent(out) :: row ! row indices
+    type(random_matrix_workspace), intent(inout) :: work ! workspace
+    integer, intent(out) :: st ! allocate error code
+    real(wp), dimension(nnz), optional, intent(out) :: val ! numerical values
+
+    integer :: nblk, blk, jfirst, jlast, maxw
+    integer(long) :: start
+    type(random_state) :: base, bstate
+
+    ! Divide entries between blocks
+    call band_split_direct(state, lsymmetric, lnonsingular, m, n, nnz, kl, &
+         ku, base, nblk, work%blkcap, work%blkcnt, st)
+    if (st .ne. 0) return
+    maxw = min(m, kl+ku+1)
+    if (lsymmetric) maxw = min(m, kl+1)
+    call workspace_reserve(work, 0, n, maxw, st)
+    if (st .ne. 0) return
+
+    ! Generate blocks, each starting where the last finished
+    start = 1
+    do blk = 1, nblk
+       jfirst = (blk-1)*BLOCK_COLS + 1
+       jlast = min(n, blk*BLOCK_COLS)
+       call random_split(base, int(blk,long), bstate)
+       call band_direct_block(bstate, lsymmetric, lnonsingular, lsort, m, n, &
+            jfirst, jlast, kl, ku, work%blkcap(blk)-work%blkcap(blk-1),      &
+            work%blkcnt(blk), start, work%mark, work%cnt(jfirst:jlast),          &
+            ptr(jfirst:jlast), row, val=val)
+       start = ptr(jlast) + work%cnt(jlast)
+    end do
+    ptr(n+1) = start
+  end subroutine band_direct_serial
+
+!
+! Grow the arrays of work if required, so that rused(:) has at least m
+! entries, cnt(:), ccap(:) and cols(:) at least n, and mark(:) at least maxw.
+! New arrays of flags are set to .false.
+!
+  subroutine workspace_reserve(work, m, n, maxw, st)
+    implicit none
+    type(random_matrix_workspace), intent(inout) :: work ! workspace
+    integer, intent(in) :: m ! rows needed in rused(:)
+    integer, intent(in) :: n ! columns needed in ccap(:) and cols(:)
+    integer, intent(in) :: maxw ! entries needed in mark(:)
+    integer, intent(out) :: st ! allocate error code
+
+    st = 0
+    if (allocated(work%rused)) then
+       if (size(work%rused) .lt. m) deallocate(work%rused)
+    end if
+    if (.not. allocated(work%rused)) then
+       allocate(work%rused(m), stat=st)
+       if (st .ne. 0) return
+       work%rused(:) = .false.
+    end if
+    call grow_int(work%cnt, n, st)
+    if (st .ne. 0) return
+    call grow_int(work%ccap, n, st)
+    if (st .ne. 0) return
+    call grow_int(work%cols, n, st)
+    if (st .ne. 0) return
+    if (allocated(work%mark)) then
+       if (size(work%mark) .lt. maxw) deallocate(work%mark)
+    end if
+    if (.not. allocated(work%mark)) then
+       allocate(work%mark(0:maxw-1), stat=st)
+       if (st .ne. 0) return
+       work%mark(:) = .false.
+    end if
+  end subroutine workspace_reserve
+
+!
+! Reallocate a if it has fewer than n entries. Contents are not preserved.
+!
+  subroutine grow_int(a, n, st)
+    implicit none
+    integer, dimension(:), allocatable, intent(inout) :: a ! array to grow
+    integer, intent(in) :: n ! entries required
+    integer, intent(out) :: st ! allocate error code
+
+    st = 0
+    if (allocated(a)) then
+       if (size(a) .ge. n) return
+       deallocate(a)
+    end if
+    allocate(a(n), stat=st)
+  end subroutine grow_int
+
+!
+! Reallocate a if it has fewer than n entries. Contents are not preserved.
+!
+  subroutine grow_long(a, n, st)
+    implicit none
+    integer(long), dimension(:), allocatable, intent(inout) :: a ! array to grow
+    integer, intent(in) :: n ! entries required
+    integer, intent(out) :: st ! allocate error code
+
+    st = 0
+    if (allocated(a)) then
+       if (size(a) .ge. n) return
+       deallocate(a)
+    end if
+    allocate(a(n), stat=st)
+  end subroutine grow_long
+
+!
+! Move the arrays of workspace from to workspace to, leaving from empty.
+! Generators take the arrays of a caller's workspace on entry, and return
+! them on exit.
+!
+  subroutine workspace_move(from, to)
+    implicit none
+    type(random_matrix_workspace), intent(inout) :: from ! source workspace
+    type(random_matrix_workspace), intent(inout) :: to ! target workspace
+
+    call move_alloc(from%cnt, to%cnt)
+    call move_alloc(from%rperm, to%rperm)
+    call move_alloc(from%cperm, to%cperm)
+    call move_alloc(from%ptr64, to%ptr64)
+    call move_alloc(from%ccap, to%ccap)
+    call move_alloc(from%cols, to%cols)
+    call move_alloc(from%rused, to%rused)
+    call move_alloc(from%mark, to%mark)
+    call move_alloc(from%blkcap, to%blkcap)
+    call move_alloc(from%blkcnt, to%blkcnt)
+  end subroutine workspace_move
+
+!
+! Shared first stage of band_generate_direct() and
+! band_generate_direct_lapack(). Copies state to base, from which all block
+! and tree node streams are split, and advances state. Returns the cumulative
+! number of free positions blkcap(0:nblk) and the number of entries
+! blkcnt(1:nblk) to place in the free positions of each block. If first and
+! last are present, positions are those of the profile instead of the band.
+! blkcap and blkcnt are reallocated only if too small.
+!
+  subroutine band_split_direct(state, lsymmetric, lnonsingular, m, n, nnz, &
+       kl, ku, base, nblk, blkcap, blkcnt, st, first, last)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator to use
+    logical, intent(in) :: lsymmetric ! generate lower triangle only
+    logical, intent(in) :: lnonsingular ! force diagonal to be present
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer(long), intent(in) :: nnz ! number of entries
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    type(random_state), intent(out) :: base ! state to split streams from
+    integer, intent(out) :: nblk ! number of blocks
+    integer(long), dimension(:), allocatable, intent(inout) :: blkcap
+    integer(long), dimension(:), allocatable, intent(inout) :: blkcnt
+    integer, intent(out) :: st ! allocate error code
+    integer, dimension(n), optional, intent(in) :: first ! first row of each
+      ! column's window
+    integer, dimension(n), optional, intent(in) :: last ! last row of each
+      ! column's window
+
+    integer :: blk, j, jfirst, jlast
+
+    st = 0
+
+    ! All streams are split from the current state, which is then advanced
+    base = state
+    call random_skip_ahead(state, 1_long)
+
+    ! Determine number of free positions in each block, excluding any forced
+    ! diagonal. blkcap(0:nblk) is then converted to cumulative form.
+    nblk = (n-1) / BLOCK_COLS + 1
+    if (allocated(blkcnt)) then
+       if (size(blkcnt) .lt. nblk) deallocate(blkcap, blkcnt)
+    end if
+    if (.not. allocated(blkcnt)) then
+       allocate(blkcap(0:nblk), blkcnt(nblk), stat=st)
+       if (st .ne. 0) return
+    end if
+    blkcap(0) = 0
+    do blk = 1, nblk
+       jfirst = (blk-1)*BLOCK_COLS + 1
+       jlast = min(n, blk*BLOCK_COLS)
+       if (present(first)) then
+          blkcap(blk) = blkcap(blk-1)
+          do j = jfirst, jlast
+             blkcap(blk) = blkcap(blk) + max(0, last(j)-first(j)+1)
+          end do
+          if (lnonsingular) blkcap(blk) = blkcap(blk) - &
+               max(0, min(jlast, m, n) - jfirst + 1)
+       else
+          blkcap(blk) = blkcap(blk-1) + band_range_free(lsymmetric, &
+               lnonsingular, m, n, kl, ku, jfirst, jlast)
+       end if
+    end do
+
+    ! Divide entries between blocks
+    if (lnonsingular) then
+       call split_blocks(1, nblk, 1_long, nnz-min(m,n))
+    else
+       call split_blocks(1, nblk, 1_long, nnz)
+    end if
+
+  contains
+    ! Divide nent entries between blocks b1:b2, where node is the index of
+    ! this range in the bisection tree
+    recursive subroutine split_blocks(b1, b2, node, nent)
+      integer, intent(in) :: b1, b2
+      integer(long), intent(in) :: node
+      integer(long), intent(in) :: nent
+
+      integer :: bmid
+      integer(long) :: nleft
+      type(random_state) :: nstate
+
+      if (b1 .eq. b2) then
+         blkcnt(b1) = nent
+         return
+      end if
+      bmid = (b1+b2) / 2
+      ! Node streams use negative indices to distinguish them from blocks
+      call random_split(base, -node, nstate)
+      nleft = random_hypergeometric(nstate, blkcap(b2)-blkcap(b1-1), &
+           blkcap(bmid)-blkcap(b1-1), nent)
+      call split_blocks(b1, bmid, 2*node, nleft)
+      call split_blocks(bmid+1, b2, 2*node+1, nent-nleft)
+    end subroutine split_blocks
+  end subroutine band_split_direct
+
+!
+! Generate columns jfirst:jlast of a band matrix for band_generate_direct(),
+! given the number of free positions and the number of entries to place in
+! them, starting at row(start). If first and last are present, column j lies
+! in rows first(j):last(j) instead of the band. On entry mark(:) must be
+! .false. (as it is again on exit).
+!
+  subroutine band_direct_block(state, lsymmetric, lnonsingular, lsort, m, n, &
+       jfirst, jlast, kl, ku, ncells, nent, start, mark, cnt, ptr, row, val, &
+       first, last, x, rhs, skew, col)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator for block
+    logical, intent(in) :: lsymmetric ! generate lower triangle only
+    logical, intent(in) :: lnonsingular ! force diagonal to be present
+    logical, intent(in) :: lsort ! sort entries within columns
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer, intent(in) :: jfirst ! first column of block
+    integer, intent(in) :: jlast ! last column of block
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth
+    integer(long), intent(in) :: ncells ! free positions in block
+    integer(long), intent(in) :: nent ! entries to place in free positions
+    integer(long), intent(in) :: start ! position of first entry in row(:)
+    logical, dimension(0:), intent(inout) :: mark ! workspace, size >= max
+      ! band width
+    integer, dimension(jfirst:jlast), intent(out) :: cnt ! entries in each
+      ! column of block
+    integer(long), dimension(jfirst:jlast), intent(out) :: ptr ! column
+      ! pointers of block
+    integer, dimension(*), intent(inout) :: row ! row indices
+    real(wp), dimension(*), optional, intent(inout) :: val ! numerical values
+    integer, dimension(n), optional, intent(in) :: first ! first row of each
+      ! column's window
+    integer, dimension(n), optional, intent(in) :: last ! last row of each
+      ! column's window
+    real(wp), dimension(*), optional, intent(in) :: x ! if present, add A*x
+    real(wp), dimension(*), optional, intent(inout) :: rhs ! to rhs
+    logical, optional, intent(in) :: skew ! matrix is skew symmetric
+    integer, dimension(*), optional, intent(inout) :: col ! if present,
+      ! column indices of entries
+
+    integer :: i, lo, hi, nfree, nsel
+    integer(long) :: jj, cells_left, ent_left
+    logical :: ldiag, lskew
+
+    lskew = .false.
+    if (present(skew)) lskew = skew
+
+    cells_left = ncells
+    ent_left = nent
+    jj = start
+    do i = jfirst, jlast
+       ptr(i) = jj
+       if (present(first)) then
+          lo = first(i)
+          hi = last(i)
+       else
+          call band_window(lsymmetric, m, i, kl, ku, lo, hi)
+       end if
+       ldiag = lnonsingular .and. (i .le. min(m,n))
+       nfree = max(0, hi-lo+1)
+       if (ldiag) nfree = nfree - 1
+       nsel = band_direct_count(state, nfree, cells_left, ent_left)
+       if (present(val)) then
+          call band_direct_col(state, ldiag, lsort, i, lo, hi, nsel, mark, &
+               cnt(i), row(jj), val=val(jj))
+          ! Column is still in cache
+          if (present(rhs)) call csc_col_matvec(lsymmetric, lskew, i, &
+               cnt(i), row(jj), val(jj), x, rhs)
+       else
+          call band_direct_col(state, ldiag, lsort, i, lo, hi, nsel, mark, &
+               cnt(i), row(jj))
+       end if
+       if (present(col)) col(jj:jj+cnt(i)-1) = i
+       jj = jj + cnt(i)
+    end do
+  end subroutine band_direct_block
+
+!
+! Draw the number of entries of a column with nfree free (i.e. not forced)
+! positions that lie in them, given that nent entries remain to be placed in
+! the ncells free positions of this column onwards within the block. Both are
+! updated to exclude the column.
+!
+  integer function band_direct_count(state, nfree, ncells, nent)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator for block
+    integer, intent(in) :: nfree ! free positions in column
+    integer(long), intent(inout) :: ncells ! free positions remaining
+    integer(long), intent(inout) :: nent ! entries remaining
+
+    band_direct_count = int(random_hypergeometric(state, ncells, &
+         int(nfree,long), nent))
+    ncells = ncells - nfree
+    nent = nent - band_direct_count
+  end function band_direct_count
+
+!
+! Generate column i, whose entries lie in rows lo:hi, with nsel entries in
+! free positions (plus the diagonal if ldiag is .true.). The rows are written
+! to row(1:cnt) and, if present, the values to val(1:cnt). On entry mark(:)
+! must be .false. (as it is again on exit).
+!
+  subroutine band_direct_col(state, ldiag, lsort, i, lo, hi, nsel, mark, cnt, &
+       row, val)
+    implicit none
+    type(random_state), intent(inout) :: state ! random generator for block
+    logical, intent(in) :: ldiag ! force diagonal to be present
+    logical, intent(in) :: lsort ! sort entries within column
+    integer, intent(in) :: i ! column
+    integer, intent(in) :: lo ! first row of window
+    integer, intent(in) :: hi ! last row of window
+    integer, intent(in) :: nsel ! number of entries in free positions
+    logical, dimension(0:), intent(inout) :: mark ! workspace, size >= max
+      ! window width
+    integer, intent(out) :: cnt ! number of entries in column
+    integer, dimension(*), intent(out) :: row ! row indices
+    real(wp), dimension(*), optional, intent(out) :: val ! numerical values
+
+    integer :: j, k, nfree, fdiag
+
+    nfree = hi - lo + 1
+    if (ldiag) nfree = nfree - 1
+    cnt = 0
+    ! Add non-singular entry if required. Free position k then maps to row
+    ! lo+k, skipping over the diagonal fdiag
+    fdiag = hi + 1
+    if (ldiag) then
+       cnt = cnt + 1
+       row(cnt) = i
+       mark(i-lo) = .true.
+       fdiag = i
+    end if
+    ! Floyd's algorithm: for the last nsel positions t of the free list,
+    ! pick k in [0,t]; take k unless already taken, in which case take t
+    do j = nfree-nsel, nfree-1
+       k = free_row(random_integer_in_range(state, 0, j))
+       if (mark(k-lo)) k = free_row(j)
+       cnt = cnt + 1
+       row(cnt) = k
+       mark(k-lo) = .true.
+    end do
+    ! Sort (if required) and reset mark(:)
+    if (lsort .and. (hi-lo+1 .le. 4*cnt)) then
+       ! Dense column: scan the band
+       j = 0
+       do k = lo, hi
+          if (.not. mark(k-lo)) cycle
+          j = j + 1
+          row(j) = k
+          mark(k-lo) = .false.
+       end do
+    else
+       if (lsort) call sort_int(cnt, row)
+       do j = 1, cnt
+          mark(row(j)-lo) = .false.
+       end do
+    end if
+    ! Determine values
+    if (present(val)) call random_real_array(state, val(1:cnt))
+
+  contains
+    ! Map free position k = 0,1,... to the corresponding row
+    integer function free_row(k)
+      integer, intent(in) :: k
+      free_row = lo + k
+      if (free_row .ge. fdiag) free_row = free_row + 1
+    end function free_row
+  end subroutine band_direct_col
+
+!
+! Returns the number of positions in the band of column j not occupied by a
+! forced diagonal entry
+!
+  integer function col_free(lsymmetric, lnonsingular, m, n, j, kl, ku)
+    implicit none
+    logical, intent(in) :: lsymmetric ! .true. if only lower triangle is used
+    logical, intent(in) :: lnonsingular ! .true. if diagonal is forced
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: n ! number of columns
+    integer, intent(in) :: j ! column
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth (ignored if symmetric)
+
+    col_free = band_col_capacity(lsymmetric, m, j, kl, ku)
+    if (lnonsingular .and. (j .le. min(m,n))) col_free = col_free - 1
+  end function col_free
+
+
+!
+! Sort a(1:n) into ascending order using heapsort
+!
+  subroutine sort_int(n, a)
+    implicit none
+    integer, intent(in) :: n
+    integer, dimension(n), intent(inout) :: a
+
+    integer :: i, last, temp
+
+    ! Build heap
+    do i = n/2, 1, -1
+       call sift_down(i, n)
+    end do
+    ! Repeatedly move largest element to end
+    do last = n, 2, -1
+       temp = a(1)
+       a(1) = a(last)
+       a(last) = temp
+       call sift_down(1, last-1)
+    end do
+
+  contains
+    subroutine sift_down(root, last)
+      integer, intent(in) :: root, last
+      integer :: parent, child, temp
+      parent = root
+      do while (2*parent .le. last)
+         child = 2*parent
+         if (child .lt. last) then
+            if (a(child+1) .gt. a(child)) child = child + 1
+         end if
+         if (a(parent) .ge. a(child)) return
+         temp = a(parent)
+         a(parent) = a(child)
+         a(child) = temp
+         parent = child
+      end do
+    end subroutine sift_down
+  end subroutine sort_int
+
+!
+! Set off(:,1:noff) to the offsets of the given stencil in d dimensions, in
+! lexicographic order with the last coordinate most significant. Neighbours
+! within the same tile then have increasing indices.
+!
+  subroutine stencil_offsets(d, stencil, noff, off, st)
+    implicit none
+    integer, intent(in) :: d ! number of grid dimensions
+    integer, intent(in) :: stencil ! stencil type
+    integer, intent(out) :: noff ! number of offsets
+    integer, dimension(:,:), allocatable, intent(out) :: off ! offsets
+    integer, intent(out) :: st ! allocate error code
+
+    integer :: k, p, r
+
+    if (stencil .eq. RANDOM_MATRIX_STENCIL_STAR) then
+       noff = 2*d + 1
+    else
+       noff = 3**d
+    end if
+    allocate(off(d,noff), stat=st)
+    if (st .ne. 0) return
+
+    off(:,:) = 0
+    if (stencil .eq. RANDOM_MATRIX_STENCIL_STAR) then
+       ! -e(d), ..., -e(1), 0, e(1), ..., e(d)
+       do k = 1, d
+          off(k,d+1-k) = -1
+          off(k,d+1+k) = 1
+       end do
+    else
+       ! Digits of p-1 in base 3, less one
+       do p = 1, noff
+          r = p - 1
+          do k = 1, d
+             off(k,p) = mod(r, 3) - 1
+             r = r / 3
+          end do
+       end do
+    end if
+  end subroutine stencil_offsets
+
+!
+! Returns the index of the grid point with (0-based) coordinates c(:), when
+! numbered tile by tile, with tiles of tsize(k) points in dimension k in
+! lexicographic order, and lexicographically within each tile.
+!
+  integer function stencil_index(d, dims, tsize, c)
+    implicit none
+    integer, intent(in) :: d ! number of grid dimensions
+    integer, dimension(d), intent(in) :: dims ! grid points in each dimension
+    integer, dimension(d), intent(in) :: tsize ! tile size in each dimension
+    integer, dimension(d), intent(in) :: c ! coordinates of point
+
+    integer :: k, i
+    integer(long) :: idx, before, inner
+    integer, dimension(d) :: tc, ext
+
+    ! Tile coordinates and extent of the tile containing c in each dimension
+    do k = 1, d
+       tc(k) = c(k) / tsize(k)
+       ext(k) = min(tsize(k), dims(k) - tc(k)*tsize(k))
+    end do
+
+    ! Points in preceding tiles: those in the slab of tiles before tc(k) in
+    ! dimension k within the current tile of each later dimension
+    idx = 1
+    do k = 1, d
+       before = int(tc(k),long) * tsize(k)
+       do i = 1, k-1
+          before = before * dims(i)
+       end do
+       do i = k+1, d
+          before = before * ext(i)
+       end do
+       idx = idx + before
+    end do
+
+    ! Position within tile
+    inner = 1
+    do k = 1, d
+       idx = idx + (c(k) - tc(k)*tsize(k)) * inner
+       inner = inner * ext(k)
+    end do
+    stencil_index = int(idx)
+  end function stencil_index
+
+!
+! Find the sorted indices nbr(1:cnt) of the stencil neighbours (including
+! itself) of grid point j with coordinates c(:) that lie in the grid, and in
+! the lower triangle in the symmetric case. The point lies in the tile with
+! coordinates tc(:) and extent ext(:), whose points have strides inner(:).
+! Neighbours within the same tile are found from these strides, in
+! increasing order, and only the others need stencil_index().
+!
+  subroutine stencil_col(d, dims, tsize, tc, ext, inner, noff, off, &
+       lsymmetric, c, j, cnt, nbr)
+    implicit none
+    integer, intent(in) :: d ! number of grid dimensions
+    integer, dimension(d), intent(in) :: dims ! grid points in each dimension
+    integer, dimension(d), intent(in) :: tsize ! tile size in each dimension
+    integer, dimension(d), intent(in) :: tc ! coordinates of tile
+    integer, dimension(d), intent(in) :: ext ! extent of tile
+    integer, dimension(d), intent(in) :: inner ! strides within tile
+    integer, intent(in) :: noff ! number of stencil offsets
+    integer, dimension(d,noff), intent(in) :: off ! stencil offsets
+    logical, intent(in) :: lsymmetric ! only use lower triangle
+    integer, dimension(d), intent(in) :: c ! coordinates of point
+    integer, intent(in) :: j ! index of point
+    integer, intent(out) :: cnt ! number of neighbours
+    integer, dimension(noff), intent(out) :: nbr ! neighbour indices
+
+    integer :: p, i, k, r, l
+    logical :: intile
+    integer, dimension(d) :: cn
+
+    cnt = 0
+    do p = 1, noff
+       cn(:) = c(:) + off(:,p)
+       if (any(cn(:) .lt. 0) .or. any(cn(:) .ge. dims(:))) cycle
+       intile = .true.
+       i = j
+       do k = 1, d
+          l = cn(k) - tc(k)*tsize(k)
+          intile = intile .and. (l .ge. 0) .and. (l .lt. ext(k))
+          i = i + off(k,p)*inner(k)
+       end do
+       if (.not. intile) i = stencil_index(d, dims, tsize, cn)
+       if (lsymmetric .and. (i .lt. j)) cycle
+       ! Insertion sort, as most neighbours arrive in order
+       r = cnt
+       do while (r .gt. 0)
+          if (nbr(r) .lt. i) exit
+          nbr(r+1) = nbr(r)
+          r = r - 1
+       end do
+       nbr(r+1) = i
+       cnt = cnt + 1
+    end do
+  end subroutine stencil_col
+
+!
+! Returns the number of positions in the band of column j
+!
+  integer function band_col_capacity(lsymmetric, m, j, kl, ku)
+    implicit none
+    logical, intent(in) :: lsymmetric ! .true. if only lower triangle is used
+    integer, intent(in) :: m ! number of rows
+    integer, intent(in) :: j ! column
+    integer, intent(in) :: kl ! lower bandwidth
+    integer, intent(in) :: ku ! upper bandwidth (ignored if symmetric)
+
+    integer :: lo, hi
+
+    call band_window(lsymmetric, m, j, kl, ku, lo, hi)
+    band_col_capacity = max(0, hi-lo+1)
+  end function band_col_capacity
+
+!
+! Returns a sample from the hypergeometric distribution: the number of
+! successes in ndraw draws without replacement from a population of size
+! npop containing nsucc successes.
+!
+! Uses inversion by chop-down search outwards from the mode, so the expected
+! cost is proportional to the standard deviation of the distribution rather
+! than to its range. Only a single random number is consumed.
+!
+  integer(long) function random_hypergeometric(state, npop, nsucc, ndraw)
+    implicit none
+    type(random_state), intent(inout) :: state ! random state
+    integer(long), intent(in) :: npop ! population size
+    integer(long), intent(in) :: nsucc ! number of successes in population
+    integer(long), intent(in) :: ndraw ! number of draws
+
+    integer(long) :: kmin, kmax, kmode, kdown, kup
+    real(wp) :: u, pmode, pdown, pup
+
+    ! Trivial cases: no random number consumed
+    kmin = max(0_long, ndraw - (npop-nsucc))
+    kmax = min(ndraw, nsucc)
+    if (kmin .ge. kmax) then
+       random_hypergeometric = kmax
+       return
+    end if
+
+    ! Probability of mode
+    kmode = int(((ndraw+1)*real(nsucc+1,wp)) / (npop+2), long)
+    kmode = max(kmin, min(kmax, kmode))
+    pmode = exp( log_choose(nsucc, kmode) + &
+         log_choose(npop-nsucc, ndraw-kmode) - log_choose(npop, ndraw) )
+
+    ! Chop-down search, alternately above and below the mode
+    u = random_real(state, positive=.true.)
+    random_hypergeometric = kmode
+    u = u - pmode
+    if (u .le. 0) return
+    kdown = kmode; pdown = pmode
+    kup = kmode; pup = pmode
+    do while ((kup .lt. kmax) .or. (kdown .gt. kmin))
+       if (kup .lt. kmax) then
+          pup = pup * ((nsucc-kup) * real(ndraw-kup,wp)) / &
+               ((kup+1) * real(npop-nsucc-ndraw+kup+1,wp))
+          kup = kup + 1
+          random_hypergeometric = kup
+          u = u - pup
+          if (u .le. 0) return
+       end if
+       if (kdown .gt. kmin) then
+          pdown = pdown * (kdown * real(npop-nsucc-ndraw+kdown,wp)) / &
+               ((nsucc-kdown+1) * real(ndraw-kdown+1,wp))
+          kdown = kdown - 1
+          random_hypergeometric = kdown
+          u = u - pdown
+          if (u .le. 0) return
+       end if
+    end do
+    ! Only reached through rounding error: return the mode
+    random_hypergeometric = kmode
+
+  contains
+    ! log of binomial coefficient (a choose b)
+    real(wp) function log_choose(a, b)
+      integer(long), intent(in) :: a, b
+      log_choose = log_gamma(a+1.0_wp) - log_gamma(b+1.0_wp) - &
+           log_gamma(a-b+1.0_wp)
+    end function log_choose
+  end function random_hypergeometric
 
 !
 ! Returns a random number in range [1,n] weighted by number of entries in
@@ -29,6 +29,7 @@ module spral_ssids_contrib
      integer :: owner ! cleanup routine to call: 0=cpu, 1=gpu
      ! Following are used by CPU to call correct cleanup routine
      logical(C_BOOL) :: posdef
+     logical(C_BOOL) :: single = .false. ! factors held in single precision
      type(C_PTR) :: owner_ptr
   end type contrib_type
 end module spral_ssids_contrib
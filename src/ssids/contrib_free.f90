@@ -20,7 +20,7 @@ contains
 
     select case(contrib%owner)
     case (0) ! CPU
-       call cpu_free_contrib(contrib%posdef, contrib%owner_ptr)
+       call cpu_free_contrib(contrib%posdef, contrib%single, contrib%owner_ptr)
     case (1) ! GPU
        call gpu_free_contrib(contrib)
     case default
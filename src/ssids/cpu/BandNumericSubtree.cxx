@@ -0,0 +1,326 @@
+/** \file
+ *  \copyright 2026 The SPRAL developers
+ *  \licence   BSD licence, see LICENCE file for details
+ */
+#include "ssids/cpu/BandNumericSubtree.hxx"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#include "omp.hxx"
+#include "ssids/cpu/AppendAlloc.hxx"
+
+using namespace spral::ssids::cpu;
+
+/////////////////////////////////////////////////////////////////////////////
+// anonymous namespace
+namespace {
+
+const int SSIDS_PAGE_SIZE = 8*1024*1024; // 8MB
+typedef BandNumericSubtree<true, double, SSIDS_PAGE_SIZE, AppendAlloc<double>> BandNumericSubtreePosdef;
+typedef BandNumericSubtree<false, double, SSIDS_PAGE_SIZE, AppendAlloc<double>> BandNumericSubtreeIndef;
+// Single precision factors (the solve interface remains double precision)
+typedef BandNumericSubtree<true, float, SSIDS_PAGE_SIZE, AppendAlloc<float>> BandNumericSubtreePosdefFlt;
+typedef BandNumericSubtree<false, float, SSIDS_PAGE_SIZE, AppendAlloc<float>> BandNumericSubtreeIndefFlt;
+
+} /* end of anon namespace */
+//////////////////////////////////////////////////////////////////////////
+
+extern "C"
+void* spral_ssids_cpu_create_band_subtree_dbl(
+      bool posdef,
+      bool single,      // If true, factors are stored in single precision
+      void const* symbolic_subtree_ptr,
+      const double *const aval, // Values of A
+      const double *const scaling, // Scaling vector (NULL if none)
+      struct cpu_factor_options const* options, // Options in
+      ThreadStats* stats // Info out
+      ) {
+   auto const& symbolic_subtree = *static_cast<SymbolicSubtree const*>(symbolic_subtree_ptr);
+
+   // Perform factorization
+   try {
+      if(posdef) {
+         if(single)
+            return (void*) new BandNumericSubtreePosdefFlt
+               (symbolic_subtree, aval, scaling, *options, *stats);
+         else
+            return (void*) new BandNumericSubtreePosdef
+               (symbolic_subtree, aval, scaling, *options, *stats);
+      } else { /* indef */
+         if(single)
+            return (void*) new BandNumericSubtreeIndefFlt
+               (symbolic_subtree, aval, scaling, *options, *stats);
+         else
+            return (void*) new BandNumericSubtreeIndef
+               (symbolic_subtree, aval, scaling, *options, *stats);
+      }
+   } catch(std::bad_alloc const&) {
+      stats->flag = Flag::ERROR_ALLOCATION;
+      return nullptr;
+   }
+}
+
+extern "C"
+void spral_ssids_cpu_destroy_band_subtree_dbl(bool posdef, bool single,
+      void* target) {
+   if(!target) return;
+
+   if(posdef) {
+      if(single) delete static_cast<BandNumericSubtreePosdefFlt*>(target);
+      else       delete static_cast<BandNumericSubtreePosdef*>(target);
+   } else {
+      if(single) delete static_cast<BandNumericSubtreeIndefFlt*>(target);
+      else       delete static_cast<BandNumericSubtreeIndef*>(target);
+   }
+}
+
+/* Double precision wrapper around templated routines */
+extern "C"
+Flag spral_ssids_cpu_band_solve_fwd_dbl(
+      bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
+      void const* subtree_ptr,// pointer to relevant type of BandNumericSubtree
+      int nrhs,         // number of right-hand sides
+      double* x,        // ldx x nrhs array of right-hand sides
+      int ldx,          // leading dimension of x
+      bool const* active, // nodes to solve, null for all
+      double* root_contrib // if not null, root updates are returned here
+      ) {
+
+   // Call method
+   try {
+      if(posdef) { // Converting from runtime to compile time posdef value
+         if(single)
+            static_cast<BandNumericSubtreePosdefFlt const*>(subtree_ptr)
+               ->solve_fwd(nrhs, x, ldx, active, root_contrib);
+         else
+            static_cast<BandNumericSubtreePosdef const*>(subtree_ptr)
+               ->solve_fwd(nrhs, x, ldx, active, root_contrib);
+      } else {
+         if(single)
+            static_cast<BandNumericSubtreeIndefFlt const*>(subtree_ptr)
+               ->solve_fwd(nrhs, x, ldx, active, root_contrib);
+         else
+            static_cast<BandNumericSubtreeIndef const*>(subtree_ptr)
+               ->solve_fwd(nrhs, x, ldx, active, root_contrib);
+      }
+   } catch(std::bad_alloc const&) {
+      return Flag::ERROR_ALLOCATION;
+   }
+   return Flag::SUCCESS;
+}
+
+/* Double precision wrapper around templated routines */
+extern "C"
+int64_t spral_ssids_cpu_band_root_contrib_size_dbl(
+      bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
+      void const* subtree_ptr // pointer to relevant type of BandNumericSubtree
+      ) {
+
+   // Call method
+   if(posdef) { // Converting from runtime to compile time posdef value
+      if(single)
+         return static_cast<BandNumericSubtreePosdefFlt const*>(subtree_ptr)
+            ->get_root_contrib_size();
+      else
+         return static_cast<BandNumericSubtreePosdef const*>(subtree_ptr)
+            ->get_root_contrib_size();
+   } else {
+      if(single)
+         return static_cast<BandNumericSubtreeIndefFlt const*>(subtree_ptr)
+            ->get_root_contrib_size();
+      else
+         return static_cast<BandNumericSubtreeIndef const*>(subtree_ptr)
+            ->get_root_contrib_size();
+   }
+}
+
+/* Double precision wrapper around templated routines */
+extern "C"
+Flag spral_ssids_cpu_band_add_root_contrib_dbl(
+      bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
+      void const* subtree_ptr,// pointer to relevant type of BandNumericSubtree
+      int nrhs,         // number of right-hand sides
+      double const* root_contrib, // root updates returned by solve_fwd
+      double* x,        // ldx x nrhs array of right-hand sides
+      int ldx           // leading dimension of x
+      ) {
+
+   // Call method
+   try {
+      if(posdef) { // Converting from runtime to compile time posdef value
+         if(single)
+            static_cast<BandNumericSubtreePosdefFlt const*>(subtree_ptr)
+               ->add_root_contrib(nrhs, root_contrib, x, ldx);
+         else
+            static_cast<BandNumericSubtreePosdef const*>(subtree_ptr)
+               ->add_root_contrib(nrhs, root_contrib, x, ldx);
+      } else {
+         if(single)
+            static_cast<BandNumericSubtreeIndefFlt const*>(subtree_ptr)
+               ->add_root_contrib(nrhs, root_contrib, x, ldx);
+         else
+            static_cast<BandNumericSubtreeIndef const*>(subtree_ptr)
+               ->add_root_contrib(nrhs, root_contrib, x, ldx);
+      }
+   } catch(std::bad_alloc const&) {
+      return Flag::ERROR_ALLOCATION;
+   }
+   return Flag::SUCCESS;
+}
+
+/* Double precision wrapper around templated routines */
+extern "C"
+Flag spral_ssids_cpu_band_solve_diag_dbl(
+      bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
+      void const* subtree_ptr,// pointer to relevant type of BandNumericSubtree
+      int nrhs,         // number of right-hand sides
+      double* x,        // ldx x nrhs array of right-hand sides
+      int ldx,          // leading dimension of x
+      bool const* active // nodes to solve, null for all
+      ) {
+
+   // Call method
+   try {
+      if(posdef) { // Converting from runtime to compile time posdef value
+         if(single)
+            static_cast<BandNumericSubtreePosdefFlt const*>(subtree_ptr)
+               ->solve_diag(nrhs, x, ldx, active);
+         else
+            static_cast<BandNumericSubtreePosdef const*>(subtree_ptr)
+               ->solve_diag(nrhs, x, ldx, active);
+      } else {
+         if(single)
+            static_cast<BandNumericSubtreeIndefFlt const*>(subtree_ptr)
+               ->solve_diag(nrhs, x, ldx, active);
+         else
+            static_cast<BandNumericSubtreeIndef const*>(subtree_ptr)
+               ->solve_diag(nrhs, x, ldx, active);
+      }
+   } catch(std::bad_alloc const&) {
+      return Flag::ERROR_ALLOCATION;
+   }
+   return Flag::SUCCESS;
+}
+
+/* Double precision wrapper around templated routines */
+extern "C"
+Flag spral_ssids_cpu_band_solve_diag_bwd_dbl(
+      bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
+      void const* subtree_ptr,// pointer to relevant type of BandNumericSubtree
+      int nrhs,         // number of right-hand sides
+      double* x,        // ldx x nrhs array of right-hand sides
+      int ldx,          // leading dimension of x
+      bool const* active // nodes to solve, null for all
+      ) {
+
+   // Call method
+   try {
+      if(posdef) { // Converting from runtime to compile time posdef value
+         if(single)
+            static_cast<BandNumericSubtreePosdefFlt const*>(subtree_ptr)
+               ->solve_diag_bwd(nrhs, x, ldx, active);
+         else
+            static_cast<BandNumericSubtreePosdef const*>(subtree_ptr)
+               ->solve_diag_bwd(nrhs, x, ldx, active);
+      } else {
+         if(single)
+            static_cast<BandNumericSubtreeIndefFlt const*>(subtree_ptr)
+               ->solve_diag_bwd(nrhs, x, ldx, active);
+         else
+            static_cast<BandNumericSubtreeIndef const*>(subtree_ptr)
+               ->solve_diag_bwd(nrhs, x, ldx, active);
+      }
+   } catch(std::bad_alloc const&) {
+      return Flag::ERROR_ALLOCATION;
+   }
+   return Flag::SUCCESS;
+}
+
+/* Double precision wrapper around templated routines */
+extern "C"
+Flag spral_ssids_cpu_band_solve_bwd_dbl(
+      bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
+      void const* subtree_ptr,// pointer to relevant type of BandNumericSubtree
+      int nrhs,         // number of right-hand sides
+      double* x,        // ldx x nrhs array of right-hand sides
+      int ldx,          // leading dimension of x
+      bool const* active // nodes to solve, null for all
+      ) {
+
+   // Call method
+   try {
+      if(posdef) { // Converting from runtime to compile time posdef value
+         if(single)
+            static_cast<BandNumericSubtreePosdefFlt const*>(subtree_ptr)
+               ->solve_bwd(nrhs, x, ldx, active);
+         else
+            static_cast<BandNumericSubtreePosdef const*>(subtree_ptr)
+               ->solve_bwd(nrhs, x, ldx, active);
+      } else {
+         if(single)
+            static_cast<BandNumericSubtreeIndefFlt const*>(subtree_ptr)
+               ->solve_bwd(nrhs, x, ldx, active);
+         else
+            static_cast<BandNumericSubtreeIndef const*>(subtree_ptr)
+               ->solve_bwd(nrhs, x, ldx, active);
+      }
+   } catch(std::bad_alloc const&) {
+      return Flag::ERROR_ALLOCATION;
+   }
+   return Flag::SUCCESS;
+}
+
+/* Double precision wrapper around templated routines */
+extern "C"
+void spral_ssids_cpu_band_enquire_dbl(
+      bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
+      void const* subtree_ptr,// pointer to relevant type of BandNumericSubtree
+      int* piv_order,   // pivot order, may be null, only used if indef
+      double* d         // diagonal entries, may be null
+      ) {
+
+   // Call method
+   if(posdef) { // Converting from runtime to compile time posdef value
+      if(single)
+         static_cast<BandNumericSubtreePosdefFlt const*>(subtree_ptr)
+            ->enquire(piv_order, d);
+      else
+         static_cast<BandNumericSubtreePosdef const*>(subtree_ptr)
+            ->enquire(piv_order, d);
+   } else {
+      if(single)
+         static_cast<BandNumericSubtreeIndefFlt const*>(subtree_ptr)
+            ->enquire(piv_order, d);
+      else
+         static_cast<BandNumericSubtreeIndef const*>(subtree_ptr)
+            ->enquire(piv_order, d);
+   }
+}
+
+/* Double precision wrapper around templated routines */
+extern "C"
+void spral_ssids_cpu_band_alter_dbl(
+      bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
+      void* subtree_ptr,// pointer to relevant type of BandNumericSubtree
+      double const* d   // new diagonal entries
+      ) {
+
+   assert(!posdef); // Should never be called on positive definite matrices.
+
+   // Call method
+   if(single)
+      static_cast<BandNumericSubtreeIndefFlt*>(subtree_ptr)->alter(d);
+   else
+      static_cast<BandNumericSubtreeIndef*>(subtree_ptr)->alter(d);
+}
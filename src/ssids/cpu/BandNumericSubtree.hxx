@@ -0,0 +1,404 @@
+/** \file
+ *  \copyright 2026 The SPRAL developers
+ *  \licence   BSD licence, see LICENCE file for details
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "ssids/profile.hxx"
+#include "ssids/cpu/cpu_iface.hxx"
+#include "ssids/cpu/factor.hxx"
+#include "ssids/cpu/BuddyAllocator.hxx"
+#include "ssids/cpu/NumericNode.hxx"
+#include "ssids/cpu/SubtreeSolver.hxx"
+#include "ssids/cpu/SymbolicSubtree.hxx"
+#include "ssids/cpu/ThreadStats.hxx"
+#include "ssids/cpu/kernels/assemble.hxx"
+
+namespace spral { namespace ssids { namespace cpu {
+
+/** \brief Factors of a matrix of small bandwidth, computed on the CPU.
+ *
+ * The symbolic subtree describes a chain of nodes, node i (0-based) holding
+ * the block of columns sptr[i]:sptr[i+1]-1 and all rows of the band below
+ * them. As all rows are consecutive, each node's contribution block occupies
+ * the leading rows and columns of the next node's front: it is added with
+ * contiguous vector operations rather than through the general index maps of
+ * assemble_pre() and assemble_post(). Each node is factorized with the usual
+ * blocked, task-based dense kernels (see factor_node()), so pivots are chosen
+ * within the band. Columns that cannot be eliminated are delayed to the next
+ * node, extending its front beyond the band. Once a front has received as
+ * many delays as the semi-bandwidth, the pivot threshold is reduced a
+ * hundredfold for that node to limit further growth; such nodes are counted
+ * in ThreadStats::num_relaxed.
+ *
+ * \tparam posdef true for Cholesky factorization, false for indefinite LDL^T
+ * \tparam T underlying numerical type e.g. double
+ * \tparam SSIDS_PAGE_SIZE initial size to be used for thread Workspace
+ * \tparam FactorAllocator allocator to be used for factor storage. It must
+ *         zero memory upon allocation (eg through calloc or memset).
+ */
+template <bool posdef,
+          typename T,
+          size_t SSIDS_PAGE_SIZE,
+          typename FactorAllocator
+          >
+class BandNumericSubtree {
+   typedef BuddyAllocator<T,std::allocator<T>> PoolAllocator;
+   typedef SubtreeSolver<posdef, T, PoolAllocator> Solver;
+public:
+   /* Delete copy constructors for safety re allocated memory */
+   BandNumericSubtree(const BandNumericSubtree&) =delete;
+   BandNumericSubtree& operator=(const BandNumericSubtree&) =delete;
+   /** \brief Construct factors associated with specified symbolic subtree by
+    *         performing factorization.
+    *  \param symbolic_subtree symbolic factorization of the band, as a chain
+    *         of nodes with consecutive rows.
+    *  \param aval pointer to user's a value array (references entire matrix)
+    *  \param scaling pointer to optional scaling vector to be applied
+    *         (references entire matrix). No scaling applied if null.
+    *  \param options user-supplied options controlling execution.
+    *  \param stats collection of statistics for return to user.
+    */
+   BandNumericSubtree(
+         SymbolicSubtree const& symbolic_subtree,
+         double const* aval,
+         double const* scaling,
+         struct cpu_factor_options const& options,
+         ThreadStats& stats)
+   : symb_(symbolic_subtree),
+     factor_alloc_(symbolic_subtree.get_factor_mem_est<T>(options.multiplier)),
+     pool_alloc_(2*symbolic_subtree.get_pool_size<T>())
+   {
+      /* Associate symbolic nodes to numeric ones; copy tree structure */
+      nodes_.reserve(symb_.nnodes_+1);
+      for(int ni=0; ni<symb_.nnodes_+1; ++ni) {
+         nodes_.emplace_back(symb_[ni], pool_alloc_);
+         auto* fc = symb_[ni].first_child;
+         nodes_[ni].first_child = fc ? &nodes_[fc->idx] : nullptr;
+         auto* nc = symb_[ni].next_child;
+         nodes_[ni].next_child = nc ? &nodes_[nc->idx] :  nullptr;
+      }
+
+      /* Allocate workspaces */
+      int num_threads = omp_get_num_threads();
+      std::vector<Workspace> work;
+      work.reserve(num_threads);
+      for(int i=0; i<num_threads; ++i)
+         work.emplace_back(SSIDS_PAGE_SIZE);
+
+      /* Delays may only extend a front by as much as the semi-bandwidth. The
+       * threshold is relaxed (but kept positive, so zero pivots are still
+       * rejected) on any non-root node that reaches this extension, and
+       * failed pivots are always retried with TPP within the node rather
+       * than passed on. The root never needs relaxing, as TPP eliminates
+       * every remaining column there. */
+      int max_delay = 1;
+      for(int ni=0; ni<symb_.nnodes_; ++ni)
+         max_delay = std::max(max_delay, symb_[ni].nrow - symb_[ni].ncol);
+      struct cpu_factor_options band_options = options;
+      band_options.failed_pivot_method = FailedPivotMethod::tpp;
+      struct cpu_factor_options relaxed_options = band_options;
+      relaxed_options.u = 0.01 * options.u;
+
+      stats = ThreadStats();
+
+      /* Nodes are factorized in order; parallelism is within each node */
+      try {
+         for(int ni=0; ni<symb_.nnodes_; ++ni) {
+#ifdef PROFILE
+            Profile::Task task_band("TA_BAND");
+#endif
+            assemble_pre(ni, aval, scaling);
+            int nrow = symb_[ni].nrow + nodes_[ni].ndelay_in;
+            stats.maxfront = std::max(stats.maxfront, nrow);
+            int ncol = symb_[ni].ncol + nodes_[ni].ndelay_in;
+            stats.maxsupernode = std::max(stats.maxsupernode, ncol);
+
+            bool relax = (nodes_[ni].ndelay_in >= max_delay) &&
+                         (symb_[ni].nrow > symb_[ni].ncol);
+            if(relax) ++stats.num_relaxed;
+            factor_node<posdef>(ni, symb_[ni], nodes_[ni],
+                  relax ? relaxed_options : band_options,
+                  stats, work, pool_alloc_);
+            if(stats.flag < Flag::SUCCESS) return;
+
+            assemble_post(ni);
+#ifdef PROFILE
+            task_band.done();
+#endif
+         }
+      } catch(std::bad_alloc const&) {
+         stats.flag = Flag::ERROR_ALLOCATION;
+         return;
+      } catch(SingularError const&) {
+         stats.flag = Flag::ERROR_SINGULAR;
+         return;
+      }
+
+      // Count stats
+      if(posdef) {
+         // all stats remain zero
+      } else { // indefinite
+         for(int ni=0; ni<symb_.nnodes_; ni++) {
+            int m = symb_[ni].nrow + nodes_[ni].ndelay_in;
+            int n = symb_[ni].ncol + nodes_[ni].ndelay_in;
+            int ldl = align_lda<T>(m);
+            T *d = nodes_[ni].lcol + n*ldl;
+            for(int i=0; i<nodes_[ni].nelim; ) {
+               T a11 = d[2*i];
+               T a21 = d[2*i+1];
+               if(i+1==nodes_[ni].nelim || std::isfinite(d[2*i+2])) {
+                  // 1x1 pivot (or zero)
+                  if(a11 == 0.0) {
+                     // NB: If we reach this stage, options.action must be true.
+                     stats.flag = Flag::WARNING_FACT_SINGULAR;
+                     stats.num_zero++;
+                  }
+                  if(a11 < 0.0) stats.num_neg++;
+                  i++;
+               } else {
+                  // 2x2 pivot
+                  T a22 = d[2*i+3];
+                  stats.num_two++;
+                  T det = a11*a22 - a21*a21; // product of evals
+                  T trace = a11 + a22; // sum of evals
+                  if(det < 0) stats.num_neg++;
+                  else if(trace < 0) stats.num_neg+=2;
+                  i+=2;
+               }
+            }
+         }
+      }
+   }
+
+   /** \brief Perform forward solve \f$ Lx = b \f$ (see
+    *         SubtreeSolver::solve_fwd()).
+    *  \param active If not null, only nodes ni with active[ni] true are
+    *         solved. As the parent of an active node is active, the inactive
+    *         nodes of the chain are those before the first active one.
+    *  \param root_contrib If not null, updates from the root of the chain
+    *         are returned here rather than added to x.
+    */
+   void solve_fwd(int nrhs, double* x, int ldx,
+         bool const* active=nullptr, double* root_contrib=nullptr) const {
+      Solver(symb_, nodes_).solve_fwd(nrhs, x, ldx, active, root_contrib);
+   }
+
+   /** \brief Return size per right-hand side of root_contrib in
+    *         solve_fwd(). */
+   size_t get_root_contrib_size() const {
+      return Solver(symb_, nodes_).get_root_contrib_size();
+   }
+
+   /** \brief Add updates returned by solve_fwd() in root_contrib to x. */
+   void add_root_contrib(int nrhs, double const* root_contrib, double* x,
+         int ldx) const {
+      Solver(symb_, nodes_).add_root_contrib(nrhs, root_contrib, x, ldx);
+   }
+
+   /** \brief Perform diagonal solve \f$ Dx = b \f$ (indef only). */
+   void solve_diag(int nrhs, double* x, int ldx,
+         bool const* active=nullptr) const {
+      Solver(symb_, nodes_).template solve_diag_bwd<true, false>(
+            nrhs, x, ldx, active);
+   }
+
+   /** \brief Perform combined diagonal and backward solve
+    *         \f$ DL^Tx = b \f$. */
+   void solve_diag_bwd(int nrhs, double* x, int ldx,
+         bool const* active=nullptr) const {
+      Solver(symb_, nodes_).template solve_diag_bwd<true, true>(
+            nrhs, x, ldx, active);
+   }
+
+   /** \brief Perform backward solve \f$ L^Tx = b \f$. */
+   void solve_bwd(int nrhs, double* x, int ldx,
+         bool const* active=nullptr) const {
+      Solver(symb_, nodes_).template solve_diag_bwd<false, true>(
+            nrhs, x, ldx, active);
+   }
+
+   /** Returns information on diagonal entries and/or pivot order.
+    * Note that piv_order is only set in indefinite case.
+    * One of piv_order or d may be null in indefinite case.
+    */
+   void enquire(int *piv_order, double* d) const {
+      if(posdef) {
+         for(int ni=0; ni<symb_.nnodes_; ++ni) {
+            int blkm = symb_[ni].nrow;
+            int nelim = symb_[ni].ncol;
+            int ldl = align_lda<T>(blkm);
+            for(int i=0; i<nelim; ++i)
+               *(d++) = nodes_[ni].lcol[i*(ldl+1)];
+         }
+      } else { /*indef*/
+         for(int ni=0, piv=0; ni<symb_.nnodes_; ++ni) {
+            int blkm = symb_[ni].nrow + nodes_[ni].ndelay_in;
+            int blkn = symb_[ni].ncol + nodes_[ni].ndelay_in;
+            int ldl = align_lda<T>(blkm);
+            int nelim = nodes_[ni].nelim;
+            T const* dptr = &nodes_[ni].lcol[blkn*ldl];
+            for(int i=0; i<nelim; ) {
+               if(i+1==nelim || std::isfinite(dptr[2*i+2])) {
+                  /* 1x1 pivot */
+                  if(piv_order) {
+                     piv_order[nodes_[ni].perm[i]-1] = (piv++);
+                  }
+                  if(d) {
+                     *(d++) = dptr[2*i+0];
+                     *(d++) = 0.0;
+                  }
+                  i+=1;
+               } else {
+                  /* 2x2 pivot */
+                  if(piv_order) {
+                     piv_order[nodes_[ni].perm[i]-1] = -(piv++);
+                     piv_order[nodes_[ni].perm[i+1]-1] = -(piv++);
+                  }
+                  if(d) {
+                     *(d++) = dptr[2*i+0];
+                     *(d++) = dptr[2*i+1];
+                     *(d++) = dptr[2*i+3];
+                     *(d++) = 0.0;
+                  }
+                  i+=2;
+               }
+            }
+         }
+      }
+   }
+
+   /** Allows user to alter D values, indef case only. */
+   void alter(double const* d) {
+      for(int ni=0; ni<symb_.nnodes_; ++ni) {
+         int blkm = symb_[ni].nrow + nodes_[ni].ndelay_in;
+         int blkn = symb_[ni].ncol + nodes_[ni].ndelay_in;
+         int ldl = align_lda<T>(blkm);
+         int nelim = nodes_[ni].nelim;
+         T* dptr = &nodes_[ni].lcol[blkn*ldl];
+         for(int i=0; i<nelim; ) {
+            if(i+1==nelim || std::isfinite(dptr[2*i+2])) {
+               /* 1x1 pivot */
+               dptr[2*i+0] = *(d++);
+               d++;
+               i+=1;
+            } else {
+               /* 2x2 pivot */
+               dptr[2*i+0] = *(d++);
+               dptr[2*i+1] = *(d++);
+               dptr[2*i+3] = *(d++);
+               d++;
+               i+=2;
+            }
+         }
+      }
+   }
+
+private:
+   /** \brief Return position in front of node ni of its k-th expected row.
+    *
+    * Rows of a node are consecutive, so this is k itself, shifted past any
+    * delayed columns for rows that are not fully summed.
+    */
+   int front_row(int ni, int k) const {
+      return (k < symb_[ni].ncol) ? k : k + nodes_[ni].ndelay_in;
+   }
+
+   /** \brief Assemble A, delays and the fully summed part of the previous
+    *         node's contribution block into the front of node ni.
+    */
+   void assemble_pre(int ni, double const* aval, double const* scaling) {
+      /* Rebind allocators */
+      typedef typename std::allocator_traits<FactorAllocator>::template rebind_traits<T> FATTraits;
+      typename FATTraits::allocator_type factor_alloc_t(factor_alloc_);
+      typedef typename std::allocator_traits<FactorAllocator>::template rebind_traits<int> FAIntTraits;
+      typename FAIntTraits::allocator_type factor_alloc_int(factor_alloc_);
+
+      SymbolicNode const& snode = symb_[ni];
+      auto& node = nodes_[ni];
+      auto* child = node.first_child; // previous node in chain, if any
+
+      /* Get space for node, now we know its size */
+      node.ndelay_in = (child) ? child->ndelay_out : 0;
+      int ncol = snode.ncol + node.ndelay_in;
+      size_t ldl = node.get_ldl();
+      size_t len = posdef ?  ldl    * ncol  // posdef
+                          : (ldl+2) * ncol; // indef (includes D)
+      node.lcol = FATTraits::allocate(factor_alloc_t, len);
+      node.alloc_contrib();
+      node.perm = FAIntTraits::allocate(factor_alloc_int, ncol);
+      for(int i=0; i<snode.ncol; i++)
+         node.perm[i] = snode.rlist[i];
+
+      /* Add A */
+      add_a_block(0, snode.num_a, node, aval, scaling);
+
+      if(!child) return;
+      SymbolicNode const& csnode = child->symb;
+      int cm = csnode.nrow - csnode.ncol;
+
+      /* Delays become the columns following the expected ones. Their
+       * non-fully summed rows in the child are the leading rows here. */
+      int lds = align_lda<T>(csnode.nrow + child->ndelay_in);
+      for(int i=0; i<child->ndelay_out; i++) {
+         int delay_col = snode.ncol + i;
+         T *dest = &node.lcol[delay_col*(ldl+1)];
+         T *src = &child->lcol[(child->nelim+i)*(lds+1)];
+         node.perm[delay_col] = child->perm[child->nelim+i];
+         for(int j=0; j<child->ndelay_out-i; j++)
+            dest[j] = src[j];
+         src = &child->lcol[child->nelim*lds + child->ndelay_in + i*lds
+            + csnode.ncol];
+         for(int k=0; k<cm; k++) {
+            int r = front_row(ni, k);
+            if(r < ncol) node.lcol[r*ldl+delay_col] = src[k];
+            else         node.lcol[delay_col*ldl+r] = src[k];
+         }
+      }
+
+      /* Fully summed columns of contribution block go straight into lcol;
+       * the rest is added to our own contribution in assemble_post() */
+      if(!child->contrib) return;
+      for(int j=0; j<std::min(cm, snode.ncol); ++j) {
+         T const* src = &child->contrib[j*cm];
+         T* dest = &node.lcol[j*ldl];
+         for(int k=j; k<std::min(cm, snode.ncol); ++k)
+            dest[k] += src[k];
+         dest += node.ndelay_in;
+         for(int k=snode.ncol; k<cm; ++k)
+            dest[k] += src[k];
+      }
+   }
+
+   /** \brief Add the remainder of the previous node's contribution block to
+    *         the contribution block of node ni, then free it.
+    */
+   void assemble_post(int ni) {
+      SymbolicNode const& snode = symb_[ni];
+      auto& node = nodes_[ni];
+      auto* child = node.first_child;
+      if(!child || !child->contrib) return;
+      SymbolicNode const& csnode = child->symb;
+      int cm = csnode.nrow - csnode.ncol;
+      int ldd = snode.nrow - snode.ncol;
+      for(int j=snode.ncol; j<cm; ++j) {
+         T const* src = &child->contrib[j*cm];
+         T* dest = &node.contrib[(j-snode.ncol)*ldd];
+         for(int k=j; k<cm; ++k)
+            dest[k-snode.ncol] += src[k];
+      }
+      child->free_contrib();
+   }
+
+   SymbolicSubtree const& symb_;
+   FactorAllocator factor_alloc_;
+   PoolAllocator pool_alloc_;
+   std::vector<NumericNode<T,PoolAllocator>> nodes_;
+};
+
+}}} /* end of namespace spral::ssids::cpu */
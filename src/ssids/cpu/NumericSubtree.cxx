@@ -6,6 +6,7 @@
 #include "ssids/cpu/NumericSubtree.hxx"
 
 #include <cassert>
+#include <cstdint>
 #include <cstdio>
 #include <memory>
 
@@ -18,10 +19,31 @@ using namespace spral::ssids::cpu;
 // anonymous namespace
 namespace {
 
-typedef double T;
 const int SSIDS_PAGE_SIZE = 8*1024*1024; // 8MB
-typedef NumericSubtree<true, T, SSIDS_PAGE_SIZE, AppendAlloc<T>> NumericSubtreePosdef;
-typedef NumericSubtree<false, T, SSIDS_PAGE_SIZE, AppendAlloc<T>> NumericSubtreeIndef;
+typedef NumericSubtree<true, double, SSIDS_PAGE_SIZE, AppendAlloc<double>> NumericSubtreePosdef;
+typedef NumericSubtree<false, double, SSIDS_PAGE_SIZE, AppendAlloc<double>> NumericSubtreeIndef;
+// Single precision factors (the solve interface remains double precision)
+typedef NumericSubtree<true, float, SSIDS_PAGE_SIZE, AppendAlloc<float>> NumericSubtreePosdefFlt;
+typedef NumericSubtree<false, float, SSIDS_PAGE_SIZE, AppendAlloc<float>> NumericSubtreeIndefFlt;
+
+/** Factorize, printing the factors if requested */
+template <typename Subtree>
+void* create_subtree(
+      SymbolicSubtree const& symbolic_subtree,
+      const double *const aval,
+      const double *const scaling,
+      void** child_contrib,
+      struct cpu_factor_options const* options,
+      ThreadStats* stats
+      ) {
+   auto* subtree = new Subtree
+      (symbolic_subtree, aval, scaling, child_contrib, *options, *stats);
+   if(options->print_level > 9999) {
+      printf("Final factors:\n");
+      subtree->print();
+   }
+   return (void*) subtree;
+}
 
 } /* end of anon namespace */
 //////////////////////////////////////////////////////////////////////////
@@ -29,6 +51,7 @@ typedef NumericSubtree<false, T, SSIDS_PAGE_SIZE, AppendAlloc<T>> NumericSubtree
 extern "C"
 void* spral_ssids_cpu_create_num_subtree_dbl(
       bool posdef,
+      bool single,      // If true, factors are stored in single precision
       void const* symbolic_subtree_ptr,
       const double *const aval, // Values of A
       const double *const scaling, // Scaling vector (NULL if none)
@@ -40,34 +63,33 @@ void* spral_ssids_cpu_create_num_subtree_dbl(
 
    // Perform factorization
    if(posdef) {
-      auto* subtree = new NumericSubtreePosdef
-         (symbolic_subtree, aval, scaling, child_contrib, *options, *stats);
-      if(options->print_level > 9999) {
-         printf("Final factors:\n");
-         subtree->print();
-      }
-      return (void*) subtree;
+      if(single)
+         return create_subtree<NumericSubtreePosdefFlt>
+            (symbolic_subtree, aval, scaling, child_contrib, options, stats);
+      else
+         return create_subtree<NumericSubtreePosdef>
+            (symbolic_subtree, aval, scaling, child_contrib, options, stats);
    } else { /* indef */
-      auto* subtree = new NumericSubtreeIndef
-         (symbolic_subtree, aval, scaling, child_contrib, *options, *stats);
-      if(options->print_level > 9999) {
-         printf("Final factors:\n");
-         subtree->print();
-      }
-      return (void*) subtree;
+      if(single)
+         return create_subtree<NumericSubtreeIndefFlt>
+            (symbolic_subtree, aval, scaling, child_contrib, options, stats);
+      else
+         return create_subtree<NumericSubtreeIndef>
+            (symbolic_subtree, aval, scaling, child_contrib, options, stats);
    }
 }
 
 extern "C"
-void spral_ssids_cpu_destroy_num_subtree_dbl(bool posdef, void* target) {
+void spral_ssids_cpu_destroy_num_subtree_dbl(bool posdef, bool single,
+      void* target) {
    if(!target) return;
 
    if(posdef) {
-      auto *subtree = static_cast<NumericSubtreePosdef*>(target);
-      delete subtree;
+      if(single) delete static_cast<NumericSubtreePosdefFlt*>(target);
+      else       delete static_cast<NumericSubtreePosdef*>(target);
    } else {
-      auto *subtree = static_cast<NumericSubtreeIndef*>(target);
-      delete subtree;
+      if(single) delete static_cast<NumericSubtreeIndefFlt*>(target);
+      else       delete static_cast<NumericSubtreeIndef*>(target);
    }
 }
 
@@ -75,22 +97,92 @@ void spral_ssids_cpu_destroy_num_subtree_dbl(bool posdef, void* target) {
 extern "C"
 Flag spral_ssids_cpu_subtree_solve_fwd_dbl(
       bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
       void const* subtree_ptr,// pointer to relevant type of NumericSubtree
       int nrhs,         // number of right-hand sides
       double* x,        // ldx x nrhs array of right-hand sides
+      int ldx,          // leading dimension of x
+      bool const* active, // nodes to solve, null for all
+      double* root_contrib // if not null, root updates are returned here
+      ) {
+
+   // Call method
+   try {
+      if(posdef) { // Converting from runtime to compile time posdef value
+         if(single)
+            static_cast<NumericSubtreePosdefFlt const*>(subtree_ptr)
+               ->solve_fwd(nrhs, x, ldx, active, root_contrib);
+         else
+            static_cast<NumericSubtreePosdef const*>(subtree_ptr)
+               ->solve_fwd(nrhs, x, ldx, active, root_contrib);
+      } else {
+         if(single)
+            static_cast<NumericSubtreeIndefFlt const*>(subtree_ptr)
+               ->solve_fwd(nrhs, x, ldx, active, root_contrib);
+         else
+            static_cast<NumericSubtreeIndef const*>(subtree_ptr)
+               ->solve_fwd(nrhs, x, ldx, active, root_contrib);
+      }
+   } catch(std::bad_alloc const&) {
+      return Flag::ERROR_ALLOCATION;
+   }
+   return Flag::SUCCESS;
+}
+
+/* Double precision wrapper around templated routines */
+extern "C"
+int64_t spral_ssids_cpu_subtree_root_contrib_size_dbl(
+      bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
+      void const* subtree_ptr // pointer to relevant type of NumericSubtree
+      ) {
+
+   // Call method
+   if(posdef) { // Converting from runtime to compile time posdef value
+      if(single)
+         return static_cast<NumericSubtreePosdefFlt const*>(subtree_ptr)
+            ->get_root_contrib_size();
+      else
+         return static_cast<NumericSubtreePosdef const*>(subtree_ptr)
+            ->get_root_contrib_size();
+   } else {
+      if(single)
+         return static_cast<NumericSubtreeIndefFlt const*>(subtree_ptr)
+            ->get_root_contrib_size();
+      else
+         return static_cast<NumericSubtreeIndef const*>(subtree_ptr)
+            ->get_root_contrib_size();
+   }
+}
+
+/* Double precision wrapper around templated routines */
+extern "C"
+Flag spral_ssids_cpu_subtree_add_root_contrib_dbl(
+      bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
+      void const* subtree_ptr,// pointer to relevant type of NumericSubtree
+      int nrhs,         // number of right-hand sides
+      double const* root_contrib, // root updates returned by solve_fwd
+      double* x,        // ldx x nrhs array of right-hand sides
       int ldx           // leading dimension of x
       ) {
 
    // Call method
    try {
       if(posdef) { // Converting from runtime to compile time posdef value
-         auto &subtree =
-            *static_cast<NumericSubtreePosdef const*>(subtree_ptr);
-         subtree.solve_fwd(nrhs, x, ldx);
+         if(single)
+            static_cast<NumericSubtreePosdefFlt const*>(subtree_ptr)
+               ->add_root_contrib(nrhs, root_contrib, x, ldx);
+         else
+            static_cast<NumericSubtreePosdef const*>(subtree_ptr)
+               ->add_root_contrib(nrhs, root_contrib, x, ldx);
       } else {
-         auto &subtree =
-            *static_cast<NumericSubtreeIndef const*>(subtree_ptr);
-         subtree.solve_fwd(nrhs, x, ldx);
+         if(single)
+            static_cast<NumericSubtreeIndefFlt const*>(subtree_ptr)
+               ->add_root_contrib(nrhs, root_contrib, x, ldx);
+         else
+            static_cast<NumericSubtreeIndef const*>(subtree_ptr)
+               ->add_root_contrib(nrhs, root_contrib, x, ldx);
       }
    } catch(std::bad_alloc const&) {
       return Flag::ERROR_ALLOCATION;
@@ -102,20 +194,30 @@ Flag spral_ssids_cpu_subtree_solve_fwd_dbl(
 extern "C"
 Flag spral_ssids_cpu_subtree_solve_diag_dbl(
       bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
       void const* subtree_ptr,// pointer to relevant type of NumericSubtree
       int nrhs,         // number of right-hand sides
       double* x,        // ldx x nrhs array of right-hand sides
-      int ldx           // leading dimension of x
+      int ldx,          // leading dimension of x
+      bool const* active // nodes to solve, null for all
       ) {
 
    // Call method
    try {
       if(posdef) { // Converting from runtime to compile time posdef value
-         auto &subtree = *static_cast<NumericSubtreePosdef const*>(subtree_ptr);
-         subtree.solve_diag(nrhs, x, ldx);
+         if(single)
+            static_cast<NumericSubtreePosdefFlt const*>(subtree_ptr)
+               ->solve_diag(nrhs, x, ldx, active);
+         else
+            static_cast<NumericSubtreePosdef const*>(subtree_ptr)
+               ->solve_diag(nrhs, x, ldx, active);
       } else {
-         auto &subtree = *static_cast<NumericSubtreeIndef const*>(subtree_ptr);
-         subtree.solve_diag(nrhs, x, ldx);
+         if(single)
+            static_cast<NumericSubtreeIndefFlt const*>(subtree_ptr)
+               ->solve_diag(nrhs, x, ldx, active);
+         else
+            static_cast<NumericSubtreeIndef const*>(subtree_ptr)
+               ->solve_diag(nrhs, x, ldx, active);
       }
    } catch(std::bad_alloc const&) {
       return Flag::ERROR_ALLOCATION;
@@ -127,22 +229,30 @@ Flag spral_ssids_cpu_subtree_solve_diag_dbl(
 extern "C"
 Flag spral_ssids_cpu_subtree_solve_diag_bwd_dbl(
       bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
       void const* subtree_ptr,// pointer to relevant type of NumericSubtree
       int nrhs,         // number of right-hand sides
       double* x,        // ldx x nrhs array of right-hand sides
-      int ldx           // leading dimension of x
+      int ldx,          // leading dimension of x
+      bool const* active // nodes to solve, null for all
       ) {
 
    // Call method
    try {
       if(posdef) { // Converting from runtime to compile time posdef value
-         auto &subtree =
-            *static_cast<NumericSubtreePosdef const*>(subtree_ptr);
-         subtree.solve_diag_bwd(nrhs, x, ldx);
+         if(single)
+            static_cast<NumericSubtreePosdefFlt const*>(subtree_ptr)
+               ->solve_diag_bwd(nrhs, x, ldx, active);
+         else
+            static_cast<NumericSubtreePosdef const*>(subtree_ptr)
+               ->solve_diag_bwd(nrhs, x, ldx, active);
       } else {
-         auto &subtree =
-            *static_cast<NumericSubtreeIndef const*>(subtree_ptr);
-         subtree.solve_diag_bwd(nrhs, x, ldx);
+         if(single)
+            static_cast<NumericSubtreeIndefFlt const*>(subtree_ptr)
+               ->solve_diag_bwd(nrhs, x, ldx, active);
+         else
+            static_cast<NumericSubtreeIndef const*>(subtree_ptr)
+               ->solve_diag_bwd(nrhs, x, ldx, active);
       }
    } catch(std::bad_alloc const&) {
       return Flag::ERROR_ALLOCATION;
@@ -154,22 +264,30 @@ Flag spral_ssids_cpu_subtree_solve_diag_bwd_dbl(
 extern "C"
 Flag spral_ssids_cpu_subtree_solve_bwd_dbl(
       bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
       void const* subtree_ptr,// pointer to relevant type of NumericSubtree
       int nrhs,         // number of right-hand sides
       double* x,        // ldx x nrhs array of right-hand sides
-      int ldx           // leading dimension of x
+      int ldx,          // leading dimension of x
+      bool const* active // nodes to solve, null for all
       ) {
 
    // Call method
    try {
       if(posdef) { // Converting from runtime to compile time posdef value
-         auto &subtree =
-            *static_cast<NumericSubtreePosdef const*>(subtree_ptr);
-         subtree.solve_bwd(nrhs, x, ldx);
+         if(single)
+            static_cast<NumericSubtreePosdefFlt const*>(subtree_ptr)
+               ->solve_bwd(nrhs, x, ldx, active);
+         else
+            static_cast<NumericSubtreePosdef const*>(subtree_ptr)
+               ->solve_bwd(nrhs, x, ldx, active);
       } else {
-         auto &subtree =
-            *static_cast<NumericSubtreeIndef const*>(subtree_ptr);
-         subtree.solve_bwd(nrhs, x, ldx);
+         if(single)
+            static_cast<NumericSubtreeIndefFlt const*>(subtree_ptr)
+               ->solve_bwd(nrhs, x, ldx, active);
+         else
+            static_cast<NumericSubtreeIndef const*>(subtree_ptr)
+               ->solve_bwd(nrhs, x, ldx, active);
       }
    } catch(std::bad_alloc const&) {
       return Flag::ERROR_ALLOCATION;
@@ -181,6 +299,7 @@ Flag spral_ssids_cpu_subtree_solve_bwd_dbl(
 extern "C"
 void spral_ssids_cpu_subtree_enquire_dbl(
       bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
       void const* subtree_ptr,// pointer to relevant type of NumericSubtree
       int* piv_order,   // pivot order, may be null, only used if indef
       double* d         // diagonal entries, may be null
@@ -188,13 +307,19 @@ void spral_ssids_cpu_subtree_enquire_dbl(
 
    // Call method
    if(posdef) { // Converting from runtime to compile time posdef value
-      auto &subtree =
-         *static_cast<NumericSubtreePosdef const*>(subtree_ptr);
-      subtree.enquire(piv_order, d);
+      if(single)
+         static_cast<NumericSubtreePosdefFlt const*>(subtree_ptr)
+            ->enquire(piv_order, d);
+      else
+         static_cast<NumericSubtreePosdef const*>(subtree_ptr)
+            ->enquire(piv_order, d);
    } else {
-      auto &subtree =
-         *static_cast<NumericSubtreeIndef const*>(subtree_ptr);
-      subtree.enquire(piv_order, d);
+      if(single)
+         static_cast<NumericSubtreeIndefFlt const*>(subtree_ptr)
+            ->enquire(piv_order, d);
+      else
+         static_cast<NumericSubtreeIndef const*>(subtree_ptr)
+            ->enquire(piv_order, d);
    }
 }
 
@@ -202,6 +327,7 @@ void spral_ssids_cpu_subtree_enquire_dbl(
 extern "C"
 void spral_ssids_cpu_subtree_alter_dbl(
       bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
       void* subtree_ptr,// pointer to relevant type of NumericSubtree
       double const* d   // new diagonal entries
       ) {
@@ -209,14 +335,17 @@ void spral_ssids_cpu_subtree_alter_dbl(
    assert(!posdef); // Should never be called on positive definite matrices.
 
    // Call method
-   auto &subtree = *static_cast<NumericSubtreeIndef*>(subtree_ptr);
-   subtree.alter(d);
+   if(single)
+      static_cast<NumericSubtreeIndefFlt*>(subtree_ptr)->alter(d);
+   else
+      static_cast<NumericSubtreeIndef*>(subtree_ptr)->alter(d);
 }
 
 /* Double precision wrapper around templated routines */
 extern "C"
 void spral_ssids_cpu_subtree_get_contrib_dbl(
       bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
       void* subtree_ptr,// pointer to relevant type of NumericSubtree
       int* n,           // returned dimension of contribution block
       double const** val,     // returned pointer to contribution block
@@ -229,15 +358,21 @@ void spral_ssids_cpu_subtree_get_contrib_dbl(
       ) {
    // Call method
    if(posdef) { // Converting from runtime to compile time posdef value
-      auto &subtree =
-         *static_cast<NumericSubtreePosdef*>(subtree_ptr);
-      subtree.get_contrib(
+      if(single)
+         static_cast<NumericSubtreePosdefFlt*>(subtree_ptr)->get_contrib(
+            *n, *val, *ldval, *rlist, *ndelay, *delay_perm, *delay_val, *lddelay
+            );
+      else
+         static_cast<NumericSubtreePosdef*>(subtree_ptr)->get_contrib(
             *n, *val, *ldval, *rlist, *ndelay, *delay_perm, *delay_val, *lddelay
             );
    } else {
-      auto &subtree =
-         *static_cast<NumericSubtreeIndef*>(subtree_ptr);
-      subtree.get_contrib(
+      if(single)
+         static_cast<NumericSubtreeIndefFlt*>(subtree_ptr)->get_contrib(
+            *n, *val, *ldval, *rlist, *ndelay, *delay_perm, *delay_val, *lddelay
+            );
+      else
+         static_cast<NumericSubtreeIndef*>(subtree_ptr)->get_contrib(
             *n, *val, *ldval, *rlist, *ndelay, *delay_perm, *delay_val, *lddelay
             );
    }
@@ -247,16 +382,19 @@ void spral_ssids_cpu_subtree_get_contrib_dbl(
 extern "C"
 void spral_ssids_cpu_subtree_free_contrib_dbl(
       bool posdef,      // If true, performs A=LL^T, if false do pivoted A=LDL^T
+      bool single,      // If true, factors are stored in single precision
       void* subtree_ptr // pointer to relevant type of NumericSubtree
       ) {
    // Call method
    if(posdef) { // Converting from runtime to compile time posdef value
-      auto &subtree =
-         *static_cast<NumericSubtreePosdef*>(subtree_ptr);
-      subtree.free_contrib();
+      if(single)
+         static_cast<NumericSubtreePosdefFlt*>(subtree_ptr)->free_contrib();
+      else
+         static_cast<NumericSubtreePosdef*>(subtree_ptr)->free_contrib();
    } else {
-      auto &subtree =
-         *static_cast<NumericSubtreeIndef*>(subtree_ptr);
-      subtree.free_contrib();
+      if(single)
+         static_cast<NumericSubtreeIndefFlt*>(subtree_ptr)->free_contrib();
+      else
+         static_cast<NumericSubtreeIndef*>(subtree_ptr)->free_contrib();
    }
 }
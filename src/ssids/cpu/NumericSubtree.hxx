@@ -12,6 +12,7 @@
 #include "ssids/cpu/NumericNode.hxx"
 #include "ssids/cpu/SymbolicSubtree.hxx"
 #include "ssids/cpu/SmallLeafNumericSubtree.hxx"
+#include "ssids/cpu/SubtreeSolver.hxx"
 #include "ssids/cpu/ThreadStats.hxx"
 
 
@@ -34,6 +35,7 @@ class NumericSubtree {
    typedef BuddyAllocator<T,std::allocator<T>> PoolAllocator;
    //typedef SimpleAlignedAllocator<T> PoolAllocator;
    typedef SmallLeafNumericSubtree<posdef, T, FactorAllocator, PoolAllocator> SLNS;
+   typedef SubtreeSolver<posdef, T, PoolAllocator> Solver;
 public:
    /* Delete copy constructors for safety re allocated memory */
    NumericSubtree(const NumericSubtree&) =delete;
@@ -52,13 +54,13 @@ public:
     */
    NumericSubtree(
          SymbolicSubtree const& symbolic_subtree,
-         T const* aval,
-         T const* scaling,
+         double const* aval,
+         double const* scaling,
          void** child_contrib,
          struct cpu_factor_options const& options,
          ThreadStats& stats)
    : symb_(symbolic_subtree),
-     factor_alloc_(symbolic_subtree.get_factor_mem_est(options.multiplier)),
+     factor_alloc_(symbolic_subtree.get_factor_mem_est<T>(options.multiplier)),
      pool_alloc_(symbolic_subtree.get_pool_size<T>()),
      small_leafs_(static_cast<SLNS*>(::operator new[](symb_.small_leafs_.size()*sizeof(SLNS))))
    {
@@ -283,138 +285,50 @@ public:
       delete[] small_leafs_;
    }
 
-   void solve_fwd(int nrhs, double* x, int ldx) const {
-      /* Allocate memory */
-      double* xlocal = new double[nrhs*symb_.n];
-      int* map_alloc = (!posdef) ? new int[symb_.n] : nullptr; // only indef
-
-      /* Main loop */
-      for(int ni=0; ni<symb_.nnodes_; ++ni) {
-         int m = symb_[ni].nrow;
-         int n = symb_[ni].ncol;
-         int nelim = (posdef) ? n
-                              : nodes_[ni].nelim;
-         int ndin = (posdef) ? 0
-                             : nodes_[ni].ndelay_in;
-         int ldl = align_lda<T>(m+ndin);
-
-         /* Build map (indef only) */
-         int const *map;
-         if(!posdef) {
-            // indef need to allow for permutation and/or delays
-            for(int i=0; i<n+ndin; ++i)
-               map_alloc[i] = nodes_[ni].perm[i];
-            for(int i=n; i<m; ++i)
-               map_alloc[i+ndin] = symb_[ni].rlist[i];
-            map = map_alloc;
-         } else {
-            // posdef there is no permutation
-            map = symb_[ni].rlist;
-         }
-
-         /* Gather into dense vector xlocal */
-         // FIXME: don't bother copying elements of x > m, just use beta=0
-         //        in dgemm call and then add as we scatter
-         for(int r=0; r<nrhs; ++r)
-         for(int i=0; i<m+ndin; ++i)
-            xlocal[r*symb_.n+i] = x[r*ldx + map[i]-1]; // Fortran indexed
-
-         /* Perform dense solve */
-         if(posdef) {
-            cholesky_solve_fwd(m, n, nodes_[ni].lcol, ldl, nrhs, xlocal, symb_.n);
-         } else { /* indef */
-            ldlt_app_solve_fwd(m+ndin, nelim, nodes_[ni].lcol, ldl, nrhs,
-                  xlocal, symb_.n);
-         }
-
-         /* Scatter result */
-         for(int r=0; r<nrhs; ++r)
-         for(int i=0; i<m+ndin; ++i)
-            x[r*ldx + map[i]-1] = xlocal[r*symb_.n+i];
-      }
-
-      /* Cleanup memory */
-      if(!posdef) delete[] map_alloc; // only used in indef case
-      delete[] xlocal;
+   /** \brief Perform forward solve \f$ Lx = b \f$ with the factors of this
+    *         subtree (see SubtreeSolver::solve_fwd()).
+    *  \param active If not null, only nodes ni with active[ni] true are
+    *         solved.
+    *  \param root_contrib If not null, updates from the roots of the subtree
+    *         are returned here rather than added to x.
+    */
+   void solve_fwd(int nrhs, double* x, int ldx,
+         bool const* active=nullptr, double* root_contrib=nullptr) const {
+      Solver(symb_, nodes_).solve_fwd(nrhs, x, ldx, active, root_contrib);
    }
 
-   template <bool do_diag, bool do_bwd>
-   void solve_diag_bwd_inner(int nrhs, double* x, int ldx) const {
-      if(posdef && !do_bwd) return; // diagonal solve is a no-op for posdef
-
-      /* Allocate memory - map only needed for indef bwd/diag_bwd solve */
-      double* xlocal = new double[nrhs*symb_.n];
-      int* map_alloc = (!posdef && do_bwd) ? new int[symb_.n]
-                                           : nullptr;
-
-      /* Perform solve */
-      for(int ni=symb_.nnodes_-1; ni>=0; --ni) {
-         int m = symb_[ni].nrow;
-         int n = symb_[ni].ncol;
-         int nelim = (posdef) ? n
-                              : nodes_[ni].nelim;
-         int ndin = (posdef) ? 0
-                             : nodes_[ni].ndelay_in;
-
-         /* Build map (indef only) */
-         int const *map;
-         if(!posdef) {
-            // indef need to allow for permutation and/or delays
-            if(do_bwd) {
-               for(int i=0; i<n+ndin; ++i)
-                  map_alloc[i] = nodes_[ni].perm[i];
-               for(int i=n; i<m; ++i)
-                  map_alloc[i+ndin] = symb_[ni].rlist[i];
-               map = map_alloc;
-            } else { // if only doing diagonal, only need first nelim<=n+ndin
-               map = nodes_[ni].perm;
-            }
-         } else {
-            // posdef there is no permutation
-            map = symb_[ni].rlist;
-         }
-
-         /* Gather into dense vector xlocal */
-         int blkm = (do_bwd) ? m+ndin
-                             : nelim;
-         int ldl = align_lda<T>(m+ndin);
-         for(int r=0; r<nrhs; ++r)
-         for(int i=0; i<blkm; ++i)
-            xlocal[r*symb_.n+i] = x[r*ldx + map[i]-1];
-
-         /* Perform dense solve */
-         if(posdef) {
-            cholesky_solve_bwd(m, n, nodes_[ni].lcol, ldl, nrhs, xlocal, symb_.n);
-         } else {
-            if(do_diag) ldlt_app_solve_diag(
-                  nelim, &nodes_[ni].lcol[(n+ndin)*ldl], nrhs, xlocal, symb_.n
-                  );
-            if(do_bwd) ldlt_app_solve_bwd(
-                  m+ndin, nelim, nodes_[ni].lcol, ldl, nrhs, xlocal, symb_.n
-                  );
-         }
-
-         /* Scatter result (only first nelim entries have changed) */
-         for(int r=0; r<nrhs; ++r)
-         for(int i=0; i<nelim; ++i)
-            x[r*ldx + map[i]-1] = xlocal[r*symb_.n+i];
-      }
+   /** \brief Return size per right-hand side of root_contrib in
+    *         solve_fwd(). */
+   size_t get_root_contrib_size() const {
+      return Solver(symb_, nodes_).get_root_contrib_size();
+   }
 
-      /* Cleanup memory */
-      if(!posdef && do_bwd) delete[] map_alloc; // only used in indef case
-      delete[] xlocal;
+   /** \brief Add updates returned by solve_fwd() in root_contrib to x. */
+   void add_root_contrib(int nrhs, double const* root_contrib, double* x,
+         int ldx) const {
+      Solver(symb_, nodes_).add_root_contrib(nrhs, root_contrib, x, ldx);
    }
 
-   void solve_diag(int nrhs, double* x, int ldx) const {
-      solve_diag_bwd_inner<true, false>(nrhs, x, ldx);
+   /** \brief Perform diagonal solve \f$ Dx = b \f$ (indef only). */
+   void solve_diag(int nrhs, double* x, int ldx,
+         bool const* active=nullptr) const {
+      Solver(symb_, nodes_).template solve_diag_bwd<true, false>(
+            nrhs, x, ldx, active);
    }
 
-   void solve_diag_bwd(int nrhs, double* x, int ldx) const {
-      solve_diag_bwd_inner<true, true>(nrhs, x, ldx);
+   /** \brief Perform combined diagonal and backward solve
+    *         \f$ DL^Tx = b \f$. */
+   void solve_diag_bwd(int nrhs, double* x, int ldx,
+         bool const* active=nullptr) const {
+      Solver(symb_, nodes_).template solve_diag_bwd<true, true>(
+            nrhs, x, ldx, active);
    }
 
-   void solve_bwd(int nrhs, double* x, int ldx) const {
-      solve_diag_bwd_inner<false, true>(nrhs, x, ldx);
+   /** \brief Perform backward solve \f$ L^Tx = b \f$. */
+   void solve_bwd(int nrhs, double* x, int ldx,
+         bool const* active=nullptr) const {
+      Solver(symb_, nodes_).template solve_diag_bwd<false, true>(
+            nrhs, x, ldx, active);
    }
 
    /** Returns information on diagonal entries and/or pivot order.
@@ -436,7 +350,7 @@ public:
             int blkn = symb_[ni].ncol + nodes_[ni].ndelay_in;
             int ldl = align_lda<T>(blkm);
             int nelim = nodes_[ni].nelim;
-            double const* dptr = &nodes_[ni].lcol[blkn*ldl];
+            T const* dptr = &nodes_[ni].lcol[blkn*ldl];
             for(int i=0; i<nelim; ) {
                if(i+1==nelim || std::isfinite(dptr[2*i+2])) {
                   /* 1x1 pivot */
@@ -474,7 +388,7 @@ public:
          int blkn = symb_[ni].ncol + nodes_[ni].ndelay_in;
          int ldl = align_lda<T>(blkm);
          int nelim = nodes_[ni].nelim;
-         double* dptr = &nodes_[ni].lcol[blkn*ldl];
+         T* dptr = &nodes_[ni].lcol[blkn*ldl];
          double dum;
          for(int i=0; i<nelim; ) {
             if(i+1==nelim || std::isfinite(dptr[2*i+2])) {
@@ -514,37 +428,58 @@ public:
 		}
 	}
 
-   /** Return contribution block from subtree (if not a real root) */
-   void get_contrib(int& n, T const*& val, int& ldval, int const*& rlist,
-         int& ndelay, int const*& delay_perm, T const*& delay_val,
-         int& lddelay) const {
+   /** Return contribution block from subtree (if not a real root).
+    *  Values are always returned in double precision: if T is narrower they
+    *  are copied into buffers owned by this subtree until free_contrib(). */
+   void get_contrib(int& n, double const*& val, int& ldval, int const*& rlist,
+         int& ndelay, int const*& delay_perm, double const*& delay_val,
+         int& lddelay) {
       auto& root = *nodes_.back().first_child;
       n = root.symb.nrow - root.symb.ncol;
-      val = root.contrib;
+      val = as_double(root.contrib, static_cast<size_t>(n)*n, contrib_dbl_);
       ldval = n;
       rlist = &root.symb.rlist[root.symb.ncol];
       ndelay = root.ndelay_out;
       delay_perm = (ndelay>0) ? &root.perm[root.nelim]
                               : nullptr;
       lddelay = align_lda<T>(root.symb.nrow + root.ndelay_in);
-      delay_val = (ndelay>0) ? &root.lcol[root.nelim*(lddelay+1)]
-                             : nullptr;
+      delay_val = (ndelay>0) ?
+         as_double(&root.lcol[root.nelim*(lddelay+1)],
+               static_cast<size_t>(ndelay-1)*lddelay + ndelay + n, delay_dbl_)
+         : nullptr;
    }
 
    /** Frees root's contribution block */
    void free_contrib() {
       nodes_.back().first_child->free_contrib();
+      std::vector<double>().swap(contrib_dbl_);
+      std::vector<double>().swap(delay_dbl_);
    }
 
    SymbolicSubtree const& get_symbolic_subtree() { return symb_; }
 
 private:
+   /** \brief Return src as an array of len doubles, converting it into buf
+    *         if T is not double. */
+   static double const* as_double(double const* src, size_t /*len*/,
+         std::vector<double>& /*buf*/) {
+      return src;
+   }
+   static double const* as_double(float const* src, size_t len,
+         std::vector<double>& buf) {
+      if(!src) return nullptr;
+      buf.assign(src, src+len);
+      return buf.data();
+   }
+
    SymbolicSubtree const& symb_;
    FactorAllocator factor_alloc_;
    PoolAllocator pool_alloc_;
    std::vector<NumericNode<T,PoolAllocator>> nodes_;
    SLNS *small_leafs_; // Apparently emplace_back isn't threadsafe, so
       // std::vector is out. So we use placement new instead.
+   std::vector<double> contrib_dbl_; //< double copy of contrib if T!=double
+   std::vector<double> delay_dbl_; //< double copy of delays if T!=double
 };
 
 }}} /* end of namespace spral::ssids::cpu */
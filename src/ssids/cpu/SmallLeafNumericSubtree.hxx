@@ -31,20 +31,24 @@ template <typename T,
           typename PoolAllocator // Allocator for pool memory usage
           >
 class SmallLeafNumericSubtree<true, T, FactorAllocator, PoolAllocator> {
-   typedef typename std::allocator_traits<FactorAllocator>::template rebind_traits<double> FADoubleTraits;
+   typedef typename std::allocator_traits<FactorAllocator>::template rebind_traits<T> FATTraits;
    typedef typename std::allocator_traits<FactorAllocator>::template rebind_traits<int> FAIntTraits;
    typedef std::allocator_traits<PoolAllocator> PATraits;
 public:
-   SmallLeafNumericSubtree(SmallLeafSymbolicSubtree const& symb, std::vector<NumericNode<T,PoolAllocator>>& old_nodes, T const* aval, T const* scaling, FactorAllocator& factor_alloc, PoolAllocator& pool_alloc, std::vector<Workspace>& work_vec, struct cpu_factor_options const& options, ThreadStats& stats)
-      : old_nodes_(old_nodes), symb_(symb), lcol_(FADoubleTraits::allocate(factor_alloc, symb.nfactor_))
+   SmallLeafNumericSubtree(SmallLeafSymbolicSubtree const& symb, std::vector<NumericNode<T,PoolAllocator>>& old_nodes, double const* aval, double const* scaling, FactorAllocator& factor_alloc, PoolAllocator& pool_alloc, std::vector<Workspace>& work_vec, struct cpu_factor_options const& options, ThreadStats& stats)
+      : old_nodes_(old_nodes), symb_(symb), nfactor_(calc_nfactor(symb)),
+        lcol_(FATTraits::allocate(factor_alloc, nfactor_))
    {
       Workspace& work = work_vec[omp_get_thread_num()];
       /* Initialize nodes */
+      T* lcol = lcol_;
       for(int ni=symb_.sa_; ni<=symb_.en_; ++ni) {
          old_nodes_[ni].ndelay_in = 0;
-         old_nodes_[ni].lcol = lcol_ + symb_[ni-symb_.sa_].lcol_offset;
+         old_nodes_[ni].lcol = lcol;
+         auto const& snode = symb_[ni-symb_.sa_];
+         lcol += snode.ncol*align_lda<T>(snode.nrow);
       }
-      memset(lcol_, 0, symb_.nfactor_*sizeof(T));
+      memset(lcol_, 0, nfactor_*sizeof(T));
 
       /* Add aval entries */
       for(int ni=symb_.sa_; ni<=symb_.en_; ++ni)
@@ -63,21 +67,29 @@ public:
          int ncol = symb_.symb_[ni].ncol;
          stats.maxsupernode = std::max(stats.maxsupernode, ncol);
          // Factorization
-         factor_node_posdef
+         factor_node_posdef<T>
             (1.0, symb_.symb_[ni], old_nodes_[ni], options, stats);
          if(stats.flag<Flag::SUCCESS) return;
       }
    }
 
 private:
+/** Number of entries of type T required for all factors of subtree */
+static size_t calc_nfactor(SmallLeafSymbolicSubtree const& symb) {
+   size_t nfactor = 0;
+   for(int ni=symb.sa_; ni<=symb.en_; ++ni)
+      nfactor += symb[ni-symb.sa_].ncol*align_lda<T>(symb[ni-symb.sa_].nrow);
+   return nfactor;
+}
+
 void add_a(
       int si,
       SymbolicNode const& snode,
-      T const* aval,
-      T const* scaling
+      double const* aval,
+      double const* scaling
       ) {
-   double *lcol = lcol_ + symb_[si].lcol_offset;
-   size_t ldl = align_lda<double>(snode.nrow);
+   T *lcol = old_nodes_[symb_.sa_+si].lcol;
+   size_t ldl = align_lda<T>(snode.nrow);
    if(scaling) {
       /* Scaling to apply */
       for(int i=0; i<snode.num_a; i++) {
@@ -110,8 +122,8 @@ void assemble(
       FactorAllocator& factor_alloc,
       PoolAllocator& pool_alloc,
       int* map,
-      T const* aval,
-      T const* scaling
+      double const* aval,
+      double const* scaling
       ) {
    /* Rebind allocators */
    typename FAIntTraits::allocator_type factor_alloc_int(factor_alloc);
@@ -149,7 +161,7 @@ void assemble(
                T *src = &child->contrib[i*cm];
                if(c < snode.ncol) {
                   // Contribution added to lcol
-                  int ldd = align_lda<double>(nrow);
+                  int ldd = align_lda<T>(nrow);
                   T *dest = &node->lcol[c*ldd];
                   for(int j=i; j<cm; j++) {
                      int r = map[ csnode.rlist[csnode.ncol+j] ];
@@ -176,6 +188,7 @@ void assemble(
 private:
    std::vector<NumericNode<T,PoolAllocator>>& old_nodes_;
    SmallLeafSymbolicSubtree const& symb_;
+   size_t nfactor_; //< Number of entries in factor for subtree.
    T* lcol_;
 };
 
@@ -185,11 +198,11 @@ template <typename T,
           typename PoolAllocator // Allocator for pool memory usage
           >
 class SmallLeafNumericSubtree<false, T, FactorAllocator, PoolAllocator> {
-   typedef typename std::allocator_traits<FactorAllocator>::template rebind_traits<double> FADoubleTraits;
+   typedef typename std::allocator_traits<FactorAllocator>::template rebind_traits<T> FATTraits;
    typedef typename std::allocator_traits<FactorAllocator>::template rebind_traits<int> FAIntTraits;
    typedef std::allocator_traits<PoolAllocator> PATraits;
 public:
-   SmallLeafNumericSubtree(SmallLeafSymbolicSubtree const& symb, std::vector<NumericNode<T,PoolAllocator>>& old_nodes, T const* aval, T const* scaling, FactorAllocator& factor_alloc, PoolAllocator& pool_alloc, std::vector<Workspace>& work_vec, struct cpu_factor_options const& options, ThreadStats& stats)
+   SmallLeafNumericSubtree(SmallLeafSymbolicSubtree const& symb, std::vector<NumericNode<T,PoolAllocator>>& old_nodes, double const* aval, double const* scaling, FactorAllocator& factor_alloc, PoolAllocator& pool_alloc, std::vector<Workspace>& work_vec, struct cpu_factor_options const& options, ThreadStats& stats)
    : old_nodes_(old_nodes), symb_(symb)
    {
       Workspace& work = work_vec[omp_get_thread_num()];
@@ -226,11 +239,11 @@ private:
          FactorAllocator& factor_alloc,
          PoolAllocator& pool_alloc,
          int* map,
-         T const* aval,
-         T const* scaling
+         double const* aval,
+         double const* scaling
          ) {
       /* Rebind allocators */
-      typename FADoubleTraits::allocator_type factor_alloc_double(factor_alloc);
+      typename FATTraits::allocator_type factor_alloc_t(factor_alloc);
       typename FAIntTraits::allocator_type factor_alloc_int(factor_alloc);
 
       /* Count incoming delays and determine size of node */
@@ -243,9 +256,9 @@ private:
 
       /* Get space for node now we know it size using Fortran allocator + zero it*/
       // NB L is  nrow x ncol and D is 2 x ncol (but no D if posdef)
-      size_t ldl = align_lda<double>(nrow);
+      size_t ldl = align_lda<T>(nrow);
       size_t len = (ldl+2) * ncol; // +2 is for D
-      node.lcol = FADoubleTraits::allocate(factor_alloc_double, len);
+      node.lcol = FATTraits::allocate(factor_alloc_t, len);
       memset(node.lcol, 0, len*sizeof(T));
 
       /* Get space for contribution block + (explicitly do not zero it!) */
@@ -33,7 +33,6 @@ private:
       int ncol;
       int sparent;
       int* rlist;
-      int lcol_offset;
    };
 
 public:
@@ -79,7 +78,6 @@ public:
      nptr_(nptr), nlist_(nlist), symb_(symb)
    {
       /* Setup basic node information */
-      nfactor_ = 0;
       int* newrlist = rlist_.get();
       for(int ni=sa; ni<=en; ++ni) {
          nodes_[ni-sa].nrow = rptr[part_offset+ni+1] - rptr[part_offset+ni];
@@ -87,9 +85,6 @@ public:
          nodes_[ni-sa].sparent = sparent[part_offset+ni]-sa-1; // sparent is Fortran indexed
          // FIXME: subtract ncol off rlist for elim'd vars
          nodes_[ni-sa].rlist = &newrlist[rptr[part_offset+ni]-rptr[part_offset+sa]];
-         nodes_[ni-sa].lcol_offset = nfactor_;
-         size_t ldl = align_lda<double>(nodes_[ni-sa].nrow);
-         nfactor_ += nodes_[ni-sa].ncol*ldl;
       }
       /* Construct rlist_ being offsets into parent node */
       for(int ni=sa; ni<=en; ++ni) {
@@ -110,13 +105,16 @@ public:
 
    /** \brief Return parent node of subtree in parttree indexing. */
    int get_parent() const { return parent_; }
+   /** \brief Return first node of subtree in parttree indexing. */
+   int get_sa() const { return sa_; }
+   /** \brief Return last node (root) of subtree in parttree indexing. */
+   int get_en() const { return en_; }
    /** \brief Return given node of this tree. */
    Node const& operator[](int idx) const { return nodes_[idx]; }
 protected:
    int sa_; //< First node in subtree.
    int en_; //< Last node in subtree.
    int nnodes_; //< Number of nodes in subtree.
-   int nfactor_; //< Number of entries in factor for subtree.
    int parent_; //< Parent of subtree in parttree.
    std::vector<Node> nodes_; //< Nodes of this subtree.
    std::shared_ptr<int> rlist_; //< Row entries of this subtree.
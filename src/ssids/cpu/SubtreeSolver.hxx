@@ -0,0 +1,506 @@
+/** \file
+ *  \copyright 2026 The SPRAL developers
+ *  \licence   BSD licence, see LICENCE file for details
+ */
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <omp.h>
+
+#include "ssids/cpu/cpu_iface.hxx"
+#include "ssids/cpu/NumericNode.hxx"
+#include "ssids/cpu/SymbolicSubtree.hxx"
+#include "ssids/cpu/kernels/cholesky.hxx"
+#include "ssids/cpu/kernels/ldlt_app.hxx"
+
+namespace spral { namespace ssids { namespace cpu {
+
+/** \brief Solves with the factors of a subtree held as NumericNode objects.
+ *
+ * Shared by NumericSubtree and BandNumericSubtree, which construct one on
+ * demand for each solve. Only references to the subtree's symbolic and
+ * numeric nodes are held.
+ *
+ * \tparam posdef true for Cholesky factorization, false for indefinite LDL^T
+ * \tparam T underlying numerical type e.g. double
+ * \tparam PoolAllocator allocator of the nodes' contribution blocks
+ */
+template <bool posdef, typename T, typename PoolAllocator>
+class SubtreeSolver {
+public:
+   /** \brief Constructor.
+    *  \param symb symbolic subtree.
+    *  \param nodes numeric nodes of the subtree, followed by a virtual root
+    *         whose children are the roots of the subtree.
+    */
+   SubtreeSolver(SymbolicSubtree const& symb,
+         std::vector<NumericNode<T,PoolAllocator>> const& nodes)
+   : symb_(symb), nodes_(nodes)
+   {}
+
+   /** \brief Perform forward solve \f$ Lx = b \f$ with the factors of the
+    *         subtree.
+    *
+    * Nodes are solved as OpenMP tasks following the assembly tree, so that
+    * siblings run concurrently (small leaf subtrees are solved as single
+    * tasks). Each node writes to x only the rows it eliminates. Its updates
+    * to the remaining rows of its front are instead kept in its own
+    * contribution buffer, which its parent adds into its front in a fixed
+    * order, so no two tasks write the same row and the result does not
+    * depend on the number of threads. A buffer is allocated when its node
+    * is solved and freed once its parent has added it in, so only those of
+    * nodes whose parent is still to be solved are held at once. The updates
+    * of the roots of the subtree are added to x once all nodes are solved,
+    * or are returned in root_contrib to be added later by
+    * add_root_contrib().
+    *
+    * If called from within a parallel region, tasks are executed by the
+    * current team; otherwise the nodes are solved in turn.
+    *
+    * \param active If not null, only nodes ni with active[ni] true are
+    *        solved. The set of active nodes must contain the parent of each
+    *        active node within the subtree, and the rows of x eliminated at
+    *        inactive nodes must be zero, as their updates are skipped.
+    * \param root_contrib If not null, the updates of the roots are stored
+    *        here rather than added to x. Must be of size
+    *        nrhs*get_root_contrib_size().
+    */
+   void solve_fwd(int nrhs, double* x, int ldx,
+         bool const* active=nullptr, double* root_contrib=nullptr) const {
+      /* Contribution buffer of each node, allocated as it is solved */
+      std::vector<std::unique_ptr<T[]>> contrib(symb_.nnodes_);
+      bool failed = false; // set if a buffer could not be allocated
+
+      /* Allocate per-thread workspace up front (tasks may not throw) */
+      int num_threads = omp_get_num_threads();
+      std::vector<SolveWorkspace> work;
+      work.reserve(num_threads);
+      for(int i=0; i<num_threads; ++i)
+         work.emplace_back(nrhs, get_maxfront(), symb_.n, !posdef);
+
+      /* Main loop: each node depend(inout) on itself and depend(in) on its
+       * parent, so a node starts only once all its children are done */
+      #pragma omp taskgroup
+      {
+         for(unsigned int si=0; si<symb_.small_leafs_.size(); ++si) {
+            auto const& leaf = symb_.small_leafs_[si];
+            if(!is_active(active, leaf.get_en())) continue; // none active
+            auto* parent_node = nodes_.data() +
+               std::min(leaf.get_parent(), symb_.nnodes_);
+            #pragma omp task default(none) \
+               firstprivate(si) \
+               shared(nrhs, x, ldx, contrib, failed, work, active) \
+               depend(in: parent_node[0:1])
+            {
+               auto const& leaf = symb_.small_leafs_[si];
+               auto& w = work[omp_get_thread_num()];
+               for(int ni=leaf.get_sa(); ni<=leaf.get_en(); ++ni) {
+                  if(!is_active(active, ni)) continue;
+                  solve_fwd_node(ni, nrhs, x, ldx, contrib, failed, active,
+                        w);
+               }
+            }
+         }
+         for(int ni=0; ni<symb_.nnodes_; ++ni) {
+            if(symb_[ni].insmallleaf) continue; // already handled
+            if(!is_active(active, ni)) continue;
+            auto* this_node = &nodes_[ni];
+            auto* parent_node = nodes_.data() +
+               std::min(symb_[ni].parent, symb_.nnodes_);
+            #pragma omp task default(none) \
+               firstprivate(ni) \
+               shared(nrhs, x, ldx, contrib, failed, work, active) \
+               depend(inout: this_node[0:1]) \
+               depend(in: parent_node[0:1])
+            solve_fwd_node(ni, nrhs, x, ldx, contrib, failed, active,
+                  work[omp_get_thread_num()]);
+         }
+      } // taskgroup
+      if(failed) throw std::bad_alloc();
+
+      /* Gather updates from roots of subtree, zero for inactive roots */
+      std::vector<double> root_work;
+      if(!root_contrib) {
+         root_work.resize(nrhs*get_root_contrib_size());
+         root_contrib = root_work.data();
+      }
+      for(auto* root=nodes_[symb_.nnodes_].first_child; root!=nullptr;
+            root=root->next_child) {
+         int ni = root->symb.idx;
+         int clen = symb_[ni].nrow + get_ndelay_in(ni) - get_nelim(ni);
+         if(is_active(active, ni)) {
+            T const* src = contrib[ni].get();
+            for(int i=0; i<nrhs*clen; ++i) root_contrib[i] = src[i];
+         } else {
+            for(int i=0; i<nrhs*clen; ++i) root_contrib[i] = 0.0;
+         }
+         root_contrib += nrhs*clen;
+      }
+
+      /* Add them to x now unless the caller is keeping them */
+      if(!root_work.empty())
+         add_root_contrib(nrhs, root_work.data(), x, ldx);
+   }
+
+   /** \brief Return the number of entries per right-hand side in the updates
+    *         of the roots of the subtree to the rows of its ancestors.
+    */
+   size_t get_root_contrib_size() const {
+      size_t len = 0;
+      for(auto* root=nodes_[symb_.nnodes_].first_child; root!=nullptr;
+            root=root->next_child) {
+         int ni = root->symb.idx;
+         len += symb_[ni].nrow + get_ndelay_in(ni) - get_nelim(ni);
+      }
+      return len;
+   }
+
+   /** \brief Add updates of the roots of the subtree, as returned by
+    *         solve_fwd() in root_contrib, to x.
+    *
+    * Roots are taken in a fixed order as they may share rows.
+    */
+   void add_root_contrib(int nrhs, double const* root_contrib, double* x,
+         int ldx) const {
+      std::vector<int> map_work(get_maxfront());
+      for(auto* root=nodes_[symb_.nnodes_].first_child; root!=nullptr;
+            root=root->next_child) {
+         int ni = root->symb.idx;
+         int nelim = get_nelim(ni);
+         int clen = symb_[ni].nrow + get_ndelay_in(ni) - nelim;
+         if(clen == 0) continue;
+         int const* map = get_row_map(ni, map_work.data());
+         for(int r=0; r<nrhs; ++r)
+         for(int i=0; i<clen; ++i)
+            x[r*ldx + map[nelim+i]-1] += root_contrib[r*clen+i];
+         root_contrib += nrhs*clen;
+      }
+   }
+
+   /** \brief Perform diagonal and/or backward solve with the factors of the
+    *         subtree.
+    *
+    * Nodes are solved as OpenMP tasks from the top of the tree down, each
+    * node waiting for its parent. A node reads from x only rows eliminated by
+    * its ancestors, and writes only the rows it eliminates, so siblings may
+    * run concurrently without conflict.
+    *
+    * \param active If not null, only nodes ni with active[ni] true are
+    *        solved. The set of active nodes must contain the parent of each
+    *        active node within the subtree.
+    */
+   template <bool do_diag, bool do_bwd>
+   void solve_diag_bwd(int nrhs, double* x, int ldx,
+         bool const* active) const {
+      if(posdef && !do_bwd) return; // diagonal solve is a no-op for posdef
+
+      /* Allocate per-thread workspace - map only needed for indef bwd/diag_bwd
+       * solve */
+      int num_threads = omp_get_num_threads();
+      std::vector<SolveWorkspace> work;
+      work.reserve(num_threads);
+      for(int i=0; i<num_threads; ++i)
+         work.emplace_back(nrhs, get_maxfront(), 0, !posdef && do_bwd);
+
+      /* Small leaf subtrees are solved as a single task, started when its
+       * root is reached */
+      std::vector<int> leaf_root(symb_.nnodes_, -1);
+      for(unsigned int si=0; si<symb_.small_leafs_.size(); ++si)
+         leaf_root[symb_.small_leafs_[si].get_en()] = si;
+
+      /* Perform solve: tasks are created parents first, each node
+       * depend(in) on its parent and depend(inout) on itself */
+      #pragma omp taskgroup
+      for(int ni=symb_.nnodes_-1; ni>=0; --ni) {
+         if(!is_active(active, ni)) continue;
+         auto* this_node = &nodes_[ni];
+         auto* parent_node = nodes_.data() +
+            std::min(symb_[ni].parent, symb_.nnodes_);
+         if(symb_[ni].insmallleaf) {
+            if(leaf_root[ni] < 0) continue; // handled with root of leaf
+            int sa = symb_.small_leafs_[leaf_root[ni]].get_sa();
+            #pragma omp task default(none) \
+               firstprivate(ni, sa) \
+               shared(nrhs, x, ldx, work, active) \
+               depend(in: parent_node[0:1])
+            {
+               auto& w = work[omp_get_thread_num()];
+               for(int nj=ni; nj>=sa; --nj) {
+                  if(!is_active(active, nj)) continue;
+                  solve_diag_bwd_node<do_diag, do_bwd>(nj, nrhs, x, ldx, w);
+               }
+            }
+         } else {
+            #pragma omp task default(none) \
+               firstprivate(ni) \
+               shared(nrhs, x, ldx, work) \
+               depend(inout: this_node[0:1]) \
+               depend(in: parent_node[0:1])
+            solve_diag_bwd_node<do_diag, do_bwd>(ni, nrhs, x, ldx, work[omp_get_thread_num()]);
+         }
+      }
+   }
+
+private:
+   /** \brief Per-thread workspace for solves. */
+   struct SolveWorkspace {
+      SolveWorkspace(int nrhs, int maxfront, int n, bool need_map)
+      : ldxlocal(maxfront), xlocal(static_cast<size_t>(nrhs)*maxfront),
+        map(need_map ? maxfront : 0), cmap(need_map ? maxfront : 0),
+        pos(n+1)
+      {}
+      int ldxlocal; //< Leading dimension of xlocal
+      std::vector<T> xlocal; //< Dense right-hand sides of a front
+      std::vector<int> map; //< Row map of a front (indef only)
+      std::vector<int> cmap; //< Row map of a child's front (indef only)
+      std::vector<int> pos; //< Position of each row of x in a front
+   };
+
+   /** \brief Return number of columns eliminated at node ni. */
+   int get_nelim(int ni) const {
+      return (posdef) ? symb_[ni].ncol : nodes_[ni].nelim;
+   }
+
+   /** \brief Return number of delayed columns passed into node ni. */
+   int get_ndelay_in(int ni) const {
+      return (posdef) ? 0 : nodes_[ni].ndelay_in;
+   }
+
+   /** \brief Return number of right-hand sides to solve at once with a
+    *         front of blkm rows of which nelim are eliminated.
+    *
+    * If the node's factors fit in cache (256KB), they are reused across
+    * panels of right-hand sides sized so that a panel of the front fits in
+    * cache too, but at least 16 wide so the updates are still BLAS-3.
+    * Otherwise all right-hand sides are taken at once, so the factors are
+    * only streamed from memory once.
+    */
+   static int get_rhs_panel(int blkm, int nelim, int nrhs) {
+      long const cache_size = 32*1024; // in doubles
+      if(static_cast<long>(blkm)*nelim > cache_size) return nrhs;
+      return std::min(nrhs,
+            std::max(16, static_cast<int>(cache_size / std::max(blkm, 1))));
+   }
+
+   /** \brief Return true if node ni is to be solved, given the active
+    *         array passed to a solve (null if all nodes are solved). */
+   static bool is_active(bool const* active, int ni) {
+      return !active || active[ni];
+   }
+
+   /** \brief Return largest front, including delays. */
+   int get_maxfront() const {
+      int maxfront = 1;
+      for(int ni=0; ni<symb_.nnodes_; ++ni)
+         maxfront = std::max(maxfront, symb_[ni].nrow + get_ndelay_in(ni));
+      return maxfront;
+   }
+
+   /** \brief Return (Fortran-indexed) rows of x corresponding to the front of
+    *         node ni: its fully summed columns in pivot order, followed by
+    *         the rest of its rows.
+    *  \param map_alloc space for the map in the indefinite case. Unused in
+    *         the positive-definite case, where there is no permutation.
+    */
+   int const* get_row_map(int ni, int* map_alloc) const {
+      if(posdef) return symb_[ni].rlist;
+      // indef need to allow for permutation and/or delays
+      int m = symb_[ni].nrow;
+      int n = symb_[ni].ncol;
+      int ndin = nodes_[ni].ndelay_in;
+      for(int i=0; i<n+ndin; ++i)
+         map_alloc[i] = nodes_[ni].perm[i];
+      for(int i=n; i<m; ++i)
+         map_alloc[i+ndin] = symb_[ni].rlist[i];
+      return map_alloc;
+   }
+
+   /** \brief Forward solve with node ni for solve_fwd().
+    *
+    * Only the rows eliminated at the node are gathered from x into xlocal,
+    * together with the parts of its children's contribution buffers that
+    * fall in those rows. After the triangular solve, the update to the
+    * remaining rows is written by GEMM (beta=0) straight into the node's own
+    * contribution buffer contrib[ni], and the rest of the children's
+    * contributions added to it. Thus x is read and written once, and no row
+    * of the front is zeroed or copied. Right-hand sides are processed in
+    * panels (see get_rhs_panel()). The children's buffers are then freed.
+    *
+    * If contrib[ni] cannot be allocated, failed is set. Once it is set,
+    * nodes return at once, as the buffers of their children may be missing.
+    */
+   void solve_fwd_node(int ni, int nrhs, double* x, int ldx,
+         std::vector<std::unique_ptr<T[]>>& contrib, bool& failed,
+         bool const* active, SolveWorkspace& w) const {
+      int m = symb_[ni].nrow;
+      int n = symb_[ni].ncol;
+      int nelim = get_nelim(ni);
+      int ndin = get_ndelay_in(ni);
+      int ldl = align_lda<T>(m+ndin);
+      int blkm = m+ndin;
+      int clen = blkm - nelim;
+      T* xlocal = w.xlocal.data();
+      int ldxlocal = w.ldxlocal;
+
+      bool fail;
+      #pragma omp atomic read
+      fail = failed;
+      if(fail) return;
+      if(clen > 0) {
+         contrib[ni].reset(
+               new (std::nothrow) T[static_cast<size_t>(nrhs)*clen]);
+         if(!contrib[ni]) {
+            #pragma omp atomic write
+            failed = true;
+            return;
+         }
+      }
+
+      int const* map = get_row_map(ni, w.map.data());
+      if(nodes_[ni].first_child) {
+         // Every row of a child's contribution is a row of this node's front
+         // (delays included)
+         for(int i=0; i<blkm; ++i)
+            w.pos[map[i]] = i;
+      }
+
+      int panel = get_rhs_panel(blkm, nelim, nrhs);
+      for(int r0=0; r0<nrhs; r0+=panel) {
+         int nr = std::min(panel, nrhs-r0);
+         double* xp = &x[r0*ldx];
+         T* dest = contrib[ni].get() + static_cast<size_t>(r0)*clen;
+
+         /* Gather rows eliminated here into dense panel xlocal */
+         for(int r=0; r<nr; ++r) {
+            #pragma omp simd
+            for(int i=0; i<nelim; ++i)
+               xlocal[r*ldxlocal+i] = xp[r*ldx + map[i]-1]; // Fortran indexed
+         }
+         add_child_contrib(ni, r0, nr, contrib, active, 0, nelim, xlocal,
+               ldxlocal, w);
+
+         /* Perform dense solve, update to remaining rows goes to dest */
+         if(posdef) {
+            cholesky_solve_fwd(m, n, nodes_[ni].lcol, ldl, nr, xlocal,
+                  ldxlocal, dest, clen);
+         } else { /* indef */
+            ldlt_app_solve_fwd(m+ndin, nelim, nodes_[ni].lcol, ldl, nr,
+                  xlocal, ldxlocal, dest, clen);
+         }
+         if(nelim == 0) {
+            // Nothing eliminated, so nothing written to dest
+            for(int r=0; r<nr; ++r)
+            for(int i=0; i<clen; ++i)
+               dest[r*clen+i] = 0.0;
+         }
+         add_child_contrib(ni, r0, nr, contrib, active, nelim, blkm, dest,
+               clen, w);
+
+         /* Scatter eliminated rows */
+         for(int r=0; r<nr; ++r) {
+            #pragma omp simd
+            for(int i=0; i<nelim; ++i)
+               xp[r*ldx + map[i]-1] = xlocal[r*ldxlocal+i];
+         }
+      }
+
+      /* Children's contributions are now added in, so free them */
+      for(auto* child=nodes_[ni].first_child; child!=nullptr;
+            child=child->next_child)
+         contrib[child->symb.idx].reset();
+   }
+
+   /** \brief Add the parts of the contribution buffers of node ni's children
+    *         that fall in rows [from, to) of its front to the panel of
+    *         right-hand sides r0:r0+nr-1, whose row from is held in y[0].
+    *         Inactive children have no contribution.
+    *  \note w.pos must map each row of the front to its position.
+    */
+   void add_child_contrib(int ni, int r0, int nr,
+         std::vector<std::unique_ptr<T[]>> const& contrib,
+         bool const* active, int from, int to, T* y, int ldy,
+         SolveWorkspace& w) const {
+      for(auto* child=nodes_[ni].first_child; child!=nullptr;
+            child=child->next_child) {
+         int ci = child->symb.idx;
+         if(!is_active(active, ci)) continue;
+         int cnelim = get_nelim(ci);
+         int clen = symb_[ci].nrow + get_ndelay_in(ci) - cnelim;
+         if(clen == 0) continue;
+         int const* cmap = get_row_map(ci, w.cmap.data()) + cnelim;
+         T const* src = contrib[ci].get() + static_cast<size_t>(r0)*clen;
+         for(int r=0; r<nr; ++r)
+         for(int i=0; i<clen; ++i) {
+            int p = w.pos[cmap[i]];
+            if(p >= from && p < to) y[r*ldy + p-from] += src[r*clen+i];
+         }
+      }
+   }
+
+   /** \brief Diagonal and/or backward solve with node ni for
+    *         solve_diag_bwd(). */
+   template <bool do_diag, bool do_bwd>
+   void solve_diag_bwd_node(int ni, int nrhs, double* x, int ldx,
+         SolveWorkspace& w) const {
+      int m = symb_[ni].nrow;
+      int n = symb_[ni].ncol;
+      int nelim = get_nelim(ni);
+      int ndin = get_ndelay_in(ni);
+      T* xlocal = w.xlocal.data();
+      int ldxlocal = w.ldxlocal;
+
+      /* Build map (indef only) */
+      int const *map;
+      if(!posdef && !do_bwd) {
+         // if only doing diagonal, only need first nelim<=n+ndin
+         map = nodes_[ni].perm;
+      } else {
+         map = get_row_map(ni, w.map.data());
+      }
+
+      int blkm = (do_bwd) ? m+ndin
+                          : nelim;
+      int ldl = align_lda<T>(m+ndin);
+      int panel = get_rhs_panel(m+ndin, nelim, nrhs);
+      for(int r0=0; r0<nrhs; r0+=panel) {
+         int nr = std::min(panel, nrhs-r0);
+         double* xp = &x[r0*ldx];
+
+         /* Gather into dense panel xlocal */
+         for(int r=0; r<nr; ++r) {
+            #pragma omp simd
+            for(int i=0; i<blkm; ++i)
+               xlocal[r*ldxlocal+i] = xp[r*ldx + map[i]-1];
+         }
+
+         /* Perform dense solve */
+         if(posdef) {
+            cholesky_solve_bwd(m, n, nodes_[ni].lcol, ldl, nr, xlocal,
+                  ldxlocal);
+         } else {
+            if(do_diag) ldlt_app_solve_diag(
+                  nelim, &nodes_[ni].lcol[(n+ndin)*ldl], nr, xlocal, ldxlocal
+                  );
+            if(do_bwd) ldlt_app_solve_bwd(
+                  m+ndin, nelim, nodes_[ni].lcol, ldl, nr, xlocal, ldxlocal
+                  );
+         }
+
+         /* Scatter result (only first nelim entries have changed) */
+         for(int r=0; r<nr; ++r) {
+            #pragma omp simd
+            for(int i=0; i<nelim; ++i)
+               xp[r*ldx + map[i]-1] = xlocal[r*ldxlocal+i];
+         }
+      }
+   }
+
+   SymbolicSubtree const& symb_;
+   std::vector<NumericNode<T,PoolAllocator>> const& nodes_;
+};
+
+}}} /* end of namespace spral::ssids::cpu */
@@ -87,13 +87,14 @@ public:
    SymbolicNode const& operator[](int idx) const {
       return nodes_[idx];
    }
+   template <typename T>
    size_t get_factor_mem_est(double multiplier) const {
-      size_t mem = n*sizeof(int) + (2*n+nfactor_)*sizeof(double);
+      size_t mem = n*sizeof(int) + (2*n+nfactor_)*sizeof(T);
       return std::max(mem, static_cast<size_t>(mem*multiplier));
    }
    template <typename T>
    size_t get_pool_size() const {
-      return maxfront_*align_lda<double>(maxfront_);
+      return maxfront_*align_lda<T>(maxfront_);
    }
 public:
    int const n; //< Maximum row index
@@ -106,6 +107,10 @@ private:
 
    template <bool posdef, typename T, size_t SSIDS_PAGE_SIZE, typename FactorAlloc>
    friend class NumericSubtree;
+   template <bool posdef, typename T, size_t SSIDS_PAGE_SIZE, typename FactorAlloc>
+   friend class BandNumericSubtree;
+   template <bool posdef, typename T, typename PoolAllocator>
+   friend class SubtreeSolver;
 };
 
 }}} /* end of namespace spral::ssids::cpu */
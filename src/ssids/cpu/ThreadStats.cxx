@@ -27,6 +27,7 @@ ThreadStats& ThreadStats::operator+=(ThreadStats const& other) {
    maxsupernode = std::max(maxsupernode, other.maxsupernode);
    not_first_pass += other.not_first_pass;
    not_second_pass += other.not_second_pass;
+   num_relaxed += other.num_relaxed;
 
    return *this;
 }
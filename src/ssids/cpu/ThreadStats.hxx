@@ -57,6 +57,7 @@ struct ThreadStats {
    int maxsupernode = 0;      ///< Maximum supernode size
    int not_first_pass = 0;    ///< Number of pivots not eliminated in APP
    int not_second_pass = 0;   ///< Number of pivots not eliminated in APP or TPP
+   int num_relaxed = 0; ///< Number of band nodes with a relaxed threshold
 
    ThreadStats& operator+=(ThreadStats const& other);
 };
@@ -0,0 +1,465 @@
+!> \file
+!> \copyright 2026 The SPRAL developers
+!> \licence   BSD licence, see LICENCE file for details
+!
+! Band-specialized CPU subtree. The symbolic subtree is an ordinary
+! cpu_symbolic_subtree describing a chain of nodes (see analyse_band_phase()),
+! but factorization and solves are performed by the C++ BandNumericSubtree.
+! A band subtree is always the only, root, subtree.
+module spral_ssids_cpu_band_subtree
+  use, intrinsic :: iso_c_binding
+  use spral_ssids_contrib, only : contrib_type
+  use spral_ssids_cpu_iface ! fixme only
+  use spral_ssids_cpu_subtree, only : cpu_symbolic_subtree, &
+       cpu_numeric_subtree
+  use spral_ssids_datatypes
+  use spral_ssids_inform, only : ssids_inform
+  use spral_ssids_subtree, only : numeric_subtree_base
+  implicit none
+
+  private
+  public :: cpu_band_symbolic_subtree, construct_cpu_band_symbolic_subtree
+  public :: cpu_band_numeric_subtree
+
+  type, extends(cpu_symbolic_subtree) :: cpu_band_symbolic_subtree
+   contains
+     procedure :: factor
+  end type cpu_band_symbolic_subtree
+
+  type, extends(cpu_numeric_subtree) :: cpu_band_numeric_subtree
+   contains
+     procedure :: get_contrib
+     procedure :: solve_fwd
+     procedure :: get_root_contrib_size
+     procedure :: solve_fwd_contrib
+     procedure :: add_root_contrib
+     procedure :: solve_diag
+     procedure :: solve_diag_bwd
+     procedure :: solve_bwd
+     procedure :: enquire_posdef
+     procedure :: enquire_indef
+     procedure :: alter
+     procedure :: cleanup => numeric_cleanup
+  end type cpu_band_numeric_subtree
+
+  interface
+     type(C_PTR) function c_create_symbolic_subtree(n, sa, en, sptr, sparent, &
+          rptr, rlist, nptr, nlist, ncontrib, contrib_idx, options) &
+          bind(C, name="spral_ssids_cpu_create_symbolic_subtree")
+       use, intrinsic :: iso_c_binding
+       import :: cpu_factor_options
+       implicit none
+       integer(C_INT), value :: n
+       integer(C_INT), value :: sa
+       integer(C_INT), value :: en
+       integer(C_INT), dimension(*), intent(in) :: sptr
+       integer(C_INT), dimension(*), intent(in) :: sparent
+       integer(C_INT64_T), dimension(*), intent(in) :: rptr
+       integer(C_INT), dimension(*), intent(in) :: rlist
+       integer(C_INT64_T), dimension(*), intent(in) :: nptr
+       integer(C_INT64_T), dimension(*), intent(in) :: nlist
+       integer(C_INT), value :: ncontrib
+       integer(C_INT), dimension(*), intent(in) :: contrib_idx
+       type(cpu_factor_options), intent(in) :: options
+     end function c_create_symbolic_subtree
+
+     type(C_PTR) function c_create_band_subtree(posdef, single, &
+          symbolic_subtree, aval, scaling, options, stats) &
+          bind(C, name="spral_ssids_cpu_create_band_subtree_dbl")
+       use, intrinsic :: iso_c_binding
+       import :: cpu_factor_options, cpu_factor_stats
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: symbolic_subtree
+       real(C_DOUBLE), dimension(*), intent(in) :: aval
+       type(C_PTR), value :: scaling
+       type(cpu_factor_options), intent(in) :: options
+       type(cpu_factor_stats), intent(out) :: stats
+     end function c_create_band_subtree
+
+     subroutine c_destroy_band_subtree(posdef, single, subtree) &
+          bind(C, name="spral_ssids_cpu_destroy_band_subtree_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+     end subroutine c_destroy_band_subtree
+
+     integer(C_INT) function c_band_solve_fwd(posdef, single, subtree, nrhs, &
+          x, ldx, active, root_contrib) &
+          bind(C, name="spral_ssids_cpu_band_solve_fwd_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+       integer(C_INT), value :: nrhs
+       real(C_DOUBLE), dimension(*), intent(inout) :: x
+       integer(C_INT), value :: ldx
+       logical(C_BOOL), dimension(*), optional, intent(in) :: active
+       real(C_DOUBLE), dimension(*), optional, intent(out) :: root_contrib
+     end function c_band_solve_fwd
+
+     integer(C_INT64_T) function c_band_root_contrib_size(posdef, single, &
+          subtree) &
+          bind(C, name="spral_ssids_cpu_band_root_contrib_size_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+     end function c_band_root_contrib_size
+
+     integer(C_INT) function c_band_add_root_contrib(posdef, single, &
+          subtree, nrhs, root_contrib, x, ldx) &
+          bind(C, name="spral_ssids_cpu_band_add_root_contrib_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+       integer(C_INT), value :: nrhs
+       real(C_DOUBLE), dimension(*), intent(in) :: root_contrib
+       real(C_DOUBLE), dimension(*), intent(inout) :: x
+       integer(C_INT), value :: ldx
+     end function c_band_add_root_contrib
+
+     integer(C_INT) function c_band_solve_diag(posdef, single, subtree, &
+          nrhs, x, ldx, active) &
+          bind(C, name="spral_ssids_cpu_band_solve_diag_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+       integer(C_INT), value :: nrhs
+       real(C_DOUBLE), dimension(*), intent(inout) :: x
+       integer(C_INT), value :: ldx
+       logical(C_BOOL), dimension(*), optional, intent(in) :: active
+     end function c_band_solve_diag
+
+     integer(C_INT) function c_band_solve_diag_bwd(posdef, single, subtree, &
+          nrhs, x, ldx, active) &
+          bind(C, name="spral_ssids_cpu_band_solve_diag_bwd_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+       integer(C_INT), value :: nrhs
+       real(C_DOUBLE), dimension(*), intent(inout) :: x
+       integer(C_INT), value :: ldx
+       logical(C_BOOL), dimension(*), optional, intent(in) :: active
+     end function c_band_solve_diag_bwd
+
+     integer(C_INT) function c_band_solve_bwd(posdef, single, subtree, nrhs, &
+          x, ldx, active) &
+          bind(C, name="spral_ssids_cpu_band_solve_bwd_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+       integer(C_INT), value :: nrhs
+       real(C_DOUBLE), dimension(*), intent(inout) :: x
+       integer(C_INT), value :: ldx
+       logical(C_BOOL), dimension(*), optional, intent(in) :: active
+     end function c_band_solve_bwd
+
+     subroutine c_band_enquire(posdef, single, subtree, piv_order, d) &
+          bind(C, name="spral_ssids_cpu_band_enquire_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+       type(C_PTR), value :: piv_order
+       type(C_PTR), value :: d
+     end subroutine c_band_enquire
+
+     subroutine c_band_alter(posdef, single, subtree, d) &
+          bind(C, name="spral_ssids_cpu_band_alter_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+       real(C_DOUBLE), dimension(*), intent(in) :: d
+     end subroutine c_band_alter
+  end interface
+
+contains
+
+  !> @brief Construct symbolic subtree for a chain of nodes sptr(1:nnodes+1)
+  !>        holding a band matrix. Node i's parent must be node i+1.
+  function construct_cpu_band_symbolic_subtree(n, nnodes, sptr, sparent, &
+       rptr, rlist, nptr, nlist, options) result(this)
+    implicit none
+    class(cpu_band_symbolic_subtree), pointer :: this
+    integer, intent(in) :: n
+    integer, intent(in) :: nnodes
+    integer, dimension(*), target, intent(in) :: sptr
+    integer, dimension(*), intent(in) :: sparent
+    integer(long), dimension(*), target, intent(in) :: rptr
+    integer, dimension(*), target, intent(in) :: rlist
+    integer(long), dimension(*), target, intent(in) :: nptr
+    integer(long), dimension(2,*), target, intent(in) :: nlist
+    class(ssids_options), intent(in) :: options
+
+    integer :: st
+    integer, dimension(1) :: contrib_idx ! unused, no child subtrees
+    type(cpu_factor_options) :: coptions
+
+    nullify(this)
+
+    ! Allocate output
+    allocate(this, stat=st)
+    if (st .ne. 0) return
+
+    ! Store basic details
+    this%n = n
+
+    ! Call C++ subtree analyse. A zero small subtree threshold ensures the
+    ! chain is not treated as a small leaf subtree.
+    call cpu_copy_options_in(options, coptions)
+    coptions%small_subtree_threshold = 0
+    contrib_idx(1) = 0
+    this%csubtree = &
+         c_create_symbolic_subtree(n, 1, nnodes+1, sptr, sparent, rptr, rlist, &
+         nptr, nlist, 0, contrib_idx, coptions)
+  end function construct_cpu_band_symbolic_subtree
+
+  function factor(this, posdef, aval, child_contrib, options, inform, scaling)
+    implicit none
+    class(numeric_subtree_base), pointer :: factor
+    class(cpu_band_symbolic_subtree), target, intent(inout) :: this
+    logical, intent(in) :: posdef
+    real(wp), dimension(*), target, intent(in) :: aval
+    type(contrib_type), dimension(:), target, intent(inout) :: child_contrib
+    type(ssids_options), intent(in) :: options
+    type(ssids_inform), intent(inout) :: inform
+    real(wp), dimension(*), target, optional, intent(in) :: scaling
+
+    type(cpu_band_numeric_subtree), pointer :: cpu_factor
+    type(cpu_factor_options) :: coptions
+    type(cpu_factor_stats) :: cstats
+    type(C_PTR) :: cscaling
+    integer :: st
+
+    ! Leave output as null until successful exit
+    nullify(factor)
+
+    ! A band subtree is the only subtree, so receives no contributions
+    if (size(child_contrib) .ne. 0) then
+       inform%flag = SSIDS_ERROR_UNKNOWN
+       return
+    end if
+
+    ! Allocate cpu_factor for output
+    allocate(cpu_factor, stat=st)
+    if (st .ne. 0) goto 10
+    cpu_factor%symbolic => this%cpu_symbolic_subtree
+
+    ! Call C++ factor routine
+    cpu_factor%posdef = posdef
+    cpu_factor%single = options%single_precision
+    cscaling = C_NULL_PTR
+    if (present(scaling)) cscaling = C_LOC(scaling)
+    call cpu_copy_options_in(options, coptions)
+    cpu_factor%csubtree = &
+         c_create_band_subtree(cpu_factor%posdef, cpu_factor%single, &
+         this%csubtree, aval, cscaling, coptions, cstats)
+    if (cstats%flag .lt. 0) then
+       call c_destroy_band_subtree(cpu_factor%posdef, cpu_factor%single, &
+            cpu_factor%csubtree)
+       deallocate(cpu_factor, stat=st)
+       inform%flag = cstats%flag
+       return
+    end if
+
+    ! Extract to Fortran data structures
+    call cpu_copy_stats_out(cstats, inform)
+
+    ! Success, set result and return
+    factor => cpu_factor
+    return
+
+    ! Allocation error handler
+10  continue
+    inform%flag = SSIDS_ERROR_ALLOCATION
+    inform%stat = st
+    deallocate(cpu_factor, stat=st)
+    return
+  end function factor
+
+  subroutine numeric_cleanup(this)
+    implicit none
+    class(cpu_band_numeric_subtree), intent(inout) :: this
+
+    call c_destroy_band_subtree(this%posdef, this%single, this%csubtree)
+  end subroutine numeric_cleanup
+
+  !> @brief A band subtree is always a root, so has no contribution block.
+  function get_contrib(this)
+    implicit none
+    type(contrib_type) :: get_contrib
+    class(cpu_band_numeric_subtree), intent(in) :: this
+
+    get_contrib%n = 0
+    nullify(get_contrib%val)
+    get_contrib%ldval = 0
+    nullify(get_contrib%rlist)
+    get_contrib%ndelay = 0
+    nullify(get_contrib%delay_perm)
+    nullify(get_contrib%delay_val)
+    get_contrib%lddelay = 0
+    get_contrib%owner = 0 ! cpu
+    get_contrib%posdef = this%posdef
+    get_contrib%single = this%single
+    get_contrib%owner_ptr = C_NULL_PTR
+  end function get_contrib
+
+  subroutine solve_fwd(this, nrhs, x, ldx, inform, active)
+    implicit none
+    class(cpu_band_numeric_subtree), intent(inout) :: this
+    integer, intent(in) :: nrhs
+    real(wp), dimension(*), intent(inout) :: x
+    integer, intent(in) :: ldx
+    type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
+
+    integer(C_INT) :: flag
+
+    flag = c_band_solve_fwd(this%posdef, this%single, this%csubtree, nrhs, &
+         x, ldx, active)
+    if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
+  end subroutine solve_fwd
+
+  function get_root_contrib_size(this) result(sz)
+    implicit none
+    class(cpu_band_numeric_subtree), intent(in) :: this
+    integer(long) :: sz
+
+    sz = c_band_root_contrib_size(this%posdef, this%single, this%csubtree)
+  end function get_root_contrib_size
+
+  subroutine solve_fwd_contrib(this, nrhs, x, ldx, root_contrib, inform, &
+       active)
+    implicit none
+    class(cpu_band_numeric_subtree), intent(inout) :: this
+    integer, intent(in) :: nrhs
+    real(wp), dimension(*), intent(inout) :: x
+    integer, intent(in) :: ldx
+    real(wp), dimension(*), intent(out) :: root_contrib
+    type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
+
+    integer(C_INT) :: flag
+
+    flag = c_band_solve_fwd(this%posdef, this%single, this%csubtree, nrhs, &
+         x, ldx, active, root_contrib)
+    if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
+  end subroutine solve_fwd_contrib
+
+  subroutine add_root_contrib(this, nrhs, root_contrib, x, ldx, inform)
+    implicit none
+    class(cpu_band_numeric_subtree), intent(inout) :: this
+    integer, intent(in) :: nrhs
+    real(wp), dimension(*), intent(in) :: root_contrib
+    real(wp), dimension(*), intent(inout) :: x
+    integer, intent(in) :: ldx
+    type(ssids_inform), intent(inout) :: inform
+
+    integer(C_INT) :: flag
+
+    flag = c_band_add_root_contrib(this%posdef, this%single, this%csubtree, &
+         nrhs, root_contrib, x, ldx)
+    if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
+  end subroutine add_root_contrib
+
+  subroutine solve_diag(this, nrhs, x, ldx, inform, active)
+    implicit none
+    class(cpu_band_numeric_subtree), intent(inout) :: this
+    integer, intent(in) :: nrhs
+    real(wp), dimension(*), intent(inout) :: x
+    integer, intent(in) :: ldx
+    type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
+
+    integer(C_INT) :: flag
+
+    flag = c_band_solve_diag(this%posdef, this%single, this%csubtree, nrhs, &
+         x, ldx, active)
+    if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
+  end subroutine solve_diag
+
+  subroutine solve_diag_bwd(this, nrhs, x, ldx, inform, active)
+    implicit none
+    class(cpu_band_numeric_subtree), intent(inout) :: this
+    integer, intent(in) :: nrhs
+    real(wp), dimension(*), intent(inout) :: x
+    integer, intent(in) :: ldx
+    type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
+
+    integer(C_INT) :: flag
+
+    flag = c_band_solve_diag_bwd(this%posdef, this%single, this%csubtree, &
+         nrhs, x, ldx, active)
+    if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
+  end subroutine solve_diag_bwd
+
+  subroutine solve_bwd(this, nrhs, x, ldx, inform, active)
+    implicit none
+    class(cpu_band_numeric_subtree), intent(inout) :: this
+    integer, intent(in) :: nrhs
+    real(wp), dimension(*), intent(inout) :: x
+    integer, intent(in) :: ldx
+    type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
+
+    integer(C_INT) :: flag
+
+    flag = c_band_solve_bwd(this%posdef, this%single, this%csubtree, nrhs, &
+         x, ldx, active)
+    if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
+  end subroutine solve_bwd
+
+  subroutine enquire_posdef(this, d)
+    implicit none
+    class(cpu_band_numeric_subtree), intent(in) :: this
+    real(wp), dimension(*), target, intent(out) :: d
+
+    call c_band_enquire(this%posdef, this%single, this%csubtree, C_NULL_PTR, &
+         C_LOC(d))
+  end subroutine enquire_posdef
+
+  subroutine enquire_indef(this, piv_order, d)
+    implicit none
+    class(cpu_band_numeric_subtree), intent(in) :: this
+    integer, dimension(*), target, optional, intent(out) :: piv_order
+    real(wp), dimension(2,*), target, optional, intent(out) :: d
+
+    type(C_PTR) :: dptr, poptr
+
+    ! Setup pointers
+    poptr = C_NULL_PTR
+    if (present(piv_order)) poptr = C_LOC(piv_order)
+    dptr = C_NULL_PTR
+    if (present(d)) dptr = C_LOC(d)
+
+    ! Call C++ routine
+    call c_band_enquire(this%posdef, this%single, this%csubtree, poptr, dptr)
+  end subroutine enquire_indef
+
+  subroutine alter(this, d)
+    implicit none
+    class(cpu_band_numeric_subtree), target, intent(inout) :: this
+    real(wp), dimension(2,*), intent(in) :: d
+
+    call c_band_alter(this%posdef, this%single, this%csubtree, d)
+  end subroutine alter
+
+end module spral_ssids_cpu_band_subtree
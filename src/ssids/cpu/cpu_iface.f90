@@ -48,6 +48,7 @@ module spral_ssids_cpu_iface
       integer(C_INT) :: maxsupernode
       integer(C_INT) :: not_first_pass
       integer(C_INT) :: not_second_pass
+      integer(C_INT) :: num_relaxed
    end type cpu_factor_stats
 
 contains
@@ -90,6 +91,7 @@ subroutine cpu_copy_stats_out(cstats, finform)
    finform%maxsupernode = max(finform%maxsupernode, cstats%maxsupernode)
    finform%not_first_pass = finform%not_first_pass + cstats%not_first_pass
    finform%not_second_pass = finform%not_second_pass + cstats%not_second_pass
+   finform%num_relaxed  = finform%num_relaxed + cstats%num_relaxed
    finform%matrix_rank  = finform%matrix_rank - cstats%num_zero
 end subroutine cpu_copy_stats_out
 
@@ -172,4 +174,79 @@ bind(C)
    call dgemv(trans, m, n, alpha, a, lda, x, incx, beta, y, incy)
 end subroutine spral_c_dgemv
 
+subroutine spral_c_sgemm(ta, tb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc) &
+bind(C)
+   use spral_blas_iface, only : sgemm
+   character(C_CHAR), intent(in) :: ta, tb
+   integer(C_INT), intent(in) :: m, n, k
+   integer(C_INT), intent(in) :: lda, ldb, ldc
+   real(C_FLOAT), intent(in) :: alpha, beta
+   real(C_FLOAT), intent(in   ), dimension(lda, *) :: a
+   real(C_FLOAT), intent(in   ), dimension(ldb, *) :: b
+   real(C_FLOAT), intent(inout), dimension(ldc, *) :: c
+   call sgemm(ta, tb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc)
+end subroutine spral_c_sgemm
+
+subroutine spral_c_spotrf(uplo, n, a, lda, info) bind(C)
+   use spral_lapack_iface, only : spotrf
+   character(C_CHAR), intent(in) :: uplo
+   integer(C_INT), intent(in) :: n, lda
+   integer(C_INT), intent(out) :: info
+   real(C_FLOAT), intent(inout), dimension(lda, *) :: a
+   call spotrf(uplo, n, a, lda, info)
+end subroutine spral_c_spotrf
+
+subroutine spral_c_ssytrf(uplo, n, a, lda, ipiv, work, lwork, info) bind(C)
+   use spral_lapack_iface, only : ssytrf
+   character(C_CHAR), intent(in) :: uplo
+   integer(C_INT), intent(in) :: n, lda, lwork
+   integer(C_INT), intent(out), dimension(n) :: ipiv
+   integer(C_INT), intent(out) :: info
+   real(C_FLOAT), intent(inout), dimension(lda, *) :: a
+   real(C_FLOAT), intent(out  ), dimension(*) :: work
+   call ssytrf(uplo, n, a, lda, ipiv, work, lwork, info)
+end subroutine spral_c_ssytrf
+
+subroutine spral_c_strsm(side, uplo, transa, diag, m, n, alpha, a, lda, b, &
+                         ldb) bind(C)
+   use spral_blas_iface, only : strsm
+   character(C_CHAR), intent(in) :: side, uplo, transa, diag
+   integer(C_INT), intent(in) :: m, n, lda, ldb
+   real(C_FLOAT), intent(in   ) :: alpha
+   real(C_FLOAT), intent(in   ) :: a(lda, *)
+   real(C_FLOAT), intent(inout) :: b(ldb, n)
+   call strsm(side, uplo, transa, diag, m, n, alpha, a, lda, b, ldb)
+end subroutine spral_c_strsm
+
+subroutine spral_c_ssyrk(uplo, trans, n, k, alpha, a, lda, beta, c, ldc) bind(C)
+   use spral_blas_iface, only : ssyrk
+   character(C_CHAR), intent(in) :: uplo, trans
+   integer(C_INT), intent(in) :: n, k, lda, ldc
+   real(C_FLOAT), intent(in) :: alpha, beta
+   real(C_FLOAT), intent(in   ), dimension(lda, *) :: a
+   real(C_FLOAT), intent(inout), dimension(ldc, n) :: c
+   call ssyrk(uplo, trans, n, k, alpha, a, lda, beta, c, ldc)
+end subroutine spral_c_ssyrk
+
+subroutine spral_c_strsv(uplo, trans, diag, n, a, lda, x, incx) bind(C)
+   use spral_blas_iface, only : strsv
+   character(C_CHAR), intent(in) :: uplo, trans, diag
+   integer(C_INT), intent(in) :: n, lda, incx
+   real(C_FLOAT), intent(in   ), dimension(lda, n) :: a
+   real(C_FLOAT), intent(inout), dimension(*) :: x
+   call strsv(uplo, trans, diag, n, a, lda, x, incx)
+end subroutine spral_c_strsv
+
+subroutine spral_c_sgemv(trans, m, n, alpha, a, lda, x, incx, beta, y, incy) &
+bind(C)
+   use spral_blas_iface, only : sgemv
+   character(C_CHAR), intent(in) :: trans
+   integer(C_INT), intent(in) :: m, n, lda, incx, incy
+   real(C_FLOAT), intent(in) :: alpha, beta
+   real(C_FLOAT), intent(in   ), dimension(lda, n) :: a
+   real(C_FLOAT), intent(in   ), dimension(*) :: x
+   real(C_FLOAT), intent(inout), dimension(*) :: y
+   call sgemv(trans, m, n, alpha, a, lda, x, incx, beta, y, incy)
+end subroutine spral_c_sgemv
+
 end module spral_ssids_cpu_iface
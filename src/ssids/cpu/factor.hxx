@@ -57,7 +57,7 @@ void factor_node_indef(
    //Verify<T> verifier(m, n, perm, lcol, ldl);
    if(options.pivot_method != PivotMethod::tpp) {
       // Use an APP based pivot method
-      node.nelim = ldlt_app_factor(
+      node.nelim = ldlt_app_factor<T>(
             m, n, perm, lcol, ldl, d, 0.0, contrib, m-n, options, work,
             pool_alloc
             );
@@ -180,7 +180,7 @@ void factor_node(
       std::vector<Workspace>& work,
       PoolAlloc& pool_alloc
       ) {
-   if(posdef) factor_node_posdef(0.0, snode, node, options, stats);
+   if(posdef) factor_node_posdef<T>(0.0, snode, node, options, stats);
    else       factor_node_indef(ni, snode, node, options, stats, work, pool_alloc);
 }
 
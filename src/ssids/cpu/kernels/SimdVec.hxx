@@ -270,4 +270,256 @@ private:
    simd_double_type val;
 };
 
+template <>
+class SimdVec<float> {
+public:
+   /*******************************************
+    * Properties of the type
+    *******************************************/
+
+#if defined(__AVX2__) || defined(__AVX__)
+   /// Length of underlying vector type
+   static const int vector_length = 8;
+   /// Typedef for underlying vector type containing floats
+   typedef __m256 simd_float_type;
+#else
+   /// Length of underlying vector type
+   static const int vector_length = 1;
+   /// Typedef for underlying vector type containing floats
+   typedef float simd_float_type;
+#endif
+
+   /*******************************************
+    * Constructors
+    *******************************************/
+
+   /// Uninitialized value constructor
+   SimdVec()
+   {}
+   /// Initialize all entries in vector to given scalar value
+   SimdVec(const float initial_value)
+   {
+#if defined(__AVX2__) || defined(__AVX__)
+      val = _mm256_set1_ps(initial_value);
+#else
+      val = initial_value;
+#endif
+   }
+#if defined(__AVX2__) || defined(__AVX__)
+   /// Initialize with underlying vector type
+   SimdVec(const simd_float_type &initial_value) {
+      val = initial_value;
+   }
+#endif
+   /// Initialize with another SimdVec
+   SimdVec(const SimdVec<float> &initial_value) {
+      val = initial_value.val;
+   }
+#if defined(__AVX2__) || defined(__AVX__)
+   /// Initialize as a vector by specifying all entries (no version for non-avx)
+   SimdVec(float x1, float x2, float x3, float x4, float x5, float x6,
+         float x7, float x8) {
+      val = _mm256_set_ps(x8, x7, x6, x5, x4, x3, x2, x1); // Reversed order
+   }
+#endif
+
+   /*******************************************
+    * Memory load/store
+    *******************************************/
+
+   /// Load from suitably aligned memory
+   static
+   const SimdVec load_aligned(const float *src) {
+#if defined(__AVX2__) || defined(__AVX__)
+      return SimdVec( _mm256_load_ps(src) );
+#else
+      return SimdVec( src[0] );
+#endif
+   }
+
+   /// Load from unaligned memory
+   static
+   const SimdVec load_unaligned(const float *src) {
+#if defined(__AVX2__) || defined(__AVX__)
+      return SimdVec( _mm256_loadu_ps(src) );
+#else
+      return SimdVec( src[0] );
+#endif
+   }
+
+   /// Extract value as array
+   void store_aligned(float *dest) const {
+#if defined(__AVX2__) || defined(__AVX__)
+      _mm256_store_ps(dest, val);
+#else
+      dest[0] = val;
+#endif
+   }
+
+   /// Extract value as array
+   void store_unaligned(float *dest) const {
+#if defined(__AVX2__) || defined(__AVX__)
+      _mm256_storeu_ps(dest, val);
+#else
+      dest[0] = val;
+#endif
+   }
+
+   /*******************************************
+    * Named operations
+    *******************************************/
+
+   /// Blend operation: returns (mask) ? x2 : x1
+   friend
+   SimdVec blend(const SimdVec &x1, const SimdVec &x2, const SimdVec &mask) {
+#if defined(__AVX2__) || defined(__AVX__)
+      return SimdVec( _mm256_blendv_ps(x1.val, x2.val, mask.val) );
+#else
+      return SimdVec( (mask.val) ? x2 : x1 );
+#endif
+   }
+
+   /// Returns absolute values
+   friend
+   SimdVec fabs(const SimdVec &x) {
+#if defined(__AVX2__) || defined(__AVX__)
+      return SimdVec(
+            _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x)
+         );
+#else
+      return SimdVec( std::fabs(x.val) );
+#endif
+   }
+
+   /// Return a = b * c + a
+   friend
+   SimdVec fmadd(const SimdVec &a, const SimdVec &b, const SimdVec &c) {
+#if defined(__AVX2__)
+      return SimdVec(
+            _mm256_fmadd_ps(b.val, c.val, a.val)
+         );
+#else
+      return b*c + a;
+#endif
+   }
+
+   /*******************************************
+    * Operators
+    *******************************************/
+
+   /// Conversion to underlying type
+   operator simd_float_type() const {
+      return val;
+   }
+
+   /// Extract indvidual elements of vector (messy and inefficient)
+   /// idx MUST be < vector_length.
+   float operator[](size_t idx) const {
+      float
+#if defined(__AVX512F__)
+        __attribute__((aligned(64)))
+#elif defined(__AVX__)
+        __attribute__((aligned(32)))
+#else
+        __attribute__((aligned(16)))
+#endif
+        val_as_array[vector_length];
+      store_aligned(val_as_array);
+      return val_as_array[idx];
+   }
+
+   /// Vector valued GT comparison
+   friend
+   SimdVec operator>(const SimdVec &lhs, const SimdVec &rhs) {
+#if defined(__AVX2__) || defined(__AVX__)
+      return SimdVec( _mm256_cmp_ps(lhs.val, rhs.val, _CMP_GT_OQ) );
+#else
+      return SimdVec( lhs.val > rhs.val );
+#endif
+   }
+
+   /// Bitwise and
+   friend
+   SimdVec operator&(const SimdVec &lhs, const SimdVec &rhs) {
+#if defined(__AVX2__) || defined(__AVX__)
+      return SimdVec( _mm256_and_ps(lhs.val, rhs.val) );
+#else
+      return SimdVec( lhs.val && rhs.val );
+#endif
+   }
+
+   /// Multiply
+   // NB: don't override builtin operator*(float,float) in scalar case
+#if defined(__AVX2__) || defined(__AVX__)
+   friend
+   SimdVec operator*(const SimdVec &lhs, const SimdVec &rhs) {
+      return SimdVec( _mm256_mul_ps(lhs.val, rhs.val) );
+   }
+#endif
+
+   SimdVec& operator*=(const SimdVec &rhs) {
+      *this = *this * rhs;
+      return *this;
+   }
+
+   /// Add
+   // NB: don't override builtin operator+(float,float) in scalar case
+#if defined(__AVX2__) || defined(__AVX__)
+   friend
+   SimdVec operator+(const SimdVec &lhs, const SimdVec &rhs) {
+      return SimdVec( _mm256_add_ps(lhs.val, rhs.val) );
+   }
+#endif
+
+   /*******************************************
+    * Factory functions for special cases
+    *******************************************/
+
+   /// Returns an instance initialized to zero using custom instructions
+   static
+   SimdVec zero() {
+#if defined(__AVX2__) || defined(__AVX__)
+      return SimdVec(_mm256_setzero_ps());
+#else
+      return SimdVec(0.0f);
+#endif
+   }
+
+   /// Returns a vector with all positions idx or above set to true, otherwise
+   /// false.
+   static
+   SimdVec gt_mask(int idx) {
+#if defined(__AVX2__) || defined(__AVX__)
+      const float t = -std::numeric_limits<float>::quiet_NaN();
+      const float f = 0.0f;
+      switch(idx) {
+         case 0:  return SimdVec(t, t, t, t, t, t, t, t);
+         case 1:  return SimdVec(f, t, t, t, t, t, t, t);
+         case 2:  return SimdVec(f, f, t, t, t, t, t, t);
+         case 3:  return SimdVec(f, f, f, t, t, t, t, t);
+         case 4:  return SimdVec(f, f, f, f, t, t, t, t);
+         case 5:  return SimdVec(f, f, f, f, f, t, t, t);
+         case 6:  return SimdVec(f, f, f, f, f, f, t, t);
+         case 7:  return SimdVec(f, f, f, f, f, f, f, t);
+         default: return SimdVec(f, f, f, f, f, f, f, f);
+      }
+#else
+      return (idx>0) ? SimdVec(false) : SimdVec(true);
+#endif
+   }
+
+   /*******************************************
+    * Debug functions
+    *******************************************/
+
+   /// Prints the vector (inefficient, use for debug only)
+   void print() {
+      for(int i=0; i<vector_length; i++) printf(" %e", (*this)[i]);
+   }
+
+private:
+   /// Underlying vector that this type wraps
+   simd_float_type val;
+};
+
 }}} /* namespaces spral::ssids::cpu */
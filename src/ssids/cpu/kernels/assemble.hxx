@@ -21,10 +21,12 @@ namespace spral { namespace ssids { namespace cpu {
 /** Assemble a column.
  *
  * Performs the operation dest( idx(:) ) += src(:)
+ * src may be of a wider type than dest (e.g. double contributions from
+ * another subtree being added to float factors).
  */
-template <typename T>
+template <typename T, typename S>
 inline
-void asm_col(int n, int const* idx, T const* src, T* dest) {
+void asm_col(int n, int const* idx, S const* src, T* dest) {
    int const nunroll = 4;
    int n2 = nunroll*(n/nunroll);
    for(int j=0; j<n2; j+=nunroll) {
@@ -149,15 +151,15 @@ void assemble_pre(
       FactorAlloc& factor_alloc,
       PoolAlloc& pool_alloc,
       std::vector<Workspace>& work,
-      T const* aval,
-      T const* scaling
+      double const* aval,
+      double const* scaling
       ) {
 #ifdef PROFILE
    Profile::Task task_asm_pre("TA_ASM_PRE");
 #endif
    /* Rebind allocators */
-   typedef typename std::allocator_traits<FactorAlloc>::template rebind_traits<double> FADoubleTraits;
-   typename FADoubleTraits::allocator_type factor_alloc_double(factor_alloc);
+   typedef typename std::allocator_traits<FactorAlloc>::template rebind_traits<T> FATTraits;
+   typename FATTraits::allocator_type factor_alloc_t(factor_alloc);
    typedef typename std::allocator_traits<FactorAlloc>::template rebind_traits<int> FAIntTraits;
    typename FAIntTraits::allocator_type factor_alloc_int(factor_alloc);
    typedef typename std::allocator_traits<PoolAlloc>::template rebind_traits<int> PAIntTraits;
@@ -183,10 +185,10 @@ void assemble_pre(
 
    /* Get space for node now we know it size using Fortran allocator + zero it*/
    // NB L is  nrow x ncol and D is 2 x ncol (but no D if posdef)
-   size_t ldl = align_lda<double>(nrow);
+   size_t ldl = align_lda<T>(nrow);
    size_t len = posdef ?  ldl    * ncol  // posdef
                        : (ldl+2) * ncol; // indef (includes D)
-   node.lcol = FADoubleTraits::allocate(factor_alloc_double, len);
+   node.lcol = FATTraits::allocate(factor_alloc_t, len);
    //memset(node.lcol, 0, len*sizeof(T)); NOT REQUIRED as PoolAlloc is
    // required to ensure it is zero for us (i.e. uses calloc)
 
@@ -319,7 +321,7 @@ void assemble_pre(
       for(int i=0; i<ndelay; i++) {
          // Add delayed rows (from delayed cols)
          T *dest = &node.lcol[delay_col*(ldl+1)];
-         T const* src = &delay_val[i*(lddelay+1)];
+         double const* src = &delay_val[i*(lddelay+1)];
          node.perm[delay_col] = delay_perm[i];
          for(int j=0; j<ndelay-i; j++) {
             dest[j] = src[j];
@@ -338,7 +340,7 @@ void assemble_pre(
       /* Handle expected contribution */
       for(int i=0; i<cn; ++i) {
          int c = cache[i];
-         T const* src = &cval[i*ldcontrib];
+         double const* src = &cval[i*ldcontrib];
          // NB: we handle contribution to contrib in assemble_post()
          if(c < snode.ncol) {
             // Contribution added to lcol
@@ -427,7 +429,7 @@ void assemble_post(
          cache[j] = map[ crlist[j] ] - ncol;
       for(int i=0; i<cn; ++i) {
          int c = cache[i]+ncol;
-         T const* src = &cval[i*ldcontrib];
+         double const* src = &cval[i*ldcontrib];
          // NB: only interested in contribution to generated element
          if(c >= snode.ncol) {
             // Contribution added to contrib
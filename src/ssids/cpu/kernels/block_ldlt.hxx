@@ -87,7 +87,7 @@ void find_maxloc(const int from, const T *a, int lda, T &bestv_out, int &rloc, i
       rloc = BLOCK_SIZE; cloc = BLOCK_SIZE;
       for(int c=from; c<BLOCK_SIZE; c++) {
          for(int r=c; r<BLOCK_SIZE; r++) {
-            double v = a[c*lda+r];
+            T v = a[c*lda+r];
             if(fabs(v) > bestv) {
                bestv = fabs(v);
                rloc = r;
@@ -30,7 +30,8 @@ namespace spral { namespace ssids { namespace cpu {
  * \param info is initialized to -1, and will be changed to the index of any
  *    column where a non-zero column is encountered.
  */
-void cholesky_factor(int m, int n, double* a, int lda, double beta, double* upd, int ldupd, int blksz, int *info) {
+template <typename T>
+void cholesky_factor(int m, int n, T* a, int lda, T beta, T* upd, int ldupd, int blksz, int *info) {
    if(n < blksz) {
       // Adjust so blocks have blksz**2 entries
       blksz = int((int64_t(blksz)*blksz) / n);
@@ -58,19 +59,19 @@ void cholesky_factor(int m, int n, double* a, int lda, double beta, double* upd,
          Profile::Task task("TA_CHOL_DIAG");
 #endif
          int blkm = std::min(blksz, m-j);
-         int flag = lapack_potrf(FILL_MODE_LWR, blkn, &a[j*(lda+1)], lda);
+         int flag = lapack_potrf<T>(FILL_MODE_LWR, blkn, &a[j*(lda+1)], lda);
          if (flag > 0) {
            // Matrix was not positive definite
            #pragma omp atomic write
            *info = flag-1; // flag uses Fortran indexing
          } else if (blkm > blkn) {
            // Diagonal block factored OK, handle some rectangular part of block
-           host_trsm(SIDE_RIGHT, FILL_MODE_LWR, OP_T, DIAG_NON_UNIT,
+           host_trsm<T>(SIDE_RIGHT, FILL_MODE_LWR, OP_T, DIAG_NON_UNIT,
                      blkm-blkn, blkn, 1.0, &a[j*(lda+1)], lda,
                      &a[j*(lda+1)+blkn], lda);
            if (upd) {
-             double rbeta = (j==0) ? beta : 1.0;
-             host_syrk(FILL_MODE_LWR, OP_N, blkm-blkn, blkn, -1.0,
+             T rbeta = (j==0) ? beta : 1.0;
+             host_syrk<T>(FILL_MODE_LWR, OP_N, blkm-blkn, blkn, -1.0,
                        &a[j*(lda+1)+blkn], lda, rbeta, upd, ldupd);
            }
          }
@@ -95,11 +96,11 @@ void cholesky_factor(int m, int n, double* a, int lda, double beta, double* upd,
 #ifdef PROFILE
            Profile::Task task("TA_CHOL_TRSM");
 #endif
-           host_trsm(SIDE_RIGHT, FILL_MODE_LWR, OP_T, DIAG_NON_UNIT,
+           host_trsm<T>(SIDE_RIGHT, FILL_MODE_LWR, OP_T, DIAG_NON_UNIT,
                      blkm, blkn, 1.0, &a[j*(lda+1)], lda, &a[j*lda+i], lda);
            if ((blkn < blksz) && upd) {
-             double rbeta = (j==0) ? beta : 1.0;
-             host_gemm(OP_N, OP_T, blkm, blksz-blkn, blkn, -1.0,
+             T rbeta = (j==0) ? beta : 1.0;
+             host_gemm<T>(OP_N, OP_T, blkm, blksz-blkn, blkn, -1.0,
                        &a[j*lda+i], lda, &a[j*(lda+1)+blkn], lda,
                        rbeta, &upd[i-n], ldupd);
            }
@@ -128,18 +129,18 @@ void cholesky_factor(int m, int n, double* a, int lda, double beta, double* upd,
              Profile::Task task("TA_CHOL_UPD");
 #endif
              int blkm = std::min(blksz, m-i);
-             host_gemm(OP_N, OP_T, blkm, blkk, blkn, -1.0, &a[j*lda+i], lda,
+             host_gemm<T>(OP_N, OP_T, blkm, blkk, blkn, -1.0, &a[j*lda+i], lda,
                        &a[j*lda+k], lda, 1.0, &a[k*lda+i], lda);
              if ((blkk < blksz) && upd) {
-               double rbeta = (j==0) ? beta : 1.0;
+               T rbeta = (j==0) ? beta : 1.0;
                int upd_width = (m<k+blksz) ? blkm - blkk : blksz - blkk;
                if ((i-n) < 0) {
                  // Special case for first block of contrib
-                 host_gemm(OP_N, OP_T, blkm+i-n, upd_width, blkn, -1.0,
+                 host_gemm<T>(OP_N, OP_T, blkm+i-n, upd_width, blkn, -1.0,
                            &a[j*lda+n], lda, &a[j*lda+k+blkk], lda, rbeta,
                            upd, ldupd);
                } else {
-                 host_gemm(OP_N, OP_T, blkm, upd_width, blkn, -1.0,
+                 host_gemm<T>(OP_N, OP_T, blkm, upd_width, blkn, -1.0,
                            &a[j*lda+i], lda, &a[j*lda+k+blkk], lda, rbeta,
                            &upd[i-n], ldupd);
                }
@@ -171,8 +172,8 @@ void cholesky_factor(int m, int n, double* a, int lda, double beta, double* upd,
                Profile::Task task("TA_CHOL_UPD");
 #endif
                int blkm = std::min(blksz, m-i);
-               double rbeta = (j==0) ? beta : 1.0;
-               host_gemm(OP_N, OP_T, blkm, blkk, blkn, -1.0,
+               T rbeta = (j==0) ? beta : 1.0;
+               host_gemm<T>(OP_N, OP_T, blkm, blkk, blkn, -1.0,
                          &a[j*lda+i], lda, &a[j*lda+k], lda,
                          rbeta, &upd[(k-n)*ldupd+(i-n)], ldupd);
 #ifdef PROFILE
@@ -185,31 +186,57 @@ void cholesky_factor(int m, int n, double* a, int lda, double beta, double* upd,
      }
    }
 }
+template void cholesky_factor<double>(int, int, double*, int, double, double*, int, int, int*);
+template void cholesky_factor<float>(int, int, float*, int, float, float*, int, int, int*);
 
 /* Forwards solve corresponding to cholesky_factor() */
-void cholesky_solve_fwd(int m, int n, double const* a, int lda, int nrhs, double* x, int ldx) {
+template <typename T>
+void cholesky_solve_fwd(int m, int n, T const* a, int lda, int nrhs, T* x, int ldx) {
    if(nrhs==1) {
-      host_trsv(FILL_MODE_LWR, OP_N, DIAG_NON_UNIT, n, a, lda, x, 1);
+      host_trsv<T>(FILL_MODE_LWR, OP_N, DIAG_NON_UNIT, n, a, lda, x, 1);
       if(m > n)
-         gemv(OP_N, m-n, n, -1.0, &a[n], lda, x, 1, 1.0, &x[n], 1);
+         gemv<T>(OP_N, m-n, n, -1.0, &a[n], lda, x, 1, 1.0, &x[n], 1);
    } else {
-      host_trsm(SIDE_LEFT, FILL_MODE_LWR, OP_N, DIAG_NON_UNIT, n, nrhs, 1.0, a, lda, x, ldx);
+      host_trsm<T>(SIDE_LEFT, FILL_MODE_LWR, OP_N, DIAG_NON_UNIT, n, nrhs, 1.0, a, lda, x, ldx);
       if(m > n)
-         host_gemm(OP_N, OP_N, m-n, nrhs, n, -1.0, &a[n], lda, x, ldx, 1.0, &x[n], ldx);
+         host_gemm<T>(OP_N, OP_N, m-n, nrhs, n, -1.0, &a[n], lda, x, ldx, 1.0, &x[n], ldx);
    }
 }
+template void cholesky_solve_fwd<double>(int, int, double const*, int, int, double*, int);
+template void cholesky_solve_fwd<float>(int, int, float const*, int, int, float*, int);
+
+/* Forwards solve corresponding to cholesky_factor(), with the update to rows
+ * n:m-1 written to y (beta=0) rather than added to x[n:m-1], which is not
+ * referenced. Only the first n rows of x are needed. */
+template <typename T>
+void cholesky_solve_fwd(int m, int n, T const* a, int lda, int nrhs, T* x, int ldx, T* y, int ldy) {
+   if(nrhs==1) {
+      host_trsv<T>(FILL_MODE_LWR, OP_N, DIAG_NON_UNIT, n, a, lda, x, 1);
+      if(m > n)
+         gemv<T>(OP_N, m-n, n, -1.0, &a[n], lda, x, 1, 0.0, y, 1);
+   } else {
+      host_trsm<T>(SIDE_LEFT, FILL_MODE_LWR, OP_N, DIAG_NON_UNIT, n, nrhs, 1.0, a, lda, x, ldx);
+      if(m > n)
+         host_gemm<T>(OP_N, OP_N, m-n, nrhs, n, -1.0, &a[n], lda, x, ldx, 0.0, y, ldy);
+   }
+}
+template void cholesky_solve_fwd<double>(int, int, double const*, int, int, double*, int, double*, int);
+template void cholesky_solve_fwd<float>(int, int, float const*, int, int, float*, int, float*, int);
 
 /* Backwards solve corresponding to cholesky_factor() */
-void cholesky_solve_bwd(int m, int n, double const* a, int lda, int nrhs, double* x, int ldx) {
+template <typename T>
+void cholesky_solve_bwd(int m, int n, T const* a, int lda, int nrhs, T* x, int ldx) {
    if(nrhs==1) {
       if(m > n)
-         gemv(OP_T, m-n, n, -1.0, &a[n], lda, &x[n], 1, 1.0, x, 1);
-      host_trsv(FILL_MODE_LWR, OP_T, DIAG_NON_UNIT, n, a, lda, x, 1);
+         gemv<T>(OP_T, m-n, n, -1.0, &a[n], lda, &x[n], 1, 1.0, x, 1);
+      host_trsv<T>(FILL_MODE_LWR, OP_T, DIAG_NON_UNIT, n, a, lda, x, 1);
    } else {
       if(m > n)
-         host_gemm(OP_T, OP_N, n, nrhs, m-n, -1.0, &a[n], lda, &x[n], ldx, 1.0, x, ldx);
-      host_trsm(SIDE_LEFT, FILL_MODE_LWR, OP_T, DIAG_NON_UNIT, n, nrhs, 1.0, a, lda, x, ldx);
+         host_gemm<T>(OP_T, OP_N, n, nrhs, m-n, -1.0, &a[n], lda, &x[n], ldx, 1.0, x, ldx);
+      host_trsm<T>(SIDE_LEFT, FILL_MODE_LWR, OP_T, DIAG_NON_UNIT, n, nrhs, 1.0, a, lda, x, ldx);
    }
 }
+template void cholesky_solve_bwd<double>(int, int, double const*, int, int, double*, int);
+template void cholesky_solve_bwd<float>(int, int, float const*, int, int, float*, int);
 
 }}} /* namespaces spral::ssids::cpu */
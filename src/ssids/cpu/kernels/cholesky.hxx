@@ -5,8 +5,13 @@
  */
 namespace spral { namespace ssids { namespace cpu {
 
-void cholesky_factor(int m, int n, double* a, int lda, double beta, double* upd, int ldupd, int blksz, int *info);
-void cholesky_solve_fwd(int m, int n, double const* a, int lda, int nrhs, double* x, int ldx);
-void cholesky_solve_bwd(int m, int n, double const* a, int lda, int nrhs, double* x, int ldx);
+template <typename T>
+void cholesky_factor(int m, int n, T* a, int lda, T beta, T* upd, int ldupd, int blksz, int *info);
+template <typename T>
+void cholesky_solve_fwd(int m, int n, T const* a, int lda, int nrhs, T* x, int ldx);
+template <typename T>
+void cholesky_solve_fwd(int m, int n, T const* a, int lda, int nrhs, T* x, int ldx, T* y, int ldy);
+template <typename T>
+void cholesky_solve_bwd(int m, int n, T const* a, int lda, int nrhs, T* x, int ldx);
 
 }}} /* namespaces spral::ssids::cpu */
@@ -1094,7 +1094,7 @@ public:
                nrow()-rfrom, cdata_[elim_col].nelim, &isrc.aval_[rfrom],
                lda_, cdata_[elim_col].d, &ld[rfrom], ldld
                );
-         host_gemm(
+         host_gemm<T>(
                OP_N, OP_T, nrow()-rfrom, ncol()-cfrom, cdata_[elim_col].nelim,
                -1.0, &ld[rfrom], ldld, &jsrc.aval_[cfrom], lda_,
                1.0, &aval_[cfrom*lda_+rfrom], lda_
@@ -1105,7 +1105,7 @@ public:
             beta = (cdata_[elim_col].first_elim) ? beta : 1.0; // user beta only on first update
             if(i_ == j_) {
                // diagonal block
-               host_gemm(
+               host_gemm<T>(
                      OP_N, OP_T, u_ncol, u_ncol, cdata_[elim_col].nelim,
                      -1.0, &ld[ncol()], ldld,
                      &jsrc.aval_[ncol()], lda_,
@@ -1115,7 +1115,7 @@ public:
                // off-diagonal block
                T* upd_ij =
                   &upd[(i_-calc_nblk(n_,block_size_))*block_size_+u_ncol];
-               host_gemm(
+               host_gemm<T>(
                      OP_N, OP_T, nrow(), u_ncol, cdata_[elim_col].nelim,
                      -1.0, &ld[rfrom], ldld, &jsrc.aval_[ncol()], lda_,
                      beta, upd_ij, ldupd
@@ -1144,7 +1144,7 @@ public:
                   cdata_[elim_col].d, &ld[rfrom], ldld
                   );
          }
-         host_gemm(
+         host_gemm<T>(
                OP_N, OP_N, nrow()-rfrom, ncol()-cfrom, cdata_[elim_col].nelim,
                -1.0, &ld[rfrom], ldld, &jsrc.aval_[cfrom*lda_], lda_,
                1.0, &aval_[cfrom*lda_+rfrom], lda_
@@ -1178,7 +1178,7 @@ public:
       // User-supplied beta only on first update; otherwise 1.0
       T rbeta = (cdata_[elim_col].first_elim) ? beta : 1.0;
       int blkn = get_nrow(j_); // nrow not ncol as we're on contrib
-      host_gemm(
+      host_gemm<T>(
             OP_N, OP_T, nrow(), blkn, cdata_[elim_col].nelim,
             -1.0, ld, ldld, jsrc.aval_, lda_,
             rbeta, upd_ij, ldupd
@@ -2533,20 +2533,39 @@ int ldlt_app_factor(int m, int n, int* perm, T* a, int lda, T* d, T beta, T* upd
             );
 }
 template int ldlt_app_factor<double, BuddyAllocator<double,std::allocator<double>>>(int, int, int*, double*, int, double*, double, double*, int, struct cpu_factor_options const&, std::vector<Workspace>&, BuddyAllocator<double,std::allocator<double>> const& alloc);
+template int ldlt_app_factor<float, BuddyAllocator<float,std::allocator<float>>>(int, int, int*, float*, int, float*, float, float*, int, struct cpu_factor_options const&, std::vector<Workspace>&, BuddyAllocator<float,std::allocator<float>> const& alloc);
 
 template <typename T>
 void ldlt_app_solve_fwd(int m, int n, T const* l, int ldl, int nrhs, T* x, int ldx) {
    if(nrhs==1) {
-      host_trsv(FILL_MODE_LWR, OP_N, DIAG_UNIT, n, l, ldl, x, 1);
+      host_trsv<T>(FILL_MODE_LWR, OP_N, DIAG_UNIT, n, l, ldl, x, 1);
       if(m > n)
-         gemv(OP_N, m-n, n, -1.0, &l[n], ldl, x, 1, 1.0, &x[n], 1);
+         gemv<T>(OP_N, m-n, n, -1.0, &l[n], ldl, x, 1, 1.0, &x[n], 1);
    } else {
-      host_trsm(SIDE_LEFT, FILL_MODE_LWR, OP_N, DIAG_UNIT, n, nrhs, 1.0, l, ldl, x, ldx);
+      host_trsm<T>(SIDE_LEFT, FILL_MODE_LWR, OP_N, DIAG_UNIT, n, nrhs, 1.0, l, ldl, x, ldx);
       if(m > n)
-         host_gemm(OP_N, OP_N, m-n, nrhs, n, -1.0, &l[n], ldl, x, ldx, 1.0, &x[n], ldx);
+         host_gemm<T>(OP_N, OP_N, m-n, nrhs, n, -1.0, &l[n], ldl, x, ldx, 1.0, &x[n], ldx);
    }
 }
 template void ldlt_app_solve_fwd<double>(int, int, double const*, int, int, double*, int);
+template void ldlt_app_solve_fwd<float>(int, int, float const*, int, int, float*, int);
+
+/* As above, but the update to rows n:m-1 is written to y (beta=0) rather than
+ * added to x[n:m-1], which is not referenced */
+template <typename T>
+void ldlt_app_solve_fwd(int m, int n, T const* l, int ldl, int nrhs, T* x, int ldx, T* y, int ldy) {
+   if(nrhs==1) {
+      host_trsv<T>(FILL_MODE_LWR, OP_N, DIAG_UNIT, n, l, ldl, x, 1);
+      if(m > n)
+         gemv<T>(OP_N, m-n, n, -1.0, &l[n], ldl, x, 1, 0.0, y, 1);
+   } else {
+      host_trsm<T>(SIDE_LEFT, FILL_MODE_LWR, OP_N, DIAG_UNIT, n, nrhs, 1.0, l, ldl, x, ldx);
+      if(m > n)
+         host_gemm<T>(OP_N, OP_N, m-n, nrhs, n, -1.0, &l[n], ldl, x, ldx, 0.0, y, ldy);
+   }
+}
+template void ldlt_app_solve_fwd<double>(int, int, double const*, int, int, double*, int, double*, int);
+template void ldlt_app_solve_fwd<float>(int, int, float const*, int, int, float*, int, float*, int);
 
 template <typename T>
 void ldlt_app_solve_diag(int n, T const* d, int nrhs, T* x, int ldx) {
@@ -2573,19 +2592,21 @@ void ldlt_app_solve_diag(int n, T const* d, int nrhs, T* x, int ldx) {
    }
 }
 template void ldlt_app_solve_diag<double>(int, double const*, int, double*, int);
+template void ldlt_app_solve_diag<float>(int, float const*, int, float*, int);
 
 template <typename T>
 void ldlt_app_solve_bwd(int m, int n, T const* l, int ldl, int nrhs, T* x, int ldx) {
    if(nrhs==1) {
       if(m > n)
-         gemv(OP_T, m-n, n, -1.0, &l[n], ldl, &x[n], 1, 1.0, x, 1);
-      host_trsv(FILL_MODE_LWR, OP_T, DIAG_UNIT, n, l, ldl, x, 1);
+         gemv<T>(OP_T, m-n, n, -1.0, &l[n], ldl, &x[n], 1, 1.0, x, 1);
+      host_trsv<T>(FILL_MODE_LWR, OP_T, DIAG_UNIT, n, l, ldl, x, 1);
    } else {
       if(m > n)
-         host_gemm(OP_T, OP_N, n, nrhs, m-n, -1.0, &l[n], ldl, &x[n], ldx, 1.0, x, ldx);
-      host_trsm(SIDE_LEFT, FILL_MODE_LWR, OP_T, DIAG_UNIT, n, nrhs, 1.0, l, ldl, x, ldx);
+         host_gemm<T>(OP_T, OP_N, n, nrhs, m-n, -1.0, &l[n], ldl, &x[n], ldx, 1.0, x, ldx);
+      host_trsm<T>(SIDE_LEFT, FILL_MODE_LWR, OP_T, DIAG_UNIT, n, nrhs, 1.0, l, ldl, x, ldx);
    }
 }
 template void ldlt_app_solve_bwd<double>(int, int, double const*, int, int, double*, int);
+template void ldlt_app_solve_bwd<float>(int, int, float const*, int, int, float*, int);
 
 }}} /* namespaces spral::ssids::cpu */
@@ -17,6 +17,9 @@ int ldlt_app_factor(int m, int n, int *perm, T *a, int lda, T *d, T beta, T* upd
 template <typename T>
 void ldlt_app_solve_fwd(int m, int n, T const* l, int ldl, int nrhs, T* x, int ldx);
 
+template <typename T>
+void ldlt_app_solve_fwd(int m, int n, T const* l, int ldl, int nrhs, T* x, int ldx, T* y, int ldy);
+
 template <typename T>
 void ldlt_app_solve_diag(int n, T const* d, int nrhs, T* x, int ldx);
 
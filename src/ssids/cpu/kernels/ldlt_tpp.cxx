@@ -18,30 +18,33 @@ namespace spral { namespace ssids { namespace cpu {
 namespace {
 
 /** Returns true if all entries in col are less than small in abs value */
-bool check_col_small(int idx, int from, int to, double const* a, int lda, double small) {
+template <typename T>
+bool check_col_small(int idx, int from, int to, T const* a, int lda, double small) {
    bool check = true;
    for(int c=from; c<idx; ++c)
-      check = check && (fabs(a[c*lda+idx]) < small);
+      check = check && (std::fabs(a[c*lda+idx]) < small);
    for(int r=idx; r<to; ++r)
-      check = check && (fabs(a[idx*lda+r]) < small);
+      check = check && (std::fabs(a[idx*lda+r]) < small);
    return check;
 }
 
 /** Returns col index of largest entry in row starting at a */
-int find_row_abs_max(int from, int to, double const* a, int lda) {
+template <typename T>
+int find_row_abs_max(int from, int to, T const* a, int lda) {
    if(from>=to) return -1;
-   int best_idx=from; double best_val=fabs(a[from*lda]);
+   int best_idx=from; T best_val=std::fabs(a[from*lda]);
    for(int idx=from+1; idx<to; ++idx)
-      if(fabs(a[idx*lda]) > best_val) {
+      if(std::fabs(a[idx*lda]) > best_val) {
          best_idx = idx;
-         best_val = fabs(a[idx*lda]);
+         best_val = std::fabs(a[idx*lda]);
       }
    return best_idx;
 }
 
 /** Performs symmetric swap of col1 and col2 in lower triangle */
 // FIXME: remove n only here for debug
-void swap_cols(int col1, int col2, int m, int n, int* perm, double* a, int lda, int nleft, double* aleft, int ldleft) {
+template <typename T>
+void swap_cols(int col1, int col2, int m, int n, int* perm, T* a, int lda, int nleft, T* aleft, int ldleft) {
    if(col1 == col2) return; // No-op
 
    // Ensure col1 < col2
@@ -72,64 +75,67 @@ void swap_cols(int col1, int col2, int m, int n, int* perm, double* a, int lda,
 }
 
 /** Returns abs value of largest unelim entry in row/col not in posn exclude or on diagonal */
-double find_rc_abs_max_exclude(int col, int nelim, int m, double const* a, int lda, int exclude) {
-   double best = 0.0;
+template <typename T>
+T find_rc_abs_max_exclude(int col, int nelim, int m, T const* a, int lda, int exclude) {
+   T best = 0.0;
    for(int c=nelim; c<col; ++c) {
       if(c==exclude) continue;
-      best = std::max(best, fabs(a[c*lda+col]));
+      best = std::max(best, std::fabs(a[c*lda+col]));
    }
    for(int r=col+1; r<m; ++r) {
       if(r==exclude) continue;
-      best = std::max(best, fabs(a[col*lda+r]));
+      best = std::max(best, std::fabs(a[col*lda+r]));
    }
    return best;
 }
 
 /** Return true if (t,p) is a good 2x2 pivot, false otherwise */
-bool test_2x2(int t, int p, double maxt, double maxp, double const* a, int lda, double u, double small, double* d) {
+template <typename T>
+bool test_2x2(int t, int p, T maxt, T maxp, T const* a, int lda, double u, double small, T* d) {
    // NB: We know t < p
 
    // Check there is a non-zero in the pivot block
-   double a11 = a[t*lda+t];
-   double a21 = a[t*lda+p];
-   double a22 = a[p*lda+p];
+   T a11 = a[t*lda+t];
+   T a21 = a[t*lda+p];
+   T a22 = a[p*lda+p];
    //printf("Testing 2x2 pivot (%d, %d) %e %e %e vs %e %e\n", t, p, a11, a21, a22, maxt, maxp);
-   double maxpiv = std::max(fabs(a11), std::max(fabs(a21), fabs(a22)));
+   T maxpiv = std::max(std::fabs(a11), std::max(std::fabs(a21), std::fabs(a22)));
    if(maxpiv < small) return false;
 
    // Ensure non-singular and not afflicted by cancellation
-   double detscale = 1/maxpiv;
-   double detpiv0 = (a11*detscale)*a22;
-   double detpiv1 = (a21*detscale)*a21;
-   double detpiv = detpiv0 - detpiv1;
-   //printf("t1 %e < %e %e %e?\n", fabs(detpiv), small, fabs(detpiv0/2), fabs(detpiv1/2));
-   if(fabs(detpiv) < std::max(small, std::max(fabs(detpiv0/2), fabs(detpiv1/2)))) return false;
+   T detscale = 1/maxpiv;
+   T detpiv0 = (a11*detscale)*a22;
+   T detpiv1 = (a21*detscale)*a21;
+   T detpiv = detpiv0 - detpiv1;
+   //printf("t1 %e < %e %e %e?\n", std::fabs(detpiv), small, std::fabs(detpiv0/2), std::fabs(detpiv1/2));
+   if(std::fabs(detpiv) < std::max<double>(small, std::max(std::fabs(detpiv0/2), std::fabs(detpiv1/2)))) return false;
 
    // Finally apply threshold pivot check
    d[0] = (a22*detscale)/detpiv;
    d[1] = (-a21*detscale)/detpiv;
-   d[2] = std::numeric_limits<double>::infinity();
+   d[2] = std::numeric_limits<T>::infinity();
    d[3] = (a11*detscale)/detpiv;
    //printf("t2 %e < %e?\n", std::max(maxp, maxt), small);
    if(std::max(maxp, maxt) < small) return true; // Rest of col small
-   double x1 = fabs(d[0])*maxt + fabs(d[1])*maxp;
-   double x2 = fabs(d[1])*maxt + fabs(d[3])*maxp;
+   T x1 = std::fabs(d[0])*maxt + std::fabs(d[1])*maxp;
+   T x2 = std::fabs(d[1])*maxt + std::fabs(d[3])*maxp;
    //printf("t3 %e < %e?\n", std::max(x1, x2), 1.0/u);
    return ( u*std::max(x1, x2) < 1.0 );
 }
 
 /** Applies the 2x2 pivot to rest of block column */
-void apply_2x2(int nelim, int m, double* a, int lda, double* ld, int ldld, double* d) {
+template <typename T>
+void apply_2x2(int nelim, int m, T* a, int lda, T* ld, int ldld, T* d) {
    /* Set diagonal block to identity */
-   double* a1 = &a[nelim*lda];
-   double* a2 = &a[(nelim+1)*lda];
+   T* a1 = &a[nelim*lda];
+   T* a2 = &a[(nelim+1)*lda];
    a1[nelim] = 1.0;
    a1[nelim+1] = 0.0;
    a2[nelim+1] = 1.0;
    /* Extract D^-1 values */
-   double d11 = d[2*nelim];
-   double d21 = d[2*nelim+1];
-   double d22 = d[2*nelim+3];
+   T d11 = d[2*nelim];
+   T d21 = d[2*nelim+1];
+   T d22 = d[2*nelim+3];
    /* Divide through, preserving copy in ld */
    for(int r=nelim+2; r<m; ++r) {
       ld[r] = a1[r]; ld[ldld+r] = a2[r];
@@ -139,12 +145,13 @@ void apply_2x2(int nelim, int m, double* a, int lda, double* ld, int ldld, doubl
 }
 
 /** Applies the 1x1 pivot to rest of block column */
-void apply_1x1(int nelim, int m, double* a, int lda, double* ld, int ldld, double* d) {
+template <typename T>
+void apply_1x1(int nelim, int m, T* a, int lda, T* ld, int ldld, T* d) {
    /* Set diagonal block to identity */
-   double* a1 = &a[nelim*lda];
+   T* a1 = &a[nelim*lda];
    a1[nelim] = 1.0;
    /* Extract D^-1 values */
-   double d11 = d[2*nelim];
+   T d11 = d[2*nelim];
    /* Divide through, preserving copy in ld */
    for(int r=nelim+1; r<m; ++r) {
       ld[r] = a1[r];
@@ -153,7 +160,8 @@ void apply_1x1(int nelim, int m, double* a, int lda, double* ld, int ldld, doubl
 }
 
 /** Sets column to zero */
-void zero_col(int col, int m, double* a, int lda) {
+template <typename T>
+void zero_col(int col, int m, T* a, int lda) {
    for(int r=col; r<m; ++r) {
       a[col*lda+r] = 0.0;
    }
@@ -163,9 +171,10 @@ void zero_col(int col, int m, double* a, int lda) {
 
 /** Simple LDL^T with threshold partial pivoting.
  * Intended for finishing off small matrices, not for performance */
-int ldlt_tpp_factor(int m, int n, int* perm, double* a, int lda, double* d,
-      double* ld, int ldld, bool action, double u, double small, int nleft,
-      double* aleft, int ldleft) {
+template <typename T>
+int ldlt_tpp_factor(int m, int n, int* perm, T* a, int lda, T* d,
+      T* ld, int ldld, bool action, double u, double small, int nleft,
+      T* aleft, int ldleft) {
    //printf("=== ENTRY %d %d ===\n", m, n);
    int nelim = 0; // Number of eliminated variables
    while(nelim<n) {
@@ -207,14 +216,14 @@ int ldlt_tpp_factor(int m, int n, int* perm, double* a, int lda, double* d,
          int t = find_row_abs_max(nelim, p, &a[p], lda);
 
          // Try (t,p) as 2x2 pivot
-         double maxt = find_rc_abs_max_exclude(t, nelim, m, a, lda, p);
-         double maxp = find_rc_abs_max_exclude(p, nelim, m, a, lda, t);
+         T maxt = find_rc_abs_max_exclude(t, nelim, m, a, lda, p);
+         T maxp = find_rc_abs_max_exclude(p, nelim, m, a, lda, t);
          if( test_2x2(t, p, maxt, maxp, a, lda, u, small, &d[2*nelim]) ) {
             //printf("2x2 pivot\n");
             swap_cols(t, nelim, m, n, perm, a, lda, nleft, aleft, ldleft);
             swap_cols(p, nelim+1, m, n, perm, a, lda, nleft, aleft, ldleft);
             apply_2x2(nelim, m, a, lda, ld, ldld, d);
-            host_gemm(OP_N, OP_T, m-nelim-2, n-nelim-2, 2, -1.0,
+            host_gemm<T>(OP_N, OP_T, m-nelim-2, n-nelim-2, 2, -1.0,
                   &a[nelim*lda+nelim+2], lda, &ld[nelim+2], ldld,
                   1.0, &a[(nelim+2)*lda+nelim+2], lda); // update trailing mat
             nelim += 2;
@@ -222,14 +231,14 @@ int ldlt_tpp_factor(int m, int n, int* perm, double* a, int lda, double* d,
          }
 
          // Try p as 1x1 pivot
-         maxp = std::max(maxp, fabs(a[t*lda+p]));
-         if( fabs(a[p*lda+p]) >= u*maxp ) {
+         maxp = std::max(maxp, std::fabs(a[t*lda+p]));
+         if( std::fabs(a[p*lda+p]) >= u*maxp ) {
             //printf("1x1 pivot\n");
             swap_cols(p, nelim, m, n, perm, a, lda, nleft, aleft, ldleft);
             d[2*nelim] = 1 / a[nelim*lda+nelim];
             d[2*nelim+1] = 0.0;
             apply_1x1(nelim, m, a, lda, ld, ldld, d);
-            host_gemm(OP_N, OP_T, m-nelim-1, n-nelim-1, 1, -1.0,
+            host_gemm<T>(OP_N, OP_T, m-nelim-1, n-nelim-1, 1, -1.0,
                   &a[nelim*lda+nelim+1], lda, &ld[nelim+1], ldld,
                   1.0, &a[(nelim+1)*lda+nelim+1], lda); // update trailing mat
             nelim += 1;
@@ -241,14 +250,14 @@ int ldlt_tpp_factor(int m, int n, int* perm, double* a, int lda, double* d,
 
          // Try 1x1 pivot on p=nelim as last resort (we started at p=nelim+1)
          p = nelim;
-         double maxp = find_rc_abs_max_exclude(p, nelim, m, a, lda, -1);
-         if( fabs(a[p*lda+p]) >= u*maxp ) {
+         T maxp = find_rc_abs_max_exclude(p, nelim, m, a, lda, -1);
+         if( std::fabs(a[p*lda+p]) >= u*maxp ) {
             //printf("1x1 pivot %d\n", p);
             swap_cols(p, nelim, m, n, perm, a, lda, nleft, aleft, ldleft);
             d[2*nelim] = 1 / a[nelim*lda+nelim];
             d[2*nelim+1] = 0.0;
             apply_1x1(nelim, m, a, lda, ld, ldld, d);
-            host_gemm(OP_N, OP_T, m-nelim-1, n-nelim-1, 1, -1.0,
+            host_gemm<T>(OP_N, OP_T, m-nelim-1, n-nelim-1, 1, -1.0,
                   &a[nelim*lda+nelim+1], lda, &ld[nelim+1], ldld,
                   1.0, &a[(nelim+1)*lda+nelim+1], lda); // update trailing mat
             nelim += 1;
@@ -268,50 +277,61 @@ int ldlt_tpp_factor(int m, int n, int* perm, double* a, int lda, double* d,
    printf("==== EXIT ====\n");*/
    return nelim;
 }
+template int ldlt_tpp_factor<double>(int, int, int*, double*, int, double*, double*, int, bool, double, double, int, double*, int);
+template int ldlt_tpp_factor<float>(int, int, int*, float*, int, float*, float*, int, bool, double, double, int, float*, int);
 
-void ldlt_tpp_solve_fwd(int m, int n, double const* l, int ldl, int nrhs, double* x, int ldx) {
+template <typename T>
+void ldlt_tpp_solve_fwd(int m, int n, T const* l, int ldl, int nrhs, T* x, int ldx) {
    if(nrhs==1) {
-      host_trsv(FILL_MODE_LWR, OP_N, DIAG_UNIT, n, l, ldl, x, 1);
+      host_trsv<T>(FILL_MODE_LWR, OP_N, DIAG_UNIT, n, l, ldl, x, 1);
       if(m > n)
-         gemv(OP_N, m-n, n, -1.0, &l[n], ldl, x, 1, 1.0, &x[n], 1);
+         gemv<T>(OP_N, m-n, n, -1.0, &l[n], ldl, x, 1, 1.0, &x[n], 1);
    } else {
-      host_trsm(SIDE_LEFT, FILL_MODE_LWR, OP_N, DIAG_UNIT, n, nrhs, 1.0, l, ldl, x, ldx);
+      host_trsm<T>(SIDE_LEFT, FILL_MODE_LWR, OP_N, DIAG_UNIT, n, nrhs, 1.0, l, ldl, x, ldx);
       if(m > n)
-         host_gemm(OP_N, OP_N, m-n, nrhs, n, -1.0, &l[n], ldl, x, ldx, 1.0, &x[n], ldx);
+         host_gemm<T>(OP_N, OP_N, m-n, nrhs, n, -1.0, &l[n], ldl, x, ldx, 1.0, &x[n], ldx);
    }
 }
+template void ldlt_tpp_solve_fwd<double>(int, int, double const*, int, int, double*, int);
+template void ldlt_tpp_solve_fwd<float>(int, int, float const*, int, int, float*, int);
 
-void ldlt_tpp_solve_diag(int n, double const* d, double* x) {
+template <typename T>
+void ldlt_tpp_solve_diag(int n, T const* d, T* x) {
    for(int i=0; i<n; ) {
       if(i+1<n && std::isinf(d[2*i+2])) {
          // 2x2 pivot
-         double d11 = d[2*i];
-         double d21 = d[2*i+1];
-         double d22 = d[2*i+3];
-         double x1 = x[i];
-         double x2 = x[i+1];
+         T d11 = d[2*i];
+         T d21 = d[2*i+1];
+         T d22 = d[2*i+3];
+         T x1 = x[i];
+         T x2 = x[i+1];
          x[i]   = d11*x1 + d21*x2;
          x[i+1] = d21*x1 + d22*x2;
          i += 2;
       } else {
          // 1x1 pivot
-         double d11 = d[2*i];
+         T d11 = d[2*i];
          x[i] *= d11;
          i++;
       }
    }
 }
+template void ldlt_tpp_solve_diag<double>(int, double const*, double*);
+template void ldlt_tpp_solve_diag<float>(int, float const*, float*);
 
-void ldlt_tpp_solve_bwd(int m, int n, double const* l, int ldl, int nrhs, double* x, int ldx) {
+template <typename T>
+void ldlt_tpp_solve_bwd(int m, int n, T const* l, int ldl, int nrhs, T* x, int ldx) {
    if(nrhs==1) {
       if(m > n)
-         gemv(OP_T, m-n, n, -1.0, &l[n], ldl, &x[n], 1, 1.0, x, 1);
-      host_trsv(FILL_MODE_LWR, OP_T, DIAG_UNIT, n, l, ldl, x, 1);
+         gemv<T>(OP_T, m-n, n, -1.0, &l[n], ldl, &x[n], 1, 1.0, x, 1);
+      host_trsv<T>(FILL_MODE_LWR, OP_T, DIAG_UNIT, n, l, ldl, x, 1);
    } else {
       if(m > n)
-         host_gemm(OP_T, OP_N, n, nrhs, m-n, -1.0, &l[n], ldl, &x[n], ldx, 1.0, x, ldx);
-      host_trsm(SIDE_LEFT, FILL_MODE_LWR, OP_T, DIAG_UNIT, n, nrhs, 1.0, l, ldl, x, ldx);
+         host_gemm<T>(OP_T, OP_N, n, nrhs, m-n, -1.0, &l[n], ldl, &x[n], ldx, 1.0, x, ldx);
+      host_trsm<T>(SIDE_LEFT, FILL_MODE_LWR, OP_T, DIAG_UNIT, n, nrhs, 1.0, l, ldl, x, ldx);
    }
 }
+template void ldlt_tpp_solve_bwd<double>(int, int, double const*, int, int, double*, int);
+template void ldlt_tpp_solve_bwd<float>(int, int, float const*, int, int, float*, int);
 
 }}} /* end of namespace spral::ssids::cpu */
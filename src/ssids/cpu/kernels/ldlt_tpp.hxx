@@ -7,11 +7,15 @@
 
 namespace spral { namespace ssids { namespace cpu {
 
-int ldlt_tpp_factor(int m, int n, int* perm, double* a, int lda, double* d,
-      double* ld, int ldld, bool action, double u, double small,
-      int nleft=0, double *aleft=nullptr, int ldleft=0);
-void ldlt_tpp_solve_fwd(int m, int n, double const* l, int ldl, int nrhs, double* x, int ldx);
-void ldlt_tpp_solve_diag(int n, double const* d, double* x);
-void ldlt_tpp_solve_bwd(int m, int n, double const* l, int ldl, int nrhs, double* x, int ldx);
+template <typename T>
+int ldlt_tpp_factor(int m, int n, int* perm, T* a, int lda, T* d,
+      T* ld, int ldld, bool action, double u, double small,
+      int nleft=0, T *aleft=nullptr, int ldleft=0);
+template <typename T>
+void ldlt_tpp_solve_fwd(int m, int n, T const* l, int ldl, int nrhs, T* x, int ldx);
+template <typename T>
+void ldlt_tpp_solve_diag(int n, T const* d, T* x);
+template <typename T>
+void ldlt_tpp_solve_bwd(int m, int n, T const* l, int ldl, int nrhs, T* x, int ldx);
 
 }}} /* end of namespace spral::ssids::cpu */
@@ -25,11 +25,15 @@ module spral_ssids_cpu_subtree
 
   type, extends(numeric_subtree_base) :: cpu_numeric_subtree
      logical(C_BOOL) :: posdef
+     logical(C_BOOL) :: single ! factors held in single precision
      type(cpu_symbolic_subtree), pointer :: symbolic
      type(C_PTR) :: csubtree
    contains
      procedure :: get_contrib
      procedure :: solve_fwd
+     procedure :: get_root_contrib_size
+     procedure :: solve_fwd_contrib
+     procedure :: add_root_contrib
      procedure :: solve_diag
      procedure :: solve_diag_bwd
      procedure :: solve_bwd
@@ -67,13 +71,14 @@ module spral_ssids_cpu_subtree
        type(C_PTR), value :: subtree
      end subroutine c_destroy_symbolic_subtree
 
-     type(C_PTR) function c_create_numeric_subtree(posdef, symbolic_subtree, &
-          aval, scaling, child_contrib, options, stats) &
+     type(C_PTR) function c_create_numeric_subtree(posdef, single, &
+          symbolic_subtree, aval, scaling, child_contrib, options, stats) &
           bind(C, name="spral_ssids_cpu_create_num_subtree_dbl")
        use, intrinsic :: iso_c_binding
        import :: cpu_factor_options, cpu_factor_stats
        implicit none
        logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
        type(C_PTR), value :: symbolic_subtree
        real(C_DOUBLE), dimension(*), intent(in) :: aval
        type(C_PTR), value :: scaling
@@ -82,87 +87,124 @@ module spral_ssids_cpu_subtree
        type(cpu_factor_stats), intent(out) :: stats
      end function c_create_numeric_subtree
 
-     subroutine c_destroy_numeric_subtree(posdef, subtree) &
+     subroutine c_destroy_numeric_subtree(posdef, single, subtree) &
           bind(C, name="spral_ssids_cpu_destroy_num_subtree_dbl")
        use, intrinsic :: iso_c_binding
        implicit none
        logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
        type(C_PTR), value :: subtree
      end subroutine c_destroy_numeric_subtree
 
-     integer(C_INT) function c_subtree_solve_fwd(posdef, subtree, nrhs, x, &
-          ldx) &
+     integer(C_INT) function c_subtree_solve_fwd(posdef, single, subtree, &
+          nrhs, x, ldx, active, root_contrib) &
           bind(C, name="spral_ssids_cpu_subtree_solve_fwd_dbl")
        use, intrinsic :: iso_c_binding
        implicit none
        logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
        type(C_PTR), value :: subtree
        integer(C_INT), value :: nrhs
        real(C_DOUBLE), dimension(*), intent(inout) :: x
        integer(C_INT), value :: ldx
+       logical(C_BOOL), dimension(*), optional, intent(in) :: active
+       real(C_DOUBLE), dimension(*), optional, intent(out) :: root_contrib
      end function c_subtree_solve_fwd
 
-     integer(C_INT) function c_subtree_solve_diag(posdef, subtree, nrhs, x, &
-          ldx) &
+     integer(C_INT64_T) function c_subtree_root_contrib_size(posdef, single, &
+          subtree) &
+          bind(C, name="spral_ssids_cpu_subtree_root_contrib_size_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+     end function c_subtree_root_contrib_size
+
+     integer(C_INT) function c_subtree_add_root_contrib(posdef, single, &
+          subtree, nrhs, root_contrib, x, ldx) &
+          bind(C, name="spral_ssids_cpu_subtree_add_root_contrib_dbl")
+       use, intrinsic :: iso_c_binding
+       implicit none
+       logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
+       type(C_PTR), value :: subtree
+       integer(C_INT), value :: nrhs
+       real(C_DOUBLE), dimension(*), intent(in) :: root_contrib
+       real(C_DOUBLE), dimension(*), intent(inout) :: x
+       integer(C_INT), value :: ldx
+     end function c_subtree_add_root_contrib
+
+     integer(C_INT) function c_subtree_solve_diag(posdef, single, subtree, &
+          nrhs, x, ldx, active) &
           bind(C, name="spral_ssids_cpu_subtree_solve_diag_dbl")
        use, intrinsic :: iso_c_binding
        implicit none
        logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
        type(C_PTR), value :: subtree
        integer(C_INT), value :: nrhs
        real(C_DOUBLE), dimension(*), intent(inout) :: x
        integer(C_INT), value :: ldx
+       logical(C_BOOL), dimension(*), optional, intent(in) :: active
      end function c_subtree_solve_diag
 
-     integer(C_INT) function c_subtree_solve_diag_bwd(posdef, subtree, nrhs, &
-          x, ldx) &
+     integer(C_INT) function c_subtree_solve_diag_bwd(posdef, single, &
+          subtree, nrhs, x, ldx, active) &
           bind(C, name="spral_ssids_cpu_subtree_solve_diag_bwd_dbl")
        use, intrinsic :: iso_c_binding
        implicit none
        logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
        type(C_PTR), value :: subtree
        integer(C_INT), value :: nrhs
        real(C_DOUBLE), dimension(*), intent(inout) :: x
        integer(C_INT), value :: ldx
+       logical(C_BOOL), dimension(*), optional, intent(in) :: active
      end function c_subtree_solve_diag_bwd
 
-     integer(C_INT) function c_subtree_solve_bwd(posdef, subtree, nrhs, x, &
-          ldx) &
+     integer(C_INT) function c_subtree_solve_bwd(posdef, single, subtree, &
+          nrhs, x, ldx, active) &
           bind(C, name="spral_ssids_cpu_subtree_solve_bwd_dbl")
        use, intrinsic :: iso_c_binding
        implicit none
        logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
        type(C_PTR), value :: subtree
        integer(C_INT), value :: nrhs
        real(C_DOUBLE), dimension(*), intent(inout) :: x
        integer(C_INT), value :: ldx
+       logical(C_BOOL), dimension(*), optional, intent(in) :: active
      end function c_subtree_solve_bwd
 
-     subroutine c_subtree_enquire(posdef, subtree, piv_order, d) &
+     subroutine c_subtree_enquire(posdef, single, subtree, piv_order, d) &
           bind(C, name="spral_ssids_cpu_subtree_enquire_dbl")
        use, intrinsic :: iso_c_binding
        implicit none
        logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
        type(C_PTR), value :: subtree
        type(C_PTR), value :: piv_order
        type(C_PTR), value :: d
      end subroutine c_subtree_enquire
 
-     subroutine c_subtree_alter(posdef, subtree, d) &
+     subroutine c_subtree_alter(posdef, single, subtree, d) &
           bind(C, name="spral_ssids_cpu_subtree_alter_dbl")
        use, intrinsic :: iso_c_binding
        implicit none
        logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
        type(C_PTR), value :: subtree
        real(C_DOUBLE), dimension(*), intent(in) :: d
      end subroutine c_subtree_alter
 
-     subroutine c_get_contrib(posdef, subtree, n, val, ldval, rlist, ndelay, &
-          delay_perm, delay_val, lddelay) &
+     subroutine c_get_contrib(posdef, single, subtree, n, val, ldval, rlist, &
+          ndelay, delay_perm, delay_val, lddelay) &
           bind(C, name="spral_ssids_cpu_subtree_get_contrib_dbl")
        use, intrinsic :: iso_c_binding
        implicit none
        logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
        type(C_PTR), value :: subtree
        integer(C_INT) :: n
        type(C_PTR) :: val
@@ -174,11 +216,12 @@ module spral_ssids_cpu_subtree
        integer(C_INT) :: lddelay
      end subroutine c_get_contrib
 
-     subroutine c_free_contrib(posdef, subtree) &
+     subroutine c_free_contrib(posdef, single, subtree) &
           bind(C, name="spral_ssids_cpu_subtree_free_contrib_dbl")
        use, intrinsic :: iso_c_binding
        implicit none
        logical(C_BOOL), value :: posdef
+       logical(C_BOOL), value :: single
        type(C_PTR), value :: subtree
      end subroutine c_free_contrib
   end interface
@@ -263,14 +306,16 @@ contains
 
     ! Call C++ factor routine
     cpu_factor%posdef = posdef
+    cpu_factor%single = options%single_precision
     cscaling = C_NULL_PTR
     if (present(scaling)) cscaling = C_LOC(scaling)
     call cpu_copy_options_in(options, coptions)
     cpu_factor%csubtree = &
-         c_create_numeric_subtree(cpu_factor%posdef, this%csubtree, &
-         aval, cscaling, contrib_ptr, coptions, cstats)
+         c_create_numeric_subtree(cpu_factor%posdef, cpu_factor%single, &
+         this%csubtree, aval, cscaling, contrib_ptr, coptions, cstats)
     if (cstats%flag .lt. 0) then
-       call c_destroy_numeric_subtree(cpu_factor%posdef, cpu_factor%csubtree)
+       call c_destroy_numeric_subtree(cpu_factor%posdef, cpu_factor%single, &
+            cpu_factor%csubtree)
        deallocate(cpu_factor, stat=st)
        inform%flag = cstats%flag
        return
@@ -295,7 +340,7 @@ contains
     implicit none
     class(cpu_numeric_subtree), intent(inout) :: this
 
-    call c_destroy_numeric_subtree(this%posdef, this%csubtree)
+    call c_destroy_numeric_subtree(this%posdef, this%single, this%csubtree)
   end subroutine numeric_cleanup
 
   function get_contrib(this)
@@ -305,9 +350,9 @@ contains
 
     type(C_PTR) :: cval, crlist, delay_perm, delay_val
 
-    call c_get_contrib(this%posdef, this%csubtree, get_contrib%n, cval,        &
-         get_contrib%ldval, crlist, get_contrib%ndelay, delay_perm, delay_val, &
-         get_contrib%lddelay)
+    call c_get_contrib(this%posdef, this%single, this%csubtree, get_contrib%n, &
+         cval, get_contrib%ldval, crlist, get_contrib%ndelay, delay_perm, &
+         delay_val, get_contrib%lddelay)
     call c_f_pointer(cval, get_contrib%val, shape = (/ get_contrib%n**2 /))
     call c_f_pointer(crlist, get_contrib%rlist, shape = (/ get_contrib%n /))
     if (c_associated(delay_val)) then
@@ -321,62 +366,123 @@ contains
     end if
     get_contrib%owner = 0 ! cpu
     get_contrib%posdef = this%posdef
+    get_contrib%single = this%single
     get_contrib%owner_ptr = this%csubtree
   end function get_contrib
 
-  subroutine solve_fwd(this, nrhs, x, ldx, inform)
+  subroutine solve_fwd(this, nrhs, x, ldx, inform, active)
     implicit none
     class(cpu_numeric_subtree), intent(inout) :: this
     integer, intent(in) :: nrhs
     real(wp), dimension(*), intent(inout) :: x
     integer, intent(in) :: ldx
     type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
     integer(C_INT) :: flag
 
-    flag = c_subtree_solve_fwd(this%posdef, this%csubtree, nrhs, x, ldx)
+    flag = c_subtree_solve_fwd(this%posdef, this%single, this%csubtree, &
+         nrhs, x, ldx, active)
     if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
   end subroutine solve_fwd
 
-  subroutine solve_diag(this, nrhs, x, ldx, inform)
+  !> @brief Return number of entries per right-hand side of the root_contrib
+  !>        argument of solve_fwd_contrib().
+  function get_root_contrib_size(this) result(sz)
+    implicit none
+    class(cpu_numeric_subtree), intent(in) :: this
+    integer(long) :: sz
+
+    sz = c_subtree_root_contrib_size(this%posdef, this%single, this%csubtree)
+  end function get_root_contrib_size
+
+  !> @brief As solve_fwd(), but the updates from the roots of the subtree to
+  !>        the rows of its ancestors are returned in root_contrib rather than
+  !>        added to x.
+  !>
+  !> Only the rows of x eliminated in this subtree are then written, so
+  !> subtrees with no ancestor/descendant relation may be solved concurrently.
+  !> The updates are later added to x by add_root_contrib().
+  subroutine solve_fwd_contrib(this, nrhs, x, ldx, root_contrib, inform, &
+       active)
+    implicit none
+    class(cpu_numeric_subtree), intent(inout) :: this
+    integer, intent(in) :: nrhs
+    real(wp), dimension(*), intent(inout) :: x
+    integer, intent(in) :: ldx
+    real(wp), dimension(*), intent(out) :: root_contrib
+    type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
+
+    integer(C_INT) :: flag
+
+    flag = c_subtree_solve_fwd(this%posdef, this%single, this%csubtree, &
+         nrhs, x, ldx, active, root_contrib)
+    if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
+  end subroutine solve_fwd_contrib
+
+  !> @brief Add root updates returned by solve_fwd_contrib() to x.
+  subroutine add_root_contrib(this, nrhs, root_contrib, x, ldx, inform)
+    implicit none
+    class(cpu_numeric_subtree), intent(inout) :: this
+    integer, intent(in) :: nrhs
+    real(wp), dimension(*), intent(in) :: root_contrib
+    real(wp), dimension(*), intent(inout) :: x
+    integer, intent(in) :: ldx
+    type(ssids_inform), intent(inout) :: inform
+
+    integer(C_INT) :: flag
+
+    flag = c_subtree_add_root_contrib(this%posdef, this%single, &
+         this%csubtree, nrhs, root_contrib, x, ldx)
+    if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
+  end subroutine add_root_contrib
+
+  subroutine solve_diag(this, nrhs, x, ldx, inform, active)
     implicit none
     class(cpu_numeric_subtree), intent(inout) :: this
     integer, intent(in) :: nrhs
     real(wp), dimension(*), intent(inout) :: x
     integer, intent(in) :: ldx
     type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
     integer(C_INT) :: flag
 
-    flag = c_subtree_solve_diag(this%posdef, this%csubtree, nrhs, x, ldx)
+    flag = c_subtree_solve_diag(this%posdef, this%single, this%csubtree, &
+         nrhs, x, ldx, active)
     if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
   end subroutine solve_diag
 
-  subroutine solve_diag_bwd(this, nrhs, x, ldx, inform)
+  subroutine solve_diag_bwd(this, nrhs, x, ldx, inform, active)
     implicit none
     class(cpu_numeric_subtree), intent(inout) :: this
     integer, intent(in) :: nrhs
     real(wp), dimension(*), intent(inout) :: x
     integer, intent(in) :: ldx
     type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
     integer(C_INT) :: flag
 
-    flag = c_subtree_solve_diag_bwd(this%posdef, this%csubtree, nrhs, x, ldx)
+    flag = c_subtree_solve_diag_bwd(this%posdef, this%single, this%csubtree, &
+         nrhs, x, ldx, active)
     if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
   end subroutine solve_diag_bwd
 
-  subroutine solve_bwd(this, nrhs, x, ldx, inform)
+  subroutine solve_bwd(this, nrhs, x, ldx, inform, active)
     implicit none
     class(cpu_numeric_subtree), intent(inout) :: this
     integer, intent(in) :: nrhs
     real(wp), dimension(*), intent(inout) :: x
     integer, intent(in) :: ldx
     type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
     integer(C_INT) :: flag
 
-    flag = c_subtree_solve_bwd(this%posdef, this%csubtree, nrhs, x, ldx)
+    flag = c_subtree_solve_bwd(this%posdef, this%single, this%csubtree, &
+         nrhs, x, ldx, active)
     if (flag .ne. SSIDS_SUCCESS) inform%flag = flag
   end subroutine solve_bwd
 
@@ -385,7 +491,8 @@ contains
     class(cpu_numeric_subtree), intent(in) :: this
     real(wp), dimension(*), target, intent(out) :: d
 
-    call c_subtree_enquire(this%posdef, this%csubtree, C_NULL_PTR, C_LOC(d))
+    call c_subtree_enquire(this%posdef, this%single, this%csubtree, &
+         C_NULL_PTR, C_LOC(d))
   end subroutine enquire_posdef
 
   subroutine enquire_indef(this, piv_order, d)
@@ -403,7 +510,7 @@ contains
     if (present(d)) dptr = C_LOC(d)
 
     ! Call C++ routine
-    call c_subtree_enquire(this%posdef, this%csubtree, poptr, dptr)
+    call c_subtree_enquire(this%posdef, this%single, this%csubtree, poptr, dptr)
   end subroutine enquire_indef
 
   subroutine alter(this, d)
@@ -411,15 +518,16 @@ contains
     class(cpu_numeric_subtree), target, intent(inout) :: this
     real(wp), dimension(2,*), intent(in) :: d
 
-    call c_subtree_alter(this%posdef, this%csubtree, d)
+    call c_subtree_alter(this%posdef, this%single, this%csubtree, d)
   end subroutine alter
 
-  subroutine cpu_free_contrib(posdef, csubtree)
+  subroutine cpu_free_contrib(posdef, single, csubtree)
     implicit none
     logical(C_BOOL), intent(in) :: posdef
+    logical(C_BOOL), intent(in) :: single
     type(C_PTR), intent(inout) :: csubtree
 
-    call c_free_contrib(posdef, csubtree)
+    call c_free_contrib(posdef, single, csubtree)
   end subroutine cpu_free_contrib
 
 end module spral_ssids_cpu_subtree
@@ -39,6 +39,7 @@ module spral_ssids_datatypes
   integer, parameter, public :: SSIDS_ERROR_NOT_LLT           = -13
   integer, parameter, public :: SSIDS_ERROR_NOT_LDLT          = -14
   integer, parameter, public :: SSIDS_ERROR_NO_SAVED_SCALING  = -15
+  integer, parameter, public :: SSIDS_ERROR_SPARSE_RHS        = -16
   integer, parameter, public :: SSIDS_ERROR_ALLOCATION        = -50
   integer, parameter, public :: SSIDS_ERROR_CUDA_UNKNOWN      = -51
   integer, parameter, public :: SSIDS_ERROR_CUBLAS_UNKNOWN    = -52
@@ -56,6 +57,7 @@ module spral_ssids_datatypes
   integer, parameter, public :: SSIDS_WARNING_ANAL_SINGULAR    = 6
   integer, parameter, public :: SSIDS_WARNING_FACT_SINGULAR    = 7
   integer, parameter, public :: SSIDS_WARNING_MATCH_ORD_NO_SCALE=8
+  integer, parameter, public :: SSIDS_WARNING_REFINE_NOT_CONV  = 9
 !$ integer, parameter, public :: SSIDS_WARNING_OMP_PROC_BIND    = 50
 
   ! solve job values
@@ -212,6 +214,16 @@ module spral_ssids_datatypes
        ! 2 Matching with METIS on compressed matrix.
      integer :: nemin = nemin_default ! Min. number of eliminations at a tree
        ! node for amalgamation not to be considered.
+     integer :: band_mode = 0 ! controls use of the band-specialized
+       ! factorization, which skips the ordering and tree-based analysis.
+       !  <=0: never used (default).
+       !    1: used if the semi-bandwidth of A (in the order supplied if
+       !       ordering=0, otherwise in its natural order) is at most
+       !       band_max_width.
+       !  >=2: used whatever the bandwidth.
+       ! Not used with ordering=2.
+     integer :: band_max_width = 64 ! Largest semi-bandwidth for which
+       ! band_mode=1 selects the band-specialized factorization.
 
      !
      ! High level subtree splitting parameters
@@ -236,6 +248,18 @@ module spral_ssids_datatypes
        !    2: Matching-based scaling by Auction Algorithm
        !    3: Scaling generated during analyse phase for matching-based order
        !  >=4: Norm equilibriation algorithm (MC77-like)
+     logical :: single_precision = .false. ! If true, factors computed on the
+       ! CPU are computed and held in single precision. Solves still take
+       ! and return double precision values; use ssids_solve_refine() to
+       ! recover double precision accuracy.
+
+     !
+     ! Options used by ssids_solve_refine()
+     !
+     integer :: max_refine = 10 ! Maximum number of refinement steps.
+     real(wp) :: refine_tol = 1e-14_wp ! Refinement stops once the scaled
+       ! residual max|b-Ax| / (||A|| ||x|| + ||b||) is at most refine_tol
+       ! (infinity norms).
 
      !
      ! CPU-specific
@@ -317,6 +341,8 @@ contains
     write (mp,'(a,i15)') ' options%unit_warning      =  ',this%unit_warning
     write (mp,'(a,i15)') ' options%nemin             =  ',this%nemin
     write (mp,'(a,i15)') ' options%ordering          =  ',this%ordering
+    write (mp,'(a,i15)') ' options%band_mode         =  ',this%band_mode
+    write (mp,'(a,i15)') ' options%band_max_width    =  ',this%band_max_width
   end subroutine print_summary_analyse
 
 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
@@ -552,17 +552,24 @@ contains
 
 ! FIXME: general: push/pop cuda settings at higher level
 ! FIXME: general: do we need to worry about avoiding unnecessary gpu_x creation?
- subroutine solve_fwd(this, nrhs, x, ldx, inform)
+ subroutine solve_fwd(this, nrhs, x, ldx, inform, active)
    implicit none
    class(gpu_numeric_subtree), intent(inout) :: this
    integer, intent(in) :: nrhs
    real(wp), dimension(*), intent(inout) :: x
    integer, intent(in) :: ldx
    type(ssids_inform), intent(inout) :: inform
+   logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
    integer :: r
    integer :: cuda_error
 
+   ! Solves restricted to active nodes are only supported on the CPU
+   if (present(active)) then
+      inform%flag = SSIDS_ERROR_UNIMPLEMENTED
+      return
+   end if
+
    ! Specify which device we're using
    cuda_error = cudaSetDevice(this%symbolic%device)
    if (cuda_error .ne. 0) goto 200
@@ -591,17 +598,24 @@ contains
  end subroutine solve_fwd
 
  ! FIXME: general solve : recover gpu_x memory on error?
- subroutine solve_diag(this, nrhs, x, ldx, inform)
+ subroutine solve_diag(this, nrhs, x, ldx, inform, active)
    implicit none
    class(gpu_numeric_subtree), intent(inout) :: this
    integer, intent(in) :: nrhs
    real(wp), dimension(*), intent(inout) :: x
    integer, intent(in) :: ldx
    type(ssids_inform), intent(inout) :: inform
+   logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
    integer :: r
    integer :: cuda_error
 
+   ! Solves restricted to active nodes are only supported on the CPU
+   if (present(active)) then
+      inform%flag = SSIDS_ERROR_UNIMPLEMENTED
+      return
+   end if
+
    ! Specify which device we're using
    cuda_error = cudaSetDevice(this%symbolic%device)
    if (cuda_error .ne. 0) goto 200
@@ -627,17 +641,24 @@ contains
    return
  end subroutine solve_diag
 
- subroutine solve_diag_bwd(this, nrhs, x, ldx, inform)
+ subroutine solve_diag_bwd(this, nrhs, x, ldx, inform, active)
    implicit none
    class(gpu_numeric_subtree), intent(inout) :: this
    integer, intent(in) :: nrhs
    real(wp), dimension(*), intent(inout) :: x
    integer, intent(in) :: ldx
    type(ssids_inform), intent(inout) :: inform
+   logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
    integer :: r
    integer :: cuda_error
 
+   ! Solves restricted to active nodes are only supported on the CPU
+   if (present(active)) then
+      inform%flag = SSIDS_ERROR_UNIMPLEMENTED
+      return
+   end if
+
    ! Specify which device we're using
    cuda_error = cudaSetDevice(this%symbolic%device)
    if (cuda_error .ne. 0) goto 200
@@ -663,17 +684,24 @@ contains
    return
  end subroutine solve_diag_bwd
 
- subroutine solve_bwd(this, nrhs, x, ldx, inform)
+ subroutine solve_bwd(this, nrhs, x, ldx, inform, active)
    implicit none
    class(gpu_numeric_subtree), intent(inout) :: this
    integer, intent(in) :: nrhs
    real(wp), dimension(*), intent(inout) :: x
    integer, intent(in) :: ldx
    type(ssids_inform), intent(inout) :: inform
+   logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
    integer :: r
    integer :: cuda_error
 
+   ! Solves restricted to active nodes are only supported on the CPU
+   if (present(active)) then
+      inform%flag = SSIDS_ERROR_UNIMPLEMENTED
+      return
+   end if
+
    ! Specify which device we're using
    cuda_error = cudaSetDevice(this%symbolic%device)
    if (cuda_error .ne. 0) goto 200
@@ -117,55 +117,63 @@ contains
     contrib%n = 0
   end subroutine gpu_free_contrib
 
-  subroutine solve_fwd(this, nrhs, x, ldx, inform)
+  subroutine solve_fwd(this, nrhs, x, ldx, inform, active)
     implicit none
     class(gpu_numeric_subtree), intent(inout) :: this
     integer, intent(in) :: nrhs
     real(wp), dimension(*), intent(inout) :: x
     integer, intent(in) :: ldx
     type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
     ! Dummy operations to prevent warnings
     x(nrhs+1*ldx) = this%dummy
+    if (present(active)) x(1) = merge(x(1), 0.0_wp, logical(active(1)))
     inform%flag = SSIDS_ERROR_UNKNOWN
   end subroutine solve_fwd
 
-  subroutine solve_diag(this, nrhs, x, ldx, inform)
+  subroutine solve_diag(this, nrhs, x, ldx, inform, active)
     implicit none
     class(gpu_numeric_subtree), intent(inout) :: this
     integer, intent(in) :: nrhs
     real(wp), dimension(*), intent(inout) :: x
     integer, intent(in) :: ldx
     type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
     ! Dummy operations to prevent warnings
     x(nrhs+1*ldx) = this%dummy
+    if (present(active)) x(1) = merge(x(1), 0.0_wp, logical(active(1)))
     inform%flag = SSIDS_ERROR_UNKNOWN
   end subroutine solve_diag
 
-  subroutine solve_diag_bwd(this, nrhs, x, ldx, inform)
+  subroutine solve_diag_bwd(this, nrhs, x, ldx, inform, active)
     implicit none
     class(gpu_numeric_subtree), intent(inout) :: this
     integer, intent(in) :: nrhs
     real(wp), dimension(*), intent(inout) :: x
     integer, intent(in) :: ldx
     type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
     ! Dummy operations to prevent warnings
     x(nrhs+1*ldx) = this%dummy
+    if (present(active)) x(1) = merge(x(1), 0.0_wp, logical(active(1)))
     inform%flag = SSIDS_ERROR_UNKNOWN
   end subroutine solve_diag_bwd
 
-  subroutine solve_bwd(this, nrhs, x, ldx, inform)
+  subroutine solve_bwd(this, nrhs, x, ldx, inform, active)
     implicit none
     class(gpu_numeric_subtree), intent(inout) :: this
     integer, intent(in) :: nrhs
     real(wp), dimension(*), intent(inout) :: x
     integer, intent(in) :: ldx
     type(ssids_inform), intent(inout) :: inform
+    logical(C_BOOL), dimension(*), optional, intent(in) :: active
 
     ! Dummy operations to prevent warnings
     x(nrhs+1*ldx) = this%dummy
+    if (present(active)) x(1) = merge(x(1), 0.0_wp, logical(active(1)))
     inform%flag = SSIDS_ERROR_UNKNOWN
   end subroutine solve_bwd
 
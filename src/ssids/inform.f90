@@ -32,6 +32,10 @@ module spral_ssids_inform
      integer :: num_neg = 0 ! Number of negative pivots
      integer :: num_sup = 0 ! Number of supernodes
      integer :: num_two = 0 ! Number of 2x2 pivots used by factorization
+     integer :: num_refine = 0 ! Number of refinement steps performed by
+       ! ssids_solve_refine()
+     integer :: num_relaxed = 0 ! Number of band nodes factorized with a
+       ! relaxed pivot threshold
      integer :: stat = 0 ! stat parameter
      type(auction_inform) :: auction
      integer :: cuda_error = 0
@@ -102,6 +106,8 @@ contains
     case(SSIDS_ERROR_NO_SAVED_SCALING)
        msg = 'Requested use of scaling from matching-based &
             &ordering but matching-based ordering not used'
+    case(SSIDS_ERROR_SPARSE_RHS)
+       msg = 'Error in sparse right-hand side or list of wanted components'
     case(SSIDS_ERROR_UNIMPLEMENTED)
        msg = 'Functionality not yet implemented'
     case(SSIDS_ERROR_CUDA_UNKNOWN)
@@ -134,6 +140,8 @@ contains
        msg = 'Matrix found to be singular'
     case(SSIDS_WARNING_MATCH_ORD_NO_SCALE)
        msg = 'Matching-based ordering used but associated scaling ignored'
+    case(SSIDS_WARNING_REFINE_NOT_CONV)
+       msg = 'Iterative refinement did not reach options%refine_tol'
 !$  case(SSIDS_WARNING_OMP_PROC_BIND)
 !$     msg = 'OMP_PROC_BIND=false, this may reduce performance'
     case default
@@ -203,6 +211,7 @@ contains
     this%num_neg = this%num_neg + other%num_neg
     this%num_sup = this%num_sup + other%num_sup
     this%num_two = this%num_two + other%num_two
+    this%num_relaxed = this%num_relaxed + other%num_relaxed
     if (other%stat .ne. 0) this%stat = other%stat
     ! FIXME: %auction ???
     if (other%cuda_error .ne. 0) this%cuda_error = other%cuda_error
@@ -17,7 +17,8 @@ module spral_ssids
                             hungarian_scale_sym, &
                             equilib_options, equilib_inform, &
                             hungarian_options, hungarian_inform
-  use spral_ssids_anal, only : analyse_phase, check_order, expand_matrix, &
+  use spral_ssids_anal, only : analyse_phase, analyse_band_phase, &
+                               band_select, check_order, expand_matrix, &
                                expand_pattern
   use spral_ssids_datatypes
   use spral_ssids_akeep, only : ssids_akeep
@@ -34,6 +35,8 @@ module spral_ssids
             ssids_analyse_coord,   & ! Analyse phase, Coordinate input
             ssids_factor,          & ! Factorize phase
             ssids_solve,           & ! Solve phase
+            ssids_solve_sparse,    & ! Solve phase, sparse rhs and/or x
+            ssids_solve_refine,    & ! Solve phase, iterative refinement
             ssids_free,            & ! Free akeep and/or fkeep
             ssids_enquire_posdef,  & ! Pivot information in posdef case
             ssids_enquire_indef,   & ! Pivot information in indef case
@@ -65,6 +68,15 @@ module spral_ssids
      module procedure ssids_solve_mult_double
   end interface ssids_solve
 
+  interface ssids_solve_sparse
+     module procedure ssids_solve_sparse_double
+  end interface ssids_solve_sparse
+
+  interface ssids_solve_refine
+     module procedure ssids_solve_refine_ptr32_double
+     module procedure ssids_solve_refine_ptr64_double
+  end interface ssids_solve_refine
+
   interface ssids_free
      module procedure free_akeep_double
      module procedure free_fkeep_double
@@ -164,6 +176,8 @@ contains
     integer(long) :: nz     ! entries in expanded matrix
     integer :: st           ! stat parameter
     integer :: flag         ! error flag for metis
+    integer :: bw           ! semi-bandwidth if band factorization used, or -1
+    integer :: i
 
     integer, dimension(:), allocatable :: order2
     integer(long), dimension(:), allocatable :: ptr2 ! col ptrs for expanded mat
@@ -284,6 +298,7 @@ contains
        if (st .ne. 0) go to 490
     end if
 
+    bw = -1
     select case(options%ordering)
     case(0)
        if (.not. present(order)) then
@@ -297,24 +312,38 @@ contains
        if (inform%flag .lt. 0) go to 490
        order2(1:n) = order(1:n)
        if (check) then
-          call expand_pattern(n, nz, akeep%ptr, akeep%row, ptr2, row2)
+          bw = band_select(n, akeep%ptr, akeep%row, options, order=order2)
+          if (bw .lt. 0) &
+               call expand_pattern(n, nz, akeep%ptr, akeep%row, ptr2, row2)
        else
-          call expand_pattern(n, nz, ptr, row, ptr2, row2)
+          bw = band_select(n, ptr, row, options, order=order2)
+          if (bw .lt. 0) call expand_pattern(n, nz, ptr, row, ptr2, row2)
        end if
     case(1)
-       ! METIS ordering
+       ! METIS ordering, unless the matrix is narrow banded in its natural
+       ! order, in which case that order is kept for the band factorization
        if (check) then
+          bw = band_select(n, akeep%ptr, akeep%row, options)
+       else
+          bw = band_select(n, ptr, row, options)
+       end if
+       if (bw .ge. 0) then
+          do i = 1, n
+             order2(i) = i
+          end do
+       else if (check) then
           call metis_order(n, akeep%ptr, akeep%row, order2, akeep%invp, &
                flag, inform%stat)
           if (flag == - 4) inform%flag = SSIDS_ERROR_NO_METIS
+          if (flag .lt. 0) go to 490
           call expand_pattern(n, nz, akeep%ptr, akeep%row, ptr2, row2)
        else
           call metis_order(n, ptr, row, order2, akeep%invp, &
                flag, inform%stat)
           if (flag == - 4) inform%flag = SSIDS_ERROR_NO_METIS
+          if (flag .lt. 0) go to 490
           call expand_pattern(n, nz, ptr, row, ptr2, row2)
        end if
-       if (flag .lt. 0) go to 490
     case(2)
        ! matching-based ordering required
        ! Expand the matrix as more efficient to do it and then
@@ -367,7 +396,15 @@ contains
     if (st .ne. 0) goto 490
 
     ! perform rest of analyse
-    if (check) then
+    if (bw .ge. 0) then
+       if (check) then
+          call analyse_band_phase(n, akeep%ptr, akeep%row, order2, &
+               akeep%invp, bw, akeep, options, inform)
+       else
+          call analyse_band_phase(n, ptr, row, order2, akeep%invp, bw, &
+               akeep, options, inform)
+       end if
+    else if (check) then
        call analyse_phase(n, akeep%ptr, akeep%row, ptr2, row2, order2,  &
             akeep%invp, akeep, options, inform)
     else
@@ -537,6 +574,8 @@ contains
     integer :: flag         ! error flag for metis
     integer :: st           ! stat parameter
     integer :: free_flag
+    integer :: bw           ! semi-bandwidth if band factorization used, or -1
+    integer :: i
 
     type(ssids_inform) :: inform_default
 
@@ -641,6 +680,7 @@ contains
        if (st .ne. 0) go to 490
     end if
 
+    bw = -1
     select case(options%ordering)
     case(0)
        if (.not. present(order)) then
@@ -653,15 +693,25 @@ contains
        call check_order(n,order,akeep%invp,options,inform)
        if (inform%flag .lt. 0) go to 490
        order2(1:n) = order(1:n)
-       call expand_pattern(n, nz, akeep%ptr, akeep%row, ptr2, row2)
+       bw = band_select(n, akeep%ptr, akeep%row, options, order=order2)
+       if (bw .lt. 0) &
+            call expand_pattern(n, nz, akeep%ptr, akeep%row, ptr2, row2)
 
     case(1)
-       ! METIS ordering
-       call metis_order(n, akeep%ptr, akeep%row, order2, akeep%invp, &
-            flag, inform%stat)
-       if (flag == - 4) inform%flag = SSIDS_ERROR_NO_METIS
-       if (flag .lt. 0) go to 490
-       call expand_pattern(n, nz, akeep%ptr, akeep%row, ptr2, row2)
+       ! METIS ordering, unless the matrix is narrow banded in its natural
+       ! order, in which case that order is kept for the band factorization
+       bw = band_select(n, akeep%ptr, akeep%row, options)
+       if (bw .ge. 0) then
+          do i = 1, n
+             order2(i) = i
+          end do
+       else
+          call metis_order(n, akeep%ptr, akeep%row, order2, akeep%invp, &
+               flag, inform%stat)
+          if (flag == - 4) inform%flag = SSIDS_ERROR_NO_METIS
+          if (flag .lt. 0) go to 490
+          call expand_pattern(n, nz, akeep%ptr, akeep%row, ptr2, row2)
+       end if
 
     case(2)
        ! matching-based ordering required
@@ -708,8 +758,13 @@ contains
 
     ! we now have the expanded structure held using ptr2, row2
     ! and we are ready to get on with the analyse phase.
-    call analyse_phase(n, akeep%ptr, akeep%row, ptr2, row2, order2,  &
-         akeep%invp, akeep, options, inform)
+    if (bw .ge. 0) then
+       call analyse_band_phase(n, akeep%ptr, akeep%row, order2, akeep%invp, &
+            bw, akeep, options, inform)
+    else
+       call analyse_phase(n, akeep%ptr, akeep%row, ptr2, row2, order2,  &
+            akeep%invp, akeep, options, inform)
+    end if
     if (inform%flag .lt. 0) go to 490
 
     if (present(order)) order(1:n) = abs(order2(1:n))
@@ -1249,6 +1304,434 @@ contains
     call inform%print_flag(options, context)
   end subroutine ssids_solve_mult_double
 
+!*************************************************************************
+!
+! Solve phase with sparse right-hand sides, optionally computing only
+! selected components of the solution. Only the parts of the factors on the
+! paths from the nonzeros of the right-hand sides and from the wanted
+! components to the roots of the assembly tree are used.
+!
+  subroutine ssids_solve_sparse_double(nrhs, rhs_ptr, rhs_row, rhs_val, x, &
+       ldx, akeep, fkeep, options, inform, want)
+    implicit none
+    integer, intent(in) :: nrhs
+    integer, dimension(nrhs+1), intent(in) :: rhs_ptr ! Column pointers of
+      ! right-hand sides in CSC format
+    integer, dimension(*), intent(in) :: rhs_row ! Row indices of
+      ! right-hand sides. Duplicates are summed.
+    real(wp), dimension(*), intent(in) :: rhs_val ! Values of right-hand sides
+    integer, intent(in) :: ldx
+    real(wp), dimension(ldx,nrhs), intent(inout) :: x ! On exit, x(i,j)
+      ! holds component i of the solution to system j for each wanted i.
+      ! Other entries are not altered.
+    type(ssids_akeep), intent(in) :: akeep
+    ! For details of keep, options, inform : see derived type description
+    type(ssids_fkeep), intent(inout) :: fkeep
+    type(ssids_options), intent(in) :: options
+    type(ssids_inform), intent(out) :: inform
+    integer, dimension(:), optional, intent(in) :: want ! Components of the
+      ! solution to compute. If absent, all are computed.
+
+    character(50)  :: context  ! Procedure name (used when printing).
+    integer :: i, n
+
+    inform%flag = SSIDS_SUCCESS
+
+    ! Perform appropriate printing
+    if ((options%print_level .ge. 1) .and. (options%unit_diagnostics .ge. 0)) then
+       write (options%unit_diagnostics,'(//a)') &
+            ' Entering ssids_solve_sparse with:'
+       write (options%unit_diagnostics,'(a,4(/a,i12),(/a,i12))') &
+            ' options parameters (options%) :', &
+            ' print_level         Level of diagnostic printing        = ', &
+            options%print_level, &
+            ' unit_diagnostics    Unit for diagnostics                = ', &
+            options%unit_diagnostics, &
+            ' unit_error          Unit for errors                     = ', &
+            options%unit_error, &
+            ' unit_warning        Unit for warnings                   = ', &
+            options%unit_warning, &
+            ' nrhs                                                    = ', &
+            nrhs
+       if (present(want)) write (options%unit_diagnostics,'(/a,i12)') &
+            ' size(want)                                              = ', &
+            size(want)
+    end if
+
+    context = 'ssids_solve_sparse'
+
+    if (akeep%nnodes .eq. 0) return
+
+    if (.not. allocated(fkeep%subtree)) then
+       ! factorize phase has not been performed
+       inform%flag = SSIDS_ERROR_CALL_SEQUENCE
+       call inform%print_flag(options, context)
+       return
+    end if
+
+    inform%flag = max(SSIDS_SUCCESS, fkeep%inform%flag) ! Preserve warnings
+    ! immediate return if already had an error
+    if ((akeep%inform%flag .lt. 0) .or. (fkeep%inform%flag .lt. 0)) then
+       inform%flag = SSIDS_ERROR_CALL_SEQUENCE
+       call inform%print_flag(options, context)
+       return
+    end if
+
+    n = akeep%n
+    if ((ldx .lt. n) .or. (nrhs .lt. 1)) then
+       inform%flag = SSIDS_ERROR_X_SIZE
+       call inform%print_flag(options, context)
+       return
+    end if
+
+    ! Check right-hand sides and wanted components
+    if (rhs_ptr(1) .ne. 1) inform%flag = SSIDS_ERROR_SPARSE_RHS
+    do i = 1, nrhs
+       if (rhs_ptr(i+1) .lt. rhs_ptr(i)) inform%flag = SSIDS_ERROR_SPARSE_RHS
+    end do
+    if (inform%flag .ne. SSIDS_ERROR_SPARSE_RHS) then
+       do i = 1, rhs_ptr(nrhs+1)-1
+          if ((rhs_row(i) .lt. 1) .or. (rhs_row(i) .gt. n)) &
+               inform%flag = SSIDS_ERROR_SPARSE_RHS
+       end do
+    end if
+    if (present(want)) then
+       if (any(want(:) .lt. 1) .or. any(want(:) .gt. n)) &
+            inform%flag = SSIDS_ERROR_SPARSE_RHS
+    end if
+    if (inform%flag .eq. SSIDS_ERROR_SPARSE_RHS) then
+       call inform%print_flag(options, context)
+       return
+    end if
+
+    ! Copy previous phases' inform data from akeep and fkeep
+    inform = fkeep%inform
+
+    call fkeep%inner_solve_sparse(nrhs, rhs_ptr, rhs_row, rhs_val, x, ldx, &
+         akeep, inform, want=want)
+    call inform%print_flag(options, context)
+  end subroutine ssids_solve_sparse_double
+
+!*************************************************************************
+!
+! Solve phase with iterative refinement - 32-bit wrapper around 64-bit version
+! Note ptr is non-optional
+!
+  subroutine ssids_solve_refine_ptr32_double(nrhs, x, ldx, val, akeep, fkeep, &
+       options, inform, ptr, row)
+    implicit none
+    integer, intent(in) :: nrhs
+    integer, intent(in) :: ldx
+    real(wp), dimension(ldx,nrhs), intent(inout) :: x
+    real(wp), dimension(*), intent(in) :: val
+    type(ssids_akeep), intent(in) :: akeep
+    type(ssids_fkeep), intent(inout) :: fkeep
+    type(ssids_options), intent(in) :: options
+    type(ssids_inform), intent(out) :: inform
+    integer, dimension(akeep%n+1), intent(in) :: ptr
+    integer, dimension(*), optional, intent(in) :: row
+
+    integer(long), dimension(:), allocatable :: ptr64
+
+    ! Copy from 32-bit to 64-bit ptr
+    allocate(ptr64(akeep%n+1), stat=inform%stat)
+    if (inform%stat .ne. 0) then
+       inform%flag = SSIDS_ERROR_ALLOCATION
+       call inform%print_flag(options, 'ssids_solve_refine')
+       return
+    end if
+    ptr64(1:akeep%n+1) = ptr(1:akeep%n+1)
+
+    ! Call 64-bit routine
+    call ssids_solve_refine_ptr64_double(nrhs, x, ldx, val, akeep, fkeep, &
+         options, inform, ptr=ptr64, row=row)
+  end subroutine ssids_solve_refine_ptr32_double
+
+!*************************************************************************
+!
+! Solve phase with iterative refinement. Solves Ax = b using the computed
+! factors, then repeatedly corrects x using the residual b - Ax computed in
+! double precision. Intended for use with factors held in single precision
+! (options%single_precision = .true.), but is also valid for double precision
+! factors.
+!
+! Refinement of each right-hand side stops once its scaled residual
+!    max_i |b - Ax|_i / ( ||A||_inf ||x||_inf + ||b||_inf )
+! is at most options%refine_tol, once it fails to halve in a step, or once
+! options%max_refine steps have been taken. The solution with the smallest
+! scaled residual is returned, so a step that increases it is undone.
+!
+  subroutine ssids_solve_refine_ptr64_double(nrhs, x, ldx, val, akeep, fkeep, &
+       options, inform, ptr, row)
+    implicit none
+    integer, intent(in) :: nrhs
+    integer, intent(in) :: ldx
+    real(wp), dimension(ldx,nrhs), intent(inout) :: x ! On entry, x(i,j)
+      ! holds component i of the right-hand side for system j. On exit, it
+      ! holds component i of the refined solution to system j.
+    real(wp), dimension(*), target, intent(in) :: val ! A values (lwr triangle)
+      ! as passed to ssids_factor()
+    type(ssids_akeep), intent(in) :: akeep
+    ! For details of keep, options, inform : see derived type description
+    type(ssids_fkeep), intent(inout) :: fkeep
+    type(ssids_options), intent(in) :: options
+    type(ssids_inform), intent(out) :: inform
+    integer(long), dimension(akeep%n+1), optional, intent(in) :: ptr ! must be
+      ! present if on call to analyse phase, check = .false.. Must be unchanged
+      ! since that call.
+    integer, dimension(*), optional, intent(in) :: row ! must be present if
+      ! on call to analyse phase, check = .false.. Must be unchanged
+      ! since that call.
+
+    character(50)  :: context  ! Procedure name (used when printing).
+    integer :: i, j, k, n, nact, local_job, matrix_type, st
+    integer(long) :: nz
+    real(wp) :: anorm, denom, err
+    real(wp), dimension(:), allocatable :: val2
+    real(wp), dimension(:), allocatable :: rowsum ! abs row sums of A
+    real(wp), dimension(:,:), allocatable :: b ! original right-hand sides
+    real(wp), dimension(:,:), allocatable :: r ! residuals/corrections for
+      ! right-hand sides still being refined
+    real(wp), dimension(:,:), allocatable :: xbest ! solutions with the
+      ! smallest scaled residuals found so far
+    real(wp), dimension(:), allocatable :: berr ! scaled residual of xbest
+    integer, dimension(:), allocatable :: active ! active(k) is the system
+      ! whose residual is held in r(:,k)
+    logical, dimension(:), allocatable :: done
+    logical :: conv
+
+    inform%flag = SSIDS_SUCCESS
+
+    ! Perform appropriate printing
+    if ((options%print_level .ge. 1) .and. (options%unit_diagnostics .ge. 0)) then
+       write (options%unit_diagnostics,'(//a)') &
+            ' Entering ssids_solve_refine with:'
+       write (options%unit_diagnostics,'(a,5(/a,i12),(/a,es12.4),(/a,i12))') &
+            ' options parameters (options%) :', &
+            ' print_level         Level of diagnostic printing        = ', &
+            options%print_level, &
+            ' unit_diagnostics    Unit for diagnostics                = ', &
+            options%unit_diagnostics, &
+            ' unit_error          Unit for errors                     = ', &
+            options%unit_error, &
+            ' unit_warning        Unit for warnings                   = ', &
+            options%unit_warning, &
+            ' max_refine          Maximum refinement steps            = ', &
+            options%max_refine, &
+            ' refine_tol          Refinement tolerance                = ', &
+            options%refine_tol, &
+            ' nrhs                                                    = ', &
+            nrhs
+    end if
+
+    context = 'ssids_solve_refine'
+
+    if (akeep%nnodes .eq. 0) return
+
+    if (.not. allocated(fkeep%subtree)) then
+       ! factorize phase has not been performed
+       inform%flag = SSIDS_ERROR_CALL_SEQUENCE
+       call inform%print_flag(options, context)
+       return
+    end if
+
+    inform%flag = max(SSIDS_SUCCESS, fkeep%inform%flag) ! Preserve warnings
+    ! immediate return if already had an error
+    if ((akeep%inform%flag .lt. 0) .or. (fkeep%inform%flag .lt. 0)) then
+       inform%flag = SSIDS_ERROR_CALL_SEQUENCE
+       call inform%print_flag(options, context)
+       return
+    end if
+
+    n = akeep%n
+    if ((ldx .lt. n) .or. (nrhs .lt. 1)) then
+       inform%flag = SSIDS_ERROR_X_SIZE
+       call inform%print_flag(options, context)
+       return
+    end if
+
+    ! Copy previous phases' inform data from akeep and fkeep
+    inform = fkeep%inform
+    st = 0
+
+    ! If matrix has been checked, produce a clean version of val in val2
+    if (akeep%check) then
+       if (fkeep%pos_def) then
+          matrix_type = SPRAL_MATRIX_REAL_SYM_PSDEF
+       else
+          matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+       end if
+       nz = akeep%ptr(n+1) - 1
+       allocate(val2(nz), stat=st)
+       if (st .ne. 0) goto 10
+       call apply_conversion_map(matrix_type, akeep%lmap, akeep%map, val, &
+            nz, val2)
+    else
+       ! analyse run with no checking so must have ptr and row present
+       if ((.not. present(ptr)) .or. (.not. present(row))) then
+          inform%flag = SSIDS_ERROR_PTR_ROW
+          call inform%print_flag(options, context)
+          return
+       end if
+    end if
+
+    allocate(b(n,nrhs), r(n,nrhs), xbest(n,nrhs), rowsum(n), berr(nrhs), &
+         active(nrhs), done(nrhs), stat=st)
+    if (st .ne. 0) goto 10
+
+    ! Find ||A||_inf
+    if (akeep%check) then
+       call sym_csc_abs_rowsum(n, akeep%ptr, akeep%row, val2, rowsum)
+    else
+       call sym_csc_abs_rowsum(n, ptr, row, val, rowsum)
+    end if
+    anorm = maxval(rowsum(:))
+
+    ! Initial solve
+    b(:,:) = x(1:n,:)
+    local_job = 0
+    call fkeep%inner_solve(local_job, nrhs, x, ldx, akeep, inform)
+    if (inform%flag .lt. 0) goto 100
+
+    ! Refine
+    inform%num_refine = 0
+    conv = .true.
+    done(:) = .false.
+    berr(:) = huge(anorm)
+    do
+       ! Form residuals of systems still being refined in r(:,1:nact)
+       nact = 0
+       do j = 1, nrhs
+          if (done(j)) cycle
+          nact = nact + 1
+          r(:,nact) = b(:,j)
+          if (akeep%check) then
+             call sym_csc_residual(n, akeep%ptr, akeep%row, val2, x(1:n,j), &
+                  r(:,nact))
+          else
+             call sym_csc_residual(n, ptr, row, val, x(1:n,j), r(:,nact))
+          end if
+          ! Test for convergence or stagnation
+          err = maxval(abs(r(:,nact)))
+          denom = anorm*maxval(abs(x(1:n,j))) + maxval(abs(b(:,j)))
+          if (denom .gt. 0.0_wp) err = err / denom
+          if (err .ge. berr(j)) then
+             ! Step did not reduce the residual: restore the best solution
+             x(1:n,j) = xbest(:,j)
+             done(j) = .true.
+             conv = .false.
+          else
+             if (err .le. options%refine_tol) then
+                done(j) = .true.
+             else if (err .gt. 0.5_wp*berr(j)) then
+                done(j) = .true.
+                conv = .false.
+             end if
+             berr(j) = err
+          end if
+          if (done(j)) then
+             nact = nact - 1
+          else
+             active(nact) = j
+          end if
+       end do
+       if (nact .eq. 0) exit
+       if (inform%num_refine .ge. options%max_refine) then
+          conv = .false.
+          exit
+       end if
+
+       ! Solve for corrections and update solutions
+       local_job = 0
+       call fkeep%inner_solve(local_job, nact, r, n, akeep, inform)
+       if (inform%flag .lt. 0) goto 100
+       do k = 1, nact
+          j = active(k)
+          do i = 1, n
+             xbest(i,j) = x(i,j)
+             x(i,j) = x(i,j) + r(i,k)
+          end do
+       end do
+       inform%num_refine = inform%num_refine + 1
+    end do
+    if (.not. conv) inform%flag = SSIDS_WARNING_REFINE_NOT_CONV
+
+    if ((options%print_level .ge. 1) .and. (options%unit_diagnostics .ge. 0)) &
+         write (options%unit_diagnostics,'(/a,i12/a,es12.4)') &
+         ' num_refine             Number of refinement steps           = ', &
+         inform%num_refine, &
+         ' Maximum scaled residual                                     = ', &
+         maxval(berr(:))
+
+100 continue
+    call inform%print_flag(options, context)
+    return
+    !!!!!!!!!!!!!!!!!!!!
+
+    !
+    ! Error handling
+    !
+10  continue
+    inform%flag = SSIDS_ERROR_ALLOCATION
+    inform%stat = st
+    goto 100
+  end subroutine ssids_solve_refine_ptr64_double
+
+!*************************************************************************
+!
+! Compute r = r - Ax, where the lower triangle of the symmetric matrix A is
+! held in CSC format.
+!
+  subroutine sym_csc_residual(n, ptr, row, val, x, r)
+    implicit none
+    integer, intent(in) :: n
+    integer(long), dimension(n+1), intent(in) :: ptr
+    integer, dimension(*), intent(in) :: row
+    real(wp), dimension(*), intent(in) :: val
+    real(wp), dimension(n), intent(in) :: x
+    real(wp), dimension(n), intent(inout) :: r
+
+    integer :: i, j
+    integer(long) :: k
+    real(wp) :: s
+
+    do j = 1, n
+       s = 0.0_wp
+       do k = ptr(j), ptr(j+1)-1
+          i = row(k)
+          r(i) = r(i) - val(k)*x(j)
+          if (i .ne. j) s = s + val(k)*x(i)
+       end do
+       r(j) = r(j) - s
+    end do
+  end subroutine sym_csc_residual
+
+!*************************************************************************
+!
+! Compute rowsum(i) = sum_j |a_ij|, where the lower triangle of the symmetric
+! matrix A is held in CSC format.
+!
+  subroutine sym_csc_abs_rowsum(n, ptr, row, val, rowsum)
+    implicit none
+    integer, intent(in) :: n
+    integer(long), dimension(n+1), intent(in) :: ptr
+    integer, dimension(*), intent(in) :: row
+    real(wp), dimension(*), intent(in) :: val
+    real(wp), dimension(n), intent(out) :: rowsum
+
+    integer :: i, j
+    integer(long) :: k
+
+    rowsum(:) = 0.0_wp
+    do j = 1, n
+       do k = ptr(j), ptr(j+1)-1
+          i = row(k)
+          rowsum(i) = rowsum(i) + abs(val(k))
+          if (i .ne. j) rowsum(j) = rowsum(j) + abs(val(k))
+       end do
+    end do
+  end subroutine sym_csc_abs_rowsum
+
 !*************************************************************************
 !
 ! Return diagonal entries to user
@@ -108,7 +108,13 @@ module spral_ssids_subtree
       !> @param x Right-hand side on entry, solution on return.
       !> @param ldx Leading dimension of x.
       !> @param inform Information/statistics to be returned to user.
-      subroutine solve_proc_iface(this, nrhs, x, ldx, inform)
+      !> @param active If present, only the nodes i of the subtree (numbered
+      !>        from 1) with active(i) true need be solved. The active nodes
+      !>        include the parent of each active node in the subtree, and
+      !>        the rows of x belonging to the other nodes are zero before a
+      !>        forward solve. Implementations may solve all nodes instead.
+      subroutine solve_proc_iface(this, nrhs, x, ldx, inform, active)
+         use, intrinsic :: iso_c_binding, only : C_BOOL
          import numeric_subtree_base, ssids_inform, wp
          implicit none
          class(numeric_subtree_base), intent(inout) :: this
@@ -116,6 +122,7 @@ module spral_ssids_subtree
          real(wp), dimension(*), intent(inout) :: x
          integer, intent(in) :: ldx
          type(ssids_inform), intent(inout) :: inform
+         logical(C_BOOL), dimension(*), optional, intent(in) :: active
       end subroutine solve_proc_iface
       !> @brief Free associated memory/resources
       !> @param this Instance pointer.
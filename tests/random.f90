@@ -15,13 +15,20 @@ program random
    real, parameter :: require_confidence = 0.99
 
    integer :: errors
+   integer :: engine
 
    errors = 0
 
-   call test_real_dist()
-   call test_integer32_dist()
-   call test_integer64_dist()
-   call test_logical_dist()
+   do engine = RANDOM_ENGINE_LCG, RANDOM_ENGINE_PHILOX
+      call test_real_dist(engine)
+      call test_integer32_dist(engine)
+      call test_integer64_dist(engine)
+      call test_logical_dist(engine)
+      call test_skip_ahead(engine)
+      call test_array(engine)
+      call test_draw_count(engine)
+   end do
+   call test_philox_kat()
 
    if(errors.eq.0) then
       write(*, "(/a)") "==================="
@@ -35,7 +42,9 @@ program random
 
 contains
 
-subroutine test_real_dist
+subroutine test_real_dist(engine)
+   integer, intent(in) :: engine
+
    type(random_state) :: state
 
    integer :: i, j
@@ -46,6 +55,8 @@ subroutine test_real_dist
    write(*, "(a)") "Testing random_real()"
    write(*, "(a)") "====================================="
 
+   call random_set_engine(state, engine)
+
 
    !
    ! Test (-1,1) distribution
@@ -93,7 +104,9 @@ subroutine test_real_dist
 
 end subroutine test_real_dist
 
-subroutine test_integer32_dist
+subroutine test_integer32_dist(engine)
+   integer, intent(in) :: engine
+
    type(random_state) :: state
 
    integer :: i
@@ -105,6 +118,8 @@ subroutine test_integer32_dist
    write(*, "(a)") "Testing random_integer() 32-bit"
    write(*, "(a)") "====================================="
 
+   call random_set_engine(state, engine)
+
    !
    ! Test (1,...,n) distribution
    !
@@ -127,7 +142,9 @@ subroutine test_integer32_dist
    endif
 end subroutine test_integer32_dist
 
-subroutine test_integer64_dist
+subroutine test_integer64_dist(engine)
+   integer, intent(in) :: engine
+
    type(random_state) :: state
 
    integer :: i
@@ -139,6 +156,8 @@ subroutine test_integer64_dist
    write(*, "(a)") "Testing random_integer() 64-bit"
    write(*, "(a)") "====================================="
 
+   call random_set_engine(state, engine)
+
    !
    ! Test (1,...,n) distribution
    !
@@ -161,7 +180,9 @@ subroutine test_integer64_dist
    endif
 end subroutine test_integer64_dist
 
-subroutine test_logical_dist
+subroutine test_logical_dist(engine)
+   integer, intent(in) :: engine
+
    type(random_state) :: state
 
    integer :: i, j
@@ -173,6 +194,8 @@ subroutine test_logical_dist
    write(*, "(a)") "Testing random_logical()"
    write(*, "(a)") "====================================="
 
+   call random_set_engine(state, engine)
+
 
    !
    ! Test (1,...,n) distribution
@@ -202,6 +225,218 @@ subroutine test_logical_dist
 
 end subroutine test_logical_dist
 
+subroutine test_skip_ahead(engine)
+   integer, intent(in) :: engine
+
+   type(random_state) :: state, state2, child, child2
+   integer :: i
+   real(wp) :: sample, sample2
+
+   write(*, "(/a)") "====================================="
+   write(*, "(a)") "Testing random_skip_ahead()"
+   write(*, "(a)") "====================================="
+
+   call random_set_engine(state, engine)
+   call random_set_engine(state2, engine)
+
+   write(*, "(a)", advance="no") "Skip vs sequential draws. "
+   do i = 1, 1001
+      sample = random_real(state)
+   end do
+   call random_skip_ahead(state2, 1000_long)
+   sample2 = random_real(state2)
+   if(sample.eq.sample2) then
+      write(*, "(a)") "pass"
+   else
+      write(*, "(a)") "fail"
+      write(*, "(a,2es24.16)") "samples = ", sample, sample2
+      errors = errors + 1
+   endif
+
+   write(*, "(a)", advance="no") "Split streams differ..... "
+   call random_split(state, 1_long, child)
+   call random_split(state, 2_long, child2)
+   if(random_real(child).ne.random_real(child2) .and. &
+         random_real(child).ne.random_real(state)) then
+      write(*, "(a)") "pass"
+   else
+      write(*, "(a)") "fail"
+      errors = errors + 1
+   endif
+end subroutine test_skip_ahead
+
+subroutine test_draw_count(engine)
+   integer, intent(in) :: engine
+
+   integer, parameter :: len = 1237
+   integer, parameter :: nchild = 8
+
+   type(random_state) :: state, child
+   integer :: i
+   real(wp) :: sample, rx(len)
+
+   write(*, "(/a)") "====================================="
+   write(*, "(a)") "Testing random_get_draws()"
+   write(*, "(a)") "====================================="
+
+   if(random_get_draws().lt.0) then
+      write(*, "(a)") "Not counted in this build, skipped"
+      return
+   endif
+
+   call random_set_engine(state, engine)
+
+   write(*, "(a)", advance="no") "Scalar and array draws.... "
+   call random_reset_draws()
+   sample = random_real(state)
+   call random_real_array(state, rx)
+   call random_real_array(state, rx(1:len-2))
+   call random_skip_ahead(state, 100_long)
+   if(random_get_draws().eq.2*len-1) then
+      write(*, "(a)") "pass"
+   else
+      write(*, "(a)") "fail"
+      write(*, "(a,i10)") "draws = ", random_get_draws()
+      errors = errors + 1
+   endif
+
+   write(*, "(a)", advance="no") "Draws by all threads...... "
+   call random_reset_draws()
+!$omp parallel do default(shared) private(child, rx)
+   do i = 1, nchild
+      call random_split(state, int(i,long), child)
+      call random_real_array(child, rx(1:i))
+   end do
+!$omp end parallel do
+   if(random_get_draws().eq.nchild*(nchild+1)/2) then
+      write(*, "(a)") "pass"
+   else
+      write(*, "(a)") "fail"
+      write(*, "(a,i10)") "draws = ", random_get_draws()
+      errors = errors + 1
+   endif
+end subroutine test_draw_count
+
+subroutine test_array(engine)
+   integer, intent(in) :: engine
+
+   ! Spans several chunks and is not a multiple of the Philox block size
+   integer, parameter :: len = 1237
+
+   type(random_state) :: state, state2
+   integer :: i
+   real(wp) :: rx(len), ry(len)
+   integer :: ix(len), iy(len)
+   integer(long) :: lx(len), ly(len)
+   logical :: ok
+
+   write(*, "(/a)") "====================================="
+   write(*, "(a)") "Testing array routines"
+   write(*, "(a)") "====================================="
+
+   call random_set_engine(state, engine)
+   call random_set_engine(state2, engine)
+   ! Start part way through a Philox block
+   ry(1) = random_real(state)
+   ry(1) = random_real(state2)
+
+   write(*, "(a)", advance="no") "Matches scalar draws...... "
+   call random_real_array(state, rx)
+   do i = 1, len
+      ry(i) = random_real(state2)
+   end do
+   ok = all(rx.eq.ry)
+   call random_real_array(state, rx(1:len-3), positive=.true.)
+   do i = 1, len-3
+      ry(i) = random_real(state2, positive=.true.)
+   end do
+   ok = ok .and. all(rx(1:len-3).eq.ry(1:len-3))
+   call random_integer_array(state, 17, ix)
+   do i = 1, len
+      iy(i) = random_integer(state2, 17)
+   end do
+   ok = ok .and. all(ix.eq.iy)
+   call random_integer_array(state, 3_long*huge(0), lx)
+   do i = 1, len
+      ly(i) = random_integer(state2, 3_long*huge(0))
+   end do
+   ok = ok .and. all(lx.eq.ly)
+   call random_integer_array_in_range(state, -5, 5, ix)
+   do i = 1, len
+      iy(i) = random_integer(state2, 11) - 6
+   end do
+   ok = ok .and. all(ix.eq.iy)
+   ! Following scalar draws should be in step
+   ok = ok .and. (random_real(state).eq.random_real(state2))
+   if(ok) then
+      write(*, "(a)") "pass"
+   else
+      write(*, "(a)") "fail"
+      errors = errors + 1
+   endif
+
+   write(*, "(a)", advance="no") "Negative seed............. "
+   call random_set_seed(state, -12345)
+   call random_set_seed(state2, -12345)
+   call random_real_array(state, rx)
+   do i = 1, len
+      ry(i) = random_real(state2)
+   end do
+   call random_skip_ahead(state2, 5_long)
+   call random_skip_ahead(state, 5_long)
+   if(all(rx.eq.ry) .and. all(abs(rx).le.1.0_wp) .and. &
+         (random_real(state).eq.random_real(state2))) then
+      write(*, "(a)") "pass"
+   else
+      write(*, "(a)") "fail"
+      write(*, "(a,2es24.16)") "first = ", rx(1), ry(1)
+      errors = errors + 1
+   endif
+
+   write(*, "(a)", advance="no") "Range respected........... "
+   call random_real_array_in_range(state, 2.0_wp, 3.0_wp, rx)
+   call random_integer_array_in_range(state, 7_long, 9_long, lx)
+   if(all(rx.ge.2.0_wp .and. rx.le.3.0_wp) .and. &
+         all(lx.ge.7 .and. lx.le.9) .and. any(lx.eq.7) .and. &
+         any(lx.eq.9)) then
+      write(*, "(a)") "pass"
+   else
+      write(*, "(a)") "fail"
+      errors = errors + 1
+   endif
+end subroutine test_array
+
+subroutine test_philox_kat
+   ! Known answer for Philox4x32-10 with zero key and counter, from the
+   ! Random123 distribution
+   integer(long), dimension(4), parameter :: kat = (/ &
+      int(z'6627E8D5', long), int(z'E169C58D', long), &
+      int(z'BC57AC4C', long), int(z'9B00DBD8', long) /)
+
+   type(random_state) :: state
+   integer :: i
+   integer(long) :: sample
+
+   write(*, "(/a)") "====================================="
+   write(*, "(a)") "Testing Philox known answer"
+   write(*, "(a)") "====================================="
+
+   write(*, "(a)", advance="no") "Zero key and counter..... "
+   call random_set_seed(state, 0)
+   call random_set_engine(state, RANDOM_ENGINE_PHILOX)
+   do i = 1, 4
+      sample = int(random_real(state, positive=.true.) * 2.0_wp**32, long)
+      if(sample.ne.kat(i)) then
+         write(*, "(a)") "fail"
+         write(*, "(a,i2,a,z8,a,z8)") "word ", i, " = ", sample, &
+            " expected ", kat(i)
+         errors = errors + 1
+         return
+      endif
+   end do
+   write(*, "(a)") "pass"
+end subroutine test_philox_kat
+
 real(wp) function chisq_pval(dof, p)
    integer, intent(in) :: dof
    real, intent(in) :: p
@@ -1,12 +1,42 @@
 program random_matrix
    use spral_matrix_util, only : SPRAL_MATRIX_UNSPECIFIED,       &
                                  SPRAL_MATRIX_REAL_RECT,       &
+                                 SPRAL_MATRIX_REAL_UNSYM,      &
                                  SPRAL_MATRIX_REAL_SYM_PSDEF,  &
                                  SPRAL_MATRIX_REAL_SYM_INDEF,  &
                                  SPRAL_MATRIX_REAL_SKEW,       &
-                                 SPRAL_MATRIX_CPLX_RECT
-   use spral_random, only : random_state, random_integer, random_logical
-   use spral_random_matrix, only : random_matrix_generate
+                                 SPRAL_MATRIX_CPLX_RECT,       &
+                                 SPRAL_MATRIX_CPLX_UNSYM,      &
+                                 SPRAL_MATRIX_CPLX_HERM_PSDEF, &
+                                 SPRAL_MATRIX_CPLX_HERM_INDEF, &
+                                 SPRAL_MATRIX_CPLX_SYM,        &
+                                 SPRAL_MATRIX_CPLX_SKEW
+   use spral_random, only : random_state, random_integer, random_logical, &
+                            random_real, random_split, &
+                            random_set_seed, random_set_engine, &
+                            RANDOM_ENGINE_LCG, RANDOM_ENGINE_PHILOX
+   use spral_random_matrix, only : random_matrix_generate, &
+                                   random_matrix_generate_lapack_band, &
+                                   random_matrix_generate_profile, &
+                                   random_matrix_envelope, &
+                                   random_matrix_generate_block_band, &
+                                   random_matrix_generate_band_batch, &
+                                   random_matrix_generate_band_coord, &
+                                   random_matrix_generate_stencil, &
+                                   random_matrix_stencil_size, &
+                                   RANDOM_MATRIX_STENCIL_STAR, &
+                                   RANDOM_MATRIX_STENCIL_BOX, &
+                                   RANDOM_MATRIX_NUMBER_LEXICOGRAPHIC, &
+                                   RANDOM_MATRIX_NUMBER_BLOCKED, &
+                                   RANDOM_MATRIX_ENVELOPE_LINEAR, &
+                                   RANDOM_MATRIX_ENVELOPE_ARROW, &
+                                   random_matrix_band_stream, &
+                                   random_matrix_band_stream_init, &
+                                   random_matrix_band_stream_next, &
+                                   random_matrix_band_stream_free, &
+                                   random_matrix_workspace, &
+                                   random_matrix_workspace_free
+!$ use omp_lib
    implicit none
 
    integer, parameter :: wp = kind(0d0)
@@ -26,6 +56,22 @@ program random_matrix
    call test_errors
    call test_random_symmetric
    call test_random_unsymmetric
+   call test_random_band
+   call test_random_band_kl_ku
+   call test_lapack_band
+   call test_band_stream
+   call test_band_dominant
+   call test_band_conditioned
+   call test_profile
+   call test_block_band
+   call test_stencil
+   call test_band_rhs
+   call test_band_precision
+   call test_band_batch
+   call test_workspace
+   call test_dense_fill
+   call test_band_coord
+   call test_band_threads
 
    write(*,"(/a)") "================"
    if(errors.eq.0) then
@@ -282,6 +328,1916 @@ subroutine chk_random_symmetric(n, nnz, ptr, row, val, nonsingular, sort)
    write(*, "(a)") "ok"
 end subroutine chk_random_symmetric
 
+subroutine test_random_band
+   integer, parameter :: nprob = 200
+   integer, parameter :: maxn = 2000
+   integer, parameter :: maxbw = 60
+
+   integer :: prblm
+   integer :: matrix_type, m, n, nnz, bw, flag, cap, j
+   integer, dimension(:), allocatable :: ptr, row
+   real(wp), dimension(:), allocatable :: val
+   type(random_state) :: state
+   logical :: lsymmetric, nonsingular, sort, direct
+
+   write(*,"(/a)") "============================"
+   write(*,"(a)")  "Testing random band matrices"
+   write(*,"(a)")  "============================"
+
+   allocate(ptr(maxn+1), row(maxn*(2*maxbw+1)), val(maxn*(2*maxbw+1)))
+
+   do prblm = 1, nprob
+      lsymmetric = random_logical(state)
+      n = random_integer(state, maxn)
+      m = n
+      if(lsymmetric) then
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+      else
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+         if(random_logical(state)) m = random_integer(state, maxn)
+      endif
+      bw = random_integer(state, maxbw)
+      direct = (prblm .gt. nprob/4)
+      nonsingular = random_logical(state)
+      sort = random_logical(state)
+      ! Pick a fill ratio, frequently close to full for the direct method
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, m, j, bw, bw)
+      end do
+      if(direct .and. random_logical(state)) then
+         nnz = cap - random_integer(state, cap/20+1) + 1
+      else
+         nnz = random_integer(state, cap/2+1)
+      endif
+      nnz = max(nnz, min(m,n))
+
+      write(*, "(a,i5,a,i5,a,i5,a,i3,a,i7,a,l1,l1,l1,l1,a)", advance="no") &
+         " * no. ", prblm, " m = ", m, " n = ", n, " bw = ", bw, &
+         " nnz = ", nnz, " flags = ", lsymmetric, nonsingular, sort, direct, &
+         " ..."
+
+      call random_matrix_generate(state, matrix_type, m, n, nnz, bw, ptr, &
+         row, flag, val=val, nonsingular=nonsingular, sort=sort, direct=direct)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      call chk_random_band(lsymmetric, m, n, nnz, bw, bw, ptr, row, val, &
+         nonsingular, sort)
+   end do
+
+   ! Check that overfilling the band is caught
+   write(*,"(a)",advance="no") " * Testing nnz > band capacity..............."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_RECT, 10, 10, 29, 1, &
+      ptr, row, flag, direct=.true.)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing positive-definite nnz < n........."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_SYM_PSDEF, 10, 10, 5, &
+      1, ptr, row, flag)
+   call print_result(flag, 0)
+   write(*,"(a)",advance="no") " * Testing definite nonsingular nnz < n......"
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_SYM_PSDEF, 10, 10, 5, &
+      1, ptr, row, flag, nonsingular=.true.)
+   call print_result(flag, ERROR_SINGULAR)
+
+end subroutine test_random_band
+
+subroutine test_random_band_kl_ku
+   integer, parameter :: nprob = 100
+   integer, parameter :: maxn = 2000
+   integer, parameter :: maxbw = 60
+
+   integer :: prblm
+   integer :: matrix_type, m, n, nnz, kl, ku, flag, cap, j
+   integer, dimension(:), allocatable :: ptr, row
+   real(wp), dimension(:), allocatable :: val
+   type(random_state) :: state
+   logical :: lsymmetric, nonsingular, sort, direct
+
+   write(*,"(/a)") "=========================================="
+   write(*,"(a)")  "Testing random band matrices with kl != ku"
+   write(*,"(a)")  "=========================================="
+
+   allocate(ptr(maxn+1), row(maxn*(2*maxbw+1)), val(maxn*(2*maxbw+1)))
+
+   do prblm = 1, nprob
+      lsymmetric = (mod(prblm, 5) .eq. 0)
+      n = random_integer(state, maxn)
+      m = n
+      kl = random_integer(state, maxbw+1) - 1
+      ku = random_integer(state, maxbw+1) - 1
+      if(lsymmetric) then
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+         ku = kl
+      else
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+         if(random_logical(state)) m = random_integer(state, maxn)
+      endif
+      direct = random_logical(state)
+      nonsingular = random_logical(state)
+      sort = random_logical(state)
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, m, j, kl, ku)
+      end do
+      nnz = random_integer(state, cap)
+      if(nonsingular) nnz = max(nnz, min(m,n))
+
+      write(*, "(a,i5,a,i5,a,i5,a,2i3,a,i7,a,l1,l1,l1,l1,a)", advance="no") &
+         " * no. ", prblm, " m = ", m, " n = ", n, " kl,ku = ", kl, ku, &
+         " nnz = ", nnz, " flags = ", lsymmetric, nonsingular, sort, direct, &
+         " ..."
+
+      call random_matrix_generate(state, matrix_type, m, n, nnz, kl, ku, ptr, &
+         row, flag, val=val, nonsingular=nonsingular, sort=sort, direct=direct)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      call chk_random_band(lsymmetric, m, n, nnz, kl, ku, ptr, row, val, &
+         nonsingular, sort)
+   end do
+
+   ! Completely full upper triangle
+   write(*,"(a)",advance="no") " * Testing full triangle with kl = 0........."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_RECT, 10, 10, 55, 0, &
+      10, ptr, row, flag, direct=.true.)
+   call print_result(flag, 0)
+   write(*,"(a)",advance="no") " * Testing kl < 0..........................."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_RECT, 10, 10, 5, -1, &
+      1, ptr, row, flag)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing symmetric with kl != ku.........."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_SYM_INDEF, 10, 10, 5, &
+      1, 2, ptr, row, flag)
+   call print_result(flag, ERROR_ARG)
+
+end subroutine test_random_band_kl_ku
+
+subroutine test_lapack_band
+   integer, parameter :: long = selected_int_kind(18)
+   integer, parameter :: nprob = 50
+   integer, parameter :: maxn = 500
+   integer, parameter :: maxbw = 30
+
+   integer :: prblm
+   integer :: matrix_type, m, n, nnz, kl, ku, ldab, off, flag, cap, i, j
+   integer, dimension(:), allocatable :: ptr, row
+   real(wp), dimension(:), allocatable :: val
+   real(wp), dimension(:,:), allocatable :: ab, ab2
+   type(random_state) :: state, state2
+   logical :: lsymmetric, nonsingular
+
+   write(*,"(/a)") "==================================="
+   write(*,"(a)")  "Testing random LAPACK band matrices"
+   write(*,"(a)")  "==================================="
+
+   allocate(ptr(maxn+1), row(maxn*(2*maxbw+1)), val(maxn*(2*maxbw+1)))
+
+   do prblm = 1, nprob
+      lsymmetric = random_logical(state)
+      n = random_integer(state, maxn)
+      m = n
+      kl = random_integer(state, maxbw+1) - 1
+      ku = random_integer(state, maxbw+1) - 1
+      if(lsymmetric) then
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+         ku = kl
+         off = 1
+         ldab = kl + 1
+      else
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+         if(random_logical(state)) m = random_integer(state, maxn)
+         off = kl + ku + 1
+         ldab = 2*kl + ku + 1
+      endif
+      ldab = ldab + random_integer(state, 3) - 1
+      nonsingular = random_logical(state)
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, m, j, kl, ku)
+      end do
+      nnz = random_integer(state, cap)
+      if(nonsingular) nnz = max(nnz, min(m,n))
+
+      write(*, "(a,i5,a,i5,a,i5,a,2i3,a,i7,a,l1,l1,a)", advance="no") &
+         " * no. ", prblm, " m = ", m, " n = ", n, " kl,ku = ", kl, ku, &
+         " nnz = ", nnz, " flags = ", lsymmetric, nonsingular, " ..."
+
+      ! Generate in both formats from the same state, and compare
+      state2 = state
+      call random_matrix_generate(state2, matrix_type, m, n, nnz, kl, ku, &
+         ptr, row, flag, val=val, nonsingular=nonsingular, direct=.true.)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "CSC flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      allocate(ab(ldab,n), ab2(ldab,n))
+      ab(:,:) = -99.0
+      call random_matrix_generate_lapack_band(state, matrix_type, m, n, &
+         int(nnz,long), kl, ku, ab, ldab, flag, nonsingular=nonsingular)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         deallocate(ab, ab2)
+         cycle
+      endif
+      ab2(:,:) = 0.0
+      do j = 1, n
+         do i = ptr(j), ptr(j+1)-1
+            ab2(off+row(i)-j, j) = val(i)
+         end do
+      end do
+      if(all(ab(:,:).eq.ab2(:,:))) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a/a)") "fail", "differs from CSC matrix"
+         errors = errors + 1
+      endif
+      deallocate(ab, ab2)
+   end do
+
+   ! Check leading dimension is checked
+   allocate(ab(5,10))
+   write(*,"(a)",advance="no") " * Testing ldab < 2*kl+ku+1.................."
+   call random_matrix_generate_lapack_band(state, SPRAL_MATRIX_REAL_RECT, 10, &
+      10, 5_long, 2, 1, ab, 5, flag)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing symmetric ldab < kl+1............."
+   call random_matrix_generate_lapack_band(state, SPRAL_MATRIX_REAL_SYM_INDEF, &
+      10, 10, 5_long, 5, 5, ab, 5, flag)
+   call print_result(flag, ERROR_ARG)
+
+end subroutine test_lapack_band
+
+subroutine test_band_stream
+   integer, parameter :: nprob = 50
+   integer, parameter :: maxn = 3000
+   integer, parameter :: maxbw = 30
+
+   integer, parameter :: long = selected_int_kind(18)
+
+   integer :: prblm
+   integer :: matrix_type, m, n, kl, ku, flag, cap, j, maxcol, jfirst, ncol
+   integer :: col
+   integer(long) :: nnz, maxent, pos
+   integer(long), dimension(:), allocatable :: ptr, cptr
+   integer, dimension(:), allocatable :: row, crow
+   real(wp), dimension(:), allocatable :: val, cval
+   type(random_state) :: state, state2
+   type(random_matrix_band_stream) :: stream
+   logical :: lsymmetric, nonsingular, sort, match
+
+   write(*,"(/a)") "================================="
+   write(*,"(a)")  "Testing streaming band generation"
+   write(*,"(a)")  "================================="
+
+   allocate(ptr(maxn+1), row(maxn*(2*maxbw+1)), val(maxn*(2*maxbw+1)))
+   allocate(cptr(maxn+1), crow(maxn*(2*maxbw+1)), cval(maxn*(2*maxbw+1)))
+
+   do prblm = 1, nprob
+      lsymmetric = random_logical(state)
+      n = random_integer(state, maxn)
+      m = n
+      kl = random_integer(state, maxbw+1) - 1
+      ku = random_integer(state, maxbw+1) - 1
+      nonsingular = random_logical(state)
+      sort = random_logical(state)
+      if(lsymmetric) then
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+         if(nonsingular) matrix_type = SPRAL_MATRIX_REAL_SYM_PSDEF
+         ku = kl
+      else
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+         if(random_logical(state)) m = random_integer(state, maxn)
+      endif
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, m, j, kl, ku)
+      end do
+      nnz = random_integer(state, cap)
+      if(nonsingular) nnz = max(nnz, int(min(m,n),long))
+      maxcol = random_integer(state, 300)
+      maxent = min(m, kl+ku+1) + random_integer(state, 2000) - 1
+
+      write(*, "(a,i5,a,i5,a,i5,a,2i3,a,i7,a,l1,l1,l1,a)", advance="no") &
+         " * no. ", prblm, " m = ", m, " n = ", n, " kl,ku = ", kl, ku, &
+         " nnz = ", nnz, " flags = ", lsymmetric, nonsingular, sort, " ..."
+
+      ! One-shot generation
+      state2 = state
+      call random_matrix_generate(state2, matrix_type, m, n, nnz, kl, ku, &
+         ptr, row, flag, val=val, nonsingular=nonsingular, sort=sort, &
+         direct=.true.)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "one-shot flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+
+      ! Streamed generation, concatenated into cptr, crow and cval
+      call random_matrix_band_stream_init(stream, state, matrix_type, m, n, &
+         nnz, kl, ku, flag, nonsingular=nonsingular, sort=sort)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "init flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      col = 1
+      cptr(1) = 1
+      do while(col.le.n)
+         pos = cptr(col)
+         call random_matrix_band_stream_next(stream, maxcol, maxent, jfirst, &
+            ncol, cptr(col:), crow(pos:), flag, val=cval(pos:))
+         if(flag.ne.0 .or. ncol.eq.0 .or. jfirst.ne.col) exit
+         cptr(col:col+ncol) = cptr(col:col+ncol) + pos - 1
+         col = col + ncol
+      end do
+      ! Stream should now be exhausted
+      if(flag.eq.0) call random_matrix_band_stream_next(stream, maxcol, &
+         maxent, jfirst, ncol, ptr, crow(nnz+1:), flag)
+      if(ncol.ne.0) col = -1
+      call random_matrix_band_stream_free(stream)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "next flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+
+      match = (col.eq.n+1)
+      if(match) match = all(cptr(1:n+1).eq.ptr(1:n+1))
+      if(match) match = all(crow(1:nnz).eq.row(1:nnz)) .and. &
+         all(cval(1:nnz).eq.val(1:nnz))
+      ! Both should leave state in the same place
+      if(match) match = (random_real(state).eq.random_real(state2))
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a/a)") "fail", "differs from one-shot generation"
+         errors = errors + 1
+      endif
+   end do
+
+end subroutine test_band_stream
+
+subroutine test_band_dominant
+   integer, parameter :: nprob = 50
+   integer, parameter :: maxn = 500
+   integer, parameter :: maxbw = 30
+
+   integer, parameter :: long = selected_int_kind(18)
+
+   integer :: prblm
+   integer :: matrix_type, n, nnz, kl, ku, ldab, off, flag, cap, i, j, info
+   integer, dimension(:), allocatable :: ptr, row
+   real(wp), dimension(:), allocatable :: val, rsum, csum, diag
+   real(wp), dimension(:,:), allocatable :: ab
+   real(wp) :: dominance
+   type(random_state) :: state, state2
+   type(random_matrix_band_stream) :: stream
+   logical :: lsymmetric, direct, match
+
+   write(*,"(/a)") "========================================="
+   write(*,"(a)")  "Testing diagonally dominant band matrices"
+   write(*,"(a)")  "========================================="
+
+   allocate(ptr(maxn+1), row(maxn*(2*maxbw+1)), val(maxn*(2*maxbw+1)))
+   allocate(rsum(maxn), csum(maxn), diag(maxn))
+
+   do prblm = 1, nprob
+      lsymmetric = random_logical(state)
+      n = random_integer(state, maxn)
+      kl = random_integer(state, maxbw+1) - 1
+      ku = random_integer(state, maxbw+1) - 1
+      dominance = 1.0 + random_real(state, .true.)
+      if(lsymmetric) then
+         matrix_type = SPRAL_MATRIX_REAL_SYM_PSDEF
+         ku = kl
+         off = 1
+         ldab = kl + 1
+      else
+         matrix_type = SPRAL_MATRIX_REAL_UNSYM
+         off = kl + ku + 1
+         ldab = 2*kl + ku + 1
+      endif
+      direct = random_logical(state)
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, n, j, kl, ku)
+      end do
+      nnz = max(n, random_integer(state, cap))
+
+      write(*, "(a,i5,a,i5,a,2i3,a,i7,a,f5.3,a,l1,l1,a)", advance="no") &
+         " * no. ", prblm, " n = ", n, " kl,ku = ", kl, ku, " nnz = ", nnz, &
+         " dom = ", dominance, " flags = ", lsymmetric, direct, " ..."
+
+      ! CSC generation
+      state2 = state
+      call random_matrix_generate(state2, matrix_type, n, n, nnz, kl, ku, &
+         ptr, row, flag, val=val, direct=direct, dominance=dominance)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "CSC flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      ! Check every diagonal entry is present and strictly dominant
+      rsum(1:n) = 0.0
+      csum(1:n) = 0.0
+      diag(1:n) = -1.0
+      do j = 1, n
+         do i = ptr(j), ptr(j+1)-1
+            if(row(i).eq.j) then
+               diag(j) = val(i)
+            else
+               csum(j) = csum(j) + abs(val(i))
+               rsum(row(i)) = rsum(row(i)) + abs(val(i))
+            endif
+         end do
+      end do
+      if(lsymmetric) then
+         csum(1:n) = csum(1:n) + rsum(1:n)
+         rsum(1:n) = csum(1:n)
+      endif
+      if(any(diag(1:n).le.rsum(1:n)) .or. any(diag(1:n).le.csum(1:n))) then
+         write(*, "(a/a)") "fail", "CSC matrix is not diagonally dominant"
+         errors = errors + 1
+         cycle
+      endif
+
+      ! LAPACK band generation should give the same matrix as direct=.true.
+      allocate(ab(ldab,n))
+      call random_matrix_generate_lapack_band(state, matrix_type, n, n, &
+         int(nnz,long), kl, ku, ab, ldab, flag, dominance=dominance)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "LAPACK flag = ", flag
+         errors = errors + 1
+         deallocate(ab)
+         cycle
+      endif
+      match = .true.
+      if(direct) then
+      do j = 1, n
+         match = match .and. (abs(ab(off,j)-diag(j)).le.1e-12*diag(j))
+         do i = ptr(j), ptr(j+1)-1
+            if(row(i).ne.j) match = match .and. (ab(off+row(i)-j,j).eq.val(i))
+         end do
+      end do
+      endif
+      if(.not.match) then
+         write(*, "(a/a)") "fail", "LAPACK band differs from CSC matrix"
+         errors = errors + 1
+         deallocate(ab)
+         cycle
+      endif
+      ! ... and a positive-definite one must factorize
+      info = 0
+      if(lsymmetric) call dpbtrf('L', n, kl, ab, ldab, info)
+      deallocate(ab)
+      if(info.ne.0) then
+         write(*, "(a/a,i5)") "fail", "dpbtrf info = ", info
+         errors = errors + 1
+      else
+         write(*, "(a)") "ok"
+      endif
+   end do
+
+   ! Check bad dominance arguments
+   allocate(ab(5,10))
+   write(*,"(a)",advance="no") " * Testing dominance <= 1...................."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_UNSYM, 10, 10, 20, &
+      2, 2, ptr, row, flag, val=val, dominance=1.0_wp)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing dominance with SKEW..............."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_SKEW, 10, 10, 20, &
+      2, 2, ptr, row, flag, val=val, dominance=2.0_wp)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing dominance with non-square........."
+   call random_matrix_generate_lapack_band(state, SPRAL_MATRIX_REAL_RECT, 9, &
+      10, 20_long, 1, 1, ab, 5, flag, dominance=2.0_wp)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing unsymmetric dominance stream......"
+   call random_matrix_band_stream_init(stream, state, &
+      SPRAL_MATRIX_REAL_UNSYM, 10, 10, 20_long, 2, 2, flag, dominance=2.0_wp)
+   call print_result(flag, ERROR_ARG)
+   call random_matrix_band_stream_free(stream)
+
+end subroutine test_band_dominant
+
+subroutine test_band_conditioned
+   integer, parameter :: nprob = 50
+   integer, parameter :: maxn = 60
+   integer, parameter :: maxbw = 10
+
+   integer :: prblm
+   integer :: matrix_type, n, nnz, kl, ku, flag, cap, i, j, info
+   integer, dimension(:), allocatable :: ptr, row
+   real(wp), dimension(:), allocatable :: val, sv, work
+   real(wp), dimension(:,:), allocatable :: a
+   real(wp), dimension(2) :: cond, cond_est
+   real(wp) :: kappa, dummy(1,1)
+   type(random_state) :: state
+   logical :: lsymmetric, direct
+
+   write(*,"(/a)") "================================="
+   write(*,"(a)")  "Testing conditioned band matrices"
+   write(*,"(a)")  "================================="
+
+   allocate(ptr(maxn+1), row(maxn*(2*maxbw+1)), val(maxn*(2*maxbw+1)))
+   allocate(a(maxn,maxn), sv(maxn), work(10*maxn))
+
+   do prblm = 1, nprob
+      lsymmetric = random_logical(state)
+      n = random_integer(state, maxn-1) + 1
+      kl = random_integer(state, maxbw+1) - 1
+      ku = random_integer(state, maxbw+1) - 1
+      cond(1) = 10.0**(6*random_real(state, .true.))
+      cond(2) = cond(1) * 10.0**(2*random_real(state, .true.))
+      if(lsymmetric) then
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+         if(random_logical(state)) matrix_type = SPRAL_MATRIX_REAL_SYM_PSDEF
+         ku = kl
+      else
+         matrix_type = SPRAL_MATRIX_REAL_UNSYM
+      endif
+      direct = random_logical(state)
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, n, j, kl, ku)
+      end do
+      nnz = max(n, random_integer(state, cap))
+
+      write(*, "(a,i5,a,i5,a,2i3,a,i5,a,2es9.2,a,l1,l1,a)", advance="no") &
+         " * no. ", prblm, " n = ", n, " kl,ku = ", kl, ku, " nnz = ", nnz, &
+         " cond = ", cond, " flags = ", lsymmetric, direct, " ..."
+
+      call random_matrix_generate(state, matrix_type, n, n, nnz, kl, ku, &
+         ptr, row, flag, val=val, direct=direct, cond=cond, cond_est=cond_est)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+
+      ! Find actual condition number from singular values of dense matrix
+      a(1:n,1:n) = 0.0
+      do j = 1, n
+         do i = ptr(j), ptr(j+1)-1
+            a(row(i),j) = val(i)
+            if(lsymmetric) a(j,row(i)) = val(i)
+         end do
+      end do
+      call dgesvd('N', 'N', n, n, a, maxn, sv, dummy, 1, dummy, 1, work, &
+         size(work), info)
+      kappa = sv(1) / sv(n)
+      if(info.ne.0) then
+         write(*, "(a/a,i5)") "fail", "dgesvd info = ", info
+         errors = errors + 1
+      else if(kappa.lt.cond(1)*(1-1e-10_wp) .or. &
+            kappa.gt.cond(2)*(1+1e-10_wp)) then
+         write(*, "(a/a,es12.4)") "fail", "condition number ", kappa
+         errors = errors + 1
+      else if(kappa.lt.cond_est(1)*(1-1e-10_wp) .or. &
+            kappa.gt.cond_est(2)*(1+1e-10_wp) .or. &
+            cond_est(2).gt.cond(2)*(1+1e-10_wp)) then
+         write(*, "(a/a,3es12.4)") "fail", "bad estimate ", cond_est, kappa
+         errors = errors + 1
+      else
+         write(*, "(a)") "ok"
+      endif
+   end do
+
+   ! Check bad arguments
+   write(*,"(a)",advance="no") " * Testing cond(1) > 1 with n = 1............"
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_UNSYM, 1, 1, 1, &
+      2, 2, ptr, row, flag, val=val, cond=(/ 10.0_wp, 50.0_wp /))
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing cond(2) < cond(1)................."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_UNSYM, 10, 10, 20, &
+      2, 2, ptr, row, flag, val=val, cond=(/ 10.0_wp, 5.0_wp /))
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing cond without val.................."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_UNSYM, 10, 10, 20, &
+      2, 2, ptr, row, flag, cond=(/ 10.0_wp, 50.0_wp /))
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing cond with dominance..............."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_UNSYM, 10, 10, 20, &
+      2, 2, ptr, row, flag, val=val, cond=(/ 10.0_wp, 50.0_wp /), &
+      dominance=2.0_wp)
+   call print_result(flag, ERROR_ARG)
+
+end subroutine test_band_conditioned
+
+subroutine test_profile
+   integer, parameter :: long = selected_int_kind(18)
+   integer, parameter :: nprob = 50
+   integer, parameter :: maxn = 1000
+   integer, parameter :: maxbw = 40
+
+   integer :: prblm
+   integer :: matrix_type, m, n, nnz, kl, ku, flag, cap, i, j, k, shape
+   integer(long) :: kk
+   integer(long), dimension(:), allocatable :: ptr
+   integer, dimension(:), allocatable :: row, ptr2, row2, first, last
+   real(wp), dimension(:), allocatable :: val, val2
+   type(random_state) :: state, state2
+   logical :: lsymmetric, nonsingular, sort, match
+   logical, dimension(:), allocatable :: seen
+
+   write(*,"(/a)") "================================="
+   write(*,"(a)")  "Testing variable profile matrices"
+   write(*,"(a)")  "================================="
+
+   allocate(ptr(maxn+1), row(maxn*maxn), val(maxn*maxn))
+   allocate(ptr2(maxn+1), row2(maxn*(2*maxbw+1)), val2(maxn*(2*maxbw+1)))
+   allocate(first(maxn), last(maxn), seen(maxn))
+
+   do prblm = 1, nprob
+      lsymmetric = random_logical(state)
+      n = random_integer(state, maxn)
+      m = n
+      nonsingular = random_logical(state)
+      sort = random_logical(state)
+      if(lsymmetric) then
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+      else
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+         if(random_logical(state)) m = random_integer(state, maxn)
+      endif
+
+      ! Random profile, with some empty columns
+      cap = 0
+      do j = 1, n
+         if(lsymmetric) then
+            first(j) = j
+         else
+            first(j) = random_integer(state, m)
+         endif
+         last(j) = first(j) + random_integer(state, m-first(j)+2) - 2
+         if(nonsingular .and. j.le.min(m,n)) then
+            first(j) = min(first(j), j)
+            last(j) = max(last(j), j)
+         endif
+         cap = cap + max(0, last(j)-first(j)+1)
+      end do
+      nnz = random_integer(state, cap)
+      if(nonsingular) nnz = max(nnz, min(m,n))
+
+      write(*, "(a,i5,a,i5,a,i5,a,i8,a,l1,l1,l1,a)", advance="no") &
+         " * no. ", prblm, " m = ", m, " n = ", n, " nnz = ", nnz, &
+         " flags = ", lsymmetric, nonsingular, sort, " ..."
+
+      call random_matrix_generate_profile(state, matrix_type, m, n, &
+         int(nnz,long), first, last, ptr, row, flag, val=val, &
+         nonsingular=nonsingular, sort=sort)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+
+      ! Check entries are distinct, within the profile, and sorted if required
+      match = (ptr(1).eq.1 .and. ptr(n+1).eq.nnz+1)
+      seen(1:m) = .false.
+      do j = 1, n
+         if(.not.match) exit
+         do kk = ptr(j), ptr(j+1)-1
+            i = row(kk)
+            match = match .and. (i.ge.first(j)) .and. (i.le.last(j))
+            if(.not.match) exit
+            match = match .and. .not.seen(i)
+            seen(i) = .true.
+            if(sort .and. kk.gt.ptr(j)) match = match .and. (row(kk-1).lt.i)
+         end do
+         if(nonsingular .and. j.le.min(m,n)) match = match .and. seen(j)
+         seen(row(ptr(j):ptr(j+1)-1)) = .false.
+      end do
+      if(match) match = all(abs(val(1:nnz)).le.1.0)
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a/a)") "fail", "bad matrix"
+         errors = errors + 1
+      endif
+   end do
+
+   ! A profile equal to the band gives the same matrix as the band generator
+   do prblm = 1, 10
+      n = random_integer(state, maxn)
+      kl = random_integer(state, maxbw+1) - 1
+      ku = random_integer(state, maxbw+1) - 1
+      write(*, "(a,i5,a,i5,a,2i3,a)", advance="no") &
+         " * Testing band profile no. ", prblm, " n = ", n, " kl,ku = ", &
+         kl, ku, "..."
+      cap = 0
+      do j = 1, n
+         first(j) = max(1, j-ku)
+         last(j) = min(n, j+kl)
+         cap = cap + last(j) - first(j) + 1
+      end do
+      nnz = random_integer(state, cap)
+      state2 = state
+      call random_matrix_generate(state2, SPRAL_MATRIX_REAL_RECT, n, n, nnz, &
+         kl, ku, ptr2, row2, flag, val=val2, direct=.true.)
+      call random_matrix_generate_profile(state, SPRAL_MATRIX_REAL_RECT, n, &
+         n, int(nnz,long), first, last, ptr, row, k, val=val)
+      match = (flag.eq.0) .and. (k.eq.0)
+      if(match) match = all(ptr(1:n+1).eq.ptr2(1:n+1)) .and. &
+         all(row(1:nnz).eq.row2(1:nnz)) .and. all(val(1:nnz).eq.val2(1:nnz))
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a/a)") "fail", "differs from band matrix"
+         errors = errors + 1
+      endif
+   end do
+
+   ! Envelope shapes
+   do shape = RANDOM_MATRIX_ENVELOPE_LINEAR, RANDOM_MATRIX_ENVELOPE_ARROW
+      write(*, "(a,i2,a)", advance="no") " * Testing envelope shape ", shape, &
+         "...................."
+      n = 500
+      call random_matrix_envelope(shape, SPRAL_MATRIX_REAL_SYM_PSDEF, n, n, &
+         20, first, last, flag)
+      cap = sum(last(1:n)-first(1:n)+1)
+      if(flag.eq.0) &
+         call random_matrix_generate_profile(state, &
+            SPRAL_MATRIX_REAL_SYM_PSDEF, n, n, int(cap/2,long), first, last, &
+            ptr, row, flag, val=val)
+      call print_result(flag, 0)
+   end do
+   write(*,"(a)",advance="no") " * Testing envelope arrow columns............"
+   call random_matrix_envelope(RANDOM_MATRIX_ENVELOPE_ARROW, &
+      SPRAL_MATRIX_REAL_RECT, 100, 50, 3, first, last, flag)
+   if(flag.eq.0 .and. any(first(1:3).ne.1 .or. last(1:3).ne.100 .or. &
+         first(4:6).ne.(/ 1, 2, 3 /) .or. last(4:6).ne.(/ 7, 8, 9 /))) flag = 1
+   call print_result(flag, 0)
+
+   ! Check bad profiles
+   write(*,"(a)",advance="no") " * Testing symmetric profile above diagonal.."
+   first(1:10) = 1
+   last(1:10) = 10
+   call random_matrix_generate_profile(state, SPRAL_MATRIX_REAL_SYM_INDEF, &
+      10, 10, 5_long, first, last, ptr, row, flag)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing nnz > profile capacity............"
+   last(1:10) = 1
+   call random_matrix_generate_profile(state, SPRAL_MATRIX_REAL_RECT, &
+      10, 10, 11_long, first, last, ptr, row, flag)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing non-singular without diagonal....."
+   call random_matrix_generate_profile(state, SPRAL_MATRIX_REAL_RECT, &
+      10, 10, 10_long, first, last, ptr, row, flag, nonsingular=.true.)
+   call print_result(flag, ERROR_ARG)
+
+end subroutine test_profile
+
+subroutine test_block_band
+   integer, parameter :: long = selected_int_kind(18)
+   integer, parameter :: nprob = 50
+   integer, parameter :: maxn = 600
+   integer, parameter :: maxb = 12
+   integer, parameter :: maxbw = 6
+
+   integer :: prblm
+   integer :: matrix_type, m, n, b, nblk, kl, ku, mb, nb, flag, cap
+   integer :: i, j, j0, bi, bj, nfound
+   integer(long) :: k
+   integer(long), dimension(:), allocatable :: ptr
+   integer, dimension(:), allocatable :: row
+   real(wp), dimension(:), allocatable :: val
+   logical, dimension(:), allocatable :: present_blk
+   type(random_state) :: state
+   logical :: lsymmetric, nonsingular, match
+
+   write(*,"(/a)") "==========================="
+   write(*,"(a)")  "Testing block band matrices"
+   write(*,"(a)")  "==========================="
+
+   allocate(ptr(maxn+1), row(maxn*maxn), val(maxn*maxn))
+   allocate(present_blk(maxn))
+
+   do prblm = 1, nprob
+      lsymmetric = random_logical(state)
+      nonsingular = random_logical(state)
+      b = random_integer(state, maxb)
+      n = random_integer(state, maxn)
+      m = n
+      if(lsymmetric) then
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+         if(random_logical(state)) matrix_type = SPRAL_MATRIX_REAL_SYM_PSDEF
+      else
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+         if(random_logical(state)) m = random_integer(state, maxn)
+      endif
+      if(matrix_type.eq.SPRAL_MATRIX_REAL_SYM_PSDEF) nonsingular = .true.
+      mb = (m-1)/b + 1
+      nb = (n-1)/b + 1
+      kl = random_integer(state, maxbw+1) - 1
+      ku = kl
+      if(.not.lsymmetric) ku = random_integer(state, maxbw+1) - 1
+      cap = 0
+      do bj = 1, nb
+         if(lsymmetric) then
+            cap = cap + min(mb, bj+kl) - bj + 1
+         else
+            cap = cap + max(0, min(mb, bj+kl) - max(1, bj-ku) + 1)
+         endif
+      end do
+      if(cap.eq.0) cycle
+      nblk = random_integer(state, cap)
+      if(nonsingular) nblk = max(nblk, min(mb, nb))
+
+      write(*, "(a,i5,a,2i5,a,i3,a,i6,a,2i3,a,l1,l1,a)", advance="no") &
+         " * no. ", prblm, " m,n = ", m, n, " b = ", b, " nblk = ", nblk, &
+         " kl,ku = ", kl, ku, " flags = ", lsymmetric, nonsingular, "..."
+
+      call random_matrix_generate_block_band(state, matrix_type, m, n, b, &
+         int(nblk,long), kl, ku, ptr, row, flag, val=val, &
+         nonsingular=nonsingular)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+
+      ! Every column of a block column must consist of the same dense blocks,
+      ! in order, within the block band
+      match = (ptr(1).eq.1)
+      nfound = 0
+      do bj = 1, nb
+         if(.not.match) exit
+         j0 = (bj-1)*b + 1
+         present_blk(1:mb) = .false.
+         do k = ptr(j0), ptr(j0+1)-1
+            present_blk((row(k)-1)/b + 1) = .true.
+         end do
+         do bi = 1, mb
+            if(.not.present_blk(bi)) cycle
+            nfound = nfound + 1
+            match = match .and. (bi-bj.le.kl) .and. (bj-bi.le.ku)
+            if(lsymmetric) match = match .and. (bi.ge.bj)
+         end do
+         if(nonsingular .and. bj.le.min(mb,nb)) &
+            match = match .and. present_blk(bj)
+         do j = j0, min(n, bj*b)
+            k = ptr(j)
+            do bi = 1, mb
+               if(.not.present_blk(bi)) cycle
+               i = (bi-1)*b + 1
+               if(lsymmetric .and. bi.eq.bj) i = j
+               do i = i, min(m, bi*b)
+                  if(k.ge.ptr(j+1)) then
+                     match = .false.
+                  else
+                     match = match .and. (row(k).eq.i)
+                  endif
+                  k = k + 1
+               end do
+            end do
+            match = match .and. (k.eq.ptr(j+1))
+         end do
+      end do
+      match = match .and. (nfound.eq.nblk)
+      if(match) then
+         if(matrix_type.eq.SPRAL_MATRIX_REAL_SYM_PSDEF) then
+            ! Diagonal is first in each column and dominates it
+            do j = 1, n
+               match = match .and. &
+                  (val(ptr(j)).gt.sum(abs(val(ptr(j)+1:ptr(j+1)-1))))
+            end do
+         else
+            match = all(abs(val(1:ptr(n+1)-1)).le.1.0)
+         endif
+      endif
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a/a)") "fail", "bad matrix"
+         errors = errors + 1
+      endif
+   end do
+
+   ! Check bad arguments
+   write(*,"(a)",advance="no") " * Testing b = 0............................."
+   call random_matrix_generate_block_band(state, SPRAL_MATRIX_REAL_RECT, &
+      10, 10, 0, 1_long, 1, 1, ptr, row, flag)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing non-square unsymmetric............"
+   call random_matrix_generate_block_band(state, SPRAL_MATRIX_REAL_UNSYM, &
+      5, 6, 4, 1_long, 1, 1, ptr, row, flag)
+   call print_result(flag, ERROR_NONSQUARE)
+   write(*,"(a)",advance="no") " * Testing nblk > block band capacity........"
+   call random_matrix_generate_block_band(state, SPRAL_MATRIX_REAL_RECT, &
+      40, 40, 4, 11_long, 0, 0, ptr, row, flag)
+   call print_result(flag, ERROR_ARG)
+
+end subroutine test_block_band
+
+subroutine test_stencil
+   integer, parameter :: long = selected_int_kind(18)
+   integer, parameter :: nprob = 40
+   integer, parameter :: maxd = 3
+   integer, parameter :: maxpts = 2000
+
+   integer :: prblm
+   integer :: matrix_type, d, stencil, numbering, tile, n, flag, i, j, k
+   integer :: ncnt, t, ntile
+   integer(long) :: nnz, kk
+   integer, dimension(maxd) :: dims, tsize, ntiles, tc, c
+   integer(long), dimension(:), allocatable :: ptr
+   integer, dimension(:), allocatable :: row
+   integer, dimension(:,:), allocatable :: coord
+   real(wp), dimension(:), allocatable :: val
+   type(random_state) :: state
+   logical :: lsymmetric, lrandom, match, more
+
+   write(*,"(/a)") "========================"
+   write(*,"(a)")  "Testing stencil matrices"
+   write(*,"(a)")  "========================"
+
+   allocate(ptr(maxpts+1), row(27*maxpts), val(27*maxpts))
+   allocate(coord(maxd,maxpts))
+
+   do prblm = 1, nprob
+      d = random_integer(state, maxd)
+      dims(:) = 1
+      do k = 1, d
+         dims(k) = random_integer(state, int(maxpts**(1.0/d)))
+      end do
+      stencil = RANDOM_MATRIX_STENCIL_STAR
+      if(random_logical(state)) stencil = RANDOM_MATRIX_STENCIL_BOX
+      numbering = RANDOM_MATRIX_NUMBER_LEXICOGRAPHIC
+      if(random_logical(state)) numbering = RANDOM_MATRIX_NUMBER_BLOCKED
+      tile = random_integer(state, 5)
+      lsymmetric = random_logical(state)
+      lrandom = random_logical(state)
+      if(lsymmetric) then
+         matrix_type = SPRAL_MATRIX_REAL_SYM_PSDEF
+      else
+         matrix_type = SPRAL_MATRIX_REAL_UNSYM
+      endif
+
+      write(*, "(a,i3,a,3i5,a,i2,a,i2,i2,a,l1,l1,a)", advance="no") &
+         " * no. ", prblm, " dims = ", dims(:), " stencil = ", stencil, &
+         " numbering = ", numbering, tile, " flags = ", lsymmetric, lrandom, &
+         "..."
+
+      call random_matrix_stencil_size(matrix_type, d, dims, stencil, n, nnz, &
+         flag)
+      if(flag.eq.0) &
+         call random_matrix_generate_stencil(state, matrix_type, d, dims, &
+            stencil, n, nnz, ptr, row, flag, val=val, &
+            random_values=lrandom, numbering=numbering, tile=tile)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+
+      ! Find coordinates of each point by enumerating the numbering
+      if(numbering.eq.RANDOM_MATRIX_NUMBER_LEXICOGRAPHIC) then
+         tsize(1:d) = dims(1:d)
+         tsize(d) = 1
+      else
+         tsize(1:d) = min(tile, dims(1:d))
+      endif
+      ntiles(1:d) = (dims(1:d)-1)/tsize(1:d) + 1
+      ntile = product(ntiles(1:d))
+      j = 0
+      do t = 0, ntile-1
+         k = t
+         do i = 1, d
+            tc(i) = mod(k, ntiles(i))
+            k = k / ntiles(i)
+         end do
+         c(1:d) = tc(1:d)*tsize(1:d)
+         more = .true.
+         do while(more)
+            j = j + 1
+            coord(1:d,j) = c(1:d)
+            more = .false.
+            do i = 1, d
+               c(i) = c(i) + 1
+               if(c(i).lt.min(dims(i), (tc(i)+1)*tsize(i))) then
+                  more = .true.
+                  exit
+               endif
+               c(i) = tc(i)*tsize(i)
+            end do
+         end do
+      end do
+
+      ! Check each column holds exactly its sorted stencil neighbours
+      match = (j.eq.n) .and. (ptr(1).eq.1) .and. (ptr(n+1).eq.nnz+1)
+      do j = 1, n
+         if(.not.match) exit
+         ncnt = 0
+         do i = 1, n
+            if(lsymmetric .and. i.lt.j) cycle
+            if(stencil.eq.RANDOM_MATRIX_STENCIL_STAR) then
+               if(sum(abs(coord(1:d,i)-coord(1:d,j))).gt.1) cycle
+            else
+               if(maxval(abs(coord(1:d,i)-coord(1:d,j))).gt.1) cycle
+            endif
+            kk = ptr(j) + ncnt
+            ncnt = ncnt + 1
+            if(kk.ge.ptr(j+1)) then
+               match = .false.
+               exit
+            endif
+            match = match .and. (row(kk).eq.i)
+            if(.not.lrandom) then
+               if(i.eq.j) then
+                  match = match .and. (val(kk).eq.merge(2*d, 3**d-1, &
+                     stencil.eq.RANDOM_MATRIX_STENCIL_STAR))
+               else
+                  match = match .and. (val(kk).eq.-1.0)
+               endif
+            endif
+         end do
+         match = match .and. (ptr(j)+ncnt.eq.ptr(j+1))
+      end do
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a/a)") "fail", "bad matrix"
+         errors = errors + 1
+      endif
+   end do
+
+   ! Check known sizes
+   write(*,"(a)",advance="no") " * Testing 5-point 10x10 size................"
+   call random_matrix_stencil_size(SPRAL_MATRIX_REAL_UNSYM, 2, (/ 10, 10 /), &
+      RANDOM_MATRIX_STENCIL_STAR, n, nnz, flag)
+   if(flag.eq.0 .and. (n.ne.100 .or. nnz.ne.460)) flag = 1
+   call print_result(flag, 0)
+   write(*,"(a)",advance="no") " * Testing 27-point 4x4x4 symmetric size....."
+   call random_matrix_stencil_size(SPRAL_MATRIX_REAL_SYM_INDEF, 3, &
+      (/ 4, 4, 4 /), RANDOM_MATRIX_STENCIL_BOX, n, nnz, flag)
+   if(flag.eq.0 .and. (n.ne.64 .or. nnz.ne.(1000+64)/2)) flag = 1
+   call print_result(flag, 0)
+
+   ! Check bad arguments
+   write(*,"(a)",advance="no") " * Testing bad stencil......................."
+   call random_matrix_stencil_size(SPRAL_MATRIX_REAL_UNSYM, 2, (/ 10, 10 /), &
+      3, n, nnz, flag)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing wrong nnz........................."
+   call random_matrix_generate_stencil(state, SPRAL_MATRIX_REAL_UNSYM, 2, &
+      (/ 10, 10 /), RANDOM_MATRIX_STENCIL_STAR, 100, 459_long, ptr, row, flag)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing bad numbering....................."
+   call random_matrix_generate_stencil(state, SPRAL_MATRIX_REAL_UNSYM, 2, &
+      (/ 10, 10 /), RANDOM_MATRIX_STENCIL_STAR, 100, 460_long, ptr, row, &
+      flag, numbering=3)
+   call print_result(flag, ERROR_ARG)
+
+end subroutine test_stencil
+
+subroutine test_band_rhs
+   integer, parameter :: nprob = 60
+   integer, parameter :: maxn = 1000
+   integer, parameter :: maxbw = 300
+
+   integer :: prblm
+   integer :: matrix_type, m, n, nnz, kl, ku, flag, i, j, k, opt, cap
+   integer, dimension(:), allocatable :: ptr, row, ptr2, row2
+   real(wp), dimension(:), allocatable :: val, val2, x, rhs, ref
+   real(wp), dimension(2) :: cond
+   type(random_state) :: state, state2
+   logical :: lsymmetric, direct, match
+   real(wp) :: sgn, err
+
+   write(*,"(/a)") "========================================="
+   write(*,"(a)")  "Testing band matrices with known solution"
+   write(*,"(a)")  "========================================="
+
+   allocate(ptr(maxn+1), row(maxn*(2*maxbw+1)), val(maxn*(2*maxbw+1)))
+   allocate(ptr2(maxn+1), row2(maxn*(2*maxbw+1)), val2(maxn*(2*maxbw+1)))
+   allocate(x(maxn), rhs(maxn), ref(maxn))
+
+   do prblm = 1, nprob
+      n = random_integer(state, maxn)
+      m = n
+      ! 1: plain, 2: dominance, 3: conditioned
+      opt = random_integer(state, 3)
+      select case(random_integer(state, 4))
+      case(1)
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+         if(opt.eq.1) m = random_integer(state, maxn)
+      case(2)
+         matrix_type = SPRAL_MATRIX_REAL_UNSYM
+      case(3)
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+      case default
+         matrix_type = SPRAL_MATRIX_REAL_SKEW
+         opt = 1
+      end select
+      lsymmetric = (matrix_type.eq.SPRAL_MATRIX_REAL_SYM_INDEF) .or. &
+         (matrix_type.eq.SPRAL_MATRIX_REAL_SKEW)
+      sgn = 1.0
+      if(matrix_type.eq.SPRAL_MATRIX_REAL_SKEW) sgn = -1.0
+      kl = random_integer(state, maxbw+1) - 1
+      ku = kl
+      if(.not.lsymmetric) ku = random_integer(state, maxbw+1) - 1
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, m, j, kl, ku)
+      end do
+      nnz = random_integer(state, cap)
+      if(opt.ne.1) nnz = max(nnz, n)
+      direct = random_logical(state)
+      cond = (/ 10.0_wp, 100.0_wp /)
+
+      write(*, "(a,i3,a,2i5,a,i7,a,2i4,a,i2,a,i2,a,l1,a)", advance="no") &
+         " * no. ", prblm, " m,n = ", m, n, " nnz = ", nnz, " kl,ku = ", &
+         kl, ku, " type = ", matrix_type, " opt = ", opt, " direct = ", &
+         direct, "..."
+
+      ! Generate with and without x and rhs from the same state
+      state2 = state
+      select case(opt)
+      case(1)
+         call random_matrix_generate(state, matrix_type, m, n, nnz, kl, ku, &
+            ptr, row, flag, val=val, direct=direct, x=x, rhs=rhs)
+         if(flag.eq.0) &
+            call random_matrix_generate(state2, matrix_type, m, n, nnz, kl, &
+               ku, ptr2, row2, flag, val=val2, direct=direct)
+      case(2)
+         call random_matrix_generate(state, matrix_type, m, n, nnz, kl, ku, &
+            ptr, row, flag, val=val, direct=direct, dominance=2.0_wp, x=x, &
+            rhs=rhs)
+         if(flag.eq.0) &
+            call random_matrix_generate(state2, matrix_type, m, n, nnz, kl, &
+               ku, ptr2, row2, flag, val=val2, direct=direct, &
+               dominance=2.0_wp)
+      case(3)
+         call random_matrix_generate(state, matrix_type, m, n, nnz, kl, ku, &
+            ptr, row, flag, val=val, direct=direct, cond=cond, x=x, rhs=rhs)
+         if(flag.eq.0) &
+            call random_matrix_generate(state2, matrix_type, m, n, nnz, kl, &
+               ku, ptr2, row2, flag, val=val2, direct=direct, cond=cond)
+      end select
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+
+      ! Matrix must be unchanged, and rhs must be A*x
+      match = all(ptr(1:n+1).eq.ptr2(1:n+1))
+      if(match) match = all(row(1:nnz).eq.row2(1:nnz)) .and. &
+         all(val(1:nnz).eq.val2(1:nnz))
+      match = match .and. all(abs(x(1:n)).lt.1.0)
+      ref(1:m) = 0.0
+      do j = 1, n
+         do k = ptr(j), ptr(j+1)-1
+            i = row(k)
+            ref(i) = ref(i) + val(k)*x(j)
+            if(lsymmetric .and. i.ne.j) ref(j) = ref(j) + sgn*val(k)*x(i)
+         end do
+      end do
+      err = maxval(abs(rhs(1:m)-ref(1:m))) / max(1.0_wp, maxval(abs(ref(1:m))))
+      match = match .and. (err.lt.1e-12_wp)
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a/a,es12.4)") "fail", "error = ", err
+         errors = errors + 1
+      endif
+   end do
+
+   write(*,"(a)",advance="no") " * Testing rhs without x....................."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_UNSYM, 10, 10, 20, &
+      2, 2, ptr, row, flag, val=val, direct=.true., rhs=rhs)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing rhs without val..................."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_UNSYM, 10, 10, 20, &
+      2, 2, ptr, row, flag, direct=.true., x=x, rhs=rhs)
+   call print_result(flag, ERROR_ARG)
+
+end subroutine test_band_rhs
+
+subroutine test_band_precision
+   integer, parameter :: sp = kind(0e0)
+   integer, parameter :: nprob = 60
+   integer, parameter :: maxn = 1000
+   integer, parameter :: maxbw = 100
+
+   integer :: prblm
+   integer :: matrix_type, rtype, m, n, nnz, kl, ku, flag, j, k, cap, prec
+   integer, dimension(:), allocatable :: ptr, row, ptr2, row2
+   real(sp), dimension(:), allocatable :: sval
+   complex(sp), dimension(:), allocatable :: cval
+   complex(wp), dimension(:), allocatable :: zval
+   real(wp), dimension(:), allocatable :: aval
+   real(wp), dimension(:), allocatable :: imval
+   type(random_state) :: state, state2
+   logical :: lsymmetric, direct, dominant, match
+   real(wp) :: offsum
+
+   write(*,"(/a)") "=================================================="
+   write(*,"(a)")  "Testing single precision and complex band matrices"
+   write(*,"(a)")  "=================================================="
+
+   allocate(ptr(maxn+1), row(maxn*(2*maxbw+1)))
+   allocate(ptr2(maxn+1), row2(maxn*(2*maxbw+1)))
+   allocate(sval(maxn*(2*maxbw+1)), cval(maxn*(2*maxbw+1)), &
+      zval(maxn*(2*maxbw+1)), aval(maxn*(2*maxbw+1)), &
+      imval(maxn*(2*maxbw+1)))
+
+   do prblm = 1, nprob
+      n = random_integer(state, maxn)
+      m = n
+      ! 1: real(sp), 2: complex(sp), 3: complex(wp)
+      prec = random_integer(state, 3)
+      select case(random_integer(state, 4))
+      case(1)
+         rtype = SPRAL_MATRIX_REAL_RECT
+         matrix_type = SPRAL_MATRIX_CPLX_RECT
+         m = random_integer(state, maxn)
+      case(2)
+         rtype = SPRAL_MATRIX_REAL_UNSYM
+         matrix_type = SPRAL_MATRIX_CPLX_UNSYM
+      case(3)
+         rtype = SPRAL_MATRIX_REAL_SYM_PSDEF
+         matrix_type = SPRAL_MATRIX_CPLX_HERM_PSDEF
+      case default
+         rtype = SPRAL_MATRIX_REAL_SYM_INDEF
+         matrix_type = SPRAL_MATRIX_CPLX_HERM_INDEF
+      end select
+      if(prec.eq.1) matrix_type = rtype
+      lsymmetric = (rtype.eq.SPRAL_MATRIX_REAL_SYM_PSDEF) .or. &
+         (rtype.eq.SPRAL_MATRIX_REAL_SYM_INDEF)
+      dominant = (rtype.eq.SPRAL_MATRIX_REAL_SYM_PSDEF)
+      kl = random_integer(state, maxbw+1) - 1
+      ku = kl
+      if(.not.lsymmetric) ku = random_integer(state, maxbw+1) - 1
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, m, j, kl, ku)
+      end do
+      nnz = random_integer(state, cap)
+      if(dominant) nnz = max(nnz, n)
+      direct = random_logical(state)
+
+      write(*, "(a,i3,a,2i5,a,i7,a,2i4,a,i2,a,i1,a,l1,a)", advance="no") &
+         " * no. ", prblm, " m,n = ", m, n, " nnz = ", nnz, " kl,ku = ", &
+         kl, ku, " type = ", matrix_type, " prec = ", prec, " direct = ", &
+         direct, "..."
+
+      ! Pattern must be that of the double precision call without values
+      state2 = state
+      select case(prec)
+      case(1)
+         call random_matrix_generate(state, matrix_type, m, n, nnz, kl, ku, &
+            ptr, row, flag, sval=sval, direct=direct, sort=.true.)
+         aval(1:nnz) = abs(sval(1:nnz))
+         imval(1:nnz) = 0.0
+      case(2)
+         call random_matrix_generate(state, matrix_type, m, n, nnz, kl, ku, &
+            ptr, row, flag, cval=cval, direct=direct, sort=.true.)
+         aval(1:nnz) = abs(cval(1:nnz))
+         imval(1:nnz) = aimag(cval(1:nnz))
+      case(3)
+         call random_matrix_generate(state, matrix_type, m, n, nnz, kl, ku, &
+            ptr, row, flag, zval=zval, direct=direct, sort=.true.)
+         aval(1:nnz) = abs(zval(1:nnz))
+         imval(1:nnz) = aimag(zval(1:nnz))
+      end select
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      call random_matrix_generate(state2, rtype, m, n, nnz, kl, ku, ptr2, &
+         row2, flag, direct=direct, sort=.true.)
+      match = (flag.eq.0) .and. all(ptr(1:n+1).eq.ptr2(1:n+1))
+      if(match) match = all(row(1:nnz).eq.row2(1:nnz))
+
+      ! Off-diagonal moduli are at most sqrt(2); Hermitian diagonals are real
+      ! and, if positive definite and present, dominant
+      do j = 1, n
+         offsum = 0.0
+         do k = ptr(j), ptr(j+1)-1
+            if(row(k).ne.j) then
+               match = match .and. (aval(k).le.1.5_wp)
+               offsum = offsum + aval(k)
+            else if(lsymmetric .and. prec.ne.1) then
+               match = match .and. (imval(k).eq.0.0)
+            endif
+         end do
+         if(dominant .and. ptr(j).lt.ptr(j+1)) then
+            k = ptr(j)
+            if(row(k).eq.j) match = match .and. (aval(k).ge.offsum)
+         endif
+      end do
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a)") "fail"
+         errors = errors + 1
+      endif
+   end do
+
+   write(*,"(a)",advance="no") " * Testing complex type for real(sp)........."
+   call random_matrix_generate(state, SPRAL_MATRIX_CPLX_UNSYM, 10, 10, 20, &
+      2, 2, ptr, row, flag, sval=sval)
+   call print_result(flag, ERROR_MATRIX_TYPE)
+   write(*,"(a)",advance="no") " * Testing real type for complex(wp)........."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_UNSYM, 10, 10, 20, &
+      2, 2, ptr, row, flag, zval=zval)
+   call print_result(flag, ERROR_MATRIX_TYPE)
+   write(*,"(a)",advance="no") " * Testing dominance of complex skew........."
+   call random_matrix_generate(state, SPRAL_MATRIX_CPLX_SKEW, 10, 10, 20, &
+      2, 2, ptr, row, flag, cval=cval, dominance=2.0_wp)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing non-square complex symmetric......"
+   call random_matrix_generate(state, SPRAL_MATRIX_CPLX_SYM, 10, 12, 20, &
+      2, 2, ptr, row, flag, cval=cval)
+   call print_result(flag, ERROR_NONSQUARE)
+   write(*,"(a)",advance="no") " * Testing both cval and zval................"
+   call random_matrix_generate(state, SPRAL_MATRIX_CPLX_UNSYM, 10, 10, 20, &
+      2, 2, ptr, row, flag, cval=cval, zval=zval)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing rhs with sval....................."
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_UNSYM, 10, 10, 20, &
+      2, 2, ptr, row, flag, sval=sval, x=aval(1:10), rhs=imval(1:10))
+   call print_result(flag, ERROR_ARG)
+
+end subroutine test_band_precision
+
+subroutine test_band_batch
+   integer, parameter :: long = selected_int_kind(18)
+   integer, parameter :: nbatch = 12
+   integer, parameter :: maxmat = 40
+   integer, parameter :: maxn = 300
+   integer, parameter :: maxbw = 50
+
+   integer :: batch, nmat, matrix_type, flag, i, j, cap, totn, totnz
+   integer, dimension(maxmat) :: m, n, nnz, kl, ku
+   integer(long), dimension(maxmat+1) :: mptr, eptr
+   integer, dimension(:), allocatable :: ptr, row, ptr1, row1
+   real(wp), dimension(:), allocatable :: val, val1
+   type(random_state) :: state, state0, mstate
+   logical :: lsymmetric, direct, sort, match, dominant
+
+   write(*,"(/a)") "=============================="
+   write(*,"(a)")  "Testing batched band generator"
+   write(*,"(a)")  "=============================="
+
+   allocate(ptr(maxmat*(maxn+1)), row(maxmat*maxn*(2*maxbw+1)), &
+      val(maxmat*maxn*(2*maxbw+1)))
+   allocate(ptr1(maxn+1), row1(maxn*(2*maxbw+1)), val1(maxn*(2*maxbw+1)))
+
+   do batch = 1, nbatch
+      nmat = random_integer(state, maxmat)
+      select case(random_integer(state, 4))
+      case(1)
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+      case(2)
+         matrix_type = SPRAL_MATRIX_REAL_UNSYM
+      case(3)
+         matrix_type = SPRAL_MATRIX_REAL_SYM_PSDEF
+      case default
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+      end select
+      lsymmetric = (matrix_type.eq.SPRAL_MATRIX_REAL_SYM_PSDEF) .or. &
+         (matrix_type.eq.SPRAL_MATRIX_REAL_SYM_INDEF)
+      dominant = (matrix_type.eq.SPRAL_MATRIX_REAL_SYM_PSDEF)
+      do i = 1, nmat
+         n(i) = random_integer(state, maxn)
+         m(i) = n(i)
+         if(matrix_type.eq.SPRAL_MATRIX_REAL_RECT) &
+            m(i) = random_integer(state, maxn)
+         kl(i) = random_integer(state, maxbw+1) - 1
+         ku(i) = kl(i)
+         if(.not.lsymmetric) ku(i) = random_integer(state, maxbw+1) - 1
+         cap = 0
+         do j = 1, n(i)
+            cap = cap + band_col_size(lsymmetric, m(i), j, kl(i), ku(i))
+         end do
+         nnz(i) = random_integer(state, cap)
+         if(dominant) nnz(i) = max(nnz(i), n(i))
+      end do
+      direct = random_logical(state)
+      sort = random_logical(state)
+      totn = sum(n(1:nmat))
+      totnz = sum(nnz(1:nmat))
+
+      write(*, "(a,i3,a,i3,a,i6,a,i8,a,i2,a,l1,a,l1,a)", advance="no") &
+         " * no. ", batch, " nmat = ", nmat, " sum n = ", totn, &
+         " sum nnz = ", totnz, " type = ", matrix_type, " direct = ", &
+         direct, " sort = ", sort, "..."
+
+      ! Each matrix must match a single call from the stream split by index
+      state0 = state
+      call random_matrix_generate_band_batch(state, matrix_type, nmat, &
+         m, n, nnz, kl, ku, mptr, eptr, ptr, row, flag, val=val, &
+         direct=direct, sort=sort)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      match = (mptr(nmat+1).eq.totn+nmat+1) .and. (eptr(nmat+1).eq.totnz+1)
+      do i = 1, nmat
+         if(.not.match) exit
+         call random_split(state0, int(i,long), mstate)
+         call random_matrix_generate(mstate, matrix_type, m(i), n(i), &
+            nnz(i), kl(i), ku(i), ptr1, row1, flag, val=val1, &
+            direct=direct, sort=sort)
+         match = (flag.eq.0) .and. &
+            all(ptr(mptr(i):mptr(i+1)-1).eq.ptr1(1:n(i)+1))
+         if(match) match = &
+            all(row(eptr(i):eptr(i+1)-1).eq.row1(1:nnz(i))) .and. &
+            all(val(eptr(i):eptr(i+1)-1).eq.val1(1:nnz(i)))
+      end do
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a)") "fail"
+         errors = errors + 1
+      endif
+   end do
+
+   write(*,"(a)",advance="no") " * Testing bad matrix in batch..............."
+   n(1:3) = 10
+   m(1:3) = 10
+   nnz(1:3) = 20
+   kl(1:3) = 2
+   ku(1:3) = 2
+   ku(2) = 3
+   call random_matrix_generate_band_batch(state, &
+      SPRAL_MATRIX_REAL_SYM_INDEF, 3, m, n, nnz, kl, ku, mptr, eptr, ptr, &
+      row, flag)
+   call print_result(flag, ERROR_ARG)
+   write(*,"(a)",advance="no") " * Testing empty batch......................."
+   call random_matrix_generate_band_batch(state, SPRAL_MATRIX_REAL_UNSYM, &
+      0, m, n, nnz, kl, ku, mptr, eptr, ptr, row, flag)
+   call print_result(flag, 0)
+
+end subroutine test_band_batch
+
+subroutine test_workspace
+   integer, parameter :: long = selected_int_kind(18)
+   integer, parameter :: nprob = 40
+   integer, parameter :: maxn = 500
+   integer, parameter :: maxbw = 60
+
+   integer :: prblm, matrix_type, m, n, nnz, bw, flag, j, cap, opt
+   integer, dimension(:), allocatable :: ptr, row, ptr2, row2
+   integer(long), dimension(:), allocatable :: ptr64, ptr64b
+   real(wp), dimension(:), allocatable :: val, val2
+   type(random_state) :: state, state2
+   type(random_matrix_workspace) :: work
+   logical :: lsymmetric, nonsingular, sort, direct, match
+
+   write(*,"(/a)") "=============================="
+   write(*,"(a)")  "Testing caller-owned workspace"
+   write(*,"(a)")  "=============================="
+
+   allocate(ptr(maxn+1), row(maxn*maxn), val(maxn*maxn))
+   allocate(ptr2(maxn+1), row2(maxn*maxn), val2(maxn*maxn))
+   allocate(ptr64(maxn+1), ptr64b(maxn+1))
+
+   ! Matrices of varying size, so that the workspace both grows and is
+   ! reused while larger than required
+   do prblm = 1, nprob
+      n = random_integer(state, maxn)
+      m = n
+      ! 1: non-band 32-bit, 2: non-band 64-bit, 3: band 32-bit, 4: band 64-bit
+      opt = random_integer(state, 4)
+      select case(random_integer(state, 3))
+      case(1)
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+         m = random_integer(state, maxn)
+      case(2)
+         matrix_type = SPRAL_MATRIX_REAL_UNSYM
+      case default
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+      end select
+      lsymmetric = (matrix_type.eq.SPRAL_MATRIX_REAL_SYM_INDEF)
+      bw = random_integer(state, maxbw)
+      if(opt.le.2) bw = max(m,n)
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, m, j, bw, bw)
+      end do
+      nnz = random_integer(state, cap)
+      nonsingular = random_logical(state)
+      if(nonsingular) nnz = max(nnz, min(m,n))
+      sort = random_logical(state)
+      direct = random_logical(state)
+
+      write(*, "(a,i3,a,2i4,a,i7,a,i3,a,i2,a,i1,a,l1,a)", advance="no") &
+         " * no. ", prblm, " m,n = ", m, n, " nnz = ", nnz, " bw = ", bw, &
+         " type = ", matrix_type, " opt = ", opt, " direct = ", direct, "..."
+
+      ! Generate with and without the workspace from the same state
+      state2 = state
+      select case(opt)
+      case(1)
+         call random_matrix_generate(state, matrix_type, m, n, nnz, ptr, &
+            row, flag, val=val, nonsingular=nonsingular, sort=sort, work=work)
+         call random_matrix_generate(state2, matrix_type, m, n, nnz, ptr2, &
+            row2, flag, val=val2, nonsingular=nonsingular, sort=sort)
+      case(2)
+         call random_matrix_generate(state, matrix_type, m, n, &
+            int(nnz,long), ptr64, row, flag, val=val, &
+            nonsingular=nonsingular, sort=sort, work=work)
+         call random_matrix_generate(state2, matrix_type, m, n, &
+            int(nnz,long), ptr64b, row2, flag, val=val2, &
+            nonsingular=nonsingular, sort=sort)
+         ptr(1:n+1) = int(ptr64(1:n+1))
+         ptr2(1:n+1) = int(ptr64b(1:n+1))
+      case(3)
+         call random_matrix_generate(state, matrix_type, m, n, nnz, bw, &
+            ptr, row, flag, val=val, nonsingular=nonsingular, sort=sort, &
+            direct=direct, work=work)
+         call random_matrix_generate(state2, matrix_type, m, n, nnz, bw, &
+            ptr2, row2, flag, val=val2, nonsingular=nonsingular, sort=sort, &
+            direct=direct)
+      case(4)
+         call random_matrix_generate(state, matrix_type, m, n, &
+            int(nnz,long), bw, bw, ptr64, row, flag, val=val, &
+            nonsingular=nonsingular, sort=sort, direct=direct, work=work)
+         call random_matrix_generate(state2, matrix_type, m, n, &
+            int(nnz,long), bw, bw, ptr64b, row2, flag, val=val2, &
+            nonsingular=nonsingular, sort=sort, direct=direct)
+         ptr(1:n+1) = int(ptr64(1:n+1))
+         ptr2(1:n+1) = int(ptr64b(1:n+1))
+      end select
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      match = all(ptr(1:n+1).eq.ptr2(1:n+1))
+      if(match) match = all(row(1:nnz).eq.row2(1:nnz)) .and. &
+         all(val(1:nnz).eq.val2(1:nnz))
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a)") "fail"
+         errors = errors + 1
+      endif
+   end do
+
+   call random_matrix_workspace_free(work)
+
+end subroutine test_workspace
+
+subroutine test_dense_fill
+   integer, parameter :: long = selected_int_kind(18)
+   integer, parameter :: nprob = 60
+   integer, parameter :: maxn = 200
+   integer, parameter :: maxbw = 40
+
+   integer :: prblm, matrix_type, m, n, nnz, bw, flag, j, cap
+   integer(long) :: chksum
+   integer, dimension(:), allocatable :: ptr, row
+   real(wp), dimension(:), allocatable :: val
+   type(random_state) :: state
+   logical :: lsymmetric, lband, nonsingular, sort
+
+   write(*,"(/a)") "======================================="
+   write(*,"(a)")  "Testing matrices filled beyond one half"
+   write(*,"(a)")  "======================================="
+
+   allocate(ptr(maxn+1), row(maxn*maxn), val(maxn*maxn))
+
+   do prblm = 1, nprob
+      n = random_integer(state, maxn)
+      m = n
+      select case(random_integer(state, 3))
+      case(1)
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+         m = random_integer(state, maxn)
+      case(2)
+         matrix_type = SPRAL_MATRIX_REAL_UNSYM
+      case default
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+      end select
+      lsymmetric = (matrix_type.eq.SPRAL_MATRIX_REAL_SYM_INDEF)
+      lband = random_logical(state)
+      bw = max(m,n)
+      if(lband) bw = random_integer(state, maxbw)
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, m, j, bw, bw)
+      end do
+      ! Somewhere between half full and full, so holes are sampled
+      nnz = cap - random_integer(state, cap/2+1) + 1
+      nonsingular = random_logical(state)
+      if(nonsingular) nnz = max(nnz, min(m,n))
+      sort = random_logical(state)
+
+      write(*, "(a,i3,a,2i4,a,i6,a,i6,a,i3,a,i1,a)", advance="no") &
+         " * no. ", prblm, " m,n = ", m, n, " nnz = ", nnz, " cap = ", cap, &
+         " bw = ", min(bw,999), " type = ", matrix_type, "..."
+
+      if(lband) then
+         call random_matrix_generate(state, matrix_type, m, n, nnz, bw, ptr, &
+            row, flag, val=val, nonsingular=nonsingular, sort=sort)
+      else
+         call random_matrix_generate(state, matrix_type, m, n, nnz, ptr, &
+            row, flag, val=val, nonsingular=nonsingular, sort=sort, &
+            complement=.true.)
+      endif
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      if(lband) then
+         call chk_random_band(lsymmetric, m, n, nnz, bw, bw, ptr, row, val, &
+            nonsingular, sort)
+      else if(lsymmetric) then
+         call chk_random_symmetric(n, nnz, ptr, row, val, nonsingular, sort)
+      else
+         call chk_random_unsymmetric(m, n, nnz, ptr, row, val, nonsingular, &
+            sort)
+      endif
+   end do
+
+   ! Without complement, dense matrices must be those of earlier versions.
+   ! The reference checksums of the row indices were found with them.
+   do prblm = 1, 2
+      if(prblm.eq.1) then
+         matrix_type = SPRAL_MATRIX_REAL_UNSYM
+         nnz = 9000
+      else
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+         nnz = 4500
+      endif
+      write(*, "(a,i1,a)", advance="no") &
+         " * unchanged without complement, type = ", matrix_type, "..."
+      call random_set_seed(state, 1234)
+      call random_matrix_generate(state, matrix_type, 100, 100, nnz, ptr, &
+         row, flag, val=val, nonsingular=.true.)
+      chksum = 0
+      do j = 1, ptr(101)-1
+         chksum = mod(31*chksum + row(j), 1000000007_long)
+      end do
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+      else if((prblm.eq.1 .and. chksum.ne.335585501_long) .or. &
+            (prblm.eq.2 .and. chksum.ne.155144602_long)) then
+         write(*, "(a/a,i12)") "fail", "checksum = ", chksum
+         errors = errors + 1
+      else
+         write(*, "(a)") "ok"
+      endif
+   end do
+
+end subroutine test_dense_fill
+
+subroutine test_band_coord
+   integer, parameter :: long = selected_int_kind(18)
+   integer, parameter :: nprob = 40
+   integer, parameter :: maxn = 500
+   integer, parameter :: maxbw = 60
+
+   integer :: prblm, matrix_type, m, n, nnz, kl, ku, flag, j, k, cap
+   integer, dimension(:), allocatable :: ptr, row, row2, col
+   real(wp), dimension(:), allocatable :: val, val2
+   type(random_state) :: state, state2
+   type(random_matrix_workspace) :: work
+   logical :: lsymmetric, nonsingular, sort, direct, use_work, match
+
+   write(*,"(/a)") "====================================="
+   write(*,"(a)")  "Testing band generation in COO format"
+   write(*,"(a)")  "====================================="
+
+   allocate(ptr(maxn+1), row(maxn*maxn), row2(maxn*maxn), col(maxn*maxn))
+   allocate(val(maxn*maxn), val2(maxn*maxn))
+
+   ! The coordinate matrix must match the CSC matrix from the same state
+   do prblm = 1, nprob
+      n = random_integer(state, maxn)
+      m = n
+      select case(random_integer(state, 4))
+      case(1)
+         matrix_type = SPRAL_MATRIX_REAL_RECT
+         m = random_integer(state, maxn)
+      case(2)
+         matrix_type = SPRAL_MATRIX_REAL_UNSYM
+      case(3)
+         matrix_type = SPRAL_MATRIX_REAL_SYM_PSDEF
+      case default
+         matrix_type = SPRAL_MATRIX_REAL_SYM_INDEF
+      end select
+      lsymmetric = (matrix_type.eq.SPRAL_MATRIX_REAL_SYM_PSDEF) .or. &
+         (matrix_type.eq.SPRAL_MATRIX_REAL_SYM_INDEF)
+      kl = random_integer(state, maxbw+1) - 1
+      ku = kl
+      if(.not.lsymmetric) ku = random_integer(state, maxbw+1) - 1
+      cap = 0
+      do j = 1, n
+         cap = cap + band_col_size(lsymmetric, m, j, kl, ku)
+      end do
+      nnz = random_integer(state, cap)
+      nonsingular = random_logical(state) .or. &
+         (matrix_type.eq.SPRAL_MATRIX_REAL_SYM_PSDEF)
+      if(nonsingular) nnz = max(nnz, min(m,n))
+      sort = random_logical(state)
+      direct = random_logical(state)
+      use_work = random_logical(state)
+
+      write(*, "(a,i3,a,2i4,a,i7,a,2i3,a,i1,a,l1,a)", advance="no") &
+         " * no. ", prblm, " m,n = ", m, n, " nnz = ", nnz, " kl,ku = ", &
+         kl, ku, " type = ", matrix_type, " direct = ", direct, "..."
+
+      state2 = state
+      if(use_work) then
+         call random_matrix_generate_band_coord(state, matrix_type, m, n, &
+            int(nnz,long), kl, ku, row, col, flag, val=val, &
+            nonsingular=nonsingular, sort=sort, direct=direct, work=work)
+      else
+         call random_matrix_generate_band_coord(state, matrix_type, m, n, &
+            int(nnz,long), kl, ku, row, col, flag, val=val, &
+            nonsingular=nonsingular, sort=sort, direct=direct)
+      endif
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      call random_matrix_generate(state2, matrix_type, m, n, nnz, kl, ku, &
+         ptr, row2, flag, val=val2, nonsingular=nonsingular, sort=sort, &
+         direct=direct)
+      match = (flag.eq.0)
+      if(match) match = all(row(1:nnz).eq.row2(1:nnz)) .and. &
+         all(val(1:nnz).eq.val2(1:nnz))
+      do j = 1, n
+         do k = ptr(j), ptr(j+1)-1
+            match = match .and. (col(k).eq.j)
+         end do
+      end do
+      ! Generators must leave state in the same position
+      match = match .and. (random_real(state).eq.random_real(state2))
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a)") "fail"
+         errors = errors + 1
+      endif
+   end do
+
+   call random_matrix_workspace_free(work)
+
+end subroutine test_band_coord
+
+subroutine test_band_threads
+   integer, parameter :: m = 3000, n = 2500, bw = 40, nnz = 120000
+   integer, parameter :: nthread_max = 4
+
+   integer :: i, flag, nthread, engine
+   integer, dimension(n+1) :: ptr, ptr1
+   integer, dimension(nnz) :: row, row1
+   real(wp), dimension(nnz) :: val, val1
+   type(random_state) :: state
+   logical :: match
+
+   write(*,"(/a)") "======================================="
+   write(*,"(a)")  "Testing direct band generator threading"
+   write(*,"(a)")  "======================================="
+
+   nthread = 1
+!$ nthread = omp_get_max_threads()
+   do engine = RANDOM_ENGINE_LCG, RANDOM_ENGINE_PHILOX
+   do i = 1, nthread_max
+      write(*, "(a,i2,a,i2,a)", advance="no") " * Testing engine ", engine, &
+         " with ", i, " threads......"
+!$    call omp_set_num_threads(i)
+      call random_set_seed(state, 1234)
+      call random_set_engine(state, engine)
+      call random_matrix_generate(state, SPRAL_MATRIX_REAL_RECT, m, n, nnz, &
+         bw, ptr, row, flag, val=val, nonsingular=.true., sort=.true., &
+         direct=.true.)
+      if(flag.ne.0) then
+         write(*, "(a/a,i5)") "fail", "flag = ", flag
+         errors = errors + 1
+         cycle
+      endif
+      if(i.eq.1) then
+         ptr1(:) = ptr(:)
+         row1(:) = row(:)
+         val1(:) = val(:)
+      endif
+      match = all(ptr(:).eq.ptr1(:)) .and. all(row(:).eq.row1(:)) .and. &
+         all(val(:).eq.val1(:))
+      if(match) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a/a)") "fail", "result differs from single thread result"
+         errors = errors + 1
+      endif
+   end do
+   end do
+!$ call omp_set_num_threads(nthread)
+end subroutine test_band_threads
+
+integer function band_col_size(lsymmetric, m, j, kl, ku)
+   logical, intent(in) :: lsymmetric
+   integer, intent(in) :: m
+   integer, intent(in) :: j
+   integer, intent(in) :: kl
+   integer, intent(in) :: ku
+
+   if(lsymmetric) then
+      band_col_size = max(0, min(m, j+kl) - j + 1)
+   else
+      band_col_size = max(0, min(m, j+kl) - max(1, j-ku) + 1)
+   endif
+end function band_col_size
+
+subroutine chk_random_band(lsymmetric, m, n, nnz, kl, ku, ptr, row, val, &
+      nonsingular, sort)
+   logical, intent(in) :: lsymmetric
+   integer, intent(in) :: m
+   integer, intent(in) :: n
+   integer, intent(in) :: nnz
+   integer, intent(in) :: kl
+   integer, intent(in) :: ku
+   integer, dimension(n+1), intent(in) :: ptr
+   integer, dimension(ptr(n+1)-1), intent(in) :: row
+   real(wp), dimension(ptr(n+1)-1), intent(in) :: val
+   logical, intent(in) :: nonsingular
+   logical, intent(in) :: sort
+
+   integer :: i, j, lo
+   logical :: dpresent
+   logical, dimension(:), allocatable :: seen
+
+   if(ptr(n+1)-1.ne.nnz) then
+      write(*, "(a/a,2i8)") "fail", "ptr(n+1)-1 != nnz requested", &
+         ptr(n+1)-1, nnz
+      errors = errors + 1
+      return
+   endif
+
+   allocate(seen(m))
+   seen(:) = .false.
+   do i = 1, n
+      if(ptr(i+1).lt.ptr(i)) then
+         write(*, "(a/a)") "fail", "ptr non-monotonic"
+         errors = errors + 1
+         return
+      endif
+      lo = max(1, i-ku)
+      if(lsymmetric) lo = i
+      dpresent = .false.
+      do j = ptr(i), ptr(i+1)-1
+         if(row(j).eq.i) dpresent = .true.
+         if(row(j).lt.lo .or. row(j).gt.min(m, i+kl)) then
+            write(*, "(a/a,i5,a,i5)") "fail", "col ", i, &
+               " has out-of-band row index ", row(j)
+            errors = errors + 1
+            return
+         endif
+         if(seen(row(j))) then
+            write(*, "(a/a,i5,a,i5)") "fail", "col ", i, &
+               " has duplicate row index ", row(j)
+            errors = errors + 1
+            return
+         endif
+         seen(row(j)) = .true.
+         if(sort .and. j.gt.ptr(i)) then
+            if(row(j).le.row(j-1)) then
+               write(*, "(a/a,i5,a,i5)") "fail", "col ", i, &
+                  "has non-monotonic row numbers at j=", j
+               errors = errors + 1
+               return
+            endif
+         endif
+         if(abs(val(j)).gt.1.0_wp) then
+            write(*, "(a/a,i5,a,es12.4)") "fail", "val( ", j, &
+               ") has out-of-range value ", val(j)
+            errors = errors + 1
+            return
+         endif
+      end do
+      do j = ptr(i), ptr(i+1)-1
+         seen(row(j)) = .false.
+      end do
+      if(nonsingular .and. i.le.min(m,n) .and. .not.dpresent) then
+         write(*, "(a/a,i5)") "fail", "nonsingular requested but diagonal not &
+            &present in column ", i
+         errors = errors + 1
+         return
+      endif
+   end do
+
+   write(*, "(a)") "ok"
+end subroutine chk_random_band
+
 subroutine test_errors
    integer :: matrix_type, m, n, nnz, flag
    integer, dimension(:), allocatable :: ptr, row
@@ -0,0 +1,266 @@
+!
+! Throughput benchmark for the random matrix generators.
+!
+! Sweeps the matrix size, bandwidth, fill ratio, matrix type and the sort,
+! nonsingular, direct and complement options of random_matrix_generate,
+! reporting for each case the entries generated per second, the peak resident
+! set size and the number of raw random samples drawn per entry. Results are
+! written as JSON, one case per line, to the file named by the first command
+! line argument if present, or to standard output otherwise.
+!
+! The peak resident set size is reset before each case where the operating
+! system allows it, but may still include memory retained by the allocator
+! from earlier cases.
+!
+! Draws are only counted if spral_random is compiled with
+! SPRAL_RANDOM_COUNT_DRAWS defined, as meson does when benchmarks are enabled,
+! and are reported as null otherwise.
+!
+program random_matrix_benchmark
+   use spral_matrix_util, only : SPRAL_MATRIX_REAL_RECT,       &
+                                 SPRAL_MATRIX_REAL_UNSYM,      &
+                                 SPRAL_MATRIX_REAL_SYM_INDEF
+   use spral_random, only : random_state, random_set_seed, &
+                            random_get_draws, random_reset_draws
+   use spral_random_matrix, only : random_matrix_generate
+!$ use omp_lib
+   implicit none
+
+   integer, parameter :: wp = kind(0d0)
+   integer, parameter :: long = selected_int_kind(18)
+
+   ! Each case is repeated until min_time has elapsed, at most max_rep times,
+   ! and the best time is reported
+   real(wp), parameter :: min_time = 0.2_wp
+   integer, parameter :: max_rep = 10
+
+   ! Sweep parameters. Non-band fill is relative to the whole matrix, band
+   ! fill to the positions within the band.
+   integer, dimension(2), parameter :: nonband_n = (/ 1000, 4000 /)
+   real(wp), dimension(4), parameter :: nonband_fill = &
+      (/ 0.01_wp, 0.1_wp, 0.5_wp, 0.9_wp /)
+   integer, dimension(2), parameter :: band_n = (/ 2000, 20000 /)
+   integer, dimension(3), parameter :: band_bw = (/ 4, 40, 400 /)
+   real(wp), dimension(3), parameter :: band_fill = &
+      (/ 0.1_wp, 0.5_wp, 0.9_wp /)
+   integer, dimension(3), parameter :: types = (/ SPRAL_MATRIX_REAL_RECT, &
+      SPRAL_MATRIX_REAL_UNSYM, SPRAL_MATRIX_REAL_SYM_INDEF /)
+
+   integer :: unit, ncase, nthread, i, j, k, l, isort, inons, idirect, icomp
+   character(len=256) :: fname
+
+   unit = 6
+   if(command_argument_count().ge.1) then
+      call get_command_argument(1, fname)
+      open(newunit=unit, file=trim(fname), status="replace", action="write")
+   endif
+
+   nthread = 1
+!$ nthread = omp_get_max_threads()
+
+   write(unit, "(a)") "{"
+   write(unit, "(a)") '  "benchmark": "random_matrix",'
+   write(unit, "(a,i0,a)") '  "threads": ', nthread, ','
+   write(unit, "(a)", advance="no") '  "cases": ['
+
+   ncase = 0
+   do k = 1, size(types)
+      do isort = 0, 1
+         do inons = 0, 1
+            ! Non-band generator, with and without complement sampling
+            do icomp = 0, 1
+               do i = 1, size(nonband_n)
+                  do j = 1, size(nonband_fill)
+                     call run_case(types(k), nonband_n(i), 0, &
+                        nonband_fill(j), isort.eq.1, inons.eq.1, .false., &
+                        icomp.eq.1)
+                  end do
+               end do
+            end do
+            ! Band generator, with and without rejection
+            do idirect = 0, 1
+               do i = 1, size(band_n)
+                  do l = 1, size(band_bw)
+                     do j = 1, size(band_fill)
+                        call run_case(types(k), band_n(i), band_bw(l), &
+                           band_fill(j), isort.eq.1, inons.eq.1, &
+                           idirect.eq.1, .false.)
+                     end do
+                  end do
+               end do
+            end do
+         end do
+      end do
+   end do
+
+   write(unit, "(/a)") "  ]"
+   write(unit, "(a)") "}"
+   if(unit.ne.6) close(unit)
+
+contains
+
+!
+! Time the generation of a single matrix and write a JSON object describing
+! the case. bw = 0 selects the non-band generator.
+!
+subroutine run_case(matrix_type, n, bw, fill, sort, nonsingular, direct, &
+      complement)
+   integer, intent(in) :: matrix_type
+   integer, intent(in) :: n
+   integer, intent(in) :: bw
+   real(wp), intent(in) :: fill
+   logical, intent(in) :: sort
+   logical, intent(in) :: nonsingular
+   logical, intent(in) :: direct
+   logical, intent(in) :: complement
+
+   integer :: m, j, flag, nrep
+   integer(long) :: cap, nnz, draws, rss, t0, t1, rate
+   integer(long), dimension(:), allocatable :: ptr
+   integer, dimension(:), allocatable :: row
+   real(wp), dimension(:), allocatable :: val
+   real(wp) :: time, best, total
+   type(random_state) :: state
+   character(len=16) :: routine
+
+   m = n
+   if(matrix_type.eq.SPRAL_MATRIX_REAL_RECT) m = (5*n)/4
+
+   ! Positions available to the generator
+   cap = 0
+   do j = 1, n
+      if(bw.eq.0) then
+         if(matrix_type.eq.SPRAL_MATRIX_REAL_SYM_INDEF) then
+            cap = cap + (n-j+1)
+         else
+            cap = cap + m
+         endif
+      else
+         if(matrix_type.eq.SPRAL_MATRIX_REAL_SYM_INDEF) then
+            cap = cap + (min(n, j+bw) - j + 1)
+         else
+            cap = cap + max(0, min(m, j+bw) - max(1, j-bw) + 1)
+         endif
+      endif
+   end do
+   nnz = max(1_long, int(fill*cap, long))
+   if(nonsingular) nnz = max(nnz, int(min(m,n), long))
+
+   call reset_peak_rss()
+   allocate(ptr(n+1), row(nnz), val(nnz))
+
+   best = huge(best)
+   total = 0
+   nrep = 0
+   draws = 0
+   do while(nrep.lt.max_rep .and. (nrep.eq.0 .or. total.lt.min_time))
+      call random_set_seed(state, 1)
+      call random_reset_draws()
+      call system_clock(t0, rate)
+      if(bw.eq.0) then
+         call random_matrix_generate(state, matrix_type, m, n, nnz, ptr, &
+            row, flag, val=val, nonsingular=nonsingular, sort=sort, &
+            complement=complement)
+      else
+         call random_matrix_generate(state, matrix_type, m, n, nnz, bw, ptr, &
+            row, flag, val=val, nonsingular=nonsingular, sort=sort, &
+            direct=direct)
+      endif
+      call system_clock(t1)
+      if(nrep.eq.0) draws = random_get_draws()
+      time = max(real(t1-t0, wp) / real(rate, wp), 1e-9_wp)
+      best = min(best, time)
+      total = total + time
+      nrep = nrep + 1
+      if(flag.ne.0) exit
+   end do
+   rss = peak_rss()
+
+   deallocate(ptr, row, val)
+
+   routine = "generate64"
+   if(bw.gt.0) routine = "generate64_band"
+   if(ncase.gt.0) write(unit, "(a)", advance="no") ","
+   ncase = ncase + 1
+   write(unit, "(/a)", advance="no") "    {"
+   write(unit, "(3a)", advance="no") '"routine": "', trim(routine), '", '
+   write(unit, "(a,i0,a)", advance="no") '"matrix_type": ', matrix_type, ', '
+   write(unit, "(a,i0,a)", advance="no") '"m": ', m, ', '
+   write(unit, "(a,i0,a)", advance="no") '"n": ', n, ', '
+   write(unit, "(a,i0,a)", advance="no") '"bw": ', bw, ', '
+   write(unit, "(3a)", advance="no") '"fill": ', trim(real_str(fill)), ', '
+   write(unit, "(a,i0,a)", advance="no") '"nnz": ', nnz, ', '
+   write(unit, "(3a)", advance="no") '"sort": ', trim(logical_str(sort)), ', '
+   write(unit, "(3a)", advance="no") &
+      '"nonsingular": ', trim(logical_str(nonsingular)), ', '
+   write(unit, "(3a)", advance="no") &
+      '"direct": ', trim(logical_str(direct)), ', '
+   write(unit, "(3a)", advance="no") &
+      '"complement": ', trim(logical_str(complement)), ', '
+   write(unit, "(a,i0,a)", advance="no") '"flag": ', flag, ', '
+   write(unit, "(a,i0,a)", advance="no") '"repeats": ', nrep, ', '
+   write(unit, "(3a)", advance="no") '"time_s": ', trim(real_str(best)), ', '
+   write(unit, "(3a)", advance="no") &
+      '"entries_per_s": ', trim(real_str(real(nnz,wp)/best)), ', '
+   write(unit, "(a,i0,a)", advance="no") '"peak_rss_kb": ', rss, ', '
+   if(draws.lt.0) then
+      ! Library built without SPRAL_RANDOM_COUNT_DRAWS
+      write(unit, "(a)", advance="no") '"draws": null, "draws_per_entry": null}'
+   else
+      write(unit, "(a,i0,a)", advance="no") '"draws": ', draws, ', '
+      write(unit, "(3a)", advance="no") '"draws_per_entry": ', &
+         trim(real_str(real(draws,wp)/real(nnz,wp))), '}'
+   endif
+end subroutine run_case
+
+!
+! Reset the peak resident set size of the process, where supported
+! (Linux only). Otherwise the peak over the whole run is reported.
+!
+subroutine reset_peak_rss()
+   integer :: u, st
+
+   open(newunit=u, file="/proc/self/clear_refs", action="write", iostat=st)
+   if(st.ne.0) return
+   write(u, "(a)", iostat=st) "5"
+   close(u, iostat=st)
+end subroutine reset_peak_rss
+
+!
+! Return the peak resident set size of the process in kB, or -1 if it is
+! not available
+!
+integer(long) function peak_rss()
+   integer :: u, st
+   character(len=256) :: line
+
+   peak_rss = -1
+   open(newunit=u, file="/proc/self/status", action="read", iostat=st)
+   if(st.ne.0) return
+   do
+      read(u, "(a)", iostat=st) line
+      if(st.ne.0) exit
+      if(line(1:6).eq."VmHWM:") then
+         read(line(7:), *, iostat=st) peak_rss
+         if(st.ne.0) peak_rss = -1
+         exit
+      endif
+   end do
+   close(u)
+end function peak_rss
+
+character(len=24) function real_str(x)
+   real(wp), intent(in) :: x
+
+   write(real_str, "(es14.6e3)") x
+   real_str = adjustl(real_str)
+end function real_str
+
+character(len=5) function logical_str(l)
+   logical, intent(in) :: l
+
+   logical_str = "false"
+   if(l) logical_str = "true"
+end function logical_str
+
+end program random_matrix_benchmark
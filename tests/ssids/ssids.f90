@@ -62,6 +62,7 @@ program main
    integer, parameter :: SSIDS_ERROR_NOT_LLT             = -13
    integer, parameter :: SSIDS_ERROR_NOT_LDLT            = -14
    integer, parameter :: SSIDS_ERROR_NO_SAVED_SCALING    = -15
+   integer, parameter :: SSIDS_ERROR_SPARSE_RHS          = -16
    integer, parameter :: SSIDS_ERROR_ALLOCATION          = -50
    integer, parameter :: SSIDS_ERROR_CUDA_UNKNOWN        = -51
    integer, parameter :: SSIDS_ERROR_CUBLAS_UNKNOWN      = -52
@@ -77,6 +78,7 @@ program main
    integer, parameter :: SSIDS_WARNING_ANAL_SINGULAR    = 6
    integer, parameter :: SSIDS_WARNING_FACT_SINGULAR    = 7
    integer, parameter :: SSIDS_WARNING_MATCH_ORD_NO_SCALE=8
+   integer, parameter :: SSIDS_WARNING_REFINE_NOT_CONV  = 9
 
    ! warning flags
 
@@ -91,6 +93,11 @@ program main
    call test_random
    call test_random_scale
    call test_big
+   call test_many_rhs
+   call test_solve_memory
+   call test_sparse_rhs
+   call test_band
+   call test_refine
 
    write(*, "(/a)") "=========================="
    write(*, "(a,i4)") "Total number of errors = ", errors
@@ -124,6 +131,7 @@ subroutine test_errors
    real(wp), dimension(:), allocatable :: x1, d1
    type(random_state) :: state
 
+   options%band_mode = 0 ! band path is tested in test_band
    options%unit_error = we_unit
    options%unit_warning = we_unit
 
@@ -849,6 +857,7 @@ subroutine test_warnings
    real(wp), dimension(:), allocatable :: x1
    integer :: cuda_error
 
+   options%band_mode = 0 ! band path is tested in test_band
    write(*,"(a)")
    write(*,"(a)") "================"
    write(*,"(a)") "Testing warnings"
@@ -1156,6 +1165,8 @@ subroutine test_special
 
    integer :: big_test_n = int(1e5 + 5)
 
+   ! Band path is tested separately in test_band
+   options%band_mode = 0; default_options%band_mode = 0
    options%unit_error = we_unit; default_options%unit_error = we_unit
    options%unit_warning = we_unit; default_options%unit_warning = we_unit
    check = .true.
@@ -1877,6 +1888,7 @@ subroutine test_random
    integer :: max_threads
    type(numa_region), dimension(:), allocatable :: fake_topology
 
+   options%band_mode = 0 ! band path is tested in test_band
    max_threads = 1
 !$ max_threads = omp_get_max_threads()
    if(max_threads > 1) then
@@ -2308,6 +2320,7 @@ subroutine test_big
    integer :: i, j, k, nrhs, cuda_error
    real(wp) :: num_flops
 
+   options%band_mode = 0 ! band path is tested in test_band
    write(*, "(a)")
    write(*, "(a)") "=================="
    write(*, "(a)") "Testing big matrix"
@@ -2402,6 +2415,682 @@ subroutine test_big
 
 end subroutine test_big
 
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+subroutine test_many_rhs
+   type(ssids_akeep) :: akeep
+   type(ssids_fkeep) :: fkeep
+   type(ssids_options) :: options
+   type(ssids_inform) :: info
+
+   type(random_state) :: state
+   type(matrix_type) :: a
+   real(wp), allocatable, dimension(:, :) :: rhs,x
+   real(wp), allocatable, dimension(:, :) :: res
+
+   logical :: posdef
+   integer :: i, j, k, r, nrhs, cuda_error
+
+   options%band_mode = 0 ! band path is tested in test_band
+   write(*, "(a)")
+   write(*, "(a)") "==============================="
+   write(*, "(a)") "Testing many right-hand sides"
+   write(*, "(a)") "==============================="
+
+   a%n = 2000
+   a%ne = 5*a%n
+   nrhs = 100 ! several panels of right-hand sides
+
+   allocate(a%ptr(a%n+1))
+   allocate(a%row(2*a%ne), a%val(2*a%ne), a%col(2*a%ne))
+   allocate(rhs(a%n,nrhs), res(a%n,nrhs), x(a%n,nrhs))
+
+   do k = 0, 1
+      posdef = (k.eq.0)
+
+      write(*, "(a, l1, a, i9, a, i11, a, i4, a)",advance="no") &
+         " * posdef = ", posdef, " n = ", a%n, " nza = ", a%ne, " nrhs = ", &
+         nrhs, "..."
+
+      if(posdef) then
+         call gen_random_posdef(a, a%ne, state)
+      else
+         call gen_random_indef(a, a%ne, state)
+      endif
+
+      call ssids_analyse(.false., a%n, a%ptr, a%row, akeep, options, info)
+      if(info%flag .ne. SSIDS_SUCCESS) then
+         write(*, "(a,i3)") "fail on analyse", info%flag
+         call ssids_free(akeep, cuda_error)
+         errors = errors + 1
+         return
+      endif
+
+      ! Generate rhs with x(i,r) = (i+r)/n. Remember we have only half
+      ! matrix held.
+      rhs(1:a%n, 1:nrhs) = zero
+      do r = 1, nrhs
+         do j = 1, a%n
+            do i = a%ptr(j), a%ptr(j+1)-1
+               rhs(a%row(i), r) = rhs(a%row(i), r) + &
+                  a%val(i)*real(j+r)/real(a%n)
+               if(a%row(i).eq.j) cycle
+               rhs(j, r) = rhs(j, r) + a%val(i)*real(a%row(i)+r)/real(a%n)
+            end do
+         end do
+      end do
+
+      call ssids_factor(posdef, a%val, akeep, fkeep, options, info, &
+         ptr=a%ptr, row=a%row)
+      if(info%flag .lt. SSIDS_SUCCESS) then
+         write(*, "(a,i3)") "fail on factor", info%flag
+         call ssids_free(akeep, fkeep, cuda_error)
+         errors = errors + 1
+         return
+      endif
+
+      ! Solve in one call
+      x(1:a%n,1:nrhs) = rhs(1:a%n,1:nrhs)
+      call ssids_solve(nrhs, x, a%n, akeep, fkeep, options, info)
+      if(info%flag .lt. SSIDS_SUCCESS) then
+         write(*, "(a,i4)") " fail on solve", info%flag
+         call ssids_free(akeep, fkeep, cuda_error)
+         errors = errors + 1
+         return
+      endif
+      call compute_resid(nrhs,a,x,a%n,rhs,a%n,res,a%n)
+      if(maxval(abs(res(1:a%n,1:nrhs))) < err_tol) then
+         write(*, "(a)", advance="no") "ok..."
+      else
+         write(*, "(a,es12.4)") " fail residual = ", &
+            maxval(abs(res(1:a%n,1:nrhs)))
+         errors = errors + 1
+      endif
+
+      ! Fwd, then bwd (posdef) or diag+bwd (indef) solves
+      x(1:a%n,1:nrhs) = rhs(1:a%n,1:nrhs)
+      call ssids_solve(nrhs, x, a%n, akeep, fkeep, options, info, job=1)
+      if(info%flag .lt. SSIDS_SUCCESS) then
+         write(*, "(a,i4)") " fail on solve with job = 1", info%flag
+         call ssids_free(akeep, fkeep, cuda_error)
+         errors = errors + 1
+         return
+      endif
+      if(posdef) then
+         call ssids_solve(nrhs, x, a%n, akeep, fkeep, options, info, job=3)
+      else
+         call ssids_solve(nrhs, x, a%n, akeep, fkeep, options, info, job=4)
+      endif
+      if(info%flag .lt. SSIDS_SUCCESS) then
+         write(*, "(a,i4)") " fail on solve with job = 3/4", info%flag
+         call ssids_free(akeep, fkeep, cuda_error)
+         errors = errors + 1
+         return
+      endif
+      call compute_resid(nrhs,a,x,a%n,rhs,a%n,res,a%n)
+      if(maxval(abs(res(1:a%n,1:nrhs))) < err_tol) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a,es12.4)") " fail residual = ", &
+            maxval(abs(res(1:a%n,1:nrhs)))
+         errors = errors + 1
+      endif
+
+      call ssids_free(akeep, fkeep, cuda_error)
+   end do
+
+end subroutine test_many_rhs
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+! The forward solve keeps the updates of each node in a buffer of nrhs
+! columns until its parent is solved. Check that these are freed as the solve
+! proceeds, so that its peak memory does not grow like nrhs times the size of
+! the whole tree. Linux only, as the peak resident set size is read from /proc.
+subroutine test_solve_memory
+   type(ssids_akeep) :: akeep
+   type(ssids_fkeep) :: fkeep
+   type(ssids_options) :: options
+   type(ssids_inform) :: info
+
+   type(matrix_type) :: a
+   real(wp), allocatable, dimension(:, :) :: x
+
+   integer, parameter :: n = 10000
+   integer, parameter :: w = 300 ! semi-bandwidth
+   integer, parameter :: nrhs = 64
+   integer :: i, j, nthreads, cuda_error
+   integer(long) :: rss, peak, bound
+
+   options%band_mode = 0 ! band path is tested in test_band
+   write(*, "(a)")
+   write(*, "(a)") "==============================="
+   write(*, "(a)") "Testing solve memory"
+   write(*, "(a)") "==============================="
+
+   write(*, "(a, i9, a, i4, a)",advance="no") &
+      " * band n = ", n, " nrhs = ", nrhs, "..."
+   rss = current_rss()
+   if(rss.lt.0) then
+      write(*, "(a)") "skipped (no /proc)"
+      return
+   endif
+
+   ! Full band of semi-bandwidth w, lower triangle by columns. Its assembly
+   ! tree is a chain of small nodes each with about w rows of updates.
+   a%n = n
+   allocate(a%ptr(a%n+1), a%row(a%n*(w+1)), a%val(a%n*(w+1)))
+   a%ptr(1) = 1
+   do j = 1, a%n
+      i = a%ptr(j)
+      a%row(i) = j; a%val(i) = 2*w+1
+      do i = a%ptr(j)+1, a%ptr(j)+min(w, a%n-j)
+         a%row(i) = j + i - a%ptr(j); a%val(i) = -1.0
+      end do
+      a%ptr(j+1) = a%ptr(j) + min(w, a%n-j) + 1
+   end do
+   allocate(x(a%n, nrhs))
+
+   call ssids_analyse(.false., a%n, a%ptr, a%row, akeep, options, info)
+   if(info%flag .ne. SSIDS_SUCCESS) then
+      write(*, "(a,i3)") "fail on analyse", info%flag
+      call ssids_free(akeep, cuda_error)
+      errors = errors + 1
+      return
+   endif
+   call ssids_factor(.true., a%val, akeep, fkeep, options, info, &
+      ptr=a%ptr, row=a%row)
+   if(info%flag .lt. SSIDS_SUCCESS) then
+      write(*, "(a,i3)") "fail on factor", info%flag
+      call ssids_free(akeep, fkeep, cuda_error)
+      errors = errors + 1
+      return
+   endif
+
+   x(:,:) = 1.0
+   call reset_peak_rss()
+   rss = current_rss()
+   call ssids_solve(nrhs, x, a%n, akeep, fkeep, options, info, job=1)
+   peak = peak_rss()
+   if(info%flag .lt. SSIDS_SUCCESS) then
+      write(*, "(a,i4)") " fail on solve", info%flag
+      call ssids_free(akeep, fkeep, cuda_error)
+      errors = errors + 1
+      return
+   endif
+
+   ! Allow for the permuted copy of x and per-thread workspace of a few
+   ! fronts, plus 8MB of slack. Keeping every node's buffer would take about
+   ! 8*nrhs*w bytes for each of the n/nemin nodes.
+   nthreads = 1
+!$ nthreads = omp_get_max_threads()
+   bound = (8*nrhs*(2_long*a%n + 4_long*nthreads*info%maxfront))/1024 + 8192
+   if(peak.lt.0) then
+      write(*, "(a)") "skipped (no peak)"
+   else if(peak-rss .le. bound) then
+      write(*, "(a)") "ok"
+   else
+      write(*, "(a,i9,a,i9,a)") " fail extra memory = ", peak-rss, &
+         "kB > ", bound, "kB"
+      errors = errors + 1
+   endif
+
+   call ssids_free(akeep, fkeep, cuda_error)
+end subroutine test_solve_memory
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+subroutine test_sparse_rhs
+   type(ssids_akeep) :: akeep
+   type(ssids_fkeep) :: fkeep
+   type(ssids_options) :: options
+   type(ssids_inform) :: info
+
+   integer, parameter :: nrhs = 3
+   integer, parameter :: nwant = 10
+   real(wp), parameter :: unset = -huge(one)
+
+   type(random_state) :: state
+   type(matrix_type) :: a
+   integer, dimension(nrhs+1) :: rhs_ptr
+   integer, dimension(5*nrhs) :: rhs_row
+   real(wp), dimension(5*nrhs) :: rhs_val
+   integer, dimension(nwant) :: want
+   real(wp), allocatable, dimension(:, :) :: rhs, x, x2
+
+   logical :: posdef, band
+   integer :: i, k, r, nz, cuda_error
+
+   write(*, "(a)")
+   write(*, "(a)") "==============================="
+   write(*, "(a)") "Testing sparse right-hand sides"
+   write(*, "(a)") "==============================="
+
+   a%n = 1000
+   a%ne = 5*a%n
+
+   allocate(a%ptr(a%n+1))
+   allocate(a%row(2*a%ne), a%val(2*a%ne), a%col(2*a%ne))
+   allocate(rhs(a%n,nrhs), x(a%n,nrhs), x2(a%n,nrhs))
+
+   do k = 0, 5
+      posdef = (mod(k,2).eq.0)
+      ! The band cases check that solves skip the inactive nodes of the chain
+      band = (k.ge.4)
+      options%band_mode = 0
+      if(band) options%band_mode = 1
+      options%scaling = 0
+      if(k.ge.2) options%scaling = 1 ! MC64
+
+      write(*, "(a, l1, a, i2, a, l1, a)",advance="no") &
+         " * posdef = ", posdef, " scaling = ", options%scaling, &
+         " band = ", band, "..."
+
+      if(band) then
+         call gen_random_band(posdef, a, a%ne, 20, state)
+      else if(posdef) then
+         call gen_random_posdef(a, a%ne, state)
+      else
+         call gen_random_indef(a, a%ne, state)
+      endif
+
+      ! Right-hand sides with 1 to 5 nonzeros each, possibly duplicated
+      rhs_ptr(1) = 1
+      rhs(:,:) = zero
+      do r = 1, nrhs
+         nz = random_integer(state, 5)
+         do i = rhs_ptr(r), rhs_ptr(r)+nz-1
+            rhs_row(i) = random_integer(state, a%n)
+            rhs_val(i) = random_real(state)
+            rhs(rhs_row(i), r) = rhs(rhs_row(i), r) + rhs_val(i)
+         end do
+         rhs_ptr(r+1) = rhs_ptr(r) + nz
+      end do
+      do i = 1, nwant
+         want(i) = random_integer(state, a%n)
+      end do
+
+      call ssids_analyse(.false., a%n, a%ptr, a%row, akeep, options, info)
+      if(info%flag .ne. SSIDS_SUCCESS) then
+         write(*, "(a,i3)") "fail on analyse", info%flag
+         call ssids_free(akeep, cuda_error)
+         errors = errors + 1
+         return
+      endif
+
+      call ssids_factor(posdef, a%val, akeep, fkeep, options, info, &
+         ptr=a%ptr, row=a%row)
+      if(info%flag .lt. SSIDS_SUCCESS) then
+         write(*, "(a,i3)") "fail on factor", info%flag
+         call ssids_free(akeep, fkeep, cuda_error)
+         errors = errors + 1
+         return
+      endif
+
+      ! Reference solution from dense solve
+      x2(:,:) = rhs(:,:)
+      call ssids_solve(nrhs, x2, a%n, akeep, fkeep, options, info)
+      if(info%flag .lt. SSIDS_SUCCESS) then
+         write(*, "(a,i4)") " fail on solve", info%flag
+         call ssids_free(akeep, fkeep, cuda_error)
+         errors = errors + 1
+         return
+      endif
+
+      ! All components
+      x(:,:) = unset
+      call ssids_solve_sparse(nrhs, rhs_ptr, rhs_row, rhs_val, x, a%n, &
+         akeep, fkeep, options, info)
+      if(info%flag .lt. SSIDS_SUCCESS) then
+         write(*, "(a,i4)") " fail on sparse solve", info%flag
+         call ssids_free(akeep, fkeep, cuda_error)
+         errors = errors + 1
+         return
+      endif
+      if(maxval(abs(x(:,:)-x2(:,:))) < err_tol*max(one,maxval(abs(x2)))) then
+         write(*, "(a)", advance="no") "ok..."
+      else
+         write(*, "(a,es12.4)") " fail difference = ", &
+            maxval(abs(x(:,:)-x2(:,:)))
+         errors = errors + 1
+      endif
+
+      ! Wanted components only, other entries left alone
+      x(:,:) = unset
+      call ssids_solve_sparse(nrhs, rhs_ptr, rhs_row, rhs_val, x, a%n, &
+         akeep, fkeep, options, info, want=want)
+      if(info%flag .lt. SSIDS_SUCCESS) then
+         write(*, "(a,i4)") " fail on sparse solve with want", info%flag
+         call ssids_free(akeep, fkeep, cuda_error)
+         errors = errors + 1
+         return
+      endif
+      if(maxval(abs(x(want,:)-x2(want,:))) < &
+            err_tol*max(one,maxval(abs(x2)))) then
+         write(*, "(a)", advance="no") "ok..."
+      else
+         write(*, "(a,es12.4)") " fail difference = ", &
+            maxval(abs(x(want,:)-x2(want,:)))
+         errors = errors + 1
+      endif
+      x(want,:) = unset
+      if(all(x(:,:).eq.unset)) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a)") " fail: unwanted components altered"
+         errors = errors + 1
+      endif
+
+      call ssids_free(akeep, fkeep, cuda_error)
+   end do
+   options%scaling = 0
+
+   ! Errors in sparse right-hand side and want
+   write(*, "(a)",advance="no") " * Testing errors............................"
+   call gen_random_posdef(a, a%ne, state)
+   call ssids_analyse(.false., a%n, a%ptr, a%row, akeep, options, info)
+   call ssids_factor(.true., a%val, akeep, fkeep, options, info, &
+      ptr=a%ptr, row=a%row)
+   rhs_ptr(:) = (/ 1, 2, 2, 3 /)
+   rhs_row(1:2) = (/ 1, a%n+1 /)
+   rhs_val(1:2) = one
+   call ssids_solve_sparse(nrhs, rhs_ptr, rhs_row, rhs_val, x, a%n, &
+      akeep, fkeep, options, info)
+   call print_result(info%flag, SSIDS_ERROR_SPARSE_RHS)
+   write(*, "(a)",advance="no") " * Testing errors............................"
+   rhs_row(2) = a%n
+   want(1) = 0
+   call ssids_solve_sparse(nrhs, rhs_ptr, rhs_row, rhs_val, x, a%n, &
+      akeep, fkeep, options, info, want=want)
+   call print_result(info%flag, SSIDS_ERROR_SPARSE_RHS)
+   call ssids_free(akeep, fkeep, cuda_error)
+
+end subroutine test_sparse_rhs
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+subroutine test_band
+   type(ssids_akeep) :: akeep
+   type(ssids_fkeep) :: fkeep
+   type(ssids_options) :: options
+   type(ssids_inform) :: info
+
+   integer, dimension(4), parameter :: bws = (/ 1, 5, 40, 100 /)
+   type(random_state) :: state
+
+   type(matrix_type) :: a
+   real(wp), allocatable, dimension(:, :) :: rhs,x
+   real(wp), allocatable, dimension(:) :: x1
+   real(wp), allocatable, dimension(:, :) :: res
+
+   logical :: posdef
+   integer :: i, j, k, ib, bw, nemin
+   integer :: cuda_error
+   integer(long) :: cap
+   integer, dimension(:), allocatable :: order
+
+   write(*, "(a)")
+   write(*, "(a)") "=========================="
+   write(*, "(a)") "Testing band factorization"
+   write(*, "(a)") "=========================="
+
+   a%n = 500
+   allocate(a%ptr(a%n+1), order(a%n))
+
+   options%band_mode = 1 ! use if semi-bandwidth <= band_max_width
+   nemin = 32 ! default options%nemin
+
+   do ib = 1, size(bws)
+      do k = 0, 1
+         posdef = (k.eq.0)
+
+         ! Fill three quarters of the band
+         cap = 0
+         do j = 1, a%n
+            cap = cap + min(a%n, j+bws(ib)) - j + 1
+         end do
+         a%ne = max(int(a%n,long), (3*cap)/4)
+         if(allocated(a%row)) deallocate(a%row, a%val)
+         allocate(a%row(a%ne), a%val(a%ne))
+         call gen_random_band(posdef, a, a%ne, bws(ib), state)
+
+         ! Measure actual semi-bandwidth
+         bw = 0
+         do j = 1, a%n
+            do i = a%ptr(j), a%ptr(j+1)-1
+               bw = max(bw, a%row(i)-j)
+            end do
+         end do
+
+         write(*, "(a,l1,a,i4,a,i8,a)") &
+            " * posdef = ", posdef, " bw = ", bw, " nza = ", a%ne, "..."
+
+         ! Alternate between natural order and a user supplied reverse order,
+         ! which has the same bandwidth
+         write(*,"(a)",advance="no") " *    analysing.........................."
+         if(mod(ib,2).eq.0) then
+            options%ordering = 0
+            do i = 1, a%n
+               order(i) = a%n - i + 1
+            end do
+            call ssids_analyse(.true., a%n, a%ptr, a%row, akeep, options, &
+               info, order=order)
+         else
+            options%ordering = 1
+            call ssids_analyse(.true., a%n, a%ptr, a%row, akeep, options, info)
+         endif
+         if(info%flag .ne. SSIDS_SUCCESS) then
+            write(*, "(a,i4)") "fail on analyse", info%flag
+            errors = errors + 1
+            call ssids_free(akeep, cuda_error)
+            cycle
+         endif
+         ! If band path was used, expect a chain of blocks of max(bw,nemin)
+         ! columns
+         if(bw.le.options%band_max_width) then
+            call print_result(info%num_sup, (a%n-1)/max(bw,nemin)+1)
+         else
+            write(*, "(a)") "ok"
+         endif
+
+         call gen_rhs(a, rhs, x1, x, res, 1, state)
+         call chk_answer(posdef, a, akeep, options, rhs, x, res, &
+            SSIDS_SUCCESS)
+         call ssids_free(akeep, cuda_error)
+      end do
+   end do
+
+   ! Block diagonal with 4x4 blocks
+   !    ( 0   0.5 1e3 0   )
+   !    ( 0.5 0   0   1e3 )
+   !    ( 1e3 0   1   0   )
+   !    ( 0   1e3 0   0   )
+   ! and two columns per node. The leading 2x2 of each block is too small to
+   ! pivot on, so it is delayed into the next node, which must then relax its
+   ! threshold without accepting a zero as a pivot. The root is never relaxed.
+   write(*, "(a)") " * posdef = F bw =    2 zero diagonal, nemin = 1..."
+   options%nemin = 1
+   options%ordering = 1
+   a%ne = 7*(a%n/4)
+   deallocate(a%row, a%val)
+   allocate(a%row(a%ne), a%val(a%ne))
+   k = 1
+   do j = 1, a%n
+      a%ptr(j) = k
+      a%row(k) = j
+      a%val(k) = merge(1.0_wp, 0.0_wp, mod(j-1, 4).eq.2)
+      k = k + 1
+      if(mod(j-1, 4).eq.0) then
+         a%row(k) = j + 1
+         a%val(k) = 0.5_wp
+         k = k + 1
+      endif
+      if(mod(j-1, 4).lt.2) then
+         a%row(k) = j + 2
+         a%val(k) = 1e3_wp
+         k = k + 1
+      endif
+   end do
+   a%ptr(a%n+1) = k
+
+   write(*,"(a)",advance="no") " *    factorizing........................"
+   call ssids_analyse(.true., a%n, a%ptr, a%row, akeep, options, info)
+   if(info%flag .ne. SSIDS_SUCCESS) then
+      write(*, "(a,i4)") "fail on analyse", info%flag
+      errors = errors + 1
+      call ssids_free(akeep, cuda_error)
+      return
+   endif
+   call ssids_factor(.false., a%val, akeep, fkeep, options, info)
+   if(info%flag .ne. SSIDS_SUCCESS) then
+      write(*, "(a,i4)") "fail on factor", info%flag
+      errors = errors + 1
+   else
+      call print_result(info%num_relaxed, a%n/4 - 1)
+   endif
+   call ssids_free(fkeep, cuda_error)
+
+   call gen_rhs(a, rhs, x1, x, res, 1, state)
+   call chk_answer(.false., a, akeep, options, rhs, x, res, SSIDS_SUCCESS)
+   call ssids_free(akeep, cuda_error)
+
+end subroutine test_band
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+subroutine test_refine
+   type(ssids_akeep) :: akeep
+   type(ssids_fkeep) :: fkeep
+   type(ssids_options) :: options
+   type(ssids_inform) :: info
+
+   integer, parameter :: nrhs = 2
+
+   type(random_state) :: state
+   type(matrix_type) :: a
+   real(wp), allocatable, dimension(:, :) :: rhs, x, res
+   real(wp), allocatable, dimension(:) :: x1
+
+   logical :: posdef, band
+   integer :: k, num_neg, cuda_error
+
+   write(*, "(a)")
+   write(*, "(a)") "===================================================="
+   write(*, "(a)") "Testing single precision factor with refinement"
+   write(*, "(a)") "===================================================="
+
+   a%n = 1000
+   a%ne = 5*a%n
+   allocate(a%ptr(a%n+1))
+   allocate(a%row(2*a%ne), a%val(2*a%ne), a%col(2*a%ne))
+
+   do k = 0, 3
+      posdef = (mod(k,2).eq.0)
+      band = (k.ge.2)
+      options%band_mode = 0
+      options%scaling = 0
+      if(.not.posdef) options%scaling = 1 ! MC64
+      if(band) then
+         options%band_mode = 1
+         call gen_random_band(posdef, a, a%ne, 40, state)
+      else if(posdef) then
+         call gen_random_posdef(a, a%ne, state)
+      else
+         call gen_random_indef(a, a%ne, state)
+      endif
+      call gen_rhs(a, rhs, x1, x, res, nrhs, state)
+
+      write(*, "(a,l1,a,l1,a)",advance="no") &
+         " * posdef = ", posdef, " band = ", band, "........"
+
+      ! Banded cases use a checked analyse, so ptr and row may be omitted
+      call ssids_analyse(band, a%n, a%ptr, a%row, akeep, options, info)
+      if(info%flag .ne. SSIDS_SUCCESS) then
+         write(*, "(a,i3)") "fail on analyse", info%flag
+         call ssids_free(akeep, cuda_error)
+         errors = errors + 1
+         cycle
+      endif
+
+      ! Inertia from double precision factors for reference
+      options%single_precision = .false.
+      call ssids_factor(posdef, a%val, akeep, fkeep, options, info, &
+         ptr=a%ptr, row=a%row)
+      num_neg = info%num_neg
+
+      options%single_precision = .true.
+      call ssids_factor(posdef, a%val, akeep, fkeep, options, info, &
+         ptr=a%ptr, row=a%row)
+      if(info%flag .lt. SSIDS_SUCCESS) then
+         write(*, "(a,i3)") "fail on factor", info%flag
+         call ssids_free(akeep, fkeep, cuda_error)
+         errors = errors + 1
+         cycle
+      endif
+      call print_result(info%num_neg, num_neg, continued=.true.)
+
+      if(band) then
+         call ssids_solve_refine(nrhs, x, a%n, a%val, akeep, fkeep, options, &
+            info)
+      else
+         call ssids_solve_refine(nrhs, x, a%n, a%val, akeep, fkeep, options, &
+            info, ptr=a%ptr, row=a%row)
+      endif
+      if(info%flag .ne. SSIDS_SUCCESS) then
+         write(*, "(a,i4)") " fail on refine", info%flag
+         call ssids_free(akeep, fkeep, cuda_error)
+         errors = errors + 1
+         cycle
+      endif
+      if(info%num_refine .lt. 1) then
+         write(*, "(a,i4)") " fail: num_refine = ", info%num_refine
+         errors = errors + 1
+      endif
+
+      call compute_resid(nrhs,a,x,a%n,rhs,a%n,res,a%n)
+      if(maxval(abs(res(1:a%n,1:nrhs))) < err_tol) then
+         write(*, "(a)") "ok"
+      else
+         write(*, "(a,es12.4)") " fail residual = ", &
+            maxval(abs(res(1:a%n,1:nrhs)))
+         errors = errors + 1
+      endif
+
+      call ssids_free(akeep, fkeep, cuda_error)
+   end do
+   options%band_mode = 0
+   options%scaling = 0
+
+   ! Too few refinement steps allowed
+   write(*, "(a)",advance="no") " * Testing max_refine = 0...................."
+   call gen_random_posdef(a, a%ne, state)
+   call gen_rhs(a, rhs, x1, x, res, 1, state)
+   call ssids_analyse(.false., a%n, a%ptr, a%row, akeep, options, info)
+   call ssids_factor(.true., a%val, akeep, fkeep, options, info, &
+      ptr=a%ptr, row=a%row)
+   options%max_refine = 0
+   options%unit_warning = -1
+   call ssids_solve_refine(1, x, a%n, a%val, akeep, fkeep, options, info, &
+      ptr=a%ptr, row=a%row)
+   call print_result(info%flag, SSIDS_WARNING_REFINE_NOT_CONV)
+   options%max_refine = 10
+   options%unit_warning = 6
+
+   ! Errors
+   options%unit_error = -1
+   write(*, "(a)",advance="no") " * Testing no row with check = .false........"
+   call ssids_solve_refine(1, x, a%n, a%val, akeep, fkeep, options, info, &
+      ptr=a%ptr)
+   call print_result(info%flag, SSIDS_ERROR_PTR_ROW)
+   write(*, "(a)",advance="no") " * Testing x too small......................."
+   call ssids_solve_refine(1, x, a%n-1, a%val, akeep, fkeep, options, info, &
+      ptr=a%ptr, row=a%row)
+   call print_result(info%flag, SSIDS_ERROR_X_SIZE)
+   call ssids_free(fkeep, cuda_error)
+   write(*, "(a)",advance="no") " * Testing refine before factor.............."
+   call ssids_solve_refine(1, x, a%n, a%val, akeep, fkeep, options, info, &
+      ptr=a%ptr, row=a%row)
+   call print_result(info%flag, SSIDS_ERROR_CALL_SEQUENCE)
+   call ssids_free(akeep, fkeep, cuda_error)
+
+end subroutine test_refine
+
 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
 subroutine test_random_scale
@@ -2437,6 +3126,7 @@ subroutine test_random_scale
 
    integer :: cuda_error
 
+   options%band_mode = 0 ! band path is tested in test_band
    write(*, "(a)")
    write(*, "(a)") "================================"
    write(*, "(a)") "Testing random matrices (scaled)"
@@ -2899,6 +3589,48 @@ subroutine gen_random_posdef(a, nza, state)
    end do
 end subroutine gen_random_posdef
 
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+subroutine gen_random_band(posdef, a, nza, bw, state)
+   logical, intent(in) :: posdef
+   type(matrix_type), intent(inout) :: a
+   integer(long), intent(in) :: nza
+   integer, intent(in) :: bw
+   type(random_state), intent(inout) :: state
+
+   integer :: i, j, k, flag
+   real(wp) :: tempv
+
+   ! Generate matrix FIXME: move to 64-bit
+   call random_matrix_generate(state, SPRAL_MATRIX_REAL_SYM_INDEF, a%n, a%n, &
+      int(nza), bw, a%ptr, a%row, flag, val=a%val, nonsingular=.true., &
+      sort=.true.)
+   if(flag.ne.0) print *, "Bad flag from random_matrix_generate()"
+
+   if(posdef) then
+      ! Make a diagonally dominant, observing first entry in column
+      ! is always the diagonal after sorting
+      do k = 1, a%n
+         a%val(a%ptr(k)) = abs(a%val(a%ptr(k)))
+      end do
+      do k = 1, a%n
+         tempv = zero
+         do j = a%ptr(k)+1, a%ptr(k+1)-1
+            tempv = tempv + abs(a%val(j))
+            i = a%ptr(a%row(j))
+            a%val(i) = a%val(i) + abs(a%val(j))
+         end do
+         i = a%ptr(k)
+         a%val(i) = one + a%val(i) + tempv
+      end do
+   else
+      ! Put zeros on some diagonals so pivoting is required
+      do k = 1, a%n, 7
+         if (a%ptr(k+1) > a%ptr(k) + 1) a%val(a%ptr(k)) = zero
+      end do
+   endif
+end subroutine gen_random_band
+
 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 subroutine assert_flag(context, actual, expected)
    character(len=*), intent(in) :: context
@@ -2942,4 +3674,50 @@ subroutine print_result(actual, expected, continued)
 end subroutine print_result
 
 
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+! Reset the peak resident set size of the process (Linux only)
+subroutine reset_peak_rss()
+   integer :: u, st
+
+   open(newunit=u, file="/proc/self/clear_refs", action="write", iostat=st)
+   if(st.ne.0) return
+   write(u, "(a)", iostat=st) "5"
+   close(u, iostat=st)
+end subroutine reset_peak_rss
+
+! Return the peak resident set size of the process in kB, or -1 if it is not
+! available
+integer(long) function peak_rss()
+   peak_rss = read_proc_status("VmHWM:")
+end function peak_rss
+
+! Return the resident set size of the process in kB, or -1 if it is not
+! available
+integer(long) function current_rss()
+   current_rss = read_proc_status("VmRSS:")
+end function current_rss
+
+! Return the value of the given field of /proc/self/status, or -1
+integer(long) function read_proc_status(field)
+   character(len=*), intent(in) :: field
+
+   integer :: u, st
+   character(len=256) :: line
+
+   read_proc_status = -1
+   open(newunit=u, file="/proc/self/status", action="read", iostat=st)
+   if(st.ne.0) return
+   do
+      read(u, "(a)", iostat=st) line
+      if(st.ne.0) exit
+      if(line(1:len(field)).eq.field) then
+         read(line(len(field)+1:), *, iostat=st) read_proc_status
+         if(st.ne.0) read_proc_status = -1
+         exit
+      endif
+   end do
+   close(u)
+end function read_proc_status
+
 end program